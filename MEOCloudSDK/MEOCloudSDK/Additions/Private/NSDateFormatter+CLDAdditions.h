@@ -12,4 +12,10 @@
 
 + (NSDateFormatter *)serviceDateFormatter;
 
+// Fixed-format parsing of "EEE, dd MMM yyyy HH:mm:ss ZZZ" dates.
+// Safe to call from any thread, anything unexpected falls back to serviceDateFormatter.
++ (NSDate *)serviceDateFromString:(NSString *)string;
++ (NSTimeInterval)serviceTimeIntervalFromString:(NSString *)string; // since reference date, NAN if invalid
++ (NSString *)serviceStringFromDate:(NSDate *)date;                 // in UTC, what serviceDateFormatter reads back
+
 @end
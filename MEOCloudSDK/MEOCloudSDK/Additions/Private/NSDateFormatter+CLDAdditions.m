@@ -8,6 +8,75 @@
 
 #import "NSDateFormatter+CLDAdditions.h"
 
+#define CLDServiceDateLength 31
+
+static const char *CLDServiceDateWeekdays[] = { "Thu", "Fri", "Sat", "Sun", "Mon", "Tue", "Wed" };
+static const char *CLDServiceDateMonths[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+
+static inline BOOL CLDParseDigits(const char *characters, int count, int *value) {
+    int result = 0;
+    for (int i = 0; i < count; i++) {
+        char c = characters[i];
+        if (c < '0' || c > '9') return NO;
+        result = result * 10 + (c - '0');
+    }
+    *value = result;
+    return YES;
+}
+
+static inline int CLDDaysInMonth(int year, int month) {
+    static const int days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    BOOL leapYear = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    return (month == 2 && leapYear) ? 29 : days[month - 1];
+}
+
+// days since 1970-01-01 for a proleptic gregorian date
+static inline int64_t CLDDaysFromCivil(int64_t year, int month, int day) {
+    year -= month <= 2;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    int64_t yearOfEra = year - era * 400;
+    int64_t dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+static BOOL CLDParseServiceDate(const char *characters, NSTimeInterval *interval) {
+    if (characters[3] != ',' || characters[4] != ' ' || characters[7] != ' ' || characters[11] != ' ' ||
+        characters[16] != ' ' || characters[19] != ':' || characters[22] != ':' || characters[25] != ' ') {
+        return NO;
+    }
+    
+    int day, year, hour, minute, second, offsetHours, offsetMinutes;
+    if (!CLDParseDigits(characters + 5, 2, &day) ||
+        !CLDParseDigits(characters + 12, 4, &year) ||
+        !CLDParseDigits(characters + 17, 2, &hour) ||
+        !CLDParseDigits(characters + 20, 2, &minute) ||
+        !CLDParseDigits(characters + 23, 2, &second) ||
+        !CLDParseDigits(characters + 27, 2, &offsetHours) ||
+        !CLDParseDigits(characters + 29, 2, &offsetMinutes)) {
+        return NO;
+    }
+    
+    int month = 0;
+    for (int i = 0; i < 12; i++) {
+        if (strncmp(characters + 8, CLDServiceDateMonths[i], 3) == 0) {
+            month = i + 1;
+            break;
+        }
+    }
+    
+    char sign = characters[26];
+    if (month == 0 || (sign != '+' && sign != '-') || day < 1 || day > CLDDaysInMonth(year, month) || hour > 23 || minute > 59 || second > 60) {
+        return NO;
+    }
+    
+    int64_t offset = (offsetHours * 60 + offsetMinutes) * 60;
+    int64_t seconds = CLDDaysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+    seconds -= sign == '+' ? offset : -offset;
+    *interval = (NSTimeInterval)seconds - NSTimeIntervalSince1970;
+    return YES;
+}
+
 @implementation NSDateFormatter (Additions)
 
 + (NSDateFormatter *)serviceDateFormatter {
@@ -21,4 +90,60 @@
     return _formatter;
 }
 
++ (NSDate *)serviceDateFromString:(NSString *)string {
+    NSTimeInterval interval = [self serviceTimeIntervalFromString:string];
+    return isnan(interval) ? nil : [NSDate dateWithTimeIntervalSinceReferenceDate:interval];
+}
+
++ (NSTimeInterval)serviceTimeIntervalFromString:(NSString *)string {
+    if (![string isKindOfClass:[NSString class]]) return NAN;
+    
+    // fast path works on the raw bytes without allocating
+    if (string.length == CLDServiceDateLength) {
+        char buffer[CLDServiceDateLength + 1];
+        const char *characters = CFStringGetCStringPtr((__bridge CFStringRef)string, kCFStringEncodingASCII);
+        if (characters == NULL && CFStringGetCString((__bridge CFStringRef)string, buffer, sizeof(buffer), kCFStringEncodingASCII)) {
+            characters = buffer;
+        }
+        NSTimeInterval interval;
+        if (characters && CLDParseServiceDate(characters, &interval)) {
+            return interval;
+        }
+    }
+    
+    // NSDateFormatter is not guaranteed to be thread-safe on every supported OS version
+    NSDateFormatter *formatter = [self serviceDateFormatter];
+    NSDate *date = nil;
+    @synchronized(formatter) {
+        date = [formatter dateFromString:string];
+    }
+    return date ? date.timeIntervalSinceReferenceDate : NAN;
+}
+
++ (NSString *)serviceStringFromDate:(NSDate *)date {
+    if (date == nil) return nil;
+    
+    int64_t seconds = (int64_t)floor(date.timeIntervalSince1970);
+    int64_t days = seconds >= 0 ? seconds / 86400 : (seconds - 86399) / 86400;
+    int64_t secondOfDay = seconds - days * 86400;
+    
+    // civil date from days since 1970-01-01
+    int64_t z = days + 719468;
+    int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    int64_t dayOfEra = z - era * 146097;
+    int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int64_t monthPart = (5 * dayOfYear + 2) / 153;
+    int day = (int)(dayOfYear - (153 * monthPart + 2) / 5 + 1);
+    int month = (int)(monthPart < 10 ? monthPart + 3 : monthPart - 9);
+    int64_t year = yearOfEra + era * 400 + (month <= 2);
+    int weekday = (int)(((days % 7) + 7) % 7);
+    
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%s, %02d %s %04lld %02d:%02d:%02d +0000",
+             CLDServiceDateWeekdays[weekday], day, CLDServiceDateMonths[month - 1], (long long)year,
+             (int)(secondOfDay / 3600), (int)(secondOfDay % 3600 / 60), (int)(secondOfDay % 60));
+    return [NSString stringWithUTF8String:buffer];
+}
+
 @end
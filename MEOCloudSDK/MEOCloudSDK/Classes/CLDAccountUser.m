@@ -93,13 +93,13 @@
         
         NSString *createDateString = dictionary[@"created_on"];
         if (createDateString) {
-            NSDate *createDate = [[NSDateFormatter serviceDateFormatter] dateFromString:createDateString];
+            NSDate *createDate = [NSDateFormatter serviceDateFromString:createDateString];
             user.createDate = createDate;
         }
         
         NSString *lastEventDateString = dictionary[@"last_event"];
         if (lastEventDateString) {
-            NSDate *lastEventDate = [[NSDateFormatter serviceDateFormatter] dateFromString:lastEventDateString];
+            NSDate *lastEventDate = [NSDateFormatter serviceDateFromString:lastEventDateString];
             user.lastEventDate = lastEventDate;
         }
         
@@ -0,0 +1,104 @@
+//
+//  CLDBatchOperation.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+@class CLDItem;
+
+/**
+ Default value for <[CLDBatchOperation maximumConcurrentRequests]>.
+ @since 1.1
+ */
+FOUNDATION_EXPORT const NSUInteger CLDBatchOperationDefaultMaximumConcurrentRequests;
+
+/**
+ This class represents the outcome of a batch operation for one of its items.
+
+ Items that were not performed, because the batch stopped at a failure or was cancelled, have neither a <resultItem> nor an <error>.
+ @since 1.1
+ */
+@interface CLDBatchResult : NSObject
+
+/**
+ The item given to the batch operation.
+ @since 1.1
+ */
+@property (readonly, strong, nonatomic) CLDItem *item;
+
+/**
+ The destination path given to the batch operation, or `nil` for operations without one.
+ @since 1.1
+ */
+@property (readonly, strong, nonatomic) NSString *path;
+
+/**
+ The item returned by the server, e.g. the copied, moved or restored item.
+ @since 1.1
+ */
+@property (readonly, strong, nonatomic) CLDItem *resultItem;
+
+/**
+ The error, if the operation failed for this item.
+ @since 1.1
+ */
+@property (readonly, strong, nonatomic) NSError *error;
+
+@end
+
+/**
+ This class performs the same operation on many items, with several requests in flight at the same time.
+
+ Results are collected as requests finish and handed to the completion block all at once, in the order of the items.
+ Batch operations are created by <CLDSession> methods such as <[CLDSession moveItems:toPaths:options:progressBlock:completionBlock:]>.
+ @since 1.1
+ */
+@interface CLDBatchOperation : NSObject
+
+/**
+ The identifier of the session this operation belongs to.
+ @since 1.1
+ */
+@property (readonly, strong, nonatomic) NSString *sessionIdentifier;
+
+/**
+ The maximum number of requests in flight at the same time.
+ Default value is `CLDBatchOperationDefaultMaximumConcurrentRequests`.
+ @since 1.1
+ */
+@property (readwrite, atomic) NSUInteger maximumConcurrentRequests;
+
+/**
+ The number of items in the batch.
+ @since 1.1
+ */
+@property (readonly, nonatomic) NSUInteger numberOfItems;
+
+/**
+ The number of items whose request finished so far, successfully or not.
+ @since 1.1
+ */
+@property (readonly, atomic) NSUInteger numberOfFinishedItems;
+
+/**
+ The number of items whose request failed so far.
+ @since 1.1
+ */
+@property (readonly, atomic) NSUInteger numberOfFailedItems;
+
+/**
+ `BOOL` stating whether the operation was cancelled.
+ @since 1.1
+ */
+@property (readonly, atomic, getter = isCancelled) BOOL cancelled;
+
+/**
+ Cancels the operation. Requests in flight are cancelled, although the server may have already performed them,
+ and the completion block is called right away with the results collected so far.
+ @since 1.1
+ */
+- (void)cancel;
+
+@end
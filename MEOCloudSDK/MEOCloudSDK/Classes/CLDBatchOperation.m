@@ -0,0 +1,216 @@
+//
+//  CLDBatchOperation.m
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import "CLDBatchOperation.h"
+
+const NSUInteger CLDBatchOperationDefaultMaximumConcurrentRequests = 4;
+
+@interface CLDBatchResult ()
+@property (readwrite, strong, nonatomic) CLDItem *item;
+@property (readwrite, strong, nonatomic) NSString *path;
+@property (readwrite, strong, nonatomic) CLDItem *resultItem;
+@property (readwrite, strong, nonatomic) NSError *error;
+@end
+
+@implementation CLDBatchResult
+@end
+
+
+
+
+@interface CLDBatchOperation ()
+@property (readwrite, strong, nonatomic) NSString *sessionIdentifier;
+@property (readwrite, nonatomic) NSUInteger numberOfItems;
+@property (readwrite, atomic) NSUInteger numberOfFinishedItems;
+@property (readwrite, atomic) NSUInteger numberOfFailedItems;
+@property (readwrite, atomic, getter = isCancelled) BOOL cancelled;
+
+@property (readwrite, strong, nonatomic) CLDSession *session;
+@property (readwrite, nonatomic) CLDSessionBatchOptions options;
+@property (readwrite, copy, nonatomic) CLDBatchOperationRequestBlock requestBlock;
+@property (readwrite, copy, nonatomic) CLDBatchOperationProgressBlock progressBlock;
+@property (readwrite, copy, nonatomic) CLDBatchOperationCompletionBlock completionBlock;
+@property (readwrite, strong, nonatomic) dispatch_queue_t callbackQueue;
+@property (readwrite, nonatomic) CLDRequestLane lane;
+@end
+
+@implementation CLDBatchOperation {
+    dispatch_queue_t _queue;
+    NSUInteger _maximumConcurrentRequests;
+    NSArray *_results;
+    NSUInteger _nextIndex;
+    NSMutableDictionary *_activeRequests;   // index -> CLDRequest
+    BOOL _started;
+    BOOL _stopping;                         // no more requests are started, the ones in flight are waited for
+    BOOL _stopped;
+    BOOL _progressPending;
+}
+
+#pragma mark - Initialization
+
+- (instancetype)initWithSession:(CLDSession *)session
+                          items:(NSArray *)items
+                          paths:(NSArray *)paths
+                        options:(CLDSessionBatchOptions)options
+                   requestBlock:(CLDBatchOperationRequestBlock)requestBlock {
+    NSParameterAssert(session);
+    NSParameterAssert(items);
+    NSParameterAssert(paths == nil || paths.count == items.count);
+    NSParameterAssert(requestBlock);
+    self = [super init];
+    if (self) {
+        _session = session;
+        _sessionIdentifier = session.sessionIdentifier;
+        _options = options;
+        _requestBlock = [requestBlock copy];
+        _maximumConcurrentRequests = CLDBatchOperationDefaultMaximumConcurrentRequests;
+        _queue = dispatch_queue_create("pt.meo.cloud.sdk.batch", DISPATCH_QUEUE_SERIAL);
+        _callbackQueue = dispatch_get_main_queue();
+        _lane = CLDRequestLaneDefault;
+        _activeRequests = [NSMutableDictionary new];
+
+        NSMutableArray *results = [NSMutableArray arrayWithCapacity:items.count];
+        [items enumerateObjectsUsingBlock:^(CLDItem *item, NSUInteger index, BOOL *stop) {
+            CLDBatchResult *result = [CLDBatchResult new];
+            result.item = item;
+            result.path = paths[index];
+            [results addObject:result];
+        }];
+        _results = results;
+        _numberOfItems = results.count;
+    }
+    return self;
+}
+
+- (void)start {
+    dispatch_async(_queue, ^{
+        _started = YES;
+        [self _scheduleRequests];
+    });
+}
+
+#pragma mark - Dynamic properties
+
+- (NSUInteger)maximumConcurrentRequests {
+    @synchronized(self) {
+        return _maximumConcurrentRequests;
+    }
+}
+
+- (void)setMaximumConcurrentRequests:(NSUInteger)maximumConcurrentRequests {
+    @synchronized(self) {
+        _maximumConcurrentRequests = MAX(maximumConcurrentRequests, 1);
+    }
+    dispatch_async(_queue, ^{
+        [self _scheduleRequests];
+    });
+}
+
+#pragma mark - Public methods
+
+- (void)cancel {
+    self.cancelled = YES;
+    dispatch_async(_queue, ^{
+        if (_stopped) return;
+        for (CLDRequest *request in _activeRequests.allValues) {
+            [request cancel];
+        }
+        [_activeRequests removeAllObjects];
+        [self _finish];
+    });
+}
+
+#pragma mark - Private methods
+
+// all methods below must be called on _queue
+
+- (void)_scheduleRequests {
+    if (!_started || _stopped) return;
+
+    if ((_stopping || _nextIndex == _results.count) && _activeRequests.count == 0) {
+        [self _finish];
+        return;
+    }
+
+    NSUInteger maximumConcurrentRequests = self.maximumConcurrentRequests;
+    while (!_stopping && _activeRequests.count < maximumConcurrentRequests && _nextIndex < _results.count) {
+        [self _startRequestAtIndex:_nextIndex++];
+    }
+}
+
+- (void)_startRequestAtIndex:(NSUInteger)index {
+    CLDBatchResult *result = _results[index];
+    CLDSession *session = self.session;
+    CLDBatchOperationRequestBlock requestBlock = self.requestBlock;
+    void(^resultBlock)(CLDItem *item) = ^(CLDItem *item) {
+        [self _didFinishRequestAtIndex:index item:item error:nil];
+    };
+    void(^failureBlock)(NSError *error) = ^(NSError *error) {
+        [self _didFinishRequestAtIndex:index item:nil error:error];
+    };
+
+    // results come back on _queue, so they are collected without going through the callback queue
+    __block CLDRequest *request = nil;
+    [session performWithCallbackQueue:_queue block:^{
+        [session performInRequestLane:self.lane block:^{
+            request = requestBlock(result.item, result.path, resultBlock, failureBlock);
+        }];
+    }];
+    if (request) _activeRequests[@(index)] = request;
+}
+
+- (void)_didFinishRequestAtIndex:(NSUInteger)index item:(CLDItem *)item error:(NSError *)error {
+    if (_stopped) return;
+    [_activeRequests removeObjectForKey:@(index)];
+
+    CLDBatchResult *result = _results[index];
+    result.resultItem = item;
+    result.error = error;
+    self.numberOfFinishedItems++;
+    if (error) {
+        self.numberOfFailedItems++;
+        if (self.options & CLDSessionBatchOptionStopOnFailure) _stopping = YES;
+    }
+
+    [self _reportProgress];
+    [self _scheduleRequests];
+}
+
+- (void)_reportProgress {
+    // one pending report at a time, so a fast batch does not flood the callback queue
+    CLDBatchOperationProgressBlock progressBlock = self.progressBlock;
+    if (progressBlock == nil || _progressPending) return;
+    _progressPending = YES;
+    NSUInteger numberOfItems = self.numberOfItems;
+    dispatch_async(self.callbackQueue, ^{
+        dispatch_async(_queue, ^{
+            _progressPending = NO;
+        });
+        progressBlock(self.numberOfFinishedItems, numberOfItems);
+    });
+}
+
+- (void)_finish {
+    if (_stopped) return;
+    _stopped = YES;
+
+    CLDBatchOperationCompletionBlock completionBlock = self.completionBlock;
+    NSArray *results = _results;
+    RunBlockOnQueue(self.callbackQueue, completionBlock, results);
+    [self _releaseBlocks];
+}
+
+// blocks usually capture the operation, break the cycle once we're done
+- (void)_releaseBlocks {
+    self.requestBlock = nil;
+    self.progressBlock = nil;
+    self.completionBlock = nil;
+    self.session = nil;
+}
+
+@end
@@ -0,0 +1,92 @@
+//
+//  CLDDownloadStream.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+@class CLDItem;
+
+/**
+ Default value for <[CLDDownloadStream maximumBufferedBytes]>.
+ @since 1.1
+ */
+FOUNDATION_EXPORT const NSUInteger CLDDownloadStreamDefaultMaximumBufferedBytes;
+
+/**
+ This class downloads a file and hands its bytes over as they arrive, so they can be parsed, decompressed or hashed while
+ the download is still running.
+
+ Bytes are delivered either to a block or through an `NSInputStream`, depending on how the stream was created. In both cases
+ the download is paused while more than <maximumBufferedBytes> bytes wait for the consumer, and resumed once it caught up.
+ The file can also be written to a cache file as it downloads.
+
+ When the connection drops, the download resumes from the bytes already received with a range request, for as long as the
+ transfer retry policy allows. It fails instead if the file changed meanwhile, since the bytes delivered cannot be taken back.
+
+ Unlike <CLDTransfer>, streams are not scheduled by the <CLDTransferManager> and do not survive the app being suspended.
+
+ Download streams are created by <[CLDSession streamItem:cacheFileURL:dataBlock:resultBlock:failureBlock:]> and
+ <[CLDSession openInputStreamForItem:cacheFileURL:resultBlock:failureBlock:]>.
+ @since 1.1
+ */
+@interface CLDDownloadStream : NSObject
+
+/**
+ The identifier of the session this stream belongs to.
+ @since 1.1
+ */
+@property (readonly, strong, nonatomic) NSString *sessionIdentifier;
+
+/**
+ The item being downloaded.
+ @since 1.1
+ */
+@property (readonly, strong, nonatomic) CLDItem *item;
+
+/**
+ The URL the file is written to as it downloads, or `nil`. The file is removed if the download fails or is cancelled.
+ @since 1.1
+ */
+@property (readonly, strong, nonatomic) NSURL *cacheFileURL;
+
+/**
+ The stream to read the file from, for streams created by <[CLDSession openInputStreamForItem:cacheFileURL:resultBlock:failureBlock:]>.
+ It reaches its end once the whole file was read, or early if the download failed, in which case the failure block is called.
+ @since 1.1
+ */
+@property (readonly, strong, nonatomic) NSInputStream *inputStream;
+
+/**
+ The maximum number of bytes waiting for the consumer before the download is paused.
+ Default value is `CLDDownloadStreamDefaultMaximumBufferedBytes`.
+ @since 1.1
+ */
+@property (readwrite, atomic) NSUInteger maximumBufferedBytes;
+
+/**
+ The number of bytes received so far.
+ @since 1.1
+ */
+@property (readonly, atomic) uint64_t numberOfBytesReceived;
+
+/**
+ The size of the file according to the server, or `NSURLResponseUnknownLength` until the response arrives.
+ @since 1.1
+ */
+@property (readonly, atomic) int64_t expectedNumberOfBytes;
+
+/**
+ `BOOL` stating whether the stream was cancelled.
+ @since 1.1
+ */
+@property (readonly, atomic, getter = isCancelled) BOOL cancelled;
+
+/**
+ Cancels the download. No more bytes are delivered and no blocks are called.
+ @since 1.1
+ */
+- (void)cancel;
+
+@end
@@ -0,0 +1,400 @@
+//
+//  CLDDownloadStream.m
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import "CLDDownloadStream.h"
+
+#define CLDDownloadStreamInputStreamBufferSize (64 * 1024)
+
+const NSUInteger CLDDownloadStreamDefaultMaximumBufferedBytes = 1024 * 1024;
+
+@interface CLDDownloadStream () <NSURLSessionDataDelegate, NSStreamDelegate>
+@property (readwrite, strong, nonatomic) NSString *sessionIdentifier;
+@property (readwrite, strong, nonatomic) CLDItem *item;
+@property (readwrite, strong, nonatomic) NSURL *cacheFileURL;
+@property (readwrite, strong, nonatomic) NSInputStream *inputStream;
+@property (readwrite, atomic) uint64_t numberOfBytesReceived;
+@property (readwrite, atomic) int64_t expectedNumberOfBytes;
+@property (readwrite, atomic, getter = isCancelled) BOOL cancelled;
+
+@property (readwrite, strong, nonatomic) CLDSession *session;
+@property (readwrite, copy, nonatomic) CLDDownloadStreamDataBlock dataBlock;
+@property (readwrite, copy, nonatomic) void(^resultBlock)();
+@property (readwrite, copy, nonatomic) void(^failureBlock)(NSError *error);
+@property (readwrite, strong, nonatomic) dispatch_queue_t callbackQueue;
+@end
+
+@implementation CLDDownloadStream {
+    dispatch_queue_t _queue;
+    dispatch_queue_t _deliveryQueue;    // keeps chunks in order, even on a concurrent callback queue
+    NSUInteger _maximumBufferedBytes;
+    NSURLSessionDataTask *_task;
+    CLDTaskTimer *_timer;
+    NSFileHandle *_cacheFileHandle;
+    NSOutputStream *_outputStream;      // bound to inputStream
+    NSMutableArray *_pendingChunks;     // waiting for room in the output stream
+    NSUInteger _pendingChunkOffset;
+    NSUInteger _bufferedBytes;          // delivered to the consumer but not consumed yet
+    NSString *_entityTag;               // of the first response, a resumed download must get the same file
+    NSUInteger _numberOfFailedAttempts;
+    BOOL _suspended;
+    BOOL _completed;
+    BOOL _stopped;
+}
+
+#pragma mark - Initialization
+
+- (instancetype)initWithSession:(CLDSession *)session
+                           item:(CLDItem *)item
+                   cacheFileURL:(NSURL *)cacheFileURL
+                      dataBlock:(CLDDownloadStreamDataBlock)dataBlock {
+    NSParameterAssert(session);
+    NSParameterAssert(item.type == CLDItemTypeFile);
+    NSParameterAssert(cacheFileURL == nil || cacheFileURL.isFileURL);
+    self = [super init];
+    if (self) {
+        _session = session;
+        _sessionIdentifier = session.sessionIdentifier;
+        _item = item;
+        _cacheFileURL = cacheFileURL;
+        _dataBlock = [dataBlock copy];
+        _maximumBufferedBytes = CLDDownloadStreamDefaultMaximumBufferedBytes;
+        _expectedNumberOfBytes = NSURLResponseUnknownLength;
+        _queue = dispatch_queue_create("pt.meo.cloud.sdk.downloadstream", DISPATCH_QUEUE_SERIAL);
+        _callbackQueue = dispatch_get_main_queue();
+        _pendingChunks = [NSMutableArray new];
+
+        if (dataBlock == nil) {
+            CFReadStreamRef readStream = NULL;
+            CFWriteStreamRef writeStream = NULL;
+            CFStreamCreateBoundPair(kCFAllocatorDefault, &readStream, &writeStream, CLDDownloadStreamInputStreamBufferSize);
+            _inputStream = CFBridgingRelease(readStream);
+            _outputStream = CFBridgingRelease(writeStream);
+        }
+    }
+    return self;
+}
+
+- (void)start {
+    dispatch_async(_queue, ^{
+        if (_stopped) return;
+        _deliveryQueue = dispatch_queue_create("pt.meo.cloud.sdk.downloadstream.delivery", DISPATCH_QUEUE_SERIAL);
+        dispatch_set_target_queue(_deliveryQueue, self.callbackQueue);
+
+        if (_outputStream) {
+            // room in the output stream is reported on _queue
+            _outputStream.delegate = self;
+            CFWriteStreamSetDispatchQueue((__bridge CFWriteStreamRef)_outputStream, _queue);
+            [_outputStream open];
+        }
+
+        if (self.cacheFileURL) {
+            [[NSFileManager defaultManager] createFileAtPath:self.cacheFileURL.path contents:nil attributes:nil];
+            _cacheFileHandle = [NSFileHandle fileHandleForWritingAtPath:self.cacheFileURL.path];
+            if (_cacheFileHandle == nil) {
+                [self _stopWithError:[CLDError errorWithCode:CLDErrorCodeUnknownError]];
+                return;
+            }
+        }
+
+        [self _startTask];
+    });
+}
+
+#pragma mark - Dynamic properties
+
+- (NSUInteger)maximumBufferedBytes {
+    @synchronized(self) {
+        return _maximumBufferedBytes;
+    }
+}
+
+- (void)setMaximumBufferedBytes:(NSUInteger)maximumBufferedBytes {
+    @synchronized(self) {
+        _maximumBufferedBytes = MAX(maximumBufferedBytes, 1);
+    }
+    dispatch_async(_queue, ^{
+        [self _updateSuspension];
+    });
+}
+
+#pragma mark - Public methods
+
+- (void)cancel {
+    self.cancelled = YES;
+    dispatch_async(_queue, ^{
+        [self _stopWithError:nil];
+    });
+}
+
+#pragma mark - NSURLSessionDataDelegate
+
+- (void)URLSession:(NSURLSession *)session
+          dataTask:(NSURLSessionDataTask *)dataTask
+didReceiveResponse:(NSURLResponse *)response
+ completionHandler:(void (^)(NSURLSessionResponseDisposition))completionHandler {
+    dispatch_async(_queue, ^{
+        BOOL allow = [self _didReceiveResponse:(NSHTTPURLResponse *)response task:dataTask];
+        completionHandler(allow ? NSURLSessionResponseAllow : NSURLSessionResponseCancel);
+    });
+}
+
+- (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveData:(NSData *)data {
+    dispatch_async(_queue, ^{
+        [self _didReceiveData:data];
+    });
+}
+
+- (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didCompleteWithError:(NSError *)error {
+    dispatch_async(_queue, ^{
+        [self _didCompleteTask:task error:error];
+    });
+}
+
+#pragma mark - NSStreamDelegate
+
+- (void)stream:(NSStream *)stream handleEvent:(NSStreamEvent)eventCode {
+    // already on _queue
+    switch (eventCode) {
+        case NSStreamEventHasSpaceAvailable:
+            [self _writePendingChunks];
+            break;
+
+        case NSStreamEventErrorOccurred:
+            // the consumer closed the input stream, nobody is reading anymore
+            [self _stopWithError:nil];
+            break;
+
+        default:
+            break;
+    }
+}
+
+#pragma mark - Private methods
+
+// all methods below must be called on _queue
+
+- (void)_startTask {
+    CLDSession *session = self.session;
+    CLDItem *item = self.item;
+    NSMutableDictionary *params = [NSMutableDictionary new];
+    if (item.revision) params[@"rev"] = item.revision;
+    NSString *path = [NSString stringWithFormat:@"/Files/<mode>/%@", item.trimmedPath];
+    NSURL *url = [session _serviceURLForEndpoint:CLDSessionEndpointContentAPI path:path query:params];
+    NSMutableURLRequest *request = [session _signedMutableURLRequestWithURL:url];
+
+    // resume after the bytes the consumer already got, as long as it is the same file
+    uint64_t offset = self.numberOfBytesReceived;
+    if (offset > 0) {
+        [request setValue:[NSString stringWithFormat:@"bytes=%llu-", (unsigned long long)offset] forHTTPHeaderField:@"Range"];
+        if (_entityTag) [request setValue:_entityTag forHTTPHeaderField:@"If-Range"];
+    }
+
+    // on the session's content connection pool, like transfer downloads it is not held back by the request scheduler,
+    // which is meant for short requests
+    _task = [session _dataTaskWithRequest:request delegate:self];
+    _timer = [CLDTaskTimer new];
+    [_timer startWithTask:_task];
+    [session incrementNumberOfActiveConnections];
+    _suspended = NO;
+    [_task resume];
+    [self _updateSuspension];
+}
+
+// returns NO if the response body is not wanted
+- (BOOL)_didReceiveResponse:(NSHTTPURLResponse *)response task:(NSURLSessionTask *)task {
+    if (_stopped || task != _task) return NO;
+    uint64_t offset = self.numberOfBytesReceived;
+    NSInteger statusCode = response.statusCode;
+    if (offset == 0 && statusCode == 200) {
+        _entityTag = response.allHeaderFields[@"ETag"];
+        self.expectedNumberOfBytes = response.expectedContentLength;
+        return YES;
+    }
+    if (offset > 0 && statusCode == 206) {
+        // "bytes start-end/size", the rest of the file has to start where we stopped
+        NSString *contentRange = response.allHeaderFields[@"Content-Range"];
+        NSString *start = [NSString stringWithFormat:@"bytes %llu-", (unsigned long long)offset];
+        if ([contentRange hasPrefix:start]) return YES;
+    }
+    if (offset > 0 && (statusCode == 200 || statusCode == 206)) {
+        // a 200 means the file changed since the first response, and what was delivered cannot be taken back
+        CLDLog(@"Download stream of %@ could not resume at %llu bytes", self.item.path, (unsigned long long)offset);
+        [self _recordTask:task error:nil];
+        [self _stopWithError:[CLDError errorWithCode:CLDErrorCodeInvalidResponse]];
+        return NO;
+    }
+    [self _didFailTask:task error:nil];
+    return NO;
+}
+
+- (void)_didReceiveData:(NSData *)data {
+    if (_stopped) return;
+    self.numberOfBytesReceived += data.length;
+    [_cacheFileHandle writeData:data];
+    _bufferedBytes += data.length;
+
+    if (self.dataBlock) {
+        CLDDownloadStreamDataBlock dataBlock = self.dataBlock;
+        NSUInteger length = data.length;
+        dispatch_async(_deliveryQueue, ^{
+            if (self.isCancelled) return;
+            dataBlock(data);
+            dispatch_async(_queue, ^{
+                _bufferedBytes -= length;
+                [self _updateSuspension];
+            });
+        });
+    } else {
+        [_pendingChunks addObject:data];
+        [self _writePendingChunks];
+    }
+    [self _updateSuspension];
+}
+
+- (void)_writePendingChunks {
+    while (_pendingChunks.count > 0 && _outputStream.hasSpaceAvailable) {
+        NSData *chunk = _pendingChunks.firstObject;
+        NSInteger written = [_outputStream write:(const uint8_t *)chunk.bytes + _pendingChunkOffset maxLength:chunk.length - _pendingChunkOffset];
+        if (written <= 0) break;
+        _pendingChunkOffset += written;
+        _bufferedBytes -= written;
+        if (_pendingChunkOffset == chunk.length) {
+            [_pendingChunks removeObjectAtIndex:0];
+            _pendingChunkOffset = 0;
+        }
+    }
+    [self _updateSuspension];
+    if (_completed && _pendingChunks.count == 0) [self _finish];
+}
+
+// backpressure: pause the download while the consumer is behind, resume once it caught up halfway
+- (void)_updateSuspension {
+    if (_stopped || _completed || _task == nil) return;
+    NSUInteger maximumBufferedBytes = self.maximumBufferedBytes;
+    if (!_suspended && _bufferedBytes > maximumBufferedBytes) {
+        _suspended = YES;
+        [_task suspend];
+    } else if (_suspended && _bufferedBytes <= maximumBufferedBytes / 2) {
+        _suspended = NO;
+        [_task resume];
+    }
+}
+
+// the same metrics, circuit breaker and overload reports as transfers
+- (void)_recordTask:(NSURLSessionTask *)task error:(NSError *)error {
+    CLDSession *session = self.session;
+    [_timer stop];
+    if ([CLDRequestScheduler outcomeForResponse:task.response error:error] == CLDRequestOutcomeOverloaded) {
+        [session _reportServerOverload];
+    }
+    [[session _metricsRecorder] recordTask:task transfer:YES waitTime:-1 timeToFirstByte:_timer.timeToFirstByte totalTime:_timer.totalTime];
+    [CLDRetryPolicy recordResponse:task.response error:error forHost:task.originalRequest.URL.host];
+}
+
+- (void)_didCompleteTask:(NSURLSessionTask *)task error:(NSError *)error {
+    if (_stopped || task != _task) return;
+
+    // a connection that ends early without the transport noticing must not pass for the whole file
+    int64_t expectedNumberOfBytes = self.expectedNumberOfBytes;
+    CLDItem *item = self.item;
+    if (error == nil && ((expectedNumberOfBytes >= 0 && self.numberOfBytesReceived != (uint64_t)expectedNumberOfBytes) ||
+                         (item.revision && item.size > 0 && self.numberOfBytesReceived != item.size))) {
+        CLDLog(@"Download stream of %@ ended early", item.path);
+        error = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorNetworkConnectionLost userInfo:nil];
+    }
+    if (error) {
+        [self _didFailTask:task error:error];
+        return;
+    }
+
+    [self _recordTask:task error:nil];
+    [self.session decrementNumberOfActiveConnections];
+    _task = nil;
+    _completed = YES;
+    [_cacheFileHandle closeFile];
+    _cacheFileHandle = nil;
+    if (_outputStream == nil || _pendingChunks.count == 0) [self _finish];
+}
+
+// retries with the transfer retry policy, from where the failed attempt stopped
+- (void)_didFailTask:(NSURLSessionTask *)task error:(NSError *)error {
+    CLDSession *session = self.session;
+    [self _recordTask:task error:error];
+    [session decrementNumberOfActiveConnections];
+    _task = nil;
+
+    // bytes already delivered cannot be asked for again unless the file is known to be the same one
+    BOOL canResume = self.numberOfBytesReceived == 0 || _entityTag || self.item.revision;
+    NSTimeInterval delay = canResume ? [[CLDRetryPolicy transferPolicy] retryDelayForRequest:task.originalRequest
+                                                                                    response:task.response
+                                                                                       error:error
+                                                                                     attempt:_numberOfFailedAttempts] : CLDRetryPolicyNoRetry;
+    if (delay == CLDRetryPolicyNoRetry) {
+        NSInteger statusCode = error ? NSNotFound : ((NSHTTPURLResponse *)task.response).statusCode;
+        [self _stopWithError:[session _errorFromStatusCode:statusCode error:error]];
+        return;
+    }
+
+    CLDLog(@"Download stream of %@ failed at %llu bytes, resuming in %.1f s", self.item.path, (unsigned long long)self.numberOfBytesReceived, delay);
+    [[session _metricsRecorder] recordRetryForRequest:task.originalRequest transfer:YES bytesResent:0];
+    _numberOfFailedAttempts++;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), _queue, ^{
+        if (_stopped) return;
+        [self _startTask];
+    });
+}
+
+- (void)_finish {
+    if (_stopped) return;
+    _stopped = YES;
+    [_outputStream close];
+
+    // after the last chunk, if chunks go to a block
+    void(^resultBlock)() = self.resultBlock;
+    dispatch_async(_deliveryQueue, ^{
+        if (self.isCancelled) return;
+        RunBlock(resultBlock);
+    });
+    [self _releaseBlocks];
+}
+
+// error is nil when cancelled
+- (void)_stopWithError:(NSError *)error {
+    if (_stopped) return;
+    _stopped = YES;
+    if (_task) {
+        [_task cancel];
+        [self.session decrementNumberOfActiveConnections];
+        _task = nil;
+    }
+    [_outputStream close];
+    [_pendingChunks removeAllObjects];
+    [_cacheFileHandle closeFile];
+    _cacheFileHandle = nil;
+    if (self.cacheFileURL) [[NSFileManager defaultManager] removeItemAtURL:self.cacheFileURL error:nil];
+
+    if (error) {
+        CLDLog(@"Download stream of %@ failed. Error: %@", self.item.path, error);
+        void(^failureBlock)(NSError *error) = self.failureBlock;
+        dispatch_async(_deliveryQueue ?: self.callbackQueue, ^{
+            if (self.isCancelled) return;
+            RunBlock(failureBlock, error);
+        });
+    }
+    [self _releaseBlocks];
+}
+
+// blocks usually capture the stream, break the cycles once we're done
+- (void)_releaseBlocks {
+    self.dataBlock = nil;
+    self.resultBlock = nil;
+    self.failureBlock = nil;
+    self.session = nil;
+}
+
+@end
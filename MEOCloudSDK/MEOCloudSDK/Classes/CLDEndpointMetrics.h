@@ -0,0 +1,101 @@
+//
+//  CLDEndpointMetrics.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+@class CLDLatencyHistogram;
+
+/**
+ This class represents a snapshot of the requests made to one endpoint of the API, such as `GET Metadata` or `PUT ChunkedUpload`.
+
+ Every attempt of a request is counted, retries included. Cancelled requests are not counted.
+ @see CLDSessionMetrics
+ @since 1.1
+ */
+@interface CLDEndpointMetrics : NSObject
+
+/**
+ The HTTP method and the endpoint, e.g. `GET Metadata`.
+ @since 1.1
+ */
+@property (readonly, strong, nonatomic) NSString *endpoint;
+
+/**
+ The number of requests made.
+ @since 1.1
+ */
+@property (readonly, nonatomic) NSUInteger numberOfRequests;
+
+/**
+ The number of requests that got no response at all, e.g. due to connectivity problems or timeouts.
+ @since 1.1
+ */
+@property (readonly, nonatomic) NSUInteger numberOfFailedRequests;
+
+/**
+ The number of requests that were retried.
+ @since 1.1
+ */
+@property (readonly, nonatomic) NSUInteger numberOfRetries;
+
+/**
+ The number of body bytes that had to be transferred again because an attempt failed, e.g. a chunk whose connection
+ dropped or a download that could not be resumed. Only counted for transfers.
+ @since 1.1
+ */
+@property (readonly, nonatomic) uint64_t bytesResent;
+
+/**
+ An `NSDictionary` with the number of responses, as `NSNumber`, for each HTTP status code, as `NSNumber`.
+ @since 1.1
+ */
+@property (readonly, strong, nonatomic) NSDictionary *statusCodeCounts;
+
+/**
+ The number of body bytes sent.
+ @since 1.1
+ */
+@property (readonly, nonatomic) uint64_t bytesSent;
+
+/**
+ The number of body bytes received.
+ @since 1.1
+ */
+@property (readonly, nonatomic) uint64_t bytesReceived;
+
+/**
+ How long requests waited for their turn before being sent. Empty for transfers.
+ @see [CLDSession statisticsForRequestLane:]
+ @since 1.1
+ */
+@property (readonly, strong, nonatomic) CLDLatencyHistogram *waitTime;
+
+/**
+ How long it took from sending a request until its response headers arrived.
+ @since 1.1
+ */
+@property (readonly, strong, nonatomic) CLDLatencyHistogram *timeToFirstByte;
+
+/**
+ How long it took from sending a request until its response was complete.
+ @since 1.1
+ */
+@property (readonly, strong, nonatomic) CLDLatencyHistogram *totalTime;
+
+/**
+ How long it took from the first failed attempt of a transfer operation until one of its attempts succeeded. Empty for API requests.
+ @since 1.1
+ */
+@property (readonly, strong, nonatomic) CLDLatencyHistogram *recoveryTime;
+
+/**
+ Returns a representation of the metrics made of property list types, suitable for JSON.
+ @return An `NSDictionary` with the metrics.
+ @since 1.1
+ */
+- (NSDictionary *)dictionaryRepresentation;
+
+@end
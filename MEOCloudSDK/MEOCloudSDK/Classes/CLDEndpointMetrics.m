@@ -0,0 +1,64 @@
+//
+//  CLDEndpointMetrics.m
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import "CLDEndpointMetrics.h"
+
+@implementation CLDEndpointMetrics
+
+- (instancetype)initWithEndpoint:(NSString *)endpoint
+                numberOfRequests:(NSUInteger)numberOfRequests
+          numberOfFailedRequests:(NSUInteger)numberOfFailedRequests
+                 numberOfRetries:(NSUInteger)numberOfRetries
+                     bytesResent:(uint64_t)bytesResent
+                statusCodeCounts:(NSDictionary *)statusCodeCounts
+                       bytesSent:(uint64_t)bytesSent
+                   bytesReceived:(uint64_t)bytesReceived
+                        waitTime:(CLDLatencyHistogram *)waitTime
+                 timeToFirstByte:(CLDLatencyHistogram *)timeToFirstByte
+                       totalTime:(CLDLatencyHistogram *)totalTime
+                    recoveryTime:(CLDLatencyHistogram *)recoveryTime {
+    NSParameterAssert(endpoint);
+    self = [super init];
+    if (self) {
+        _endpoint = endpoint;
+        _numberOfRequests = numberOfRequests;
+        _numberOfFailedRequests = numberOfFailedRequests;
+        _numberOfRetries = numberOfRetries;
+        _bytesResent = bytesResent;
+        _statusCodeCounts = statusCodeCounts ?: @{};
+        _bytesSent = bytesSent;
+        _bytesReceived = bytesReceived;
+        _waitTime = waitTime;
+        _timeToFirstByte = timeToFirstByte;
+        _totalTime = totalTime;
+        _recoveryTime = recoveryTime;
+    }
+    return self;
+}
+
+- (NSDictionary *)dictionaryRepresentation {
+    // JSON keys must be strings
+    NSMutableDictionary *statusCodeCounts = [NSMutableDictionary new];
+    for (NSNumber *statusCode in self.statusCodeCounts) {
+        statusCodeCounts[statusCode.stringValue] = self.statusCodeCounts[statusCode];
+    }
+    return @{@"endpoint": self.endpoint,
+             @"requests": @(self.numberOfRequests),
+             @"failed_requests": @(self.numberOfFailedRequests),
+             @"retries": @(self.numberOfRetries),
+             @"bytes_resent": @(self.bytesResent),
+             @"status_codes": statusCodeCounts,
+             @"bytes_sent": @(self.bytesSent),
+             @"bytes_received": @(self.bytesReceived),
+             @"wait_time": [self.waitTime dictionaryRepresentation],
+             @"time_to_first_byte": [self.timeToFirstByte dictionaryRepresentation],
+             @"total_time": [self.totalTime dictionaryRepresentation],
+             @"recovery_time": [self.recoveryTime dictionaryRepresentation]};
+}
+
+@end
@@ -80,7 +80,9 @@
 @property (readwrite, strong, nonatomic) NSURL *uploadURL;
 @end
 
-@implementation CLDItem
+@implementation CLDItem {
+    NSString *_name;
+}
 
 #pragma mark - NSCoding
 
@@ -92,6 +94,7 @@
     _sandbox = [aDecoder decodeBoolForKey:@"sandbox"];
     _revision = [aDecoder decodeObjectForKey:@"revision"];
     _path = [aDecoder decodeObjectForKey:@"path"];
+    _name = [self.class _nameWithPath:_path];
     _lastModified = [aDecoder decodeObjectForKey:@"lastModified"];
     _lastModifiedMTime = [aDecoder decodeObjectForKey:@"lastModifiedMTime"];
     _hasPublicLink = [aDecoder decodeBoolForKey:@"hasPublicLink"];
@@ -131,10 +134,19 @@
 #pragma mark - Dynamic properties
 
 - (NSString *)name {
-    if (self.path && self.path.length > 1) {
-        NSString *path = [self.path stringByTrimmingCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@"/"]];
-        NSArray *items = [path componentsSeparatedByString:@"/"];
-        return [items lastObject];
+    return _name;
+}
+
+- (void)setPath:(NSString *)path {
+    _path = path;
+    _name = [self.class _nameWithPath:path];
+}
+
++ (NSString *)_nameWithPath:(NSString *)path {
+    if (path && path.length > 1) {
+        NSString *trimmedPath = [path stringByTrimmingCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@"/"]];
+        NSRange separator = [trimmedPath rangeOfString:@"/" options:NSBackwardsSearch];
+        return separator.location == NSNotFound ? trimmedPath : [trimmedPath substringFromIndex:NSMaxRange(separator)];
     } else {
         return nil;
     }
@@ -224,6 +236,7 @@
     NSParameterAssert([dictionary isKindOfClass:[NSDictionary class]]);
     NSParameterAssert(session);
     
+    uint64_t traceStart = CLDTraceBegin();
     CLDItem *item = [self new];
     item.sessionIdentifier = session.sessionIdentifier;
     
@@ -231,14 +244,14 @@
     item.revision = dictionary[@"rev"];
     item.path = dictionary[@"path"];
 //    item.sizeString = dictionary[@"size"];
-    item.size = [dictionary[@"bytes"] unsignedIntegerValue];
+    item.size = [dictionary[@"bytes"] unsignedLongLongValue];
     item.iconName = dictionary[@"icon"];
     item.owner = [dictionary[@"is_owner"] boolValue];
     item.sandbox = [dictionary[@"root"] isEqualToString:[session _accessModeSandbox]];
     item.type = [dictionary[@"is_dir"] boolValue] ? CLDItemTypeFolder : CLDItemTypeFile;
     item.hasThumbnail = [dictionary[@"thumb_exists"] boolValue];
-    item.lastModified = [[NSDateFormatter serviceDateFormatter] dateFromString:dictionary[@"modified"]];
-    item.lastModifiedMTime = [[NSDateFormatter serviceDateFormatter] dateFromString:dictionary[@"client_mtime"]];
+    item.lastModified = [NSDateFormatter serviceDateFromString:dictionary[@"modified"]];
+    item.lastModifiedMTime = [NSDateFormatter serviceDateFromString:dictionary[@"client_mtime"]];
     item.deleted = [dictionary[@"is_deleted"] boolValue];
     item.hasPublicLink = [dictionary[@"is_link"] boolValue];
     
@@ -262,16 +275,74 @@
             item.folderHash = dictionary[@"hash"];
             NSArray *contents = dictionary[@"contents"];
             if (contents) {
-                NSMutableArray *contentItems = [NSMutableArray new];
-                for (NSDictionary *contentItem in contents) {
-                    [contentItems addObject:[self itemWithDictionary:contentItem session:session]];
-                }
-                item.contents = [NSArray arrayWithArray:contentItems];
+                item.contents = [CLDItemListing listingWithDictionaries:contents session:session];
             }
             break;
         }
     }
     
+    CLDTraceEnd(CLDTraceSpanItemMaterialization, traceStart);
+    return item;
+}
+
++ (instancetype)itemWithListing:(CLDItemListing *)listing index:(NSUInteger)index {
+    NSParameterAssert(listing);
+    const CLDItemListingEntry *entry = [listing entryAtIndex:index];
+    
+    CLDItem *item = [self new];
+    item.sessionIdentifier = listing.sessionIdentifier;
+    
+    // rebuild path from its shared parent, name is already known so skip the setter
+    NSString *name = [listing pooledStringAtOffset:entry->name];
+    NSString *parentPath = [listing internedStringAtIndex:entry->parentPath];
+    if (name) {
+        item->_path = parentPath ? [parentPath stringByAppendingString:name] : name;
+        item->_name = name.length > 0 ? name : [self _nameWithPath:item->_path];
+    }
+    
+    item.revision = [listing pooledStringAtOffset:entry->revision];
+    item.size = entry->size;
+    item.iconName = [listing internedStringAtIndex:entry->iconName];
+    item.owner = (entry->flags & CLDItemListingFlagOwner) != 0;
+    item.sandbox = (entry->flags & CLDItemListingFlagSandbox) != 0;
+    item.type = (entry->flags & CLDItemListingFlagFolder) ? CLDItemTypeFolder : CLDItemTypeFile;
+    item.hasThumbnail = (entry->flags & CLDItemListingFlagHasThumbnail) != 0;
+    item.lastModified = isnan(entry->lastModified) ? nil : [NSDate dateWithTimeIntervalSinceReferenceDate:entry->lastModified];
+    item.lastModifiedMTime = isnan(entry->lastModifiedMTime) ? nil : [NSDate dateWithTimeIntervalSinceReferenceDate:entry->lastModifiedMTime];
+    item.deleted = (entry->flags & CLDItemListingFlagDeleted) != 0;
+    item.hasPublicLink = (entry->flags & CLDItemListingFlagPublicLink) != 0;
+    item.mimeType = [listing internedStringAtIndex:entry->mimeType];
+    item.hasUploadLink = (entry->flags & CLDItemListingFlagUploadLink) != 0;
+    item.folderType = entry->folderType;
+    item.folderHash = [listing pooledStringAtOffset:entry->folderHash];
+    
+    return item;
+}
+
++ (instancetype)itemWithPath:(NSString *)path
+                    revision:(NSString *)revision
+                        type:(CLDItemType)type
+                        size:(uint64_t)size
+                lastModified:(NSDate *)lastModified
+                    mimeType:(NSString *)mimeType
+                    iconName:(NSString *)iconName
+                hasThumbnail:(BOOL)hasThumbnail
+                     session:(CLDSession *)session {
+    NSParameterAssert(path);
+    NSParameterAssert(session);
+    
+    CLDItem *item = [self new];
+    item.sessionIdentifier = session.sessionIdentifier;
+    item.sandbox = session.isSandbox;
+    item.path = path;
+    item.revision = revision;
+    item.type = type;
+    item.folderType = (type == CLDItemTypeFolder) ? CLDItemFolderTypeNormal : CLDItemFolderTypeUnknown;
+    item.size = size;
+    item.lastModified = lastModified;
+    item.mimeType = mimeType;
+    item.iconName = iconName;
+    item.hasThumbnail = hasThumbnail;
     return item;
 }
 
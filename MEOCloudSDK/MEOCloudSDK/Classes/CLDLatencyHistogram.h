@@ -0,0 +1,76 @@
+//
+//  CLDLatencyHistogram.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+/**
+ This class represents a snapshot of the distribution of a duration, such as the response time of the requests to an endpoint.
+
+ Times are counted in fixed buckets, from 10 milliseconds to 60 seconds, so percentiles are approximate: they are reported as
+ the upper bound of the bucket they fall in.
+ @see CLDEndpointMetrics
+ @since 1.1
+ */
+@interface CLDLatencyHistogram : NSObject
+
+/**
+ The number of times recorded.
+ @since 1.1
+ */
+@property (readonly, nonatomic) NSUInteger count;
+
+/**
+ The sum of all times recorded, in seconds.
+ @since 1.1
+ */
+@property (readonly, nonatomic) NSTimeInterval totalTime;
+
+/**
+ The average time recorded, in seconds, or `0` if none was.
+ @since 1.1
+ */
+@property (readonly, nonatomic) NSTimeInterval averageTime;
+
+/**
+ The shortest time recorded, in seconds, or `0` if none was.
+ @since 1.1
+ */
+@property (readonly, nonatomic) NSTimeInterval minimumTime;
+
+/**
+ The longest time recorded, in seconds, or `0` if none was.
+ @since 1.1
+ */
+@property (readonly, nonatomic) NSTimeInterval maximumTime;
+
+/**
+ An array of `NSNumber` with the upper bound of each bucket, in seconds. The last bucket has no upper bound and is not included.
+ @since 1.1
+ */
+@property (readonly, strong, nonatomic) NSArray *bucketUpperBounds;
+
+/**
+ An array of `NSNumber` with the number of times recorded in each bucket. It has one more element than <bucketUpperBounds>.
+ @since 1.1
+ */
+@property (readonly, strong, nonatomic) NSArray *bucketCounts;
+
+/**
+ Returns an estimate of a percentile of the times recorded.
+ @param percentile The percentile, from `0` to `100`.
+ @return The time, in seconds, or `0` if none was recorded.
+ @since 1.1
+ */
+- (NSTimeInterval)timeAtPercentile:(double)percentile;
+
+/**
+ Returns a representation of the histogram made of property list types, suitable for JSON.
+ @return An `NSDictionary` with the histogram.
+ @since 1.1
+ */
+- (NSDictionary *)dictionaryRepresentation;
+
+@end
@@ -0,0 +1,92 @@
+//
+//  CLDLatencyHistogram.m
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import "CLDLatencyHistogram.h"
+
+static const NSTimeInterval CLDLatencyHistogramUpperBounds[CLDLatencyHistogramBucketCount - 1] = {0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30, 60};
+
+@implementation CLDLatencyHistogram {
+    NSUInteger _counts[CLDLatencyHistogramBucketCount];
+}
+
++ (NSUInteger)_bucketForTime:(NSTimeInterval)time {
+    for (NSUInteger bucket = 0; bucket < CLDLatencyHistogramBucketCount - 1; bucket++) {
+        if (time <= CLDLatencyHistogramUpperBounds[bucket]) return bucket;
+    }
+    return CLDLatencyHistogramBucketCount - 1;
+}
+
+- (instancetype)initWithBucketCounts:(const NSUInteger *)bucketCounts
+                           totalTime:(NSTimeInterval)totalTime
+                         minimumTime:(NSTimeInterval)minimumTime
+                         maximumTime:(NSTimeInterval)maximumTime {
+    NSParameterAssert(bucketCounts);
+    self = [super init];
+    if (self) {
+        memcpy(_counts, bucketCounts, sizeof(_counts));
+        for (NSUInteger bucket = 0; bucket < CLDLatencyHistogramBucketCount; bucket++) {
+            _count += _counts[bucket];
+        }
+        _totalTime = totalTime;
+        _minimumTime = minimumTime;
+        _maximumTime = maximumTime;
+    }
+    return self;
+}
+
+#pragma mark - Properties
+
+- (NSTimeInterval)averageTime {
+    return self.count > 0 ? self.totalTime / self.count : 0;
+}
+
+- (NSArray *)bucketUpperBounds {
+    NSMutableArray *bounds = [NSMutableArray arrayWithCapacity:CLDLatencyHistogramBucketCount - 1];
+    for (NSUInteger bucket = 0; bucket < CLDLatencyHistogramBucketCount - 1; bucket++) {
+        [bounds addObject:@(CLDLatencyHistogramUpperBounds[bucket])];
+    }
+    return bounds;
+}
+
+- (NSArray *)bucketCounts {
+    NSMutableArray *counts = [NSMutableArray arrayWithCapacity:CLDLatencyHistogramBucketCount];
+    for (NSUInteger bucket = 0; bucket < CLDLatencyHistogramBucketCount; bucket++) {
+        [counts addObject:@(_counts[bucket])];
+    }
+    return counts;
+}
+
+#pragma mark - Percentiles
+
+- (NSTimeInterval)timeAtPercentile:(double)percentile {
+    if (self.count == 0) return 0;
+    double rank = MAX(1, ceil(MIN(MAX(percentile, 0), 100) / 100 * self.count));
+    NSUInteger seen = 0;
+    for (NSUInteger bucket = 0; bucket < CLDLatencyHistogramBucketCount - 1; bucket++) {
+        seen += _counts[bucket];
+        if (seen >= rank) {
+            // the bound can't be more than what was actually recorded
+            return MIN(CLDLatencyHistogramUpperBounds[bucket], self.maximumTime);
+        }
+    }
+    return self.maximumTime;
+}
+
+- (NSDictionary *)dictionaryRepresentation {
+    return @{@"count": @(self.count),
+             @"total": @(self.totalTime),
+             @"minimum": @(self.minimumTime),
+             @"maximum": @(self.maximumTime),
+             @"p50": @([self timeAtPercentile:50]),
+             @"p90": @([self timeAtPercentile:90]),
+             @"p99": @([self timeAtPercentile:99]),
+             @"bucket_upper_bounds": self.bucketUpperBounds,
+             @"bucket_counts": self.bucketCounts};
+}
+
+@end
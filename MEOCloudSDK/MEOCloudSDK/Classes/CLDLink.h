@@ -7,6 +7,7 @@
 //
 
 @class CLDItem;
+@class CLDRequest;
 
 /**
  This class is used to represent a public or upload link (Upload2Me).
@@ -80,36 +81,40 @@
  @param expireDate      The new expire date.
  @param resultBlock     The block to be executed once the new expire date is set.
  @param failureBlock    The block to be executed if the new expire date could not be set. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the request.
  @since 1.0
  */
-- (void)setExpireDate:(NSDate *)expireDate resultBlock:(void(^)())resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+- (CLDRequest *)setExpireDate:(NSDate *)expireDate resultBlock:(void(^)())resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
 
 /**
  Removes the expire date of the receiver.
  @param resultBlock     The block to be executed once the expire date is removed
  @param failureBlock    The block to be executed if the  expire date could not be removed. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the request.
  @since 1.0
  */
-- (void)removeExpireDateWithResultBlock:(void(^)())resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+- (CLDRequest *)removeExpireDateWithResultBlock:(void(^)())resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
 
 /**
  Fetches a short URL from the server and assigns it to the `shortURL` property.
  @note For convenience, `resultBlock` also passes the new URL as an argument.
  @param resultBlock     The block to be executed once the URL is fetched. This block takes an `NSURL` argument.
  @param failureBlock    The block to be executed if the URL could not be fetched. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the request.
  @see -deleteShortURLWithResultBlock:failureBlock:
  @since 1.0
  */
-- (void)fetchShortURLWithResultBlock:(void(^)(NSURL *shortURL))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+- (CLDRequest *)fetchShortURLWithResultBlock:(void(^)(NSURL *shortURL))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
 
 /**
  Deletes a short URL from the server.
  @note The `shortURL` is changed immediately. The blocks are only useful for confirmation that the change has been sucessfully made on the server.
  @param resultBlock     The block to be executed once the URL is deleted.
  @param failureBlock    The block to be executed if the URL could not be deleted. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the request.
  @see -fetchShortURLWithResultBlock:failureBlock:
  @since 1.0
  */
-- (void)deleteShortURLWithResultBlock:(void(^)())resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+- (CLDRequest *)deleteShortURLWithResultBlock:(void(^)())resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
 
 @end
@@ -53,75 +53,86 @@
 
 #pragma mark - Expire date
 
-- (void)setExpireDate:(NSDate *)expireDate resultBlock:(void (^)())resultBlock failureBlock:(void (^)(NSError *))failureBlock {
+- (CLDRequest *)setExpireDate:(NSDate *)expireDate resultBlock:(void (^)())resultBlock failureBlock:(void (^)(NSError *))failureBlock {
     NSParameterAssert(expireDate);
     NSAssert([expireDate compare:[NSDate date]] == NSOrderedDescending, @"expireDate must be in the future. :-)");
     NSParameterAssert(self.shareId);
     CLDSession *session = [CLDSession sessionWithIdentifier:self.sessionIdentifier];
+    dispatch_queue_t callbackQueue = [session _currentCallbackQueue];
+    CLDRequest *handle = [CLDRequest new];
     NSURL *url = [session _serviceURLForEndpoint:CLDSessionEndpointPublicAPI path:@"SetLinkTTL"];
     NSMutableURLRequest *request = [session _signedMutableURLRequestWithURL:url];
     request.HTTPMethod = @"POST";
     request.HTTPBody = [session _postDataWithDictionary:@{@"ttl":[NSString stringWithFormat:@"%d", (int)[expireDate timeIntervalSinceNow]],
                                                           @"shareid":self.shareId}];
-    [session _performRequest:request successBlock:^(NSData *data) {
-        RunBlockOnMainThread(resultBlock);
+    [session _performRequest:request handle:handle successBlock:^(NSData *data) {
+        RunRequestBlockOnQueue(handle, callbackQueue, resultBlock);
     } failureBlock:^(CLDError *error) {
-        RunBlockOnMainThread(failureBlock, error);
+        RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, error);
     }];
+    return handle;
 }
 
-- (void)removeExpireDateWithResultBlock:(void(^)())resultBlock failureBlock:(void(^)(NSError *error))failureBlock
+- (CLDRequest *)removeExpireDateWithResultBlock:(void(^)())resultBlock failureBlock:(void(^)(NSError *error))failureBlock
 {
     CLDSession *session = [CLDSession sessionWithIdentifier:self.sessionIdentifier];
+    dispatch_queue_t callbackQueue = [session _currentCallbackQueue];
+    CLDRequest *handle = [CLDRequest new];
     NSURL *url = [session _serviceURLForEndpoint:CLDSessionEndpointPublicAPI path:@"RemoveLinkTTL"];
     NSMutableURLRequest *request = [session _signedMutableURLRequestWithURL:url];
     request.HTTPMethod = @"POST";
     request.HTTPBody = [session _postDataWithDictionary:@{@"shareid":self.shareId}];
-    [session _performRequest:request successBlock:^(NSData *data) {
-        RunBlockOnMainThread(resultBlock);
+    [session _performRequest:request handle:handle successBlock:^(NSData *data) {
+        RunRequestBlockOnQueue(handle, callbackQueue, resultBlock);
     } failureBlock:^(CLDError *error) {
-        RunBlockOnMainThread(failureBlock, error);
+        RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, error);
     }];
+    return handle;
 }
 
 #pragma mark - ShortURL
 
-- (void)fetchShortURLWithResultBlock:(void (^)(NSURL *))resultBlock failureBlock:(void (^)(NSError *))failureBlock {
+- (CLDRequest *)fetchShortURLWithResultBlock:(void (^)(NSURL *))resultBlock failureBlock:(void (^)(NSError *))failureBlock {
     NSParameterAssert(self.shareId);
     CLDSession *session = [CLDSession sessionWithIdentifier:self.sessionIdentifier];
+    dispatch_queue_t callbackQueue = [session _currentCallbackQueue];
+    CLDRequest *handle = [CLDRequest new];
     NSURL *url = [session _serviceURLForEndpoint:CLDSessionEndpointPublicAPI path:@"ShortenLinkURL"];
     NSMutableURLRequest *request = [session _signedMutableURLRequestWithURL:url];
     request.HTTPMethod = @"POST";
     request.HTTPBody = [session _postDataWithDictionary:@{@"shareid":self.shareId}];
-    [session _performJSONRequest:request successBlock:^(id object) {
+    [session _performJSONRequest:request handle:handle successBlock:^(id object) {
         if ([object isKindOfClass:[NSDictionary class]] && object[@"url"]) {
             self.shortURL = object[@"url"];
-            RunBlockOnMainThread(resultBlock, self.shortURL);
+            RunRequestBlockOnQueue(handle, callbackQueue, resultBlock, self.shortURL);
         } else {
-            RunBlockOnMainThread(failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
+            RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
         }
     } failureBlock:^(CLDError *error) {
-        RunBlockOnMainThread(failureBlock, error);
+        RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, error);
     }];
+    return handle;
 }
 
-- (void)deleteShortURLWithResultBlock:(void (^)())resultBlock failureBlock:(void (^)(NSError *))failureBlock {
+- (CLDRequest *)deleteShortURLWithResultBlock:(void (^)())resultBlock failureBlock:(void (^)(NSError *))failureBlock {
+    CLDSession *session = [CLDSession sessionWithIdentifier:self.sessionIdentifier];
+    dispatch_queue_t callbackQueue = [session _currentCallbackQueue];
+    CLDRequest *handle = [CLDRequest new];
     if (!self.shortURL) {
-        RunBlockOnMainThread(resultBlock);
-        return;
+        RunRequestBlockOnQueue(handle, callbackQueue, resultBlock);
     } else {
         NSString *shortURLIdentifier = [[[self.shortURL host] componentsSeparatedByString:@"."] firstObject];
         NSString *path = [NSString stringWithFormat:@"DestroyShortURL/%@", shortURLIdentifier];
-        CLDSession *session = [CLDSession sessionWithIdentifier:self.sessionIdentifier];
         NSURL *url = [session _serviceURLForEndpoint:CLDSessionEndpointPublicAPI path:path];
         NSMutableURLRequest *request = [session _signedMutableURLRequestWithURL:url];
         request.HTTPMethod = @"POST";
-        [session _performJSONRequest:request successBlock:^(id object) {
-            RunBlockOnMainThread(resultBlock);
+        [session _performJSONRequest:request handle:handle successBlock:^(id object) {
+            RunRequestBlockOnQueue(handle, callbackQueue, resultBlock);
         } failureBlock:^(CLDError *error) {
-            RunBlockOnMainThread(failureBlock, error);
+            RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, error);
         }];
     }
+    return handle;
 }
 
 #pragma mark - Private methods
@@ -175,7 +186,7 @@
     
     link.shareId = dictionary[@"shareid"];
     if (dictionary[@"expires"]) {
-        link.expireDate = [[NSDateFormatter serviceDateFormatter] dateFromString:dictionary[@"expires"]];
+        link.expireDate = [NSDateFormatter serviceDateFromString:dictionary[@"expires"]];
     } else if (dictionary[@"expiry"]) {
         link.expireDate = [NSDate dateWithTimeIntervalSince1970:[dictionary[@"expiry"] doubleValue]];
     }
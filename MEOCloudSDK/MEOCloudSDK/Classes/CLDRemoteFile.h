@@ -0,0 +1,105 @@
+//
+//  CLDRemoteFile.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+@class CLDItem;
+@class CLDRequest;
+
+/**
+ Default value for <[CLDRemoteFile blockSize]>.
+ @since 1.1
+ */
+FOUNDATION_EXPORT const NSUInteger CLDRemoteFileDefaultBlockSize;
+
+/**
+ Default value for <[CLDRemoteFile maximumNumberOfCachedBlocks]>.
+ @since 1.1
+ */
+FOUNDATION_EXPORT const NSUInteger CLDRemoteFileDefaultMaximumNumberOfCachedBlocks;
+
+/**
+ Default value for <[CLDRemoteFile numberOfReadAheadBlocks]>.
+ @since 1.1
+ */
+FOUNDATION_EXPORT const NSUInteger CLDRemoteFileDefaultNumberOfReadAheadBlocks;
+
+/**
+ This class reads arbitrary byte ranges of a file without downloading all of it, e.g. to preview the index of a ZIP archive
+ or the tail of a large log.
+
+ The file is read in blocks of <blockSize> bytes, which are kept in memory and reused by later reads. Once the cache is full,
+ the least recently used blocks are dropped. Contiguous blocks missing from the cache are fetched with a single request, and
+ sequential reads fetch a few blocks ahead.
+
+ Remote files are pinned to the <[CLDItem revision]> of their item, so blocks are always consistent with each other. If the
+ file changes on the server, open it again to read the new revision.
+
+ Remote files are opened by <[CLDSession openRemoteFileForItem:resultBlock:failureBlock:]>.
+ @since 1.1
+ */
+@interface CLDRemoteFile : NSObject
+
+/**
+ The identifier of the session this file belongs to.
+ @since 1.1
+ */
+@property (readonly, strong, nonatomic) NSString *sessionIdentifier;
+
+/**
+ The item whose revision is read.
+ @since 1.1
+ */
+@property (readonly, strong, nonatomic) CLDItem *item;
+
+/**
+ The size of the file, in bytes.
+ @since 1.1
+ */
+@property (readonly, nonatomic) uint64_t size;
+
+/**
+ The size of each cached block, in bytes.
+ Default value is `CLDRemoteFileDefaultBlockSize`.
+ @since 1.1
+ */
+@property (readonly, nonatomic) NSUInteger blockSize;
+
+/**
+ The maximum number of blocks kept in memory. Reads can't be larger than this many blocks.
+ Default value is `CLDRemoteFileDefaultMaximumNumberOfCachedBlocks`.
+ @since 1.1
+ */
+@property (readwrite, atomic) NSUInteger maximumNumberOfCachedBlocks;
+
+/**
+ The number of blocks fetched past the end of a read that continues the previous one. `0` disables reading ahead.
+ Default value is `CLDRemoteFileDefaultNumberOfReadAheadBlocks`.
+ @since 1.1
+ */
+@property (readwrite, atomic) NSUInteger numberOfReadAheadBlocks;
+
+/**
+ Reads a range of the file.
+
+ Ranges past the end of the file are cut short, so the data may be shorter than `length`, or empty.
+
+ @param offset       The offset of the first byte to be read.
+ @param length       The number of bytes to be read. Must not be larger than <blockSize> times <maximumNumberOfCachedBlocks>.
+ @param resultBlock  The block to be executed once the range is read. This block takes an `NSData` argument containing the bytes.
+ @param failureBlock The block to be executed if the range could not be read. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the read. Blocks already being fetched are still cached for later reads.
+ @since 1.1
+ */
+- (CLDRequest *)readDataAtOffset:(uint64_t)offset length:(NSUInteger)length resultBlock:(void(^)(NSData *data))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+
+/**
+ Drops every cached block.
+ @since 1.1
+ */
+- (void)removeAllCachedBlocks;
+
+@end
@@ -0,0 +1,364 @@
+//
+//  CLDRemoteFile.m
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import "CLDRemoteFile.h"
+
+#define CLDRemoteFileMaximumBlocksPerRequest 32
+
+const NSUInteger CLDRemoteFileDefaultBlockSize = 64 * 1024;
+const NSUInteger CLDRemoteFileDefaultMaximumNumberOfCachedBlocks = 64;
+const NSUInteger CLDRemoteFileDefaultNumberOfReadAheadBlocks = 4;
+
+// one call to readDataAtOffset:, waiting for its blocks
+@interface CLDRemoteFileRead : NSObject
+@property (readwrite, nonatomic) uint64_t offset;
+@property (readwrite, nonatomic) NSUInteger length;
+@property (readwrite, nonatomic) NSRange blocks;
+@property (readwrite, strong, nonatomic) CLDRequest *handle;
+@property (readwrite, strong, nonatomic) dispatch_queue_t callbackQueue;
+@property (readwrite, copy, nonatomic) void(^resultBlock)(NSData *data);
+@property (readwrite, copy, nonatomic) void(^failureBlock)(NSError *error);
+@end
+
+@implementation CLDRemoteFileRead
+@end
+
+
+
+
+@interface CLDRemoteFile ()
+@property (readwrite, strong, nonatomic) NSString *sessionIdentifier;
+@property (readwrite, strong, nonatomic) CLDItem *item;
+@property (readwrite, nonatomic) uint64_t size;
+@property (readwrite, nonatomic) NSUInteger blockSize;
+
+@property (readwrite, weak, nonatomic) CLDSession *session;
+@property (readwrite, strong, nonatomic) dispatch_queue_t callbackQueue;
+@end
+
+@implementation CLDRemoteFile {
+    dispatch_queue_t _queue;
+    NSUInteger _maximumNumberOfCachedBlocks;
+    NSUInteger _numberOfReadAheadBlocks;
+    NSMutableDictionary *_blocks;           // block index -> NSData
+    NSMutableArray *_recentBlocks;          // block indexes, least recently used first
+    NSMutableIndexSet *_fetchingBlocks;
+    NSMutableDictionary *_fetches;          // NSValue of a block range -> CLDRequest fetching it
+    NSMutableArray *_pendingReads;
+    uint64_t _lastReadEnd;
+}
+
+#pragma mark - Initialization
+
+- (instancetype)initWithSession:(CLDSession *)session item:(CLDItem *)item {
+    NSParameterAssert(session);
+    NSParameterAssert(item.type == CLDItemTypeFile);
+    NSParameterAssert(item.revision);
+    self = [super init];
+    if (self) {
+        _session = session;
+        _sessionIdentifier = session.sessionIdentifier;
+        _item = item;
+        _size = item.size;
+        _blockSize = CLDRemoteFileDefaultBlockSize;
+        _maximumNumberOfCachedBlocks = CLDRemoteFileDefaultMaximumNumberOfCachedBlocks;
+        _numberOfReadAheadBlocks = CLDRemoteFileDefaultNumberOfReadAheadBlocks;
+        _queue = dispatch_queue_create("pt.meo.cloud.sdk.remotefile", DISPATCH_QUEUE_SERIAL);
+        _callbackQueue = dispatch_get_main_queue();
+        _blocks = [NSMutableDictionary new];
+        _recentBlocks = [NSMutableArray new];
+        _fetchingBlocks = [NSMutableIndexSet new];
+        _fetches = [NSMutableDictionary new];
+        _pendingReads = [NSMutableArray new];
+    }
+    return self;
+}
+
+#pragma mark - Dynamic properties
+
+- (NSUInteger)maximumNumberOfCachedBlocks {
+    @synchronized(self) {
+        return _maximumNumberOfCachedBlocks;
+    }
+}
+
+- (void)setMaximumNumberOfCachedBlocks:(NSUInteger)maximumNumberOfCachedBlocks {
+    @synchronized(self) {
+        _maximumNumberOfCachedBlocks = MAX(maximumNumberOfCachedBlocks, 1);
+    }
+}
+
+- (NSUInteger)numberOfReadAheadBlocks {
+    @synchronized(self) {
+        return _numberOfReadAheadBlocks;
+    }
+}
+
+- (void)setNumberOfReadAheadBlocks:(NSUInteger)numberOfReadAheadBlocks {
+    @synchronized(self) {
+        _numberOfReadAheadBlocks = numberOfReadAheadBlocks;
+    }
+}
+
+- (NSUInteger)_numberOfBlocks {
+    return (NSUInteger)((self.size + self.blockSize - 1) / self.blockSize);
+}
+
+#pragma mark - Public methods
+
+- (CLDRequest *)readDataAtOffset:(uint64_t)offset
+                          length:(NSUInteger)length
+                     resultBlock:(void (^)(NSData *))resultBlock
+                    failureBlock:(void (^)(NSError *))failureBlock {
+    NSParameterAssert(length <= self.blockSize * self.maximumNumberOfCachedBlocks);
+    CLDRequest *handle = [CLDRequest new];
+    dispatch_queue_t callbackQueue = self.callbackQueue;
+
+    dispatch_async(_queue, ^{
+        uint64_t end = MIN(offset + length, self.size);
+        if (offset >= end) {
+            RunRequestBlockOnQueue(handle, callbackQueue, resultBlock, [NSData data]);
+            return;
+        }
+
+        NSUInteger blockSize = self.blockSize;
+        NSUInteger firstBlock = (NSUInteger)(offset / blockSize);
+        NSUInteger lastBlock = (NSUInteger)((end - 1) / blockSize);
+        CLDRemoteFileRead *read = [CLDRemoteFileRead new];
+        read.offset = offset;
+        read.length = (NSUInteger)(end - offset);
+        read.blocks = NSMakeRange(firstBlock, lastBlock - firstBlock + 1);
+        read.handle = handle;
+        read.callbackQueue = callbackQueue;
+        read.resultBlock = resultBlock;
+        read.failureBlock = failureBlock;
+
+        // a read that picks up where the last one ended is likely followed by another one
+        NSRange blocks = read.blocks;
+        if (offset == _lastReadEnd) {
+            NSUInteger numberOfReadAheadBlocks = MIN(self.numberOfReadAheadBlocks, [self _numberOfBlocks] - NSMaxRange(blocks));
+            numberOfReadAheadBlocks = MIN(numberOfReadAheadBlocks, self.maximumNumberOfCachedBlocks - MIN(blocks.length, self.maximumNumberOfCachedBlocks));
+            blocks.length += numberOfReadAheadBlocks;
+        }
+        _lastReadEnd = end;
+
+        [_pendingReads addObject:read];
+        [self _fetchMissingBlocksInRange:blocks];
+        [self _finishPendingReads];
+    });
+    __weak CLDRemoteFile *weakSelf = self;
+    __weak CLDRequest *weakHandle = handle;
+    handle.cancellationHandler = ^{
+        [weakSelf _cancelReadWithHandle:weakHandle];
+    };
+    return handle;
+}
+
+- (void)removeAllCachedBlocks {
+    dispatch_async(_queue, ^{
+        // blocks pending reads are waiting for stay, or they would have to be fetched all over again
+        NSIndexSet *pinnedBlocks = [self _pinnedBlocks];
+        for (NSNumber *key in [_recentBlocks copy]) {
+            if ([pinnedBlocks containsIndex:key.unsignedIntegerValue]) continue;
+            [_blocks removeObjectForKey:key];
+            [_recentBlocks removeObject:key];
+        }
+    });
+}
+
+#pragma mark - Private methods
+
+- (void)_cancelReadWithHandle:(CLDRequest *)handle {
+    if (handle == nil) return;
+    dispatch_async(_queue, ^{
+        [self _removeReadWithHandle:handle];
+    });
+}
+
+// all methods below must be called on _queue
+
+- (void)_fetchMissingBlocksInRange:(NSRange)range {
+    NSMutableIndexSet *missingBlocks = [NSMutableIndexSet new];
+    for (NSUInteger index = range.location; index < NSMaxRange(range); index++) {
+        if (_blocks[@(index)] == nil && ![_fetchingBlocks containsIndex:index]) [missingBlocks addIndex:index];
+    }
+
+    // adjacent misses are fetched together, up to a point, so one slow request doesn't hold up everything
+    [missingBlocks enumerateRangesUsingBlock:^(NSRange missingRange, BOOL *stop) {
+        for (NSUInteger location = missingRange.location; location < NSMaxRange(missingRange); location += CLDRemoteFileMaximumBlocksPerRequest) {
+            NSUInteger length = MIN(CLDRemoteFileMaximumBlocksPerRequest, NSMaxRange(missingRange) - location);
+            [self _fetchBlocksInRange:NSMakeRange(location, length)];
+        }
+    }];
+}
+
+- (void)_fetchBlocksInRange:(NSRange)range {
+    CLDSession *session = self.session;
+    if (session == nil) {
+        [self _didFailToFetchBlocksInRange:range error:[CLDError errorWithCode:CLDErrorCodeSessionNotLinked]];
+        return;
+    }
+    [_fetchingBlocks addIndexesInRange:range];
+    NSValue *fetchKey = [NSValue valueWithRange:range];
+
+    uint64_t start = (uint64_t)range.location * self.blockSize;
+    uint64_t end = MIN((uint64_t)NSMaxRange(range) * self.blockSize, self.size);
+    NSString *path = [NSString stringWithFormat:@"/Files/<mode>/%@", self.item.trimmedPath];
+    NSURL *url = [session _serviceURLForEndpoint:CLDSessionEndpointContentAPI path:path query:@{@"rev": self.item.revision}];
+    NSMutableURLRequest *request = [session _signedMutableURLRequestWithURL:url];
+    [request setValue:[NSString stringWithFormat:@"bytes=%llu-%llu", start, end - 1] forHTTPHeaderField:@"Range"];
+
+    // fetches cancelled after their response was on its way are ignored
+    __block CLDRequest *fetch = nil;
+    fetch = [session _performRequest:request successBlock:^(NSData *data) {
+        dispatch_async(_queue, ^{
+            if (_fetches[fetchKey] != fetch) return;
+            [_fetches removeObjectForKey:fetchKey];
+            [self _didFetchData:data blocksInRange:range];
+        });
+    } failureBlock:^(CLDError *error) {
+        dispatch_async(_queue, ^{
+            if (_fetches[fetchKey] != fetch) return;
+            [_fetches removeObjectForKey:fetchKey];
+            [self _didFailToFetchBlocksInRange:range error:error];
+        });
+    }];
+    _fetches[fetchKey] = fetch;
+}
+
+- (void)_removeReadWithHandle:(CLDRequest *)handle {
+    for (CLDRemoteFileRead *read in [_pendingReads copy]) {
+        if (read.handle == handle) [_pendingReads removeObject:read];
+    }
+
+    // fetches no read is waiting for anymore, read ahead included, only waste bandwidth
+    NSIndexSet *pinnedBlocks = [self _pinnedBlocks];
+    for (NSValue *fetchKey in _fetches.allKeys) {
+        NSRange range = fetchKey.rangeValue;
+        if ([pinnedBlocks intersectsIndexesInRange:range]) continue;
+        [_fetches[fetchKey] cancel];
+        [_fetches removeObjectForKey:fetchKey];
+        [_fetchingBlocks removeIndexesInRange:range];
+    }
+    [self _trimCache];
+}
+
+- (void)_didFetchData:(NSData *)data blocksInRange:(NSRange)range {
+    [_fetchingBlocks removeIndexesInRange:range];
+
+    NSUInteger blockSize = self.blockSize;
+    uint64_t start = (uint64_t)range.location * blockSize;
+    uint64_t end = MIN((uint64_t)NSMaxRange(range) * blockSize, self.size);
+
+    // servers that ignore the range send the whole file
+    uint64_t dataOffset = 0;
+    if (data.length != end - start) {
+        if (data.length == self.size) {
+            dataOffset = start;
+        } else {
+            CLDLog(@"Unexpected %lu bytes for range %llu-%llu of %@", (unsigned long)data.length, start, end - 1, self.item.path);
+            [self _didFailToFetchBlocksInRange:range error:[CLDError errorWithCode:CLDErrorCodeInvalidResponse]];
+            return;
+        }
+    }
+
+    for (NSUInteger index = range.location; index < NSMaxRange(range); index++) {
+        uint64_t blockStart = dataOffset + (uint64_t)(index - range.location) * blockSize;
+        NSUInteger blockLength = (NSUInteger)MIN((uint64_t)blockSize, dataOffset + (end - start) - blockStart);
+        [self _cacheBlock:[data subdataWithRange:NSMakeRange((NSUInteger)blockStart, blockLength)] atIndex:index];
+    }
+    [self _finishPendingReads];
+}
+
+- (void)_didFailToFetchBlocksInRange:(NSRange)range error:(NSError *)error {
+    [_fetchingBlocks removeIndexesInRange:range];
+    for (CLDRemoteFileRead *read in [_pendingReads copy]) {
+        if (NSIntersectionRange(read.blocks, range).length == 0) continue;
+        [_pendingReads removeObject:read];
+        RunRequestBlockOnQueue(read.handle, read.callbackQueue, read.failureBlock, error);
+    }
+}
+
+- (void)_finishPendingReads {
+    for (CLDRemoteFileRead *read in [_pendingReads copy]) {
+        if (read.handle.isCancelled) {
+            [_pendingReads removeObject:read];
+            continue;
+        }
+
+        BOOL complete = YES;
+        for (NSUInteger index = read.blocks.location; index < NSMaxRange(read.blocks); index++) {
+            if (_blocks[@(index)] == nil) {
+                complete = NO;
+                break;
+            }
+        }
+        if (!complete) {
+            // blocks of pending reads are never dropped, so the missing ones are still on their way
+            continue;
+        }
+
+        NSUInteger blockSize = self.blockSize;
+        NSMutableData *data = [NSMutableData dataWithCapacity:read.length];
+        for (NSUInteger index = read.blocks.location; index < NSMaxRange(read.blocks); index++) {
+            NSData *block = [self _cachedBlockAtIndex:index];
+            uint64_t blockStart = (uint64_t)index * blockSize;
+            uint64_t start = MAX(read.offset, blockStart);
+            uint64_t end = MIN(read.offset + read.length, blockStart + block.length);
+            [data appendData:[block subdataWithRange:NSMakeRange((NSUInteger)(start - blockStart), (NSUInteger)(end - start))]];
+        }
+        [_pendingReads removeObject:read];
+        RunRequestBlockOnQueue(read.handle, read.callbackQueue, read.resultBlock, data);
+    }
+    [self _trimCache];
+}
+
+#pragma mark - Block cache
+
+- (NSData *)_cachedBlockAtIndex:(NSUInteger)index {
+    NSNumber *key = @(index);
+    NSData *block = _blocks[key];
+    if (block) {
+        [_recentBlocks removeObject:key];
+        [_recentBlocks addObject:key];
+    }
+    return block;
+}
+
+- (void)_cacheBlock:(NSData *)block atIndex:(NSUInteger)index {
+    NSNumber *key = @(index);
+    if (_blocks[key]) [_recentBlocks removeObject:key];
+    _blocks[key] = block;
+    [_recentBlocks addObject:key];
+    [self _trimCache];
+}
+
+// blocks of pending reads
+- (NSIndexSet *)_pinnedBlocks {
+    NSMutableIndexSet *pinnedBlocks = [NSMutableIndexSet new];
+    for (CLDRemoteFileRead *read in _pendingReads) {
+        [pinnedBlocks addIndexesInRange:read.blocks];
+    }
+    return pinnedBlocks;
+}
+
+// drops the least recently used blocks no pending read is waiting for, the cache only
+// grows past its limit while several reads are pending at once
+- (void)_trimCache {
+    NSUInteger maximumNumberOfCachedBlocks = self.maximumNumberOfCachedBlocks;
+    if (_recentBlocks.count <= maximumNumberOfCachedBlocks) return;
+    NSIndexSet *pinnedBlocks = [self _pinnedBlocks];
+    for (NSNumber *key in [_recentBlocks copy]) {
+        if (_recentBlocks.count <= maximumNumberOfCachedBlocks) break;
+        if ([pinnedBlocks containsIndex:key.unsignedIntegerValue]) continue;
+        [_blocks removeObjectForKey:key];
+        [_recentBlocks removeObject:key];
+    }
+}
+
+@end
@@ -0,0 +1,72 @@
+//
+//  CLDRequest.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+/**
+ Scheduling lanes for the requests performed by a <CLDSession>, from the first to be admitted to the last.
+ @see [CLDSession performInRequestLane:block:]
+ @since 1.1
+ */
+typedef NS_ENUM(NSInteger, CLDRequestLane) {
+    /**
+     Requests the user is waiting for, e.g. the contents of the folder on screen.
+     @since 1.1
+     */
+    CLDRequestLaneInteractive = 0,
+    /**
+     Requests without a lane of their own. This is the lane of every request started outside of <[CLDSession performInRequestLane:block:]>.
+     @since 1.1
+     */
+    CLDRequestLaneDefault,
+    /**
+     Requests the user is not waiting for, e.g. folder crawling and delta polling.
+     @since 1.1
+     */
+    CLDRequestLaneBackground,
+    /**
+     Requests for data that may never be needed, e.g. thumbnail prefetching.
+     @since 1.1
+     */
+    CLDRequestLanePrefetch
+};
+
+/**
+ This class represents a request started by <CLDSession> or <CLDLink>.
+
+ Cancelling a request stops its network activity and keeps its result and failure blocks from being called.
+ When a request is cancelled on the queue its blocks are executed on, none of them is executed afterwards.
+ Requests made of several steps are cancelled at whatever step they are in.
+ @since 1.1
+ */
+@interface CLDRequest : NSObject
+
+/**
+ `BOOL` stating whether the request was cancelled.
+ @since 1.1
+ */
+@property (readonly, atomic, getter = isCancelled) BOOL cancelled;
+
+/**
+ The lane in which the request is scheduled.
+ @since 1.1
+ */
+@property (readonly, atomic) CLDRequestLane lane;
+
+/**
+ The priority of the request, between `0` and `1`. Default value is `0.5`.
+ @note Priorities are only taken into account on iOS 8 and OS X 10.10 or later.
+ @since 1.1
+ */
+@property (readwrite, atomic) float priority;
+
+/**
+ Cancels the request. Neither its result block nor its failure block are called.
+ @since 1.1
+ */
+- (void)cancel;
+
+@end
@@ -0,0 +1,111 @@
+//
+//  CLDRequest.m
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import "CLDRequest.h"
+
+@implementation CLDRequest {
+    NSURLSessionTask *_task;
+    void(^_cancellationHandler)();
+    float _priority;
+    CLDRequestLane _lane;
+    BOOL _cancelled;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _priority = 0.5;
+        _lane = CLDRequestLaneDefault;
+    }
+    return self;
+}
+
+#pragma mark - Dynamic properties
+
+- (BOOL)isCancelled {
+    @synchronized(self) {
+        return _cancelled;
+    }
+}
+
+- (CLDRequestLane)lane {
+    @synchronized(self) {
+        return _lane;
+    }
+}
+
+- (void)setLane:(CLDRequestLane)lane {
+    @synchronized(self) {
+        _lane = lane;
+    }
+}
+
+- (float)priority {
+    @synchronized(self) {
+        return _priority;
+    }
+}
+
+- (void)setPriority:(float)priority {
+    @synchronized(self) {
+        _priority = MIN(MAX(priority, 0), 1);
+        [self _applyPriority];
+    }
+}
+
+- (void (^)())cancellationHandler {
+    @synchronized(self) {
+        return _cancellationHandler;
+    }
+}
+
+- (void)setCancellationHandler:(void (^)())cancellationHandler {
+    BOOL cancelled = NO;
+    @synchronized(self) {
+        cancelled = _cancelled;
+        if (!cancelled) _cancellationHandler = [cancellationHandler copy];
+    }
+    // too late, run it right away
+    if (cancelled) RunBlock(cancellationHandler);
+}
+
+#pragma mark - Public methods
+
+- (void)cancel {
+    void(^cancellationHandler)() = nil;
+    @synchronized(self) {
+        if (_cancelled) return;
+        _cancelled = YES;
+        [_task cancel];
+        cancellationHandler = _cancellationHandler;
+        _cancellationHandler = nil;
+    }
+    RunBlock(cancellationHandler);
+}
+
+- (void)startWithTask:(NSURLSessionTask *)task {
+    @synchronized(self) {
+        _task = task;
+        [self _applyPriority];
+
+        // always resume, cancelled tasks still have to call their completion handlers
+        [task resume];
+        if (_cancelled) [task cancel];
+    }
+}
+
+#pragma mark - Private methods
+
+- (void)_applyPriority {
+    // task priorities are only available on iOS 8 and OS X 10.10
+    if ([_task respondsToSelector:@selector(setPriority:)]) {
+        _task.priority = _priority;
+    }
+}
+
+@end
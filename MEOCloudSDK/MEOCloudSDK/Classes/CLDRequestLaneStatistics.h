@@ -0,0 +1,54 @@
+//
+//  CLDRequestLaneStatistics.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import <MEOCloudSDK/CLDRequest.h>
+
+/**
+ This class represents a snapshot of the requests scheduled in one lane of a <CLDSession>.
+ @see [CLDSession statisticsForRequestLane:]
+ @since 1.1
+ */
+@interface CLDRequestLaneStatistics : NSObject
+
+/**
+ The lane these statistics refer to.
+ @since 1.1
+ */
+@property (readonly, nonatomic) CLDRequestLane lane;
+
+/**
+ The number of requests waiting to be started.
+ @since 1.1
+ */
+@property (readonly, nonatomic) NSUInteger numberOfPendingRequests;
+
+/**
+ The number of requests in progress.
+ @since 1.1
+ */
+@property (readonly, nonatomic) NSUInteger numberOfActiveRequests;
+
+/**
+ The number of requests started since the session was created or its statistics were reset.
+ @since 1.1
+ */
+@property (readonly, nonatomic) NSUInteger numberOfStartedRequests;
+
+/**
+ The average time, in seconds, started requests waited before being started.
+ @since 1.1
+ */
+@property (readonly, nonatomic) NSTimeInterval averageWaitTime;
+
+/**
+ The longest time, in seconds, a started request waited before being started.
+ @since 1.1
+ */
+@property (readonly, nonatomic) NSTimeInterval maximumWaitTime;
+
+@end
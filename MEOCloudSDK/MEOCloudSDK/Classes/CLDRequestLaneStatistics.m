@@ -0,0 +1,31 @@
+//
+//  CLDRequestLaneStatistics.m
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import "CLDRequestLaneStatistics.h"
+
+@implementation CLDRequestLaneStatistics
+
+- (instancetype)initWithLane:(CLDRequestLane)lane
+     numberOfPendingRequests:(NSUInteger)numberOfPendingRequests
+      numberOfActiveRequests:(NSUInteger)numberOfActiveRequests
+     numberOfStartedRequests:(NSUInteger)numberOfStartedRequests
+             averageWaitTime:(NSTimeInterval)averageWaitTime
+             maximumWaitTime:(NSTimeInterval)maximumWaitTime {
+    self = [super init];
+    if (self) {
+        _lane = lane;
+        _numberOfPendingRequests = numberOfPendingRequests;
+        _numberOfActiveRequests = numberOfActiveRequests;
+        _numberOfStartedRequests = numberOfStartedRequests;
+        _averageWaitTime = averageWaitTime;
+        _maximumWaitTime = maximumWaitTime;
+    }
+    return self;
+}
+
+@end
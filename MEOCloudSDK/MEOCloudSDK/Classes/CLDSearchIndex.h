@@ -0,0 +1,88 @@
+//
+//  CLDSearchIndex.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+@class CLDSession;
+@class CLDItem;
+
+/**
+ How queries are matched against item names.
+ @since 1.1
+ */
+typedef NS_ENUM(NSInteger, CLDSearchIndexMatch) {
+    /**
+     Names that start with the query.
+     @since 1.1
+     */
+    CLDSearchIndexMatchPrefix,
+    /**
+     Names that contain the query anywhere.
+     @since 1.1
+     */
+    CLDSearchIndexMatchSubstring
+};
+
+/**
+ This class keeps a local index of the items a <CLDSession> has already fetched, so that they can be searched without network access.
+
+ The index is fed by folder listings (<[CLDSession fetchItem:options:resultBlock:failureBlock:]> with `CLDSessionFetchItemOptionListContents`),
+ crawls, delta polling, search results and the session's own copies, moves, deletes and folder creations. It is archived in the Caches directory
+ and loaded again in the background when the session is linked.
+
+ Names are matched regardless of case and diacritics. Queries of three or more characters, and all prefix queries, are answered from
+ trigram and prefix postings, so they stay fast over hundreds of thousands of items. Shorter substring queries go through every name.
+ Deleted items are not indexed.
+
+ A folder is fully indexed once it and every known subfolder below it were listed. Searches outside fully indexed folders only return
+ the items the index happens to know about, see <[CLDSession searchItem:query:match:limit:mimeType:resultBlock:failureBlock:]> for
+ a search that falls back to the server in that case.
+ @since 1.1
+ */
+@interface CLDSearchIndex : NSObject
+
+/**
+ The session whose items are indexed.
+ @since 1.1
+ */
+@property (readonly, weak, nonatomic) CLDSession *session;
+
+/**
+ The number of indexed items.
+ @since 1.1
+ */
+@property (readonly, atomic) NSUInteger numberOfItems;
+
+/**
+ Returns whether a folder and all of its subfolders were listed, so that searching it locally finds everything.
+ @param folder The folder.
+ @return `YES` if the folder is fully indexed.
+ @since 1.1
+ */
+- (BOOL)isFolderIndexed:(CLDItem *)folder;
+
+/**
+ Searches the index synchronously.
+
+ @param folder   The folder to search in, including its subfolders.
+ @param query    The text to look for in item names. Must not be empty.
+ @param match    How `query` is matched against names.
+ @param mimeType The mime-type of the items to be returned, or `nil` to return items of any type, including folders.
+ @param limit    The maximum number of items to be returned, or `0` for no limit.
+ @return An `NSArray` of <CLDItem> instances. These items do not have contents or folder hashes.
+ @note The calling thread waits for any indexing in progress, e.g. of a large crawl. Use
+ <[CLDSession searchItem:query:match:limit:mimeType:resultBlock:failureBlock:]> on the main thread.
+ @since 1.1
+ */
+- (NSArray *)itemsInFolder:(CLDItem *)folder matchingQuery:(NSString *)query match:(CLDSearchIndexMatch)match mimeType:(NSString *)mimeType limit:(NSUInteger)limit;
+
+/**
+ Removes every item from the index, in memory and on disk.
+ @since 1.1
+ */
+- (void)removeAllItems;
+
+@end
@@ -0,0 +1,676 @@
+//
+//  CLDSearchIndex.m
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import "CLDSearchIndex.h"
+
+#define CLDSearchIndexSaveDelay 10
+#define CLDSearchIndexMinimumRemovedRecordsForRebuild 10000
+
+typedef NS_OPTIONS(uint8_t, CLDSearchIndexRecordFlags) {
+    CLDSearchIndexRecordFlagFolder       = 1 << 0,
+    CLDSearchIndexRecordFlagHasThumbnail = 1 << 1,
+    CLDSearchIndexRecordFlagRemoved      = 1 << 2
+};
+
+// fixed size metadata of an indexed item, strings are kept apart
+typedef struct {
+    uint64_t size;
+    NSTimeInterval lastModified;    // since the reference date, NAN if unknown
+    uint32_t mimeType;              // index in _strings
+    uint32_t iconName;              // index in _strings
+    uint8_t flags;
+} CLDSearchIndexRecord;
+
+static const uint32_t CLDSearchIndexNoString = UINT32_MAX;
+
+static NSString *CLDSearchIndexFoldedString(NSString *string) {
+    return [string stringByFoldingWithOptions:NSCaseInsensitiveSearch|NSDiacriticInsensitiveSearch locale:nil];
+}
+
+// anchored grams start with a character that never shows up in names, so they don't collide with trigrams
+static NSString *CLDSearchIndexAnchoredGram(NSString *foldedName) {
+    return [@"\u0001" stringByAppendingString:[foldedName substringToIndex:MIN(foldedName.length, 2)]];
+}
+
+static NSSet *CLDSearchIndexGrams(NSString *foldedName) {
+    NSMutableSet *grams = [NSMutableSet new];
+    NSUInteger length = foldedName.length;
+    if (length > 0) [grams addObject:[@"\u0001" stringByAppendingString:[foldedName substringToIndex:1]]];
+    if (length > 1) [grams addObject:[@"\u0001" stringByAppendingString:[foldedName substringToIndex:2]]];
+    for (NSUInteger location = 0; location + 3 <= length; location++) {
+        [grams addObject:[foldedName substringWithRange:NSMakeRange(location, 3)]];
+    }
+    return grams;
+}
+
+// service paths are case insensitive, every key below is a lowercase path
+static NSString *CLDSearchIndexKey(NSString *path) {
+    return path.lowercaseString;
+}
+
+static NSString *CLDSearchIndexParentKey(NSString *key) {
+    return key.stringByDeletingLastPathComponent;
+}
+
+@interface CLDSearchIndex ()
+@property (readwrite, weak, nonatomic) CLDSession *session;
+@property (readwrite, atomic) NSUInteger numberOfItems;
+@end
+
+@implementation CLDSearchIndex {
+    dispatch_queue_t _queue;
+    dispatch_queue_t _archiveQueue;     // loading and saving, so that queries never wait for the disk
+    NSString *_sessionIdentifier;
+    NSUInteger _generation;             // bumped when every item is removed, a state loaded before that is stale
+
+    // one entry per record, removed records keep their slot until the next rebuild
+    NSMutableArray *_paths;
+    NSMutableArray *_names;             // folded last path components
+    NSMutableArray *_revisions;
+    NSMutableData *_records;            // CLDSearchIndexRecord
+    NSUInteger _numberOfRemovedRecords;
+
+    NSMutableArray *_strings;           // mime types and icon names, shared by all records
+    NSMutableDictionary *_stringIndexes;
+
+    NSMutableDictionary *_recordIndexes;    // key -> record index
+    NSMutableDictionary *_children;         // key -> NSMutableSet of keys
+    NSMutableDictionary *_postings;         // gram -> NSMutableData of ascending uint32_t record indexes
+
+    NSMutableSet *_listedFolders;       // keys of folders whose contents are known
+    NSMutableSet *_unlistedFolders;     // keys of known folders whose contents are not
+    NSMutableSet *_keysRemovedBeforeLoad;   // removed while the archive was loading, nil once it was merged
+    NSMutableSet *_foldersListedBeforeLoad; // same, for folders whose whole contents were indexed
+    BOOL _saveScheduled;
+}
+
+#pragma mark - Initialization
+
+- (instancetype)initWithSession:(CLDSession *)session {
+    NSParameterAssert(session);
+    self = [super init];
+    if (self) {
+        _session = session;
+        _sessionIdentifier = session.sessionIdentifier;
+        _queue = dispatch_queue_create("pt.meo.cloud.sdk.searchindex", DISPATCH_QUEUE_SERIAL);
+        _archiveQueue = dispatch_queue_create("pt.meo.cloud.sdk.searchindex.archive", DISPATCH_QUEUE_SERIAL);
+        [self _resetWithStrings:nil];
+        _keysRemovedBeforeLoad = [NSMutableSet new];
+        _foldersListedBeforeLoad = [NSMutableSet new];
+
+        NSNotificationCenter *notificationCenter = [NSNotificationCenter defaultCenter];
+        [notificationCenter addObserver:self selector:@selector(_itemsChanged:) name:kCLDSessionItemsCreatedNotification object:session];
+        [notificationCenter addObserver:self selector:@selector(_itemsChanged:) name:kCLDSessionItemsModifiedNotification object:session];
+        [notificationCenter addObserver:self selector:@selector(_itemsDeleted:) name:kCLDSessionItemsDeletedNotification object:session];
+
+        [self _loadState];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
+#pragma mark - Public methods
+
+- (BOOL)isFolderIndexed:(CLDItem *)folder {
+    NSString *key = CLDSearchIndexKey(folder.path ?: @"/");
+    __block BOOL indexed = NO;
+    dispatch_sync(_queue, ^{
+        indexed = [self _isFolderIndexedWithKey:key];
+    });
+    return indexed;
+}
+
+- (NSArray *)itemsInFolder:(CLDItem *)folder matchingQuery:(NSString *)query match:(CLDSearchIndexMatch)match mimeType:(NSString *)mimeType limit:(NSUInteger)limit {
+    NSParameterAssert(query.length > 0);
+    CLDSession *session = self.session;
+    if (session == nil) return @[];
+
+    NSString *folderKey = CLDSearchIndexKey(folder.path ?: @"/");
+    NSString *foldedQuery = CLDSearchIndexFoldedString(query);
+    __block NSArray *items = nil;
+    dispatch_sync(_queue, ^{
+        items = [self _itemsInFolderWithKey:folderKey matchingQuery:foldedQuery match:match mimeType:mimeType limit:limit session:session];
+    });
+    return items;
+}
+
+- (void)removeAllItems {
+    dispatch_sync(_queue, ^{
+        _generation++;
+        [self _resetWithStrings:nil];
+        _keysRemovedBeforeLoad = nil;
+        _foldersListedBeforeLoad = nil;
+        // after any save already on its way
+        NSURL *url = [[self class] _stateArchiveURLForSessionIdentifier:_sessionIdentifier];
+        dispatch_async(_archiveQueue, ^{
+            [[NSFileManager defaultManager] removeItemAtURL:url error:nil];
+        });
+    });
+}
+
+#pragma mark - Private methods
+
+- (void)queryItemsInFolder:(CLDItem *)folder
+             matchingQuery:(NSString *)query
+                     match:(CLDSearchIndexMatch)match
+                  mimeType:(NSString *)mimeType
+                     limit:(NSUInteger)limit
+             onlyIfIndexed:(BOOL)onlyIfIndexed
+                     block:(void (^)(NSArray *))block {
+    NSParameterAssert(query.length > 0);
+    NSParameterAssert(block);
+    NSString *folderKey = CLDSearchIndexKey(folder.path ?: @"/");
+    NSString *foldedQuery = CLDSearchIndexFoldedString(query);
+    dispatch_async(_queue, ^{
+        CLDSession *session = self.session;
+        if (session == nil) {
+            block(@[]);
+        } else if (onlyIfIndexed && ![self _isFolderIndexedWithKey:folderKey]) {
+            block(nil);
+        } else {
+            block([self _itemsInFolderWithKey:folderKey matchingQuery:foldedQuery match:match mimeType:mimeType limit:limit session:session]);
+        }
+    });
+}
+
+- (void)indexItems:(NSArray *)items {
+    if (items.count == 0) return;
+    dispatch_async(_queue, ^{
+        for (CLDItem *item in items) {
+            [self _indexItem:item];
+        }
+        [self _didChange];
+    });
+}
+
+- (void)indexFolder:(CLDItem *)folder {
+    NSParameterAssert(folder.type == CLDItemTypeFolder);
+    NSArray *contents = folder.contents;
+    if (contents == nil) {
+        [self indexItems:@[folder]];
+        return;
+    }
+    dispatch_async(_queue, ^{
+        if (folder.isDeleted) {
+            [self _removeRecordWithKey:CLDSearchIndexKey(folder.path)];
+            [self _didChange];
+            return;
+        }
+
+        NSString *key = CLDSearchIndexKey(folder.path);
+        [self _indexItem:folder];
+        NSMutableSet *childKeys = [NSMutableSet setWithCapacity:contents.count];
+        for (CLDItem *item in contents) {
+            if (item.path == nil) continue;
+            [self _indexItem:item];
+            if (!item.isDeleted) [childKeys addObject:CLDSearchIndexKey(item.path)];
+        }
+
+        // the listing is complete, anything else we knew about inside this folder is gone
+        for (NSString *childKey in [_children[key] copy]) {
+            if (![childKeys containsObject:childKey]) [self _removeRecordWithKey:childKey];
+        }
+        [_listedFolders addObject:key];
+        [_unlistedFolders removeObject:key];
+        [_foldersListedBeforeLoad addObject:key];
+        [self _didChange];
+    });
+}
+
+- (void)removeItemsAtPaths:(NSArray *)paths {
+    if (paths.count == 0) return;
+    dispatch_async(_queue, ^{
+        for (NSString *path in paths) {
+            [self _removeRecordWithKey:CLDSearchIndexKey(path)];
+        }
+        [self _didChange];
+    });
+}
+
+- (void)moveItemAtPath:(NSString *)path toItem:(CLDItem *)item {
+    NSParameterAssert(path);
+    NSParameterAssert(item.path);
+    dispatch_async(_queue, ^{
+        NSString *key = CLDSearchIndexKey(path);
+        NSString *destinationPath = item.path;
+
+        // gather the subtree before removing it, then add it back under the new path
+        NSMutableArray *subtree = [NSMutableArray new];
+        [self _enumerateSubtreeWithKey:key block:^(NSString *subtreeKey) {
+            NSNumber *recordIndex = _recordIndexes[subtreeKey];
+            if (recordIndex == nil || [subtreeKey isEqualToString:key]) return;
+            NSUInteger index = recordIndex.unsignedIntegerValue;
+            NSString *subtreePath = _paths[index];
+            NSMutableDictionary *entry = [NSMutableDictionary new];
+            entry[@"path"] = [destinationPath stringByAppendingString:[subtreePath substringFromIndex:MIN(path.length, subtreePath.length)]];
+            entry[@"record"] = [NSData dataWithBytes:&[self _recordBytes][index] length:sizeof(CLDSearchIndexRecord)];
+            if (_revisions[index] != [NSNull null]) entry[@"revision"] = _revisions[index];
+            if ([_listedFolders containsObject:subtreeKey]) entry[@"listed"] = @YES;
+            [subtree addObject:entry];
+        }];
+        BOOL listed = [_listedFolders containsObject:key];
+        [self _removeRecordWithKey:key];
+
+        [self _indexItem:item];
+        if (listed) {
+            NSString *destinationKey = CLDSearchIndexKey(destinationPath);
+            [_listedFolders addObject:destinationKey];
+            [_unlistedFolders removeObject:destinationKey];
+        }
+        for (NSDictionary *entry in subtree) {
+            CLDSearchIndexRecord record;
+            [entry[@"record"] getBytes:&record length:sizeof(record)];
+            [self _addRecord:record path:entry[@"path"] revision:entry[@"revision"] listed:[entry[@"listed"] boolValue]];
+        }
+        [self _didChange];
+    });
+}
+
++ (void)removeStateForSessionIdentifier:(NSString *)sessionIdentifier {
+    NSURL *url = [self _stateArchiveURLForSessionIdentifier:sessionIdentifier];
+    [[NSFileManager defaultManager] removeItemAtURL:url error:nil];
+}
+
+#pragma mark - Notifications
+
+- (void)_itemsChanged:(NSNotification *)notification {
+    [self indexItems:notification.userInfo[kCLDSessionItemsKey]];
+}
+
+- (void)_itemsDeleted:(NSNotification *)notification {
+    NSArray *items = notification.userInfo[kCLDSessionItemsKey];
+    [self removeItemsAtPaths:[items valueForKey:@"path"]];
+}
+
+#pragma mark - Records
+
+// all methods below must be called on _queue
+
+- (CLDSearchIndexRecord *)_recordBytes {
+    return (CLDSearchIndexRecord *)_records.mutableBytes;
+}
+
+- (void)_resetWithStrings:(NSArray *)strings {
+    _paths = [NSMutableArray new];
+    _names = [NSMutableArray new];
+    _revisions = [NSMutableArray new];
+    _records = [NSMutableData new];
+    _numberOfRemovedRecords = 0;
+    _strings = strings ? [strings mutableCopy] : [NSMutableArray new];
+    _stringIndexes = [NSMutableDictionary new];
+    [_strings enumerateObjectsUsingBlock:^(NSString *string, NSUInteger index, BOOL *stop) {
+        _stringIndexes[string] = @(index);
+    }];
+    _recordIndexes = [NSMutableDictionary new];
+    _children = [NSMutableDictionary new];
+    _postings = [NSMutableDictionary new];
+    _listedFolders = [NSMutableSet new];
+    _unlistedFolders = [NSMutableSet new];
+    self.numberOfItems = 0;
+}
+
+- (uint32_t)_indexOfString:(NSString *)string {
+    if (string == nil) return CLDSearchIndexNoString;
+    NSNumber *index = _stringIndexes[string];
+    if (index == nil) {
+        index = @(_strings.count);
+        [_strings addObject:string];
+        _stringIndexes[string] = index;
+    }
+    return index.unsignedIntValue;
+}
+
+- (NSString *)_stringAtIndex:(uint32_t)index {
+    return index == CLDSearchIndexNoString ? nil : _strings[index];
+}
+
+- (void)_indexItem:(CLDItem *)item {
+    NSString *path = item.path;
+    if (path.length == 0) return;
+    if (item.isDeleted) {
+        [self _removeRecordWithKey:CLDSearchIndexKey(path)];
+        return;
+    }
+    // the root folder is never a search result
+    if ([path isEqualToString:@"/"]) return;
+
+    CLDSearchIndexRecord record;
+    record.size = item.size;
+    record.lastModified = item.lastModified ? item.lastModified.timeIntervalSinceReferenceDate : NAN;
+    record.mimeType = [self _indexOfString:item.mimeType];
+    record.iconName = [self _indexOfString:item.iconName];
+    record.flags = 0;
+    if (item.type == CLDItemTypeFolder) record.flags |= CLDSearchIndexRecordFlagFolder;
+    if (item.hasThumbnail) record.flags |= CLDSearchIndexRecordFlagHasThumbnail;
+    [self _addRecord:record path:path revision:item.revision listed:NO];
+}
+
+- (void)_addRecord:(CLDSearchIndexRecord)record path:(NSString *)path revision:(NSString *)revision listed:(BOOL)listed {
+    NSString *key = CLDSearchIndexKey(path);
+    NSNumber *existingIndex = _recordIndexes[key];
+    if (existingIndex) {
+        // names are folded, so a change of case keeps the same postings
+        NSUInteger index = existingIndex.unsignedIntegerValue;
+        _paths[index] = path;
+        _revisions[index] = revision ?: [NSNull null];
+        [self _recordBytes][index] = record;
+    } else {
+        uint32_t index = (uint32_t)_paths.count;
+        NSString *name = CLDSearchIndexFoldedString(path.lastPathComponent);
+        [_paths addObject:path];
+        [_names addObject:name];
+        [_revisions addObject:revision ?: [NSNull null]];
+        [_records appendBytes:&record length:sizeof(record)];
+        _recordIndexes[key] = @(index);
+
+        for (NSString *gram in CLDSearchIndexGrams(name)) {
+            NSMutableData *posting = _postings[gram];
+            if (posting == nil) {
+                posting = [NSMutableData new];
+                _postings[gram] = posting;
+            }
+            [posting appendBytes:&index length:sizeof(index)];
+        }
+
+        NSString *parentKey = CLDSearchIndexParentKey(key);
+        NSMutableSet *siblings = _children[parentKey];
+        if (siblings == nil) {
+            siblings = [NSMutableSet new];
+            _children[parentKey] = siblings;
+        }
+        [siblings addObject:key];
+    }
+
+    if (listed) {
+        [_listedFolders addObject:key];
+        [_unlistedFolders removeObject:key];
+    } else if ((record.flags & CLDSearchIndexRecordFlagFolder) && ![_listedFolders containsObject:key]) {
+        [_unlistedFolders addObject:key];
+    } else if (!(record.flags & CLDSearchIndexRecordFlagFolder)) {
+        [_listedFolders removeObject:key];
+        [_unlistedFolders removeObject:key];
+    }
+}
+
+- (void)_removeRecordWithKey:(NSString *)key {
+    [_keysRemovedBeforeLoad addObject:key];
+    for (NSString *childKey in [_children[key] copy]) {
+        [self _removeRecordWithKey:childKey];
+    }
+    [_children removeObjectForKey:key];
+    [_listedFolders removeObject:key];
+    [_unlistedFolders removeObject:key];
+
+    NSNumber *recordIndex = _recordIndexes[key];
+    if (recordIndex == nil) return;
+
+    // postings are left alone, removed records are skipped by queries and dropped by the next rebuild
+    NSUInteger index = recordIndex.unsignedIntegerValue;
+    [self _recordBytes][index].flags |= CLDSearchIndexRecordFlagRemoved;
+    _paths[index] = [NSNull null];
+    _names[index] = [NSNull null];
+    _revisions[index] = [NSNull null];
+    _numberOfRemovedRecords++;
+    [_recordIndexes removeObjectForKey:key];
+    [_children[CLDSearchIndexParentKey(key)] removeObject:key];
+}
+
+- (void)_enumerateSubtreeWithKey:(NSString *)key block:(void(^)(NSString *key))block {
+    block(key);
+    for (NSString *childKey in [_children[key] copy]) {
+        [self _enumerateSubtreeWithKey:childKey block:block];
+    }
+}
+
+- (BOOL)_isFolderIndexedWithKey:(NSString *)key {
+    if (![_listedFolders containsObject:key]) return NO;
+    // every folder below a listed one is known, so it's enough to look for one that was not listed
+    NSString *prefix = [key hasSuffix:@"/"] ? key : [key stringByAppendingString:@"/"];
+    for (NSString *unlistedKey in _unlistedFolders) {
+        if ([unlistedKey hasPrefix:prefix]) return NO;
+    }
+    return YES;
+}
+
+- (void)_didChange {
+    self.numberOfItems = _recordIndexes.count;
+    if (_numberOfRemovedRecords > CLDSearchIndexMinimumRemovedRecordsForRebuild && _numberOfRemovedRecords > _paths.count / 2) {
+        [self _rebuild];
+    }
+    [self _scheduleSave];
+}
+
+// drops removed records and their postings
+- (void)_rebuild {
+    NSDictionary *state = [self _state];
+    [self _resetWithStrings:state[@"strings"]];
+    [self _restoreState:state];
+}
+
+#pragma mark - Queries
+
+- (NSArray *)_recordIndexesInFolderWithKey:(NSString *)folderKey matchingQuery:(NSString *)foldedQuery match:(CLDSearchIndexMatch)match mimeType:(NSString *)mimeType limit:(NSUInteger)limit {
+    uint32_t mimeTypeIndex = CLDSearchIndexNoString;
+    if (mimeType) {
+        NSNumber *index = _stringIndexes[mimeType];
+        if (index == nil) return @[];
+        mimeTypeIndex = index.unsignedIntValue;
+    }
+
+    // the shortest posting among the query's grams holds every candidate
+    NSMutableArray *grams = [NSMutableArray new];
+    if (match == CLDSearchIndexMatchPrefix) [grams addObject:CLDSearchIndexAnchoredGram(foldedQuery)];
+    for (NSUInteger location = 0; location + 3 <= foldedQuery.length; location++) {
+        [grams addObject:[foldedQuery substringWithRange:NSMakeRange(location, 3)]];
+    }
+    NSData *candidates = nil;
+    for (NSString *gram in grams) {
+        NSData *posting = _postings[gram];
+        if (posting == nil) return @[];
+        if (candidates == nil || posting.length < candidates.length) candidates = posting;
+    }
+
+    // short substring queries have no gram to look up, go through every name instead
+    NSUInteger numberOfCandidates = candidates ? candidates.length / sizeof(uint32_t) : _paths.count;
+    const uint32_t *candidateIndexes = candidates.bytes;
+    const CLDSearchIndexRecord *records = [self _recordBytes];
+    NSString *folderPrefix = [folderKey hasSuffix:@"/"] ? folderKey : [folderKey stringByAppendingString:@"/"];
+    BOOL scoped = ![folderKey isEqualToString:@"/"];
+
+    NSMutableArray *recordIndexes = [NSMutableArray new];
+    for (NSUInteger candidate = 0; candidate < numberOfCandidates; candidate++) {
+        NSUInteger index = candidateIndexes ? candidateIndexes[candidate] : candidate;
+        const CLDSearchIndexRecord *record = &records[index];
+        if (record->flags & CLDSearchIndexRecordFlagRemoved) continue;
+        if (mimeType && record->mimeType != mimeTypeIndex) continue;
+
+        NSString *name = _names[index];
+        if (match == CLDSearchIndexMatchPrefix) {
+            if (![name hasPrefix:foldedQuery]) continue;
+        } else if ([name rangeOfString:foldedQuery].location == NSNotFound) {
+            continue;
+        }
+
+        if (scoped) {
+            NSString *path = _paths[index];
+            NSRange range = [path rangeOfString:folderPrefix options:NSCaseInsensitiveSearch|NSAnchoredSearch];
+            if (range.location == NSNotFound) continue;
+        }
+
+        [recordIndexes addObject:@(index)];
+        if (limit > 0 && recordIndexes.count == limit) break;
+    }
+    return recordIndexes;
+}
+
+- (NSArray *)_itemsInFolderWithKey:(NSString *)folderKey matchingQuery:(NSString *)foldedQuery match:(CLDSearchIndexMatch)match mimeType:(NSString *)mimeType limit:(NSUInteger)limit session:(CLDSession *)session {
+    NSArray *recordIndexes = [self _recordIndexesInFolderWithKey:folderKey matchingQuery:foldedQuery match:match mimeType:mimeType limit:limit];
+    NSMutableArray *items = [NSMutableArray arrayWithCapacity:recordIndexes.count];
+    for (NSNumber *recordIndex in recordIndexes) {
+        [items addObject:[self _itemAtIndex:recordIndex.unsignedIntegerValue session:session]];
+    }
+    return items;
+}
+
+- (CLDItem *)_itemAtIndex:(NSUInteger)index session:(CLDSession *)session {
+    const CLDSearchIndexRecord *record = &[self _recordBytes][index];
+    id revision = _revisions[index];
+    return [CLDItem itemWithPath:_paths[index]
+                        revision:(revision == [NSNull null] ? nil : revision)
+                            type:(record->flags & CLDSearchIndexRecordFlagFolder) ? CLDItemTypeFolder : CLDItemTypeFile
+                            size:record->size
+                    lastModified:isnan(record->lastModified) ? nil : [NSDate dateWithTimeIntervalSinceReferenceDate:record->lastModified]
+                        mimeType:[self _stringAtIndex:record->mimeType]
+                        iconName:[self _stringAtIndex:record->iconName]
+                    hasThumbnail:(record->flags & CLDSearchIndexRecordFlagHasThumbnail) != 0
+                         session:session];
+}
+
+#pragma mark - State
+
++ (NSURL *)_stateArchiveURLForSessionIdentifier:(NSString *)sessionIdentifier {
+    NSURL *caches = [CLDUtil cachesDirectory];
+    NSString *fileName = [NSString stringWithFormat:@"pt.meo.cloud.sdk.%@.searchindex", sessionIdentifier];
+    return [caches URLByAppendingPathComponent:fileName];
+}
+
+// live records only, postings and names are rebuilt when restored
+- (NSDictionary *)_state {
+    NSMutableArray *paths = [NSMutableArray arrayWithCapacity:_recordIndexes.count];
+    NSMutableArray *revisions = [NSMutableArray arrayWithCapacity:_recordIndexes.count];
+    NSMutableData *records = [NSMutableData dataWithCapacity:_recordIndexes.count * sizeof(CLDSearchIndexRecord)];
+    const CLDSearchIndexRecord *recordBytes = [self _recordBytes];
+    for (NSUInteger index = 0; index < _paths.count; index++) {
+        if (recordBytes[index].flags & CLDSearchIndexRecordFlagRemoved) continue;
+        [paths addObject:_paths[index]];
+        [revisions addObject:_revisions[index]];
+        [records appendBytes:&recordBytes[index] length:sizeof(CLDSearchIndexRecord)];
+    }
+    return @{@"paths": paths,
+             @"revisions": revisions,
+             @"records": records,
+             @"strings": [_strings copy],
+             @"listedFolders": _listedFolders.allObjects};
+}
+
+- (void)_restoreState:(NSDictionary *)state {
+    NSArray *paths = state[@"paths"];
+    NSArray *revisions = state[@"revisions"];
+    NSData *records = state[@"records"];
+    if (revisions.count != paths.count || records.length != paths.count * sizeof(CLDSearchIndexRecord)) return;
+
+    const CLDSearchIndexRecord *recordBytes = records.bytes;
+    [paths enumerateObjectsUsingBlock:^(NSString *path, NSUInteger index, BOOL *stop) {
+        id revision = revisions[index];
+        [self _addRecord:recordBytes[index] path:path revision:(revision == [NSNull null] ? nil : revision) listed:NO];
+    }];
+    for (NSString *key in state[@"listedFolders"]) {
+        [_listedFolders addObject:key];
+        [_unlistedFolders removeObject:key];
+    }
+    self.numberOfItems = _recordIndexes.count;
+}
+
+// unarchived on _archiveQueue, queries keep being answered from whatever is indexed meanwhile
+- (void)_loadState {
+    NSString *filePath = [[self class] _stateArchiveURLForSessionIdentifier:_sessionIdentifier].path;
+    NSUInteger generation = _generation;
+    dispatch_async(_archiveQueue, ^{
+        NSDictionary *state = nil;
+        uint64_t traceStart = CLDTraceBegin();
+        @try {
+            state = [NSKeyedUnarchiver unarchiveObjectWithFile:filePath];
+        }
+        @catch (NSException *exception) {
+            CLDLog(@"Could not load search index. Error: %@", exception.description);
+        }
+        CLDTraceEnd(CLDTraceSpanArchiveLoad, traceStart);
+        dispatch_async(_queue, ^{
+            if (generation != _generation) return;
+            if ([state isKindOfClass:[NSDictionary class]]) [self _mergeLoadedState:state];
+            _keysRemovedBeforeLoad = nil;
+            _foldersListedBeforeLoad = nil;
+        });
+    });
+}
+
+// must be called on _queue
+- (void)_mergeLoadedState:(NSDictionary *)state {
+    // anything indexed before the archive was loaded is newer, so it goes in last
+    NSDictionary *newerState = _recordIndexes.count > 0 || _listedFolders.count > 0 ? [self _state] : nil;
+    NSMutableDictionary *listedChildren = [NSMutableDictionary new];    // folder key -> keys of what it holds now
+    for (NSString *key in _foldersListedBeforeLoad) {
+        listedChildren[key] = [_children[key] copy] ?: [NSSet set];
+    }
+    NSSet *removedKeys = _keysRemovedBeforeLoad;
+    _keysRemovedBeforeLoad = nil;
+    _foldersListedBeforeLoad = nil;
+    [self _resetWithStrings:state[@"strings"]];
+    [self _restoreState:state];
+
+    // removals made meanwhile are newer too and the archive must not undo them, whether items were removed one by one
+    // or left out of a complete listing; anything indexed again after them goes in below
+    for (NSString *key in removedKeys) {
+        [self _removeRecordWithKey:key];
+    }
+    [listedChildren enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSSet *childKeys, BOOL *stop) {
+        for (NSString *childKey in [_children[key] copy]) {
+            if (![childKeys containsObject:childKey]) [self _removeRecordWithKey:childKey];
+        }
+    }];
+
+    if (newerState) {
+        NSArray *strings = newerState[@"strings"];
+        NSMutableData *records = [newerState[@"records"] mutableCopy];
+        CLDSearchIndexRecord *recordBytes = records.mutableBytes;
+        for (NSUInteger index = 0; index < records.length / sizeof(CLDSearchIndexRecord); index++) {
+            recordBytes[index].mimeType = [self _indexOfString:[self _stringAtIndex:recordBytes[index].mimeType inStrings:strings]];
+            recordBytes[index].iconName = [self _indexOfString:[self _stringAtIndex:recordBytes[index].iconName inStrings:strings]];
+        }
+        NSMutableDictionary *mergedState = [newerState mutableCopy];
+        mergedState[@"records"] = records;
+        [self _restoreState:mergedState];
+    }
+    CLDLog(@"Loaded search index with %lu items", (unsigned long)_recordIndexes.count);
+    // the archive does not have the changes made while it was loading yet
+    if (newerState || removedKeys.count > 0 || listedChildren.count > 0) [self _didChange];
+}
+
+- (NSString *)_stringAtIndex:(uint32_t)index inStrings:(NSArray *)strings {
+    return index == CLDSearchIndexNoString ? nil : strings[index];
+}
+
+- (void)_scheduleSave {
+    if (_saveScheduled) return;
+    _saveScheduled = YES;
+    // changes come in bursts, e.g. while crawling, so they're written once things settle down
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(CLDSearchIndexSaveDelay * NSEC_PER_SEC)), _queue, ^{
+        _saveScheduled = NO;
+        [self _saveState];
+    });
+}
+
+// the state is taken on _queue and archived on _archiveQueue
+- (void)_saveState {
+    NSString *filePath = [[self class] _stateArchiveURLForSessionIdentifier:_sessionIdentifier].path;
+    NSDictionary *state = (_recordIndexes.count > 0 || _listedFolders.count > 0) ? [self _state] : nil;
+    dispatch_async(_archiveQueue, ^{
+        if (state) {
+            uint64_t traceStart = CLDTraceBegin();
+            [NSKeyedArchiver archiveRootObject:state toFile:filePath];
+            CLDTraceEnd(CLDTraceSpanArchiveSave, traceStart);
+        } else {
+            [[NSFileManager defaultManager] removeItemAtPath:filePath error:nil];
+        }
+    });
+}
+
+@end
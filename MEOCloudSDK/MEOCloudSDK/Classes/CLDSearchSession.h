@@ -0,0 +1,97 @@
+//
+//  CLDSearchSession.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+@class CLDItem;
+
+/**
+ Default value for <[CLDSearchSession debounceInterval]>.
+ @since 1.1
+ */
+FOUNDATION_EXPORT const NSTimeInterval CLDSearchSessionDefaultDebounceInterval;
+
+/**
+ Default value for <[CLDSearchSession limit]>.
+ @since 1.1
+ */
+FOUNDATION_EXPORT const NSUInteger CLDSearchSessionDefaultLimit;
+
+/**
+ This class searches a folder as the user types, e.g. from a search field.
+
+ Queries are only sent once typing pauses for <debounceInterval>. A new query cancels the one in flight, and results of superseded
+ queries are never delivered, so they can't arrive out of order. When a query only narrows an earlier one whose results were complete,
+ e.g. "report" after "repo", those results are filtered locally instead of asking the server again. Recent results are shared by all
+ search sessions of a <CLDSession>, by folder, query, mime-type and whether deleted items are included.
+
+ Queries shorter than 3 characters, which the server does not accept, are answered by the <[CLDSession searchIndex]>.
+
+ Search sessions are created by <[CLDSession searchSessionForItem:mimeType:includeDeletedItems:resultBlock:failureBlock:]>.
+ @since 1.1
+ */
+@interface CLDSearchSession : NSObject
+
+/**
+ The identifier of the session this search belongs to.
+ @since 1.1
+ */
+@property (readonly, strong, nonatomic) NSString *sessionIdentifier;
+
+/**
+ The folder being searched.
+ @since 1.1
+ */
+@property (readonly, strong, nonatomic) CLDItem *item;
+
+/**
+ The mime-type of the items to be returned, or `nil` for any.
+ @since 1.1
+ */
+@property (readonly, strong, nonatomic) NSString *mimeType;
+
+/**
+ `BOOL` stating whether deleted items are included in the results.
+ @since 1.1
+ */
+@property (readonly, nonatomic) BOOL includeDeletedItems;
+
+/**
+ How long typing must pause before a query is performed.
+ Default value is `CLDSearchSessionDefaultDebounceInterval`.
+ @since 1.1
+ */
+@property (readwrite, atomic) NSTimeInterval debounceInterval;
+
+/**
+ The maximum number of items returned for each query. Must be between 1 and 25000.
+ Default value is `CLDSearchSessionDefaultLimit`.
+ @since 1.1
+ */
+@property (readwrite, atomic) NSUInteger limit;
+
+/**
+ The latest query given to <searchQuery:>.
+ @since 1.1
+ */
+@property (readonly, atomic) NSString *query;
+
+/**
+ Searches for a query once typing pauses, superseding any earlier query.
+
+ Empty queries cancel the search without calling any block.
+ @param query The query, usually the contents of a search field.
+ @since 1.1
+ */
+- (void)searchQuery:(NSString *)query;
+
+/**
+ Cancels the pending query, if any. Blocks are not called for it.
+ @since 1.1
+ */
+- (void)cancel;
+
+@end
@@ -0,0 +1,239 @@
+//
+//  CLDSearchSession.m
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import "CLDSearchSession.h"
+
+#define CLDSearchSessionResultLifetime 60
+#define CLDSearchSessionMinimumServerQueryLength 3
+#define CLDSearchSessionMaximumServerQueryLength 20
+
+const NSTimeInterval CLDSearchSessionDefaultDebounceInterval = 0.3;
+const NSUInteger CLDSearchSessionDefaultLimit = 1000;
+
+// results of one server query, shared through the result cache
+@interface CLDSearchSessionResult : NSObject
+@property (readwrite, strong, nonatomic) NSArray *items;
+@property (readwrite, nonatomic, getter = isComplete) BOOL complete;  // fewer items than the limit, so every match is there
+@property (readwrite, strong, nonatomic) NSDate *date;
+@end
+
+@implementation CLDSearchSessionResult
+@end
+
+
+
+
+@interface CLDSearchSession ()
+@property (readwrite, strong, nonatomic) NSString *sessionIdentifier;
+@property (readwrite, strong, nonatomic) CLDItem *item;
+@property (readwrite, strong, nonatomic) NSString *mimeType;
+@property (readwrite, nonatomic) BOOL includeDeletedItems;
+@property (readwrite, atomic) NSString *query;
+
+@property (readwrite, weak, nonatomic) CLDSession *session;
+@property (readwrite, copy, nonatomic) CLDSearchSessionResultBlock resultBlock;
+@property (readwrite, copy, nonatomic) CLDSearchSessionFailureBlock failureBlock;
+@property (readwrite, strong, nonatomic) dispatch_queue_t callbackQueue;
+@end
+
+@implementation CLDSearchSession {
+    dispatch_queue_t _queue;
+    NSCache *_resultCache;
+    NSUInteger _generation;         // bumped by every query, blocks of older queries are ignored
+    CLDRequest *_activeRequest;
+    NSTimeInterval _debounceInterval;
+    NSUInteger _limit;
+}
+
+#pragma mark - Initialization
+
+- (instancetype)initWithSession:(CLDSession *)session
+                           item:(CLDItem *)item
+                       mimeType:(NSString *)mimeType
+            includeDeletedItems:(BOOL)includeDeletedItems
+                    resultCache:(NSCache *)resultCache {
+    NSParameterAssert(session);
+    NSParameterAssert(item.type == CLDItemTypeFolder);
+    NSParameterAssert(resultCache);
+    self = [super init];
+    if (self) {
+        _session = session;
+        _sessionIdentifier = session.sessionIdentifier;
+        _item = item;
+        _mimeType = mimeType;
+        _includeDeletedItems = includeDeletedItems;
+        _resultCache = resultCache;
+        _debounceInterval = CLDSearchSessionDefaultDebounceInterval;
+        _limit = CLDSearchSessionDefaultLimit;
+        _queue = dispatch_queue_create("pt.meo.cloud.sdk.searchsession", DISPATCH_QUEUE_SERIAL);
+        _callbackQueue = dispatch_get_main_queue();
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [_activeRequest cancel];
+}
+
+#pragma mark - Dynamic properties
+
+- (NSTimeInterval)debounceInterval {
+    @synchronized(self) {
+        return _debounceInterval;
+    }
+}
+
+- (void)setDebounceInterval:(NSTimeInterval)debounceInterval {
+    @synchronized(self) {
+        _debounceInterval = MAX(debounceInterval, 0);
+    }
+}
+
+- (NSUInteger)limit {
+    @synchronized(self) {
+        return _limit;
+    }
+}
+
+- (void)setLimit:(NSUInteger)limit {
+    NSParameterAssert(limit >= 1);
+    NSParameterAssert(limit <= 25000);
+    @synchronized(self) {
+        _limit = limit;
+    }
+}
+
+#pragma mark - Public methods
+
+- (void)searchQuery:(NSString *)query {
+    query = [query copy];
+    self.query = query;
+    NSTimeInterval debounceInterval = self.debounceInterval;
+    dispatch_async(_queue, ^{
+        NSUInteger generation = [self _supersede];
+        if (query.length == 0) return;
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(debounceInterval * NSEC_PER_SEC)), _queue, ^{
+            if (generation != _generation) return;
+            [self _performQuery:query generation:generation];
+        });
+    });
+}
+
+- (void)cancel {
+    dispatch_async(_queue, ^{
+        [self _supersede];
+    });
+}
+
+#pragma mark - Private methods
+
+// all methods below must be called on _queue
+
+- (NSUInteger)_supersede {
+    [_activeRequest cancel];
+    _activeRequest = nil;
+    return ++_generation;
+}
+
+- (void)_performQuery:(NSString *)query generation:(NSUInteger)generation {
+    CLDSession *session = self.session;
+    if (session == nil) return;
+    NSUInteger limit = self.limit;
+
+    NSArray *cachedItems = [self _cachedItemsForQuery:query limit:limit];
+    if (cachedItems) {
+        [self _deliverItems:cachedItems query:query];
+        return;
+    }
+
+    // the server won't take it, so the index is all we have
+    if (query.length < CLDSearchSessionMinimumServerQueryLength || query.length > CLDSearchSessionMaximumServerQueryLength) {
+        NSArray *items = [session.searchIndex itemsInFolder:self.item matchingQuery:query match:CLDSearchIndexMatchSubstring mimeType:self.mimeType limit:limit];
+        [self _deliverItems:items ?: @[] query:query];
+        return;
+    }
+
+    // results come back on _queue, where superseded ones are dropped
+    __block CLDRequest *request = nil;
+    [session performWithCallbackQueue:_queue block:^{
+        request = [session searchItem:self.item query:query limit:limit mimeType:self.mimeType includeDeletedItems:self.includeDeletedItems resultBlock:^(NSArray *items) {
+            [self _cacheItems:items query:query complete:(items.count < limit)];
+            if (generation != _generation) return;
+            _activeRequest = nil;
+            [self _deliverItems:items query:query];
+        } failureBlock:^(NSError *error) {
+            if (generation != _generation) return;
+            _activeRequest = nil;
+            CLDSearchSessionFailureBlock failureBlock = self.failureBlock;
+            RunBlockOnQueue(self.callbackQueue, failureBlock, query, error);
+        }];
+    }];
+    _activeRequest = request;
+}
+
+- (void)_deliverItems:(NSArray *)items query:(NSString *)query {
+    CLDSearchSessionResultBlock resultBlock = self.resultBlock;
+    RunBlockOnQueue(self.callbackQueue, resultBlock, query, items);
+}
+
+#pragma mark - Result cache
+
+// queries are folded like the server and the search index do, "cafe" and "café" find the same items
+- (NSString *)_cacheKeyForQuery:(NSString *)query {
+    NSString *foldedQuery = [query stringByFoldingWithOptions:NSCaseInsensitiveSearch|NSDiacriticInsensitiveSearch locale:nil];
+    return [NSString stringWithFormat:@"%@\n%@\n%@\n%d", self.item.path.lowercaseString, foldedQuery, self.mimeType ?: @"", self.includeDeletedItems];
+}
+
+- (CLDSearchSessionResult *)_cachedResultForQuery:(NSString *)query {
+    NSString *key = [self _cacheKeyForQuery:query];
+    CLDSearchSessionResult *result = [_resultCache objectForKey:key];
+    if (result && -result.date.timeIntervalSinceNow > CLDSearchSessionResultLifetime) {
+        [_resultCache removeObjectForKey:key];
+        return nil;
+    }
+    return result;
+}
+
+- (void)_cacheItems:(NSArray *)items query:(NSString *)query complete:(BOOL)complete {
+    CLDSearchSessionResult *result = [CLDSearchSessionResult new];
+    result.items = items;
+    result.complete = complete;
+    result.date = [NSDate date];
+    [_resultCache setObject:result forKey:[self _cacheKeyForQuery:query]];
+}
+
+- (NSArray *)_cachedItemsForQuery:(NSString *)query limit:(NSUInteger)limit {
+    CLDSearchSessionResult *result = [self _cachedResultForQuery:query];
+    if (result && (result.isComplete || result.items.count >= limit)) {
+        return [self _items:result.items truncatedToLimit:limit];
+    }
+
+    // every match of a query is also a match of any part of it, so a complete result of a shorter query
+    // can be narrowed down locally, e.g. "report" from "repo"; longer parts match fewer items, try them first.
+    // Names are matched ignoring case and diacritics, as the server does, or refining would lose e.g. "Café" for "cafe"
+    for (NSUInteger length = query.length - 1; length >= CLDSearchSessionMinimumServerQueryLength; length--) {
+        for (NSUInteger location = 0; location + length <= query.length; location++) {
+            result = [self _cachedResultForQuery:[query substringWithRange:NSMakeRange(location, length)]];
+            if (!result.isComplete) continue;
+
+            NSMutableArray *items = [NSMutableArray new];
+            for (CLDItem *item in result.items) {
+                if ([item.name rangeOfString:query options:NSCaseInsensitiveSearch|NSDiacriticInsensitiveSearch].location != NSNotFound) [items addObject:item];
+            }
+            [self _cacheItems:items query:query complete:YES];
+            return [self _items:items truncatedToLimit:limit];
+        }
+    }
+    return nil;
+}
+
+- (NSArray *)_items:(NSArray *)items truncatedToLimit:(NSUInteger)limit {
+    return items.count > limit ? [items subarrayWithRange:NSMakeRange(0, limit)] : items;
+}
+
+@end
@@ -7,11 +7,25 @@
 //
 
 #import <MEOCloudSDK/CLDAccountUser.h>
+#import <MEOCloudSDK/CLDBatchOperation.h>
+#import <MEOCloudSDK/CLDDownloadStream.h>
+#import <MEOCloudSDK/CLDEndpointMetrics.h>
 #import <MEOCloudSDK/CLDItem.h>
+#import <MEOCloudSDK/CLDLatencyHistogram.h>
 #import <MEOCloudSDK/CLDLink.h>
+#import <MEOCloudSDK/CLDRemoteFile.h>
+#import <MEOCloudSDK/CLDRequest.h>
+#import <MEOCloudSDK/CLDRequestLaneStatistics.h>
+#import <MEOCloudSDK/CLDSearchIndex.h>
+#import <MEOCloudSDK/CLDSearchSession.h>
 #import <MEOCloudSDK/CLDSessionConfiguration.h>
+#import <MEOCloudSDK/CLDSessionMetrics.h>
+#import <MEOCloudSDK/CLDThumbnailCache.h>
 #import <MEOCloudSDK/CLDTransferManager.h>
 #import <MEOCloudSDK/CLDTransfer.h>
+#import <MEOCloudSDK/CLDTreeCrawler.h>
+
+@class CLDThumbnailPrefetcher;
 
 #ifndef CLDImage
 
@@ -23,6 +37,35 @@
 
 #endif
 
+/**
+ Posted when delta polling finds new items. `userInfo` contains an `NSArray` of <CLDItem> instances for the `kCLDSessionItemsKey` key.
+ @see -startPollingForDeltaUpdatesWithResultBlock:failureBlock:
+ @since 1.1
+ */
+FOUNDATION_EXPORT NSString* const kCLDSessionItemsCreatedNotification;
+/**
+ Posted when delta polling finds items that changed. `userInfo` contains an `NSArray` of <CLDItem> instances for the `kCLDSessionItemsKey` key.
+ @see -startPollingForDeltaUpdatesWithResultBlock:failureBlock:
+ @since 1.1
+ */
+FOUNDATION_EXPORT NSString* const kCLDSessionItemsModifiedNotification;
+/**
+ Posted when delta polling finds items that were removed. `userInfo` contains an `NSArray` of hollow <CLDItem> instances for the `kCLDSessionItemsKey` key.
+ Removing a folder removes everything inside it, so only the folder is included.
+ @see -startPollingForDeltaUpdatesWithResultBlock:failureBlock:
+ @since 1.1
+ */
+FOUNDATION_EXPORT NSString* const kCLDSessionItemsDeletedNotification;
+/**
+ Posted when a mutation queued while offline failed once replayed and no failure block was waiting for it, e.g. because it was queued before the app was relaunched.
+ `userInfo` contains an `NSArray` with the hollow <CLDItem> the mutation applied to for the `kCLDSessionItemsKey` key and the `NSError` for the `kCLDSessionErrorKey` key.
+ @see queuesMutationsWhileOffline
+ @since 1.1
+ */
+FOUNDATION_EXPORT NSString* const kCLDSessionQueuedMutationFailedNotification;
+FOUNDATION_EXPORT NSString* const kCLDSessionItemsKey;
+FOUNDATION_EXPORT NSString* const kCLDSessionErrorKey;
+
 /**
  Image format for item thumbnails.
  @since 1.0
@@ -124,6 +167,23 @@ typedef NS_OPTIONS(NSInteger, CLDSessionFetchItemOptions) {
     CLDSessionFetchItemOptionIncludeDeletedItems = 1 << 1
 };
 
+/**
+ Options for batch operations.
+ @since 1.1
+ */
+typedef NS_OPTIONS(NSInteger, CLDSessionBatchOptions) {
+    /**
+     No options
+     @since 1.1
+     */
+    CLDSessionBatchOptionNone = 0,
+    /**
+     Stop starting requests at the first failure. Requests already in flight are still waited for.
+     @since 1.1
+     */
+    CLDSessionBatchOptionStopOnFailure = 1 << 0
+};
+
 /**
  Possible network states.
  @since 1.0
@@ -279,9 +339,10 @@ typedef BOOL(^CLDSessionValidateCallbackURLBlock)(NSURL *url);
  
  @param resultBlock  The block to be executed once the information is fetched. This block takes an <CLDAccountUser> argument containing the account information.
  @param failureBlock The block to be executed if account information could not be fetched. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the request.
  @since 1.0
  */
-- (void)fetchAccountInformationWithResultBlock:(void(^)(CLDAccountUser *user))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+- (CLDRequest *)fetchAccountInformationWithResultBlock:(void(^)(CLDAccountUser *user))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -291,6 +352,148 @@ typedef BOOL(^CLDSessionValidateCallbackURLBlock)(NSURL *url);
 @property (readonly, atomic) CLDSessionNetworkState networkState;
 
 
+/**
+ Opens connections to the API and content servers ahead of time, so that the first requests and transfers
+ do not pay for the TCP and TLS handshakes.
+ 
+ Call this method when requests are expected soon, e.g. when the app becomes active or a transfer screen appears.
+ Idle connections are closed by the system after a while, so there is no point in calling it long before they are needed.
+ @since 1.1
+ */
+- (void)warmUpConnections;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @name Callback queues
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ The queue on which result and failure blocks are executed.
+ 
+ Use a background or concurrent queue to process results without going through the main thread, e.g. in command line tools or batch jobs.
+ Setting this property to `nil` restores the default value, which is the main queue.
+ @note Notifications are always posted on the main thread.
+ @since 1.1
+ */
+@property (readwrite, strong, atomic) dispatch_queue_t callbackQueue;
+
+/**
+ Executes a block synchronously, and every request started from it executes its result and failure blocks on `callbackQueue` instead of the session's <callbackQueue>.
+ 
+ Only requests started on the calling thread while `block` is running are affected.
+ 
+ @param callbackQueue The queue for the result and failure blocks of the requests started in `block`, or `nil` to use the session's <callbackQueue>.
+ @param block         The block that starts the requests.
+ @since 1.1
+ */
+- (void)performWithCallbackQueue:(dispatch_queue_t)callbackQueue block:(void(^)())block;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @name Request lanes
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ Executes a block synchronously, and every request started from it is scheduled in `lane` instead of `CLDRequestLaneDefault`.
+ 
+ Requests are admitted in lane order, within the limit of their lane. One connection is always kept for interactive requests,
+ so these never wait for background ones. Only requests started on the calling thread while `block` is running are affected.
+ Folder crawling and delta polling use `CLDRequestLaneBackground` and thumbnail prefetching uses `CLDRequestLanePrefetch`.
+ @note Transfers are performed by the <transferManager> and are not scheduled in lanes.
+ 
+ @param lane  The lane for the requests started in `block`.
+ @param block The block that starts the requests.
+ @since 1.1
+ */
+- (void)performInRequestLane:(CLDRequestLane)lane block:(void(^)())block;
+
+/**
+ Returns the maximum number of requests of a lane in progress at the same time.
+ @param lane The lane.
+ @return The maximum number of concurrent requests.
+ @since 1.1
+ */
+- (NSUInteger)maximumConcurrentRequestsForLane:(CLDRequestLane)lane;
+
+/**
+ Sets the maximum number of requests of a lane in progress at the same time.
+ The default values are 6 for interactive requests, 4 for default requests and 2 for background and prefetch requests,
+ and no more than <concurrencyLimit> requests are in progress at the same time regardless of their lane.
+ @param maximumConcurrentRequests The maximum number of concurrent requests. Values lower than `1` are treated as `1`.
+ @param lane                      The lane.
+ @since 1.1
+ */
+- (void)setMaximumConcurrentRequests:(NSUInteger)maximumConcurrentRequests forLane:(CLDRequestLane)lane;
+
+/**
+ The number of requests currently allowed in progress at the same time, regardless of their lane.
+ 
+ This limit adapts to the server: it starts at 6 and grows by one request per round trip while response times stay flat,
+ up to 24, and shrinks by 30% on timeouts, `429` and `5xx` responses or rising response times. Transfers are not limited by it,
+ but their timeouts and `5xx` responses do shrink it.
+ @since 1.1
+ */
+@property (readonly, atomic) NSUInteger concurrencyLimit;
+
+/**
+ Returns the queue depth and wait times of a lane.
+ @param lane The lane.
+ @return A <CLDRequestLaneStatistics> snapshot.
+ @since 1.1
+ */
+- (CLDRequestLaneStatistics *)statisticsForRequestLane:(CLDRequestLane)lane;
+
+/**
+ Resets the number of started requests and the wait times of every lane.
+ @since 1.1
+ */
+- (void)resetRequestStatistics;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @name Metrics
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ Returns the request counts, status codes, latencies and bytes transferred of every endpoint, for API requests and transfers,
+ along with the number of access token refreshes. Recording is always on and cheap, and so is taking a snapshot.
+ @return A <CLDSessionMetrics> snapshot.
+ @since 1.1
+ */
+- (CLDSessionMetrics *)metrics;
+
+/**
+ Resets every metric of the session.
+ @since 1.1
+ */
+- (void)resetMetrics;
+
+/**
+ An object that is handed a <metrics> snapshot every <metricsExportInterval> seconds, or `nil`.
+ @since 1.1
+ */
+@property (readwrite, strong, atomic) id<CLDMetricsExporter> metricsExporter;
+
+/**
+ How often metrics are handed to the <metricsExporter>, in seconds.
+ Default value is `CLDSessionMetricsDefaultExportInterval`.
+ @since 1.1
+ */
+@property (readwrite, atomic) NSTimeInterval metricsExportInterval;
+
+/**
+ Returns the most recent internal spans of the SDK, of every session, in Chrome's trace event format.
+ 
+ Spans are always recorded, in release builds too, into a buffer that keeps the last 8192 of them. They cover building and
+ signing requests, waiting for a lane, refreshing the access token, network time, JSON parsing, creating items, hopping
+ to the main thread, sending transfer chunks and saving state to disk. Save the data to a file and open it in
+ `chrome://tracing` to see where the time went.
+ @return An `NSData` with the trace, in JSON.
+ @since 1.1
+ */
++ (NSData *)traceEventData;
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @name Fetching item information
 ////////////////////////////////////////////////////////////////////////////////
@@ -309,9 +512,40 @@ typedef BOOL(^CLDSessionValidateCallbackURLBlock)(NSURL *url);
  @param options      Bitmask of options for fetching items. For a list of valid constants, see <CLDSessionFetchItemOptions>
  @param resultBlock  The block to be executed once the item information is fetched. This block takes an <CLDItem> argument containing the item.
  @param failureBlock The block to be executed if the item information could not be fetched. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the request.
  @since 1.0
  */
-- (void)fetchItem:(CLDItem *)item options:(CLDSessionFetchItemOptions)options resultBlock:(void(^)(CLDItem *item))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+- (CLDRequest *)fetchItem:(CLDItem *)item options:(CLDSessionFetchItemOptions)options resultBlock:(void(^)(CLDItem *item))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @name Crawling folders
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ Lists a folder and all of its subfolders, breadth-first, with several requests in flight at the same time.
+ 
+ When a checkpoint is given, folders whose hash did not change since that checkpoint are not listed again, nor are the subfolders the checkpoint knows below them,
+ and `folderBlock` is not called for them. Unfinished checkpoints (e.g. from a cancelled or failed crawl) resume the crawl where it stopped.
+ 
+ A folder that cannot be listed does not stop the crawl, its error is kept in <[CLDTreeCrawlerCheckpoint folderErrors]>.
+ 
+ @param item         The folder at the top of the tree.
+ @param options      Bitmask of options for fetching items. Only `CLDSessionFetchItemOptionIncludeDeletedItems` is taken into account, contents are always listed.
+ @param checkpoint   A checkpoint from a previous crawl of the same folder, or `nil` to list the whole tree.
+ @param folderBlock  The block to be executed for each listed folder. This block takes an <CLDItem> argument containing the folder with its contents.
+ @param resultBlock  The block to be executed once the whole tree was visited. This block takes a <CLDTreeCrawlerCheckpoint> argument that should be kept for the next crawl.
+ @param failureBlock The block to be executed if the crawl stopped before visiting the whole tree. This block takes an `NSError` argument containing the error and a <CLDTreeCrawlerCheckpoint> argument that can be used to resume the crawl.
+ 
+ @return An instance of <CLDTreeCrawler> that can be tracked or cancelled at any time.
+ @since 1.1
+ */
+- (CLDTreeCrawler *)crawlItem:(CLDItem *)item
+                      options:(CLDSessionFetchItemOptions)options
+                   checkpoint:(CLDTreeCrawlerCheckpoint *)checkpoint
+                  folderBlock:(void(^)(CLDItem *folder))folderBlock
+                  resultBlock:(void(^)(CLDTreeCrawlerCheckpoint *checkpoint))resultBlock
+                 failureBlock:(void(^)(NSError *error, CLDTreeCrawlerCheckpoint *checkpoint))failureBlock;
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -325,20 +559,24 @@ typedef BOOL(^CLDSessionValidateCallbackURLBlock)(NSURL *url);
  @param path         The destination path of the item. This path should contain the destination item's name.
  @param resultBlock  The block to be executed once the item is copied. This block takes an <CLDItem> argument containing the copied item.
  @param failureBlock The block to be executed if the item could not be copied. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the request.
  @since 1.0
  */
-- (void)copyItem:(CLDItem *)item toPath:(NSString *)path resultBlock:(void(^)(CLDItem *newItem))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+- (CLDRequest *)copyItem:(CLDItem *)item toPath:(NSString *)path resultBlock:(void(^)(CLDItem *newItem))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
 
 /**
  Fetches an reference code that can be given to another user to quickly copy a file or folder into their MEOCloud folder.
  To copy a file or folder using a reference use <copyItemFromReference:toPath:resultBlock:failureBlock:>.
  
+ References are cached per revision until shortly before they expire.
+ 
  @param item         The item to be copied
  @param resultBlock  The block to be executed once the reference is successfully obtained. This block takes two arguments: an `NSString` with the reference code and an `NSDate` with the code expiration date.
  @param failureBlock The block to be executed if the reference code could not be fetched. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the request.
  @since 1.0
  */
-- (void)fetchCopyReferenceForItem:(CLDItem *)item resultBlock:(void(^)(NSString *reference, NSDate *expireDate))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+- (CLDRequest *)fetchCopyReferenceForItem:(CLDItem *)item resultBlock:(void(^)(NSString *reference, NSDate *expireDate))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
 
 /**
  Fetches information about an item to be copied using a reference code.
@@ -358,9 +596,10 @@ typedef BOOL(^CLDSessionValidateCallbackURLBlock)(NSURL *url);
   - *iconName*
  
  @param failureBlock The block to be executed if the information could not be fetched. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the request.
  @since 1.0
  */
-- (void)fetchItemDetailsFromReference:(NSString *)reference resultBlock:(void(^)(NSDictionary *itemInfo))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+- (CLDRequest *)fetchItemDetailsFromReference:(NSString *)reference resultBlock:(void(^)(NSDictionary *itemInfo))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
 
 /**
  Copies an item from a reference code to a specified path.
@@ -369,9 +608,10 @@ typedef BOOL(^CLDSessionValidateCallbackURLBlock)(NSURL *url);
  @param path         The destination path for the item. This path should contain the destination item's name.
  @param resultBlock  The block to be executed once the item is copied. This block takes an <CLDItem> argument containing the copied item.
  @param failureBlock The block to be executed if the item could not be copied. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the request.
  @since 1.0
  */
-- (void)copyItemFromReference:(NSString *)reference toPath:(NSString *)path resultBlock:(void(^)(CLDItem *newItem))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+- (CLDRequest *)copyItemFromReference:(NSString *)reference toPath:(NSString *)path resultBlock:(void(^)(CLDItem *newItem))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -385,9 +625,10 @@ typedef BOOL(^CLDSessionValidateCallbackURLBlock)(NSURL *url);
  @param path         The destination path of the item. This path should contain the destination item's name.
  @param resultBlock  The block to be executed once the item is moved. This block takes an <CLDItem> argument containing the moved item.
  @param failureBlock The block to be executed if the item could not be moved. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the request.
  @since 1.0
  */
-- (void)moveItem:(CLDItem *)item toPath:(NSString *)path resultBlock:(void(^)(CLDItem *newItem))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+- (CLDRequest *)moveItem:(CLDItem *)item toPath:(NSString *)path resultBlock:(void(^)(CLDItem *newItem))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -401,9 +642,10 @@ typedef BOOL(^CLDSessionValidateCallbackURLBlock)(NSURL *url);
  @param name         The new name for the item. This should include any extension, if applicable.
  @param resultBlock  The block to be executed once the item is renamed. This block takes an <CLDItem> argument containing the renamed item.
  @param failureBlock The block to be executed if the item could not be renamed. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the request.
  @since 1.0
  */
-- (void)renameItem:(CLDItem *)item name:(NSString *)name resultBlock:(void(^)(CLDItem *renamedItem))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+- (CLDRequest *)renameItem:(CLDItem *)item name:(NSString *)name resultBlock:(void(^)(CLDItem *renamedItem))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -416,9 +658,10 @@ typedef BOOL(^CLDSessionValidateCallbackURLBlock)(NSURL *url);
  @param item         The item to be deleted.
  @param resultBlock  The block to be executed once the item is deleted. This block takes an <CLDItem> argument containing the deleted item.
  @param failureBlock The block to be executed if the item could not be deleted. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the request.
  @since 1.0
  */
-- (void)deleteItem:(CLDItem *)item resultBlock:(void(^)(CLDItem *deletedItem))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+- (CLDRequest *)deleteItem:(CLDItem *)item resultBlock:(void(^)(CLDItem *deletedItem))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
 
 /**
  Restores a previously deleted item. Use <restoreItem:resultBlock:failureBlock:> instead if you want to restore an item to a specific revision.
@@ -426,9 +669,10 @@ typedef BOOL(^CLDSessionValidateCallbackURLBlock)(NSURL *url);
  @param item         The item to be deleted.
  @param resultBlock  The block to be executed once the item is deleted. This block takes an <CLDItem> argument containing the restored item.
  @param failureBlock The block to be executed if the item could not be restored. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the request.
  @since 1.0
  */
-- (void)undeleteItem:(CLDItem *)item resultBlock:(void(^)(CLDItem *restoredItem))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+- (CLDRequest *)undeleteItem:(CLDItem *)item resultBlock:(void(^)(CLDItem *restoredItem))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -441,9 +685,54 @@ typedef BOOL(^CLDSessionValidateCallbackURLBlock)(NSURL *url);
  @param path         The path where the folder should be created. This path must contain the folder's name.
  @param resultBlock  The block to be executed once the folder is created. This block takes an <CLDItem> argument containing the newly created folder.
  @param failureBlock The block to be executed if the folder could not be created. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the request.
  @since 1.0
  */
-- (void)createFolderAtPath:(NSString *)path resultBlock:(void(^)(CLDItem *newFolder))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+- (CLDRequest *)createFolderAtPath:(NSString *)path resultBlock:(void(^)(CLDItem *newFolder))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @name Offline mutations
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ `BOOL` stating if copies, moves, renames, deletes and folder creations should be queued while offline instead of failing. Default value is `NO`.
+ 
+ Mutations are queued when the network is unreachable, when they fail before reaching the server, or when earlier mutations are still queued,
+ so that they never overtake each other. Queued mutations are archived and replayed in order once the network is reachable again,
+ even after the app is relaunched, with mutations on unrelated paths replayed two at a time.
+ 
+ Redundant mutations are merged as they are queued: a chain of moves or renames of the same item becomes a single move,
+ an item created, copied or moved offline and then moved again is created, copied or moved straight to its final path,
+ and an item created or copied offline and then deleted is never sent to the server.
+ 
+ The result or failure block of a queued mutation is executed once it is replayed, which may take a long time.
+ Merged mutations share the outcome of the one they were merged into. Mutations queued before the app was relaunched have no blocks to execute,
+ so their failures are posted as `kCLDSessionQueuedMutationFailedNotification`.
+ Cancelling a queued mutation removes it from the queue, unless other mutations were merged into it or it is already being replayed.
+ @since 1.1
+ */
+@property (readwrite, atomic) BOOL queuesMutationsWhileOffline;
+
+/**
+ The number of mutations waiting to be replayed, including the ones being replayed.
+ @since 1.1
+ */
+@property (readonly, atomic) NSUInteger numberOfQueuedMutations;
+
+/**
+ Replays the queued mutations right away. This is done automatically when the network becomes reachable,
+ so calling this method is only needed to retry sooner after the server was unavailable.
+ @since 1.1
+ */
+- (void)replayQueuedMutations;
+
+/**
+ Removes every queued mutation. Their failure blocks are executed with a `CLDErrorCancelledByUser` error.
+ Mutations already being replayed are not cancelled, but their blocks are not executed.
+ @since 1.1
+ */
+- (void)discardQueuedMutations;
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -458,9 +747,10 @@ typedef BOOL(^CLDSessionValidateCallbackURLBlock)(NSURL *url);
  @param item         The item whose revisions should be fetched.
  @param resultBlock  The block to be executed once the item revisions are fetched. This block takes an `NSArray` argument containing the array of revision items. Each item is an instance of <CLDItem> and can be used directly in <restoreItem:resultBlock:failureBlock:>.
  @param failureBlock The block to be executed if the item revisions could not be fetched. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the request.
  @since 1.0
  */
-- (void)fetchRevisionsForItem:(CLDItem *)item resultBlock:(void(^)(NSArray *items))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+- (CLDRequest *)fetchRevisionsForItem:(CLDItem *)item resultBlock:(void(^)(NSArray *items))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
 
 /**
  Fetches a list of available revisions for a specified item.
@@ -473,9 +763,10 @@ typedef BOOL(^CLDSessionValidateCallbackURLBlock)(NSURL *url);
  @param limit        Maximum number of revisions to be fetched.
  @param resultBlock  The block to be executed once the item revisions are fetched. This block takes an `NSArray` argument containing the array of revision items. Each item is an instance of <CLDItem> and can be used directly in <restoreItem:resultBlock:failureBlock:>.
  @param failureBlock The block to be executed if the item revisions could not be fetched. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the request.
  @since 1.0
  */
-- (void)fetchRevisionsForItem:(CLDItem *)item revisionLimit:(NSUInteger)limit resultBlock:(void(^)(NSArray *items))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+- (CLDRequest *)fetchRevisionsForItem:(CLDItem *)item revisionLimit:(NSUInteger)limit resultBlock:(void(^)(NSArray *items))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
 
 /**
  Restores an item to a specified revision.
@@ -485,9 +776,80 @@ typedef BOOL(^CLDSessionValidateCallbackURLBlock)(NSURL *url);
  @param item         The item to be restored
  @param resultBlock  The block to be executed once the item is restored. This block takes an <CLDItem> argument containing the restored item.
  @param failureBlock The block to be executed if the item could not be restored. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the request.
  @since 1.0
  */
-- (void)restoreItem:(CLDItem *)item resultBlock:(void(^)(CLDItem *restoredItem))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+- (CLDRequest *)restoreItem:(CLDItem *)item resultBlock:(void(^)(CLDItem *restoredItem))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @name Batch operations
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ Copies many items, with several requests in flight at the same time.
+ 
+ Batch operations go through the same requests as their single item counterparts, but results are collected off the main thread
+ and handed to `completionBlock` all at once. Requests are scheduled in the lane of the calling thread, see <performInRequestLane:block:>.
+ 
+ @param items           An `NSArray` of <CLDItem> instances to be copied.
+ @param paths           An `NSArray` with the destination path of each item, in the same order. Each path should contain the destination item's name.
+ @param options         Bitmask of options for batch operations. For a list of valid constants, see <CLDSessionBatchOptions>
+ @param progressBlock   The block to be executed as items finish. This block takes two `NSUInteger` arguments: the number of finished items and the total number of items. Calls are coalesced, so not every item is reported.
+ @param completionBlock The block to be executed once every item finished, the batch stopped at a failure or was cancelled. This block takes an `NSArray` argument containing a <CLDBatchResult> for each item, in the same order.
+ @return An instance of <CLDBatchOperation> that can be tracked or cancelled at any time.
+ @since 1.1
+ */
+- (CLDBatchOperation *)copyItems:(NSArray *)items toPaths:(NSArray *)paths options:(CLDSessionBatchOptions)options progressBlock:(void(^)(NSUInteger numberOfFinishedItems, NSUInteger numberOfItems))progressBlock completionBlock:(void(^)(NSArray *results))completionBlock;
+
+/**
+ Moves many items, with several requests in flight at the same time.
+ 
+ @param items           An `NSArray` of <CLDItem> instances to be moved.
+ @param paths           An `NSArray` with the destination path of each item, in the same order. Each path should contain the destination item's name.
+ @param options         Bitmask of options for batch operations. For a list of valid constants, see <CLDSessionBatchOptions>
+ @param progressBlock   The block to be executed as items finish. This block takes two `NSUInteger` arguments: the number of finished items and the total number of items. Calls are coalesced, so not every item is reported.
+ @param completionBlock The block to be executed once every item finished, the batch stopped at a failure or was cancelled. This block takes an `NSArray` argument containing a <CLDBatchResult> for each item, in the same order.
+ @return An instance of <CLDBatchOperation> that can be tracked or cancelled at any time.
+ @since 1.1
+ */
+- (CLDBatchOperation *)moveItems:(NSArray *)items toPaths:(NSArray *)paths options:(CLDSessionBatchOptions)options progressBlock:(void(^)(NSUInteger numberOfFinishedItems, NSUInteger numberOfItems))progressBlock completionBlock:(void(^)(NSArray *results))completionBlock;
+
+/**
+ Deletes many items, with several requests in flight at the same time.
+ 
+ @param items           An `NSArray` of <CLDItem> instances to be deleted.
+ @param options         Bitmask of options for batch operations. For a list of valid constants, see <CLDSessionBatchOptions>
+ @param progressBlock   The block to be executed as items finish. This block takes two `NSUInteger` arguments: the number of finished items and the total number of items. Calls are coalesced, so not every item is reported.
+ @param completionBlock The block to be executed once every item finished, the batch stopped at a failure or was cancelled. This block takes an `NSArray` argument containing a <CLDBatchResult> for each item, in the same order.
+ @return An instance of <CLDBatchOperation> that can be tracked or cancelled at any time.
+ @since 1.1
+ */
+- (CLDBatchOperation *)deleteItems:(NSArray *)items options:(CLDSessionBatchOptions)options progressBlock:(void(^)(NSUInteger numberOfFinishedItems, NSUInteger numberOfItems))progressBlock completionBlock:(void(^)(NSArray *results))completionBlock;
+
+/**
+ Restores many previously deleted items, with several requests in flight at the same time.
+ 
+ @param items           An `NSArray` of <CLDItem> instances to be restored.
+ @param options         Bitmask of options for batch operations. For a list of valid constants, see <CLDSessionBatchOptions>
+ @param progressBlock   The block to be executed as items finish. This block takes two `NSUInteger` arguments: the number of finished items and the total number of items. Calls are coalesced, so not every item is reported.
+ @param completionBlock The block to be executed once every item finished, the batch stopped at a failure or was cancelled. This block takes an `NSArray` argument containing a <CLDBatchResult> for each item, in the same order.
+ @return An instance of <CLDBatchOperation> that can be tracked or cancelled at any time.
+ @since 1.1
+ */
+- (CLDBatchOperation *)undeleteItems:(NSArray *)items options:(CLDSessionBatchOptions)options progressBlock:(void(^)(NSUInteger numberOfFinishedItems, NSUInteger numberOfItems))progressBlock completionBlock:(void(^)(NSArray *results))completionBlock;
+
+/**
+ Restores many items to their revisions, with several requests in flight at the same time.
+ 
+ @param items           An `NSArray` of <CLDItem> instances with the revisions to be restored, as accepted by <restoreItem:resultBlock:failureBlock:>.
+ @param options         Bitmask of options for batch operations. For a list of valid constants, see <CLDSessionBatchOptions>
+ @param progressBlock   The block to be executed as items finish. This block takes two `NSUInteger` arguments: the number of finished items and the total number of items. Calls are coalesced, so not every item is reported.
+ @param completionBlock The block to be executed once every item finished, the batch stopped at a failure or was cancelled. This block takes an `NSArray` argument containing a <CLDBatchResult> for each item, in the same order.
+ @return An instance of <CLDBatchOperation> that can be tracked or cancelled at any time.
+ @since 1.1
+ */
+- (CLDBatchOperation *)restoreItems:(NSArray *)items options:(CLDSessionBatchOptions)options progressBlock:(void(^)(NSUInteger numberOfFinishedItems, NSUInteger numberOfItems))progressBlock completionBlock:(void(^)(NSArray *results))completionBlock;
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -499,9 +861,10 @@ typedef BOOL(^CLDSessionValidateCallbackURLBlock)(NSURL *url);
  
  @param resultBlock  The block to be executed once the links are fetched. This block takes an `NSArray` argument containing the array of links. Each link is an instance of <CLDLink>.
  @param failureBlock The block to be executed if the links could not be fetched. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the request.
  @since 1.0
  */
-- (void)fetchPublicLinksWithResultBlock:(void(^)(NSArray *items))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+- (CLDRequest *)fetchPublicLinksWithResultBlock:(void(^)(NSArray *items))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
 
 /**
  Fetches a public link for a specific item. If an link was previously created on this or another device, the same link will be returned here.
@@ -509,9 +872,10 @@ typedef BOOL(^CLDSessionValidateCallbackURLBlock)(NSURL *url);
  @param item         The item whose public link should be fetched.
  @param resultBlock  The block to be executed once the link is fetched. This block takes an <CLDLink> argument containing the public link.
  @param failureBlock The block to be executed if the link could not be fetched. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the request.
  @since 1.0
  */
-- (void)fetchPublicLinkForItem:(CLDItem *)item resultBlock:(void(^)(CLDLink *link))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+- (CLDRequest *)fetchPublicLinkForItem:(CLDItem *)item resultBlock:(void(^)(CLDLink *link))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
 
 /**
  Deletes and invalidates a public link.
@@ -519,9 +883,10 @@ typedef BOOL(^CLDSessionValidateCallbackURLBlock)(NSURL *url);
  @param link         The link to be deleted.
  @param resultBlock  The block to be executed once the link is deleted.
  @param failureBlock The block to be executed if the link could not be deleted. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the request.
  @since 1.0
  */
-- (void)deletePublicLink:(CLDLink *)link resultBlock:(void(^)())resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+- (CLDRequest *)deletePublicLink:(CLDLink *)link resultBlock:(void(^)())resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -533,9 +898,10 @@ typedef BOOL(^CLDSessionValidateCallbackURLBlock)(NSURL *url);
  
  @param resultBlock  The block to be executed once the links are fetched. This block takes an `NSArray` argument containing the array of links. Each link is an instance of <CLDLink>.
  @param failureBlock The block to be executed if the links could not be fetched. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the request.
  @since 1.0
  */
-- (void)fetchUploadLinksWithResultBlock:(void(^)(NSArray *items))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+- (CLDRequest *)fetchUploadLinksWithResultBlock:(void(^)(NSArray *items))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
 
 /**
  Fetches an upload link for a specific item. If an link was previously created on this or another device, the same link will be returned here.
@@ -543,9 +909,10 @@ typedef BOOL(^CLDSessionValidateCallbackURLBlock)(NSURL *url);
  @param item         The item whose upload link should be fetched.
  @param resultBlock  The block to be executed once the link is fetched. This block takes an <CLDLink> argument containing the upload link.
  @param failureBlock The block to be executed if the link could not be fetched. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the request.
  @since 1.0
  */
-- (void)fetchUploadLinkForItem:(CLDItem *)item resultBlock:(void(^)(CLDLink *link))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+- (CLDRequest *)fetchUploadLinkForItem:(CLDItem *)item resultBlock:(void(^)(CLDLink *link))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
 
 /**
  Deletes and invalidates an upload link.
@@ -553,9 +920,10 @@ typedef BOOL(^CLDSessionValidateCallbackURLBlock)(NSURL *url);
  @param link         The link to be deleted.
  @param resultBlock  The block to be executed once the link is deleted.
  @param failureBlock The block to be executed if the link could not be deleted. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the request.
  @since 1.0
  */
-- (void)deleteUploadLink:(CLDLink *)link resultBlock:(void(^)())resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+- (CLDRequest *)deleteUploadLink:(CLDLink *)link resultBlock:(void(^)())resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -567,9 +935,10 @@ typedef BOOL(^CLDSessionValidateCallbackURLBlock)(NSURL *url);
  
  @param resultBlock  The block to be executed once the list is fetched. This block takes an `NSArray` argument containing the list of folders. Each folder is an instance of <CLDSharedFolder>.
  @param failureBlock The block to be executed if the list of folders could not be fetched. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the request.
  @since 1.0
  */
-- (void)fetchSharedItemsWithResultBlock:(void(^)(NSArray *items))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+- (CLDRequest *)fetchSharedItemsWithResultBlock:(void(^)(NSArray *items))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
 
 /**
  Sends an invitation to share a folder to a specified e-mail address.
@@ -578,9 +947,10 @@ typedef BOOL(^CLDSessionValidateCallbackURLBlock)(NSURL *url);
  @param email        The e-mail where the invite should be sent.
  @param resultBlock  The block to be executed if the invite is sent successfully. This block takes an `NSString` argument containing the request ID.
  @param failureBlock The block to be executed if the invite could not be sent. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the request.
  @since 1.0
  */
-- (void)shareItem:(CLDItem *)item withEmail:(NSString *)email resultBlock:(void(^)(NSString *inviteRequestId))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+- (CLDRequest *)shareItem:(CLDItem *)item withEmail:(NSString *)email resultBlock:(void(^)(NSString *inviteRequestId))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -598,12 +968,13 @@ typedef BOOL(^CLDSessionValidateCallbackURLBlock)(NSURL *url);
  @param query        The query string to be searched. Must be between 3 and 20 characters.
  @param resultBlock  The block to be executed once the search is performed. This block takes an `NSArray` argument containig the search results. Each item is an instance of <CLDItem>.
  @param failureBlock The block to be executed if the search could not be performed. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the request.
  @see -searchPath:query:limit:resultBlock:failureBlock:
  @see -searchPath:query:limit:mimeType:resultBlock:failureBlock:
  @see -searchPath:query:limit:mimeType:includeDeletedItems:resultBlock:failureBlock:
  @since 1.0
  */
-- (void)searchItem:(CLDItem *)item query:(NSString *)query resultBlock:(void(^)(NSArray *items))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+- (CLDRequest *)searchItem:(CLDItem *)item query:(NSString *)query resultBlock:(void(^)(NSArray *items))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
 
 /**
  Performs a search on a given path with a specified query string.
@@ -615,12 +986,13 @@ typedef BOOL(^CLDSessionValidateCallbackURLBlock)(NSURL *url);
  @param limit        The maximum number of items to be returned. Must be between 1 and 25000.
  @param resultBlock  The block to be executed once the search is performed. This block takes an `NSArray` argument containig the search results. Each item is an instance of <CLDItem>.
  @param failureBlock The block to be executed if the search could not be performed. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the request.
  @see -searchPath:query:resultBlock:failureBlock:
  @see -searchPath:query:limit:mimeType:resultBlock:failureBlock:
  @see -searchPath:query:limit:mimeType:includeDeletedItems:resultBlock:failureBlock:
  @since 1.0
  */
-- (void)searchItem:(CLDItem *)item query:(NSString *)query limit:(NSUInteger)limit resultBlock:(void(^)(NSArray *items))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+- (CLDRequest *)searchItem:(CLDItem *)item query:(NSString *)query limit:(NSUInteger)limit resultBlock:(void(^)(NSArray *items))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
 
 /**
  Performs a search on a given path with a specified query string and mime-type.
@@ -633,12 +1005,13 @@ typedef BOOL(^CLDSessionValidateCallbackURLBlock)(NSURL *url);
  @param mimeType     The mime-type that should be returned.
  @param resultBlock  The block to be executed once the search is performed. This block takes an `NSArray` argument containig the search results. Each item is an instance of <CLDItem>.
  @param failureBlock The block to be executed if the search could not be performed. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the request.
  @see -searchPath:query:resultBlock:failureBlock:
  @see -searchPath:query:limit:resultBlock:failureBlock:
  @see -searchPath:query:limit:mimeType:includeDeletedItems:resultBlock:failureBlock:
  @since 1.0
  */
-- (void)searchItem:(CLDItem *)item query:(NSString *)query limit:(NSUInteger)limit mimeType:(NSString *)mimeType resultBlock:(void(^)(NSArray *items))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+- (CLDRequest *)searchItem:(CLDItem *)item query:(NSString *)query limit:(NSUInteger)limit mimeType:(NSString *)mimeType resultBlock:(void(^)(NSArray *items))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
 
 /**
  Performs a search on a given path with a specified query string and mime-type.
@@ -652,21 +1025,79 @@ typedef BOOL(^CLDSessionValidateCallbackURLBlock)(NSURL *url);
  @param includeDeletedItems  `BOOL` stating if the search results should include previously deleted items.
  @param resultBlock          The block to be executed once the search is performed. This block takes an `NSArray` argument containig the search results. Each item is an instance of <CLDItem>.
  @param failureBlock         The block to be executed if the search could not be performed. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the request.
  @see -searchPath:query:resultBlock:failureBlock:
  @see -searchPath:query:limit:resultBlock:failureBlock:
  @see -searchPath:query:limit:mimeType:resultBlock:failureBlock:
  @since 1.0
  */
-- (void)searchItem:(CLDItem *)item query:(NSString *)query limit:(NSUInteger)limit mimeType:(NSString *)mimeType includeDeletedItems:(BOOL)includeDeletedItems resultBlock:(void(^)(NSArray *items))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+- (CLDRequest *)searchItem:(CLDItem *)item query:(NSString *)query limit:(NSUInteger)limit mimeType:(NSString *)mimeType includeDeletedItems:(BOOL)includeDeletedItems resultBlock:(void(^)(NSArray *items))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+
+/**
+ Searches a folder using the local search index, and the server only when the index cannot answer.
+ 
+ If the folder is fully indexed, see <[CLDSearchIndex isFolderIndexed:]>, the search is answered locally without network access.
+ Otherwise, substring queries of 3 to 20 characters are sent to the server and its results are indexed. Any other query, or a
+ search that fails for lack of network access, returns the items the index knows about, which may be incomplete.
+ 
+ @param item         The item where you want to perform the search. Must be of type `CLDItemTypeFolder`.
+ @param query        The query string to be searched. Must not be empty.
+ @param match        How the query is matched against item names.
+ @param limit        The maximum number of items to be returned, or `0` for no limit. Must not be larger than 25000. Server searches return up to 1000 items if no limit is given.
+ @param mimeType     The mime-type that should be returned, or `nil` for any.
+ @param resultBlock  The block to be executed once the search is performed. This block takes an `NSArray` argument containig the search results. Each item is an instance of <CLDItem>.
+ @param failureBlock The block to be executed if the search could not be performed. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the request.
+ @see searchIndex
+ @since 1.1
+ */
+- (CLDRequest *)searchItem:(CLDItem *)item query:(NSString *)query match:(CLDSearchIndexMatch)match limit:(NSUInteger)limit mimeType:(NSString *)mimeType resultBlock:(void(^)(NSArray *items))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+
+/**
+ Creates a search session, to search a folder as the user types.
+ 
+ Call <[CLDSearchSession searchQuery:]> on every change of the search field. Blocks are called for the latest query only.
+ 
+ @param item                The item where you want to perform the search. Must be of type `CLDItemTypeFolder`.
+ @param mimeType            The mime-type that should be returned, or `nil` for any.
+ @param includeDeletedItems `BOOL` stating if the search results should include previously deleted items.
+ @param resultBlock         The block to be executed once a query is performed. This block takes the query and an `NSArray` argument containig the search results. Each item is an instance of <CLDItem>.
+ @param failureBlock        The block to be executed if a query could not be performed. This block takes the query and an `NSError` argument containing the error.
+ @return A <CLDSearchSession> that performs the queries.
+ @since 1.1
+ */
+- (CLDSearchSession *)searchSessionForItem:(CLDItem *)item mimeType:(NSString *)mimeType includeDeletedItems:(BOOL)includeDeletedItems resultBlock:(void(^)(NSString *query, NSArray *items))resultBlock failureBlock:(void(^)(NSString *query, NSError *error))failureBlock;
+
+/**
+ The index of the items this session fetched so far, or `nil` if the session is not linked.
+ 
+ The index is emptied and removed from disk when the session is unlinked.
+ @since 1.1
+ */
+@property (readonly, strong, atomic) CLDSearchIndex *searchIndex;
 
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @name Accessing items
 ////////////////////////////////////////////////////////////////////////////////
 
+/**
+ The thumbnail cache for this session.
+ @since 1.1
+ */
+@property (readonly, strong, nonatomic) CLDThumbnailCache *thumbnailCache;
+
+/**
+ The thumbnail prefetcher for this session.
+ @since 1.1
+ */
+@property (readonly, strong, nonatomic) CLDThumbnailPrefetcher *thumbnailPrefetcher;
+
 /**
  Fetches a thumbnail for an item with a specific format and size.
  
+ Thumbnails are kept in <thumbnailCache> and are only fetched again when the item's revision changes.
+ 
  @note If you want to view a photo, please note that this method will never return the full size **original** image. For displaying a full resolution image you should use <fetchURLForItem:resultBlock:failureblock:>.
  
  @param item         The item whose thumbnail should be fetched.
@@ -675,23 +1106,40 @@ typedef BOOL(^CLDSessionValidateCallbackURLBlock)(NSURL *url);
  @param cropToSize   `BOOL` stating if the thumbnail should be cropped to the chosen size.
  @param resultBlock  The block to be executed once the thumbnail is fetched. This block takes an `UIImage` argument containing the thumbnail.
  @param failureBlock The block to be executed if the thumbnail could not be fetched. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the request.
  @since 1.0
  */
-- (void)fetchThumbnailForItem:(CLDItem *)item format:(CLDItemThumbnailFormat)format size:(CLDItemThumbnailSize)size cropToSize:(BOOL)cropToSize resultBlock:(void(^)(CLDImage *thumbnail))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+- (CLDRequest *)fetchThumbnailForItem:(CLDItem *)item format:(CLDItemThumbnailFormat)format size:(CLDItemThumbnailSize)size cropToSize:(BOOL)cropToSize resultBlock:(void(^)(CLDImage *thumbnail))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
 
 /**
  Fetches a direct `NSURL` to download a file. This is useful if you want to download files yourself or if you want to share a direct link between apps without the user having to authenticate again on another device or app.
  
+ URLs are cached per revision until shortly before they expire, and fetched again ahead of time as their expiration approaches.
+ 
  @param item         The item whose URL should be fetched. Must be of type `CLDItemTypeFile`.
  @param transcode    `BOOL` stating if a transcoding URL should be returned, when available. Please note that passing `YES` may result in longer response times.
  @param resultBlock  The block to be executed once the URL is fetched. This block takes two arguments: an `NSURL` containing the URL and and `NSDate` with the URL's expiration date.
  @param failureBlock The block to be executed if the URL could not be fetched. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the request.
  @since 1.0
  */
-- (void)fetchURLForItem:(CLDItem *)item
-    transcodeIfPossible:(BOOL)transcode
-            resultBlock:(void(^)(NSURL *url, NSURL *transcodingURL, NSDate *expireDate))resultBlock
-           failureBlock:(void(^)(NSError *error))failureBlock;
+- (CLDRequest *)fetchURLForItem:(CLDItem *)item
+            transcodeIfPossible:(BOOL)transcode
+                    resultBlock:(void(^)(NSURL *url, NSURL *transcodingURL, NSDate *expireDate))resultBlock
+                   failureBlock:(void(^)(NSError *error))failureBlock;
+
+/**
+ Opens a file to read arbitrary byte ranges of it, without downloading the whole file.
+ 
+ The item is fetched first, so the file is pinned to its latest revision.
+ 
+ @param item         The item to be read. Must be of type `CLDItemTypeFile`.
+ @param resultBlock  The block to be executed once the file is opened. This block takes a <CLDRemoteFile> argument to read the file with.
+ @param failureBlock The block to be executed if the file could not be opened. This block takes an `NSError` argument containing the error.
+ @return A <CLDRequest> that can be used to cancel the request.
+ @since 1.1
+ */
+- (CLDRequest *)openRemoteFileForItem:(CLDItem *)item resultBlock:(void(^)(CLDRemoteFile *file))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -726,6 +1174,38 @@ typedef BOOL(^CLDSessionValidateCallbackURLBlock)(NSURL *url);
                   resultBlock:(void(^)(NSURL *fileURL))resultBlock
                  failureBlock:(void(^)(NSError *error))failureBlock;
 
+/**
+ Downloads a file and hands its bytes over to a block as they arrive.
+ 
+ The data block is called on the callback queue, one chunk at a time and in order. The download is paused while the
+ chunks not yet handled add up to more than <[CLDDownloadStream maximumBufferedBytes]>, so a slow consumer is never flooded.
+ 
+ @param item         The item to be downloaded. Must be of type `CLDItemTypeFile`. Its revision is downloaded, if it has one.
+ @param cacheFileURL The URL of a file to write the download to as well, or `nil`.
+ @param dataBlock    The block to be executed for each chunk of the file. This block takes an `NSData` argument containing the chunk.
+ @param resultBlock  The block to be executed after the last chunk, once the whole file was downloaded.
+ @param failureBlock The block to be executed if the file could not be downloaded. This block takes an `NSError` argument containing the error.
+ @return A <CLDDownloadStream> that can be used to cancel the download.
+ @see -openInputStreamForItem:cacheFileURL:resultBlock:failureBlock:
+ @since 1.1
+ */
+- (CLDDownloadStream *)streamItem:(CLDItem *)item cacheFileURL:(NSURL *)cacheFileURL dataBlock:(void(^)(NSData *data))dataBlock resultBlock:(void(^)())resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+
+/**
+ Downloads a file to be read through an `NSInputStream` as it arrives.
+ 
+ Read the file from <[CLDDownloadStream inputStream]>. The download is paused while the stream's reader is behind.
+ 
+ @param item         The item to be downloaded. Must be of type `CLDItemTypeFile`. Its revision is downloaded, if it has one.
+ @param cacheFileURL The URL of a file to write the download to as well, or `nil`.
+ @param resultBlock  The block to be executed once the whole file was written to the input stream.
+ @param failureBlock The block to be executed if the file could not be downloaded. This block takes an `NSError` argument containing the error.
+ @return A <CLDDownloadStream> whose input stream delivers the file.
+ @see -streamItem:cacheFileURL:dataBlock:resultBlock:failureBlock:
+ @since 1.1
+ */
+- (CLDDownloadStream *)openInputStreamForItem:(CLDItem *)item cacheFileURL:(NSURL *)cacheFileURL resultBlock:(void(^)())resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+
 /**
  Uploads a new item to a specific location. The item should be created with a convenience <CLDItem> class method.
  
@@ -816,4 +1296,42 @@ typedef BOOL(^CLDSessionValidateCallbackURLBlock)(NSURL *url);
 + (void)handleEventsForBackgroundURLSession:(NSString *)identifier completionHandler:(void (^)())completionHandler;
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// @name Polling for updates
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ `BOOL` stating whether the session is polling the service for changes.
+ @since 1.1
+ */
+@property (readonly, atomic, getter = isPollingForDeltaUpdates) BOOL pollingForDeltaUpdates;
+
+/**
+ Starts polling the service for changes.
+ 
+ The session will post `kCLDSessionItemsCreatedNotification`, `kCLDSessionItemsModifiedNotification` and `kCLDSessionItemsDeletedNotification` whenever items are created, edited or removed.
+ Changes are batched, each notification includes one or more instances of <CLDItem> in its `userInfo` property.
+ 
+ Polling resumes from where it last stopped, even across app launches. The polling interval grows while nothing changes and shrinks back as soon as something does.
+ 
+ @note If polling has already started for this session, `failureBlock` will be called with a corresponding error.
+ 
+ @param resultBlock  The block to be executed once polling began. Notifications will only be posted after this.
+ @param failureBlock The block to be executed if polling could not begin. This block takes an `NSError` argument containing the error.
+ @since 1.1
+ */
+- (void)startPollingForDeltaUpdatesWithResultBlock:(void(^)())resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+
+/**
+ Stops polling the service for changes.
+ 
+ @warning Do not call <stopPollingForDeltaUpdates> and <startPollingForDeltaUpdatesWithResultBlock:failureBlock:> repeatedly in an attempt to obtain faster updates.
+ Doing so may result in denial of service for undetermined amounts of time.
+ The SDK is already optimized to continuously poll the service without hitting any limits.
+ 
+ @since 1.1
+ */
+- (void)stopPollingForDeltaUpdates;
+
+
 @end
\ No newline at end of file
@@ -13,22 +13,42 @@
 #import "CLDLoginViewController.h"
 #endif
 
+NSString* const kCLDSessionItemsCreatedNotification = @"kCLDSessionItemsCreatedNotification";
+NSString* const kCLDSessionItemsModifiedNotification = @"kCLDSessionItemsModifiedNotification";
+NSString* const kCLDSessionItemsDeletedNotification = @"kCLDSessionItemsDeletedNotification";
+NSString* const kCLDSessionQueuedMutationFailedNotification = @"kCLDSessionQueuedMutationFailedNotification";
+NSString* const kCLDSessionItemsKey = @"kCLDSessionItemsKey";
+NSString* const kCLDSessionErrorKey = @"kCLDSessionErrorKey";
+
 @interface CLDTransferManager (CLDSession)
 - (void)cancelAndRemoveAllTransfers;
 @end
 
-@interface CLDSession () <NSURLSessionTaskDelegate>
+@interface CLDSession () <NSURLSessionDataDelegate>
 @property (readonly, nonatomic) NSString *accessMode;
 @property (readwrite, strong, nonatomic) NSString *sessionIdentifier;
 @property (readwrite, nonatomic, getter = isLinked) BOOL linked;
 @property (readwrite, strong, nonatomic) CLDTransferManager *transferManager;
+@property (readwrite, strong, nonatomic) CLDThumbnailCache *thumbnailCache;
+@property (readwrite, strong, nonatomic) CLDThumbnailPrefetcher *thumbnailPrefetcher;
 @property (readwrite, strong, nonatomic) CLDAuthCredential *credentials;
 @property (readwrite, strong, nonatomic) NSURLSession *urlSession;
+@property (readwrite, strong, nonatomic) NSURLSession *contentURLSession;
 @property (readwrite, atomic) CLDSessionNetworkState networkState;
+@property (readwrite, strong, nonatomic) CLDDeltaPoller *deltaPoller;
+@property (readwrite, strong, atomic) CLDMutationQueue *mutationQueue;
+@property (readwrite, strong, atomic) CLDSearchIndex *searchIndex;
+@property (readwrite, strong, atomic) NSCache *searchResultCache;
+@property (readwrite, strong, atomic) CLDExpiringCache *mediaURLCache;
+@property (readwrite, strong, atomic) CLDExpiringCache *copyReferenceCache;
 @end
 
 @implementation CLDSession {
 	NSUInteger _numberOfNetworkConnections;
+    dispatch_queue_t _callbackQueue;
+    CLDRequestScheduler *_requestScheduler;
+    CLDMetricsRecorder *_metricsRecorder;
+    NSMapTable *_taskDelegates;         // task -> delegate, for data tasks without a completion handler
 }
 
 #pragma mark - Private configuration
@@ -37,6 +57,7 @@
 
 - (NSString *)_authScheme { return @"https"; }
 - (NSString *)_authHost { return @"meocloud.pt"; }
+- (NSNumber *)_authPort { return nil; }
 - (NSString *)_authAuthorizePath { return @"/oauth2/authorize"; }
 - (NSString *)_authAuthorizeQuery { return @"client_id=%@&redirect_uri=%@&response_type=code"; }
 - (NSString *)_authTokenPath { return @"/oauth2/token"; }
@@ -44,6 +65,13 @@
 - (NSString *)_apiScheme { return @"https"; }
 - (NSString *)_apiHost { return @"publicapi.meocloud.pt"; }
 - (NSString *)_apiContentHost { return @"api-content.meocloud.pt"; }
+// nil for the scheme's default port, e.g. to point a subclass at a stub server on the loopback interface
+- (NSNumber *)_apiPort { return nil; }
+- (NSNumber *)_apiContentPort { return nil; }
+#ifdef DEBUG
+// called when a transfer task finishes, to replace its outcome, e.g. to fail every other chunk of an upload
+- (CLDTransferFault)_transferFaultForRequest:(NSURLRequest *)request { return CLDTransferFaultNone; }
+#endif
 - (NSString *)_apiVersion { return @"1"; }
 
 - (NSString *)_accessModeSandbox { return @"sandbox"; }
@@ -91,16 +119,60 @@
         // get credentials (if they exist)
         self.credentials = [CLDAuthCredential credentialWithIdentifier:identifier];
         
-        // create NSURLSession
-        NSURLSessionConfiguration *configuration = [NSURLSessionConfiguration defaultSessionConfiguration];
-        configuration.timeoutIntervalForRequest = 15;
-        configuration.timeoutIntervalForResource = 15;
-        self.urlSession = [NSURLSession sessionWithConfiguration:configuration delegate:self delegateQueue:nil];
+        // create NSURLSessions, one connection pool per API host
+        _taskDelegates = [NSMapTable strongToStrongObjectsMapTable];
+        NSOperationQueue *delegateQueue = [NSOperationQueue new];
+        delegateQueue.maxConcurrentOperationCount = 1;
+        // responses are handed over to the queue of their lane right away, interactive ones should not wait for this one
+        if ([delegateQueue respondsToSelector:@selector(setQualityOfService:)]) {
+            delegateQueue.qualityOfService = NSQualityOfServiceUserInitiated;
+        }
+        self.urlSession = [NSURLSession sessionWithConfiguration:[self _configurationForEndpoint:CLDSessionEndpointPublicAPI]
+                                                        delegate:self
+                                                   delegateQueue:delegateQueue];
+        self.contentURLSession = [NSURLSession sessionWithConfiguration:[self _configurationForEndpoint:CLDSessionEndpointContentAPI]
+                                                               delegate:self
+                                                          delegateQueue:delegateQueue];
+        
+        // API requests wait here for their turn
+        _requestScheduler = [CLDRequestScheduler new];
+        _metricsRecorder = [[CLDMetricsRecorder alloc] initWithSession:self];
         
     }
     return self;
 }
 
+// timeoutIntervalForRequest is an idle timeout, it only fires when no data arrives for that long,
+// so large Metadata and Search responses are bounded by the generous resource timeout instead
+// both pools fit everything the request scheduler may admit at once, a smaller pool would only keep admitted requests
+// waiting for a connection, with their timeouts already running
+- (NSURLSessionConfiguration *)_configurationForEndpoint:(CLDSessionEndpoint)endpoint {
+    NSURLSessionConfiguration *configuration = [NSURLSessionConfiguration defaultSessionConfiguration];
+    configuration.requestCachePolicy = NSURLRequestReloadIgnoringLocalCacheData;
+    configuration.URLCache = nil;
+    configuration.HTTPShouldSetCookies = NO;
+    configuration.HTTPMaximumConnectionsPerHost = CLDRequestSchedulerMaximumConcurrencyLimit;
+    switch (endpoint) {
+        case CLDSessionEndpointPublicAPI:
+            configuration.timeoutIntervalForRequest = 20;
+            configuration.timeoutIntervalForResource = 10 * 60;
+            break;
+        case CLDSessionEndpointContentAPI:
+            configuration.timeoutIntervalForRequest = 30;
+            configuration.timeoutIntervalForResource = 30 * 60;
+            break;
+    }
+    return configuration;
+}
+
+- (NSURLSession *)_urlSessionForRequest:(NSURLRequest *)request {
+    // both hosts may be the same stub server, on different ports
+    NSNumber *contentPort = [self _apiContentPort];
+    if ([request.URL.host isEqualToString:[self _apiContentHost]] &&
+        (contentPort == nil || [request.URL.port isEqualToNumber:contentPort])) return self.contentURLSession;
+    return self.urlSession;
+}
+
 - (BOOL)isEqual:(id)object {
     return ([object isKindOfClass:[self class]] && [self.sessionIdentifier isEqualToString:[object sessionIdentifier]]);
 }
@@ -111,6 +183,47 @@
 
 #pragma mark - NSURLSession
 
+- (NSURLSessionDataTask *)_dataTaskWithRequest:(NSURLRequest *)request delegate:(id<NSURLSessionDataDelegate>)delegate {
+    NSParameterAssert(delegate);
+    NSURLSessionDataTask *task = [[self _urlSessionForRequest:request] dataTaskWithRequest:request];
+    @synchronized(_taskDelegates) {
+        [_taskDelegates setObject:delegate forKey:task];
+    }
+    return task;
+}
+
+- (id<NSURLSessionDataDelegate>)_delegateForTask:(NSURLSessionTask *)task {
+    @synchronized(_taskDelegates) {
+        return [_taskDelegates objectForKey:task];
+    }
+}
+
+- (void)URLSession:(NSURLSession *)session
+          dataTask:(NSURLSessionDataTask *)dataTask
+didReceiveResponse:(NSURLResponse *)response
+ completionHandler:(void (^)(NSURLSessionResponseDisposition))completionHandler {
+    id<NSURLSessionDataDelegate> delegate = [self _delegateForTask:dataTask];
+    if ([delegate respondsToSelector:_cmd]) {
+        [delegate URLSession:session dataTask:dataTask didReceiveResponse:response completionHandler:completionHandler];
+    } else {
+        completionHandler(NSURLSessionResponseAllow);
+    }
+}
+
+- (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveData:(NSData *)data {
+    id<NSURLSessionDataDelegate> delegate = [self _delegateForTask:dataTask];
+    if ([delegate respondsToSelector:_cmd]) [delegate URLSession:session dataTask:dataTask didReceiveData:data];
+}
+
+- (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didCompleteWithError:(NSError *)error {
+    id<NSURLSessionDataDelegate> delegate = nil;
+    @synchronized(_taskDelegates) {
+        delegate = [_taskDelegates objectForKey:task];
+        [_taskDelegates removeObjectForKey:task];
+    }
+    if ([delegate respondsToSelector:_cmd]) [delegate URLSession:session task:task didCompleteWithError:error];
+}
+
 - (void)URLSession:(NSURLSession *)session
               task:(NSURLSessionTask *)task
 willPerformHTTPRedirection:(NSHTTPURLResponse *)response
@@ -153,10 +266,47 @@ static CLDSession *_defaultSession = nil;
         if (linked) {
             // Create transfer manager
             self.transferManager = [[CLDTransferManager alloc] initWithSession:self];
+            self.thumbnailCache = [[CLDThumbnailCache alloc] initWithSession:self];
+            self.thumbnailPrefetcher = [[CLDThumbnailPrefetcher alloc] initWithSession:self];
+            self.mutationQueue = [[CLDMutationQueue alloc] initWithSession:self];
+            self.searchIndex = [[CLDSearchIndex alloc] initWithSession:self];
+            self.searchResultCache = [NSCache new];
+            self.searchResultCache.countLimit = 50;
+            self.mediaURLCache = [[CLDExpiringCache alloc] initWithSession:self];
+            self.copyReferenceCache = [[CLDExpiringCache alloc] initWithSession:self];
         } else {
             // Cancel all transfers
             [self.transferManager cancelAndRemoveAllTransfers];
             self.transferManager = nil;
+            
+            // Thumbnails belong to the account, so they must not outlive the link
+            [self.thumbnailPrefetcher cancelAllPrefetching];
+            self.thumbnailPrefetcher = nil;
+            [self.thumbnailCache removeAllThumbnails];
+            self.thumbnailCache = nil;
+            
+            // Stop polling and forget about the account's state
+            @synchronized(self) {
+                [self.deltaPoller stop];
+                self.deltaPoller = nil;
+            }
+            [CLDDeltaPoller removeStateForSessionIdentifier:self.sessionIdentifier];
+            
+            // Queued mutations belong to the account as well
+            [self.mutationQueue removeAllMutationsWithError:[CLDError errorWithCode:CLDErrorCodeSessionNotLinked]];
+            self.mutationQueue = nil;
+            [CLDMutationQueue removeStateForSessionIdentifier:self.sessionIdentifier];
+            
+            // ...and so does everything we know about its items
+            [self.searchIndex removeAllItems];
+            self.searchIndex = nil;
+            [CLDSearchIndex removeStateForSessionIdentifier:self.sessionIdentifier];
+            [self.searchResultCache removeAllObjects];
+            self.searchResultCache = nil;
+            [self.mediaURLCache removeAllValues];
+            self.mediaURLCache = nil;
+            [self.copyReferenceCache removeAllValues];
+            self.copyReferenceCache = nil;
         }
     }
 }
@@ -174,23 +324,24 @@ static CLDSession *_defaultSession = nil;
 - (void)linkSessionWithConfiguration:(CLDSessionConfiguration *)configuration
                          resultBlock:(void (^)())resultBlock
                         failureBlock:(void (^)(NSError *))failureBlock {
+    dispatch_queue_t callbackQueue = [self _currentCallbackQueue];
     if (self.isLinked) {
-        RunBlockOnMainThread(failureBlock, [CLDError errorWithCode:CLDErrorCodeSessionAlreadyLinked]);
+        RunBlockOnQueue(callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeSessionAlreadyLinked]);
         return;
     }
     
     UIWindow *currentWindow = [UIApplication sharedApplication].keyWindow;
     if (currentWindow == nil) {
-        RunBlockOnMainThread(failureBlock, [CLDError errorWithCode:CLDErrorCodeMissingWindow]);
+        RunBlockOnQueue(callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeMissingWindow]);
     } else {
         CLDLoginViewController *vc = [[CLDLoginViewController alloc] initWithSession:self configuration:configuration resultBlock:^{
             [currentWindow.rootViewController dismissViewControllerAnimated:YES completion:^{
-                RunBlockOnMainThread(resultBlock);
+                RunBlockOnQueue(callbackQueue, resultBlock);
             }];
         } failureBlock:^(NSError *error) {
             if (error.code == CLDErrorCancelledByUser) {
                 [currentWindow.rootViewController dismissViewControllerAnimated:YES completion:^{
-                    RunBlockOnMainThread(failureBlock, error);
+                    RunBlockOnQueue(callbackQueue, failureBlock, error);
                 }];
             }
         }];
@@ -209,14 +360,16 @@ static CLDSession *_defaultSession = nil;
                             URLBlock:(void (^)(NSURL *, CLDSessionValidateCallbackURLBlock))URLBlock
                          resultBlock:(void (^)())resultBlock
                         failureBlock:(void (^)(NSError *))failureBlock {
+    dispatch_queue_t callbackQueue = [self _currentCallbackQueue];
     if (self.isLinked) {
-        RunBlockOnMainThread(failureBlock, [CLDError errorWithCode:CLDErrorCodeSessionAlreadyLinked]);
+        RunBlockOnQueue(callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeSessionAlreadyLinked]);
         return;
     }
     
     NSURLComponents *authorizeURLComponents = [NSURLComponents new];
     authorizeURLComponents.scheme = [self _authScheme];
     authorizeURLComponents.host = [self _authHost];
+    authorizeURLComponents.port = [self _authPort];
     authorizeURLComponents.path = [self _authAuthorizePath];
     authorizeURLComponents.percentEncodedQuery = [NSString stringWithFormat:[self _authAuthorizeQuery],
                                                   [self _escapedURLQueryArgumentFromString:configuration.consumerKey],
@@ -245,6 +398,7 @@ static CLDSession *_defaultSession = nil;
                         NSURLComponents *tokenURLComponents = [NSURLComponents new];
                         tokenURLComponents.scheme = [self _authScheme];
                         tokenURLComponents.host = [self _authHost];
+                        tokenURLComponents.port = [self _authPort];
                         tokenURLComponents.path = [self _authTokenPath];
                         NSURL *tokenURL = tokenURLComponents.URL;
                         
@@ -283,13 +437,13 @@ static CLDSession *_defaultSession = nil;
                                     [CLDAuthCredential storeCredential:credential withIdentifier:self.sessionIdentifier];
                                     self.credentials = credential;
                                     
-                                    RunBlockOnMainThread(resultBlock);
+                                    RunBlockOnQueue(callbackQueue, resultBlock);
                                 } else {
-                                    RunBlockOnMainThread(failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
+                                    RunBlockOnQueue(callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
                                 }
                             } else {
                                 CLDError *e = [CLDError errorWithCode:CLDErrorCodeInvalidResponse userInfo:@{@"status_code": @(statusCode)}];
-                                RunBlockOnMainThread(failureBlock, e);
+                                RunBlockOnQueue(callbackQueue, failureBlock, e);
                             }
                             
                         }] resume];
@@ -311,6 +465,7 @@ static CLDSession *_defaultSession = nil;
 }
 
 - (void)unlinkSessionWithResultBlock:(void (^)())resultBlock failureBlock:(void (^)(NSError *))failureBlock {
+    dispatch_queue_t callbackQueue = [self _currentCallbackQueue];
     if (self.isLinked) {
         
         // request device removal from account (fire & forget)
@@ -322,29 +477,31 @@ static CLDSession *_defaultSession = nil;
         // clear credentials
         self.credentials = nil;
         [CLDAuthCredential deleteCredentialWithIdentifier:self.sessionIdentifier];
-        RunBlockOnMainThread(resultBlock);
+        RunBlockOnQueue(callbackQueue, resultBlock);
     } else {
-        RunBlockOnMainThread(failureBlock, [CLDError errorWithCode:CLDErrorCodeSessionNotLinked]);
+        RunBlockOnQueue(callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeSessionNotLinked]);
     }
 }
 
-- (void)fetchAccountInformationWithResultBlock:(void (^)(CLDAccountUser *))resultBlock
-                                  failureBlock:(void (^)(NSError *))failureBlock {
+- (CLDRequest *)fetchAccountInformationWithResultBlock:(void (^)(CLDAccountUser *))resultBlock
+                                          failureBlock:(void (^)(NSError *))failureBlock {
+    dispatch_queue_t callbackQueue = [self _currentCallbackQueue];
+    CLDRequest *handle = [CLDRequest new];
     
     NSURL *url = [self _serviceURLForEndpoint:CLDSessionEndpointPublicAPI path:@"Account/Info"];
     NSURLRequest *request = [self _signedMutableURLRequestWithURL:url];
     
-    [self _performJSONRequest:request successBlock:^(NSDictionary *info) {
+    [self _performJSONRequest:request handle:handle successBlock:^(NSDictionary *info) {
         CLDAccountUser *user = [CLDAccountUser userWithDictionary:info];
         if (user) {
-            RunBlockOnMainThread(resultBlock, user);
+            RunRequestBlockOnQueue(handle, callbackQueue, resultBlock, user);
         } else {
-            RunBlockOnMainThread(failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
+            RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
         }
     } failureBlock:^(CLDError *error) {
-        RunBlockOnMainThread(failureBlock, error);
+        RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, error);
     }];
-    
+    return handle;
 }
 
 - (void)_refreshCredentialsIfNeeded {
@@ -355,6 +512,7 @@ static CLDSession *_defaultSession = nil;
         NSURLComponents *tokenURLComponents = [NSURLComponents new];
         tokenURLComponents.scheme = [self _authScheme];
         tokenURLComponents.host = [self _authHost];
+        tokenURLComponents.port = [self _authPort];
         tokenURLComponents.path = [self _authTokenPath];
         NSURL *tokenURL = tokenURLComponents.URL;
         
@@ -373,8 +531,8 @@ static CLDSession *_defaultSession = nil;
         NSHTTPURLResponse *response = nil;
         NSError *error = nil;
         NSData *data = [NSURLConnection sendSynchronousRequest:request returningResponse:&response error:&error];
-        if (error) return;
-        NSDictionary *credentialDictionary = [NSJSONSerialization JSONObjectWithData:data options:0 error:&error];
+        NSDictionary *credentialDictionary = data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:&error] : nil;
+        [_metricsRecorder recordTokenRefreshWithSuccess:(error == nil)];
         if (error) return;
         
         NSTimeInterval expireInterval = [credentialDictionary[@"expires_in"] doubleValue];
@@ -421,14 +579,151 @@ static CLDSession *_defaultSession = nil;
     }
 }
 
+#pragma mark - Connections
+
+- (void)warmUpConnections {
+    // a HEAD request is enough to open the connection and go through the TLS handshake, whatever the response
+    for (NSNumber *endpoint in @[@(CLDSessionEndpointPublicAPI), @(CLDSessionEndpointContentAPI)]) {
+        NSURL *url = [self _serviceURLForEndpoint:endpoint.unsignedIntegerValue path:@""];
+        NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:url];
+        request.HTTPMethod = @"HEAD";
+        [[[self _urlSessionForRequest:request] dataTaskWithRequest:request completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+            CLDLog(@"Warmed up connection to %@: %@", url.host, error ?: @(((NSHTTPURLResponse *)response).statusCode));
+        }] resume];
+    }
+    [self.transferManager warmUpConnections];
+}
+
+#pragma mark - Callback queues
+
+- (dispatch_queue_t)callbackQueue {
+    @synchronized(self) {
+        return _callbackQueue ?: dispatch_get_main_queue();
+    }
+}
+
+- (void)setCallbackQueue:(dispatch_queue_t)callbackQueue {
+    @synchronized(self) {
+        _callbackQueue = callbackQueue;
+    }
+}
+
+- (void)performWithCallbackQueue:(dispatch_queue_t)callbackQueue block:(void (^)())block {
+    NSParameterAssert(block);
+    
+    // overrides are per thread, so requests started elsewhere in the meantime are not affected
+    NSMutableDictionary *threadDictionary = [NSThread currentThread].threadDictionary;
+    NSString *key = [self _callbackQueueThreadKey];
+    id previousCallbackQueue = threadDictionary[key];
+    if (callbackQueue) threadDictionary[key] = callbackQueue;
+    else [threadDictionary removeObjectForKey:key];
+    
+    @try {
+        block();
+    }
+    @finally {
+        if (previousCallbackQueue) threadDictionary[key] = previousCallbackQueue;
+        else [threadDictionary removeObjectForKey:key];
+    }
+}
+
+- (NSString *)_callbackQueueThreadKey {
+    return [NSString stringWithFormat:@"pt.meo.cloud.sdk.%@.callbackQueue", self.sessionIdentifier];
+}
+
+// queue for the blocks of a request being started on the current thread
+- (dispatch_queue_t)_currentCallbackQueue {
+    dispatch_queue_t callbackQueue = [NSThread currentThread].threadDictionary[[self _callbackQueueThreadKey]];
+    return callbackQueue ?: self.callbackQueue;
+}
+
+#pragma mark - Request lanes
+
+- (void)performInRequestLane:(CLDRequestLane)lane block:(void (^)())block {
+    NSParameterAssert(block);
+    
+    // same as callback queues, overrides are per thread
+    NSMutableDictionary *threadDictionary = [NSThread currentThread].threadDictionary;
+    NSString *key = [self _requestLaneThreadKey];
+    id previousLane = threadDictionary[key];
+    threadDictionary[key] = @(lane);
+    
+    @try {
+        block();
+    }
+    @finally {
+        if (previousLane) threadDictionary[key] = previousLane;
+        else [threadDictionary removeObjectForKey:key];
+    }
+}
+
+- (NSUInteger)maximumConcurrentRequestsForLane:(CLDRequestLane)lane {
+    return [_requestScheduler maximumConcurrentRequestsForLane:lane];
+}
+
+- (void)setMaximumConcurrentRequests:(NSUInteger)maximumConcurrentRequests forLane:(CLDRequestLane)lane {
+    [_requestScheduler setMaximumConcurrentRequests:maximumConcurrentRequests forLane:lane];
+}
+
+- (NSUInteger)concurrencyLimit {
+    return [_requestScheduler concurrencyLimit];
+}
+
+- (CLDRequestLaneStatistics *)statisticsForRequestLane:(CLDRequestLane)lane {
+    return [_requestScheduler statisticsForLane:lane];
+}
+
+- (void)resetRequestStatistics {
+    [_requestScheduler resetStatistics];
+}
+
+- (void)_reportServerOverload {
+    [_requestScheduler reportOverload];
+}
+
+#pragma mark - Metrics
+
+- (CLDSessionMetrics *)metrics {
+    return [_metricsRecorder metrics];
+}
+
+- (void)resetMetrics {
+    [_metricsRecorder reset];
+}
 
+- (id<CLDMetricsExporter>)metricsExporter {
+    return _metricsRecorder.exporter;
+}
 
+- (void)setMetricsExporter:(id<CLDMetricsExporter>)metricsExporter {
+    _metricsRecorder.exporter = metricsExporter;
+}
 
+- (NSTimeInterval)metricsExportInterval {
+    return _metricsRecorder.exportInterval;
+}
 
+- (void)setMetricsExportInterval:(NSTimeInterval)metricsExportInterval {
+    _metricsRecorder.exportInterval = metricsExportInterval;
+}
 
++ (NSData *)traceEventData {
+    return CLDTraceCopyChromeTraceData();
+}
 
+- (CLDMetricsRecorder *)_metricsRecorder {
+    return _metricsRecorder;
+}
 
+- (NSString *)_requestLaneThreadKey {
+    return [NSString stringWithFormat:@"pt.meo.cloud.sdk.%@.requestLane", self.sessionIdentifier];
+}
 
+// lane for a request being started on the current thread
+- (CLDRequestLane)_currentRequestLane {
+    NSNumber *lane = [NSThread currentThread].threadDictionary[[self _requestLaneThreadKey]];
+    return lane ? lane.integerValue : CLDRequestLaneDefault;
+}
 
 #pragma mark - Fetching item information
 
@@ -438,11 +733,13 @@ static CLDSession *_defaultSession = nil;
     return _itemLimit;
 }
 
-- (void)fetchItem:(CLDItem *)item
-          options:(CLDSessionFetchItemOptions)options
-      resultBlock:(void (^)(CLDItem *))resultBlock
-     failureBlock:(void (^)(NSError *))failureBlock {
+- (CLDRequest *)fetchItem:(CLDItem *)item
+                  options:(CLDSessionFetchItemOptions)options
+              resultBlock:(void (^)(CLDItem *))resultBlock
+             failureBlock:(void (^)(NSError *))failureBlock {
     NSParameterAssert(item);
+    dispatch_queue_t callbackQueue = [self _currentCallbackQueue];
+    CLDRequest *handle = [CLDRequest new];
     
     BOOL listContents = (options & CLDSessionFetchItemOptionListContents) != 0;
     BOOL includeDeletedItems = (options & CLDSessionFetchItemOptionIncludeDeletedItems) != 0;
@@ -458,20 +755,23 @@ static CLDSession *_defaultSession = nil;
     NSURL *url = [self _serviceURLForEndpoint:CLDSessionEndpointPublicAPI path:urlPath query:query];
     NSMutableURLRequest *request = [self _signedMutableURLRequestWithURL:url];
     
-    [self _performJSONRequest:request successBlock:^(id object) {
+    [self _performJSONRequest:request handle:handle successBlock:^(id object) {
         CLDItem *newItem = [CLDItem itemWithDictionary:object session:self];
         if (newItem) {
-            RunBlockOnMainThread(resultBlock, newItem);
+            if (newItem.contents) [self.searchIndex indexFolder:newItem];
+            else [self.searchIndex indexItems:@[newItem]];
+            RunRequestBlockOnQueue(handle, callbackQueue, resultBlock, newItem);
         } else {
-            RunBlockOnMainThread(failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
+            RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
         }
     } failureBlock:^(CLDError *error) {
         if (item.folderHash && error.statusCode == 304) {
-            RunBlockOnMainThread(resultBlock, item);
+            RunRequestBlockOnQueue(handle, callbackQueue, resultBlock, item);
         } else {
-            RunBlockOnMainThread(failureBlock, error);
+            RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, error);
         }
     }];
+    return handle;
 }
 
 
@@ -481,14 +781,44 @@ static CLDSession *_defaultSession = nil;
 
 
 
+#pragma mark - Crawling folders
+
+- (CLDTreeCrawler *)crawlItem:(CLDItem *)item
+                      options:(CLDSessionFetchItemOptions)options
+                   checkpoint:(CLDTreeCrawlerCheckpoint *)checkpoint
+                  folderBlock:(void (^)(CLDItem *))folderBlock
+                  resultBlock:(void (^)(CLDTreeCrawlerCheckpoint *))resultBlock
+                 failureBlock:(void (^)(NSError *, CLDTreeCrawlerCheckpoint *))failureBlock {
+    NSParameterAssert(item);
+    NSParameterAssert(item.type == CLDItemTypeFolder);
+    
+    CLDTreeCrawler *crawler = [[CLDTreeCrawler alloc] initWithSession:self item:item options:options checkpoint:checkpoint];
+    crawler.callbackQueue = [self _currentCallbackQueue];
+    crawler.folderBlock = folderBlock;
+    crawler.resultBlock = resultBlock;
+    crawler.failureBlock = failureBlock;
+    [crawler start];
+    return crawler;
+}
+
+
+
+
+
+
+
+
+
 #pragma mark - Copying items
 
-- (void)copyItem:(CLDItem *)item
-          toPath:(NSString *)path
-     resultBlock:(void (^)(CLDItem *))resultBlock
-    failureBlock:(void (^)(NSError *))failureBlock {
+- (CLDRequest *)copyItem:(CLDItem *)item
+                  toPath:(NSString *)path
+             resultBlock:(void (^)(CLDItem *))resultBlock
+            failureBlock:(void (^)(NSError *))failureBlock {
     NSParameterAssert(item);
     NSParameterAssert(path);
+    dispatch_queue_t callbackQueue = [self _currentCallbackQueue];
+    CLDRequest *handle = [CLDRequest new];
     
     NSMutableDictionary *parameters = [NSMutableDictionary new];
     parameters[@"root"] = self.accessMode;
@@ -500,57 +830,92 @@ static CLDSession *_defaultSession = nil;
     request.HTTPMethod = @"POST";
     request.HTTPBody = [self _postDataWithDictionary:parameters];
     
-    [self _performJSONRequest:request successBlock:^(id object) {
+    CLDMutation *mutation = [self _queueableMutationWithType:CLDMutationTypeCopy item:item path:path handle:handle
+                                               callbackQueue:callbackQueue resultBlock:resultBlock failureBlock:failureBlock];
+    if ([self _queueMutation:mutation]) return handle;
+    
+    [self _performJSONRequest:request handle:handle successBlock:^(id object) {
+        [self _endMutation:mutation error:nil];
         CLDItem *copiedItem = [CLDItem itemWithDictionary:object session:self];
         if (copiedItem) {
-            RunBlockOnMainThread(resultBlock, copiedItem);
+            [self.searchIndex indexItems:@[copiedItem]];
+            RunRequestBlockOnQueue(handle, callbackQueue, resultBlock, copiedItem);
         } else {
-            RunBlockOnMainThread(failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
+            RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
         }
     } failureBlock:^(CLDError *error) {
+        if ([self _endMutation:mutation error:error]) return;
         if (error.statusCode == 403) {
             NSString *failureReason = [CLDError localizedFailureReasonForCode:CLDErrorCodeResourceAlreadyExists,
                                      item.type == CLDItemTypeFile ? CLDLocalizedString(@"That file") : CLDLocalizedString(@"That folder")];
-            RunBlockOnMainThread(failureBlock, [CLDError errorWithCode:CLDErrorCodeResourceAlreadyExists
-                                                              userInfo:@{NSLocalizedFailureReasonErrorKey : failureReason}]);
+            RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeResourceAlreadyExists
+                                                                             userInfo:@{NSLocalizedFailureReasonErrorKey : failureReason}]);
         } else {
-            RunBlockOnMainThread(failureBlock, error);
+            RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, error);
         }
     }];
+    return handle;
 }
 
-- (void)fetchCopyReferenceForItem:(CLDItem *)item
-                      resultBlock:(void (^)(NSString *, NSDate *))resultBlock
-                     failureBlock:(void (^)(NSError *))failureBlock {
+- (CLDRequest *)fetchCopyReferenceForItem:(CLDItem *)item
+                              resultBlock:(void (^)(NSString *, NSDate *))resultBlock
+                             failureBlock:(void (^)(NSError *))failureBlock {
     NSParameterAssert(item);
+    dispatch_queue_t callbackQueue = [self _currentCallbackQueue];
+    CLDRequest *handle = [CLDRequest new];
+    CLDExpiringCache *cache = self.copyReferenceCache;
+    if (cache == nil) {
+        RunBlockOnQueue(callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeSessionNotLinked]);
+        return handle;
+    }
+    
+    NSString *key = [NSString stringWithFormat:@"%@\n%@", item.path.lowercaseString, item.revision ?: @""];
+    [cache valuesForKey:key handle:handle callbackQueue:callbackQueue loadBlock:^CLDRequest *(CLDExpiringCacheResultBlock cacheResultBlock, void (^cacheFailureBlock)(NSError *)) {
+        return [self _fetchCopyReferenceForItem:item resultBlock:^(NSString *reference, NSDate *expireDate) {
+            cacheResultBlock(@[reference], expireDate);
+        } failureBlock:cacheFailureBlock];
+    } resultBlock:^(NSArray *values, NSDate *expireDate) {
+        RunBlock(resultBlock, values[0], expireDate);
+    } failureBlock:failureBlock];
+    return handle;
+}
+
+- (CLDRequest *)_fetchCopyReferenceForItem:(CLDItem *)item
+                               resultBlock:(void (^)(NSString *, NSDate *))resultBlock
+                              failureBlock:(void (^)(NSError *))failureBlock {
+    dispatch_queue_t callbackQueue = [self _currentCallbackQueue];
+    CLDRequest *handle = [CLDRequest new];
     
     NSString *urlPath = [NSString stringWithFormat:@"CopyRef/%@/%@", self.accessMode, item.trimmedPath];
     NSURL *url = [self _serviceURLForEndpoint:CLDSessionEndpointContentAPI path:urlPath];
     NSURLRequest *request = [self _signedMutableURLRequestWithURL:url];
     
-    [self _performJSONRequest:request successBlock:^(id object) {
+    [self _performJSONRequest:request handle:handle successBlock:^(id object) {
         NSString *reference = object[@"copy_ref"];
-        NSDate *expireDate = [[NSDateFormatter serviceDateFormatter] dateFromString:object[@"expires"]];
+        NSDate *expireDate = [NSDateFormatter serviceDateFromString:object[@"expires"]];
         if (reference && expireDate) {
-            RunBlockOnMainThread(resultBlock, reference, expireDate);
+            RunRequestBlockOnQueue(handle, callbackQueue, resultBlock, reference, expireDate);
         } else {
-            RunBlockOnMainThread(failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
+            RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
         }
     } failureBlock:^(CLDError *error) {
-        RunBlockOnMainThread(failureBlock, error);
+        RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, error);
     }];
+    return handle;
 }
 
-- (void)fetchItemDetailsFromReference:(NSString *)reference
-                          resultBlock:(void (^)(NSDictionary *))resultBlock
-                         failureBlock:(void (^)(NSError *))failureBlock {
+- (CLDRequest *)fetchItemDetailsFromReference:(NSString *)reference
+                                  resultBlock:(void (^)(NSDictionary *))resultBlock
+                                 failureBlock:(void (^)(NSError *))failureBlock {
     NSParameterAssert(reference);
+    dispatch_queue_t callbackQueue = [self _currentCallbackQueue];
+    CLDRequest *handle = [CLDRequest new];
     
     NSDictionary *queryParameters = @{@"copy_ref":reference};
     NSURL *url = [self _serviceURLForEndpoint:CLDSessionEndpointPublicAPI path:@"CopyRefDetails" query:queryParameters];
     NSURLRequest *request = [self _signedMutableURLRequestWithURL:url];
     
-    [self _performJSONRequest:request successBlock:^(id object) {
+    [self _performJSONRequest:request handle:handle successBlock:^(id object) {
         if (object[@"is_dir"] &&
             object[@"bytes"] &&
             object[@"size"] &&
@@ -570,22 +935,25 @@ static CLDSession *_defaultSession = nil;
                                           @"name":name,
                                           @"mimeType":mimeType,
                                           @"iconName":iconName};
-            RunBlockOnMainThread(resultBlock, itemDetails);
+            RunRequestBlockOnQueue(handle, callbackQueue, resultBlock, itemDetails);
         } else {
-            RunBlockOnMainThread(failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
+            RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
         }
     } failureBlock:^(CLDError *error) {
-        RunBlockOnMainThread(failureBlock, error);
+        RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, error);
     }];
+    return handle;
 }
 
 // Developer note: this is exactly the same as a standard copy, but it uses a copy reference instead of a path.
-- (void)copyItemFromReference:(NSString *)reference
-                       toPath:(NSString *)path
-                  resultBlock:(void (^)(CLDItem *))resultBlock
-                 failureBlock:(void (^)(NSError *))failureBlock {
+- (CLDRequest *)copyItemFromReference:(NSString *)reference
+                               toPath:(NSString *)path
+                          resultBlock:(void (^)(CLDItem *))resultBlock
+                         failureBlock:(void (^)(NSError *))failureBlock {
     NSParameterAssert(reference);
     NSParameterAssert(path);
+    dispatch_queue_t callbackQueue = [self _currentCallbackQueue];
+    CLDRequest *handle = [CLDRequest new];
     
     NSMutableDictionary *parameters = [NSMutableDictionary new];
     parameters[@"root"] = self.accessMode;
@@ -597,22 +965,24 @@ static CLDSession *_defaultSession = nil;
     request.HTTPMethod = @"POST";
     request.HTTPBody = [self _postDataWithDictionary:parameters];
     
-    [self _performJSONRequest:request successBlock:^(id object) {
+    [self _performJSONRequest:request handle:handle successBlock:^(id object) {
         CLDItem *copiedItem = [CLDItem itemWithDictionary:object session:self];
         if (copiedItem) {
-            RunBlockOnMainThread(resultBlock, copiedItem);
+            [self.searchIndex indexItems:@[copiedItem]];
+            RunRequestBlockOnQueue(handle, callbackQueue, resultBlock, copiedItem);
         } else {
-            RunBlockOnMainThread(failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
+            RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
         }
     } failureBlock:^(CLDError *error) {
         if (error.statusCode == 403) {
             NSString *failureReason = [CLDError localizedFailureReasonForCode:CLDErrorCodeResourceAlreadyExists, CLDLocalizedString(@"That file")];
-            RunBlockOnMainThread(failureBlock, [CLDError errorWithCode:CLDErrorCodeResourceAlreadyExists
-                                                              userInfo:@{NSLocalizedFailureReasonErrorKey : failureReason}]);
+            RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeResourceAlreadyExists
+                                                                             userInfo:@{NSLocalizedFailureReasonErrorKey : failureReason}]);
         } else {
-            RunBlockOnMainThread(failureBlock, error);
+            RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, error);
         }
     }];
+    return handle;
 }
 
 
@@ -624,12 +994,14 @@ static CLDSession *_defaultSession = nil;
 
 #pragma mark - Moving items
 
-- (void)moveItem:(CLDItem *)item
-          toPath:(NSString *)path
-     resultBlock:(void (^)(CLDItem *))resultBlock
-    failureBlock:(void (^)(NSError *))failureBlock {
+- (CLDRequest *)moveItem:(CLDItem *)item
+                  toPath:(NSString *)path
+             resultBlock:(void (^)(CLDItem *))resultBlock
+            failureBlock:(void (^)(NSError *))failureBlock {
     NSParameterAssert(item);
     NSParameterAssert(path);
+    dispatch_queue_t callbackQueue = [self _currentCallbackQueue];
+    CLDRequest *handle = [CLDRequest new];
     
     NSMutableDictionary *parameters = [NSMutableDictionary new];
     parameters[@"root"] = self.accessMode;
@@ -641,23 +1013,31 @@ static CLDSession *_defaultSession = nil;
     request.HTTPMethod = @"POST";
     request.HTTPBody = [self _postDataWithDictionary:parameters];
     
-    [self _performJSONRequest:request successBlock:^(id object) {
+    CLDMutation *mutation = [self _queueableMutationWithType:CLDMutationTypeMove item:item path:path handle:handle
+                                               callbackQueue:callbackQueue resultBlock:resultBlock failureBlock:failureBlock];
+    if ([self _queueMutation:mutation]) return handle;
+    
+    [self _performJSONRequest:request handle:handle successBlock:^(id object) {
+        [self _endMutation:mutation error:nil];
         CLDItem *movedItem = [CLDItem itemWithDictionary:object session:self];
         if (movedItem) {
-            RunBlockOnMainThread(resultBlock, movedItem);
+            [self.searchIndex moveItemAtPath:item.path toItem:movedItem];
+            RunRequestBlockOnQueue(handle, callbackQueue, resultBlock, movedItem);
         } else {
-            RunBlockOnMainThread(failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
+            RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
         }
     } failureBlock:^(CLDError *error) {
+        if ([self _endMutation:mutation error:error]) return;
         if (error.statusCode == 403) {
             NSString *failureReason = [CLDError localizedFailureReasonForCode:CLDErrorCodeResourceAlreadyExists,
                                        item.type == CLDItemTypeFile ? CLDLocalizedString(@"That file") : CLDLocalizedString(@"That folder")];
-            RunBlockOnMainThread(failureBlock, [CLDError errorWithCode:CLDErrorCodeResourceAlreadyExists
-                                                              userInfo:@{NSLocalizedFailureReasonErrorKey : failureReason}]);
+            RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeResourceAlreadyExists
+                                                                             userInfo:@{NSLocalizedFailureReasonErrorKey : failureReason}]);
         } else {
-            RunBlockOnMainThread(failureBlock, error);
+            RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, error);
         }
     }];
+    return handle;
 }
 
 
@@ -669,17 +1049,17 @@ static CLDSession *_defaultSession = nil;
 
 #pragma mark - Renaming items
 
-- (void)renameItem:(CLDItem *)item
-              name:(NSString *)name
-       resultBlock:(void (^)(CLDItem *))resultBlock
-      failureBlock:(void (^)(NSError *))failureBlock {
+- (CLDRequest *)renameItem:(CLDItem *)item
+                      name:(NSString *)name
+               resultBlock:(void (^)(CLDItem *))resultBlock
+              failureBlock:(void (^)(NSError *))failureBlock {
     NSParameterAssert(item);
     NSParameterAssert(name);
     
     NSString *path = [item.path stringByDeletingLastPathComponent];
     path = [path stringByAppendingPathComponent:name];
     
-    [self moveItem:item toPath:path resultBlock:resultBlock failureBlock:failureBlock];
+    return [self moveItem:item toPath:path resultBlock:resultBlock failureBlock:failureBlock];
 }
 
 
@@ -691,10 +1071,12 @@ static CLDSession *_defaultSession = nil;
 
 #pragma mark - Deleting items
 
-- (void)deleteItem:(CLDItem *)item
-       resultBlock:(void (^)(CLDItem *))resultBlock
-      failureBlock:(void (^)(NSError *))failureBlock {
+- (CLDRequest *)deleteItem:(CLDItem *)item
+               resultBlock:(void (^)(CLDItem *))resultBlock
+              failureBlock:(void (^)(NSError *))failureBlock {
     NSParameterAssert(item);
+    dispatch_queue_t callbackQueue = [self _currentCallbackQueue];
+    CLDRequest *handle = [CLDRequest new];
     
     NSMutableDictionary *parameters = [NSMutableDictionary new];
     parameters[@"root"] = self.accessMode;
@@ -705,22 +1087,32 @@ static CLDSession *_defaultSession = nil;
     request.HTTPMethod = @"POST";
     request.HTTPBody = [self _postDataWithDictionary:parameters];
     
-    [self _performJSONRequest:request successBlock:^(id object) {
+    CLDMutation *mutation = [self _queueableMutationWithType:CLDMutationTypeDelete item:item path:nil handle:handle
+                                               callbackQueue:callbackQueue resultBlock:resultBlock failureBlock:failureBlock];
+    if ([self _queueMutation:mutation]) return handle;
+    
+    [self _performJSONRequest:request handle:handle successBlock:^(id object) {
+        [self _endMutation:mutation error:nil];
         CLDItem *deletedItem = [CLDItem itemWithDictionary:object session:self];
         if (deletedItem) {
-            RunBlockOnMainThread(resultBlock, deletedItem);
+            [self.searchIndex removeItemsAtPaths:@[item.path]];
+            RunRequestBlockOnQueue(handle, callbackQueue, resultBlock, deletedItem);
         } else {
-            RunBlockOnMainThread(failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
+            RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
         }
     } failureBlock:^(CLDError *error) {
-        RunBlockOnMainThread(failureBlock, error);
+        if ([self _endMutation:mutation error:error]) return;
+        RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, error);
     }];
+    return handle;
 }
 
-- (void)undeleteItem:(CLDItem *)item
-         resultBlock:(void (^)(CLDItem *))resultBlock
-        failureBlock:(void (^)(NSError *))failureBlock {
+- (CLDRequest *)undeleteItem:(CLDItem *)item
+                 resultBlock:(void (^)(CLDItem *))resultBlock
+                failureBlock:(void (^)(NSError *))failureBlock {
     NSParameterAssert(item);
+    dispatch_queue_t callbackQueue = [self _currentCallbackQueue];
+    CLDRequest *handle = [CLDRequest new];
     
     NSMutableDictionary *parameters = [NSMutableDictionary new];
     parameters[@"root"] = self.accessMode;
@@ -731,16 +1123,18 @@ static CLDSession *_defaultSession = nil;
     request.HTTPMethod = @"POST";
     request.HTTPBody = [self _postDataWithDictionary:parameters];
     
-    [self _performJSONRequest:request successBlock:^(id object) {
+    [self _performJSONRequest:request handle:handle successBlock:^(id object) {
         CLDItem *deletedItem = [CLDItem itemWithDictionary:object session:self];
         if (deletedItem) {
-            RunBlockOnMainThread(resultBlock, deletedItem);
+            [self.searchIndex indexItems:@[deletedItem]];
+            RunRequestBlockOnQueue(handle, callbackQueue, resultBlock, deletedItem);
         } else {
-            RunBlockOnMainThread(failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
+            RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
         }
     } failureBlock:^(CLDError *error) {
-        RunBlockOnMainThread(failureBlock, error);
+        RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, error);
     }];
+    return handle;
 }
 
 
@@ -755,10 +1149,12 @@ static CLDSession *_defaultSession = nil;
 
 #pragma mark - Creating folders
 
-- (void)createFolderAtPath:(NSString *)path
-               resultBlock:(void (^)(CLDItem *))resultBlock
-              failureBlock:(void (^)(NSError *))failureBlock {
+- (CLDRequest *)createFolderAtPath:(NSString *)path
+                       resultBlock:(void (^)(CLDItem *))resultBlock
+                      failureBlock:(void (^)(NSError *))failureBlock {
     NSParameterAssert(path);
+    dispatch_queue_t callbackQueue = [self _currentCallbackQueue];
+    CLDRequest *handle = [CLDRequest new];
     
     NSMutableDictionary *parameters = [NSMutableDictionary new];
     parameters[@"root"] = self.accessMode;
@@ -769,22 +1165,105 @@ static CLDSession *_defaultSession = nil;
     request.HTTPMethod = @"POST";
     request.HTTPBody = [self _postDataWithDictionary:parameters];
     
-    [self _performJSONRequest:request successBlock:^(id object) {
+    CLDMutation *mutation = [self _queueableMutationWithType:CLDMutationTypeCreateFolder item:nil path:path handle:handle
+                                               callbackQueue:callbackQueue resultBlock:resultBlock failureBlock:failureBlock];
+    if ([self _queueMutation:mutation]) return handle;
+    
+    [self _performJSONRequest:request handle:handle successBlock:^(id object) {
+        [self _endMutation:mutation error:nil];
         CLDItem *newFolderItem = [CLDItem itemWithDictionary:object session:self];
         if (newFolderItem) {
-            RunBlockOnMainThread(resultBlock, newFolderItem);
+            [self.searchIndex indexItems:@[newFolderItem]];
+            RunRequestBlockOnQueue(handle, callbackQueue, resultBlock, newFolderItem);
         } else {
-            RunBlockOnMainThread(failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
+            RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
         }
     } failureBlock:^(CLDError *error) {
+        if ([self _endMutation:mutation error:error]) return;
         if (error.statusCode == 403) {
             NSString *failureReason = [CLDError localizedFailureReasonForCode:CLDErrorCodeResourceAlreadyExists, CLDLocalizedString(@"That folder")];
-            RunBlockOnMainThread(failureBlock, [CLDError errorWithCode:CLDErrorCodeResourceAlreadyExists
-                                                              userInfo:@{NSLocalizedFailureReasonErrorKey : failureReason}]);
+            RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeResourceAlreadyExists
+                                                                             userInfo:@{NSLocalizedFailureReasonErrorKey : failureReason}]);
         } else {
-            RunBlockOnMainThread(failureBlock, error);
+            RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, error);
         }
     }];
+    return handle;
+}
+
+
+
+
+
+
+
+
+
+
+
+#pragma mark - Offline mutations
+
+- (NSUInteger)numberOfQueuedMutations {
+    return self.mutationQueue.numberOfMutations;
+}
+
+- (void)replayQueuedMutations {
+    [self.mutationQueue replay];
+}
+
+- (void)discardQueuedMutations {
+    [self.mutationQueue removeAllMutationsWithError:[CLDError errorWithCode:CLDErrorCancelledByUser]];
+}
+
+- (void)_performWithoutQueueingMutations:(void (^)())block {
+    NSParameterAssert(block);
+    
+    // same as callback queues, overrides are per thread
+    NSMutableDictionary *threadDictionary = [NSThread currentThread].threadDictionary;
+    NSString *key = [self _mutationReplayThreadKey];
+    id previousValue = threadDictionary[key];
+    threadDictionary[key] = @YES;
+    
+    @try {
+        block();
+    }
+    @finally {
+        if (previousValue) threadDictionary[key] = previousValue;
+        else [threadDictionary removeObjectForKey:key];
+    }
+}
+
+- (NSString *)_mutationReplayThreadKey {
+    return [NSString stringWithFormat:@"pt.meo.cloud.sdk.%@.mutationReplay", self.sessionIdentifier];
+}
+
+// returns nil unless the mutation being started on the current thread may be queued for later
+- (CLDMutation *)_queueableMutationWithType:(CLDMutationType)type
+                                       item:(CLDItem *)item
+                                       path:(NSString *)path
+                                     handle:(CLDRequest *)handle
+                              callbackQueue:(dispatch_queue_t)callbackQueue
+                                resultBlock:(void(^)(CLDItem *item))resultBlock
+                               failureBlock:(void(^)(NSError *error))failureBlock {
+    if (!self.queuesMutationsWhileOffline || self.mutationQueue == nil) return nil;
+    if ([NSThread currentThread].threadDictionary[[self _mutationReplayThreadKey]]) return nil;
+    
+    CLDMutation *mutation = [CLDMutation mutationWithType:type item:item path:path];
+    [mutation addCallbackWithHandle:handle callbackQueue:callbackQueue resultBlock:resultBlock failureBlock:failureBlock];
+    return mutation;
+}
+
+// queues a mutation that has to wait for earlier ones, otherwise the mutation keeps them from overtaking it until it ends
+- (BOOL)_queueMutation:(CLDMutation *)mutation {
+    CLDMutationQueue *mutationQueue = self.mutationQueue;
+    if (mutation == nil || mutationQueue == nil) return NO;
+    return ![mutationQueue beginMutation:mutation];
+}
+
+// returns YES if the mutation failed without reaching the server and was kept to be replayed later
+- (BOOL)_endMutation:(CLDMutation *)mutation error:(NSError *)error {
+    if (mutation == nil) return NO;
+    return [self.mutationQueue endMutation:mutation error:error];
 }
 
 
@@ -799,40 +1278,45 @@ static CLDSession *_defaultSession = nil;
 
 #pragma mark - Item revisions
 
-- (void)fetchRevisionsForItem:(CLDItem *)item resultBlock:(void (^)(NSArray *))resultBlock failureBlock:(void (^)(NSError *))failureBlock {
-    [self fetchRevisionsForItem:item revisionLimit:7 resultBlock:resultBlock failureBlock:failureBlock];
+- (CLDRequest *)fetchRevisionsForItem:(CLDItem *)item resultBlock:(void (^)(NSArray *))resultBlock failureBlock:(void (^)(NSError *))failureBlock {
+    return [self fetchRevisionsForItem:item revisionLimit:7 resultBlock:resultBlock failureBlock:failureBlock];
 }
 
-- (void)fetchRevisionsForItem:(CLDItem *)item
-                revisionLimit:(NSUInteger)limit
-                  resultBlock:(void (^)(NSArray *))resultBlock
-                 failureBlock:(void (^)(NSError *))failureBlock {
+- (CLDRequest *)fetchRevisionsForItem:(CLDItem *)item
+                        revisionLimit:(NSUInteger)limit
+                          resultBlock:(void (^)(NSArray *))resultBlock
+                         failureBlock:(void (^)(NSError *))failureBlock {
     NSParameterAssert(item);
     NSParameterAssert(item.type == CLDItemTypeFile);
+    dispatch_queue_t callbackQueue = [self _currentCallbackQueue];
+    CLDRequest *handle = [CLDRequest new];
     
     NSDictionary *query = @{@"rev_limit":@(limit)};
     NSString *urlString = [NSString stringWithFormat:@"Revisions/%@/%@", self.accessMode, item.trimmedPath];
     NSURL *url = [self _serviceURLForEndpoint:CLDSessionEndpointPublicAPI path:urlString query:query];
     NSURLRequest *request = [self _signedMutableURLRequestWithURL:url];
     
-    [self _performJSONRequest:request successBlock:^(id object) {
+    [self _performJSONRequest:request handle:handle successBlock:^(id object) {
         NSMutableArray *revisionItems = [NSMutableArray new];
         for (NSDictionary *itemDictionary in object) {
             CLDItem *item = [CLDItem itemWithDictionary:itemDictionary session:self];
             if (item) [revisionItems addObject:item];
         }
-        RunBlockOnMainThread(resultBlock, [NSArray arrayWithArray:revisionItems]);
+        RunRequestBlockOnQueue(handle, callbackQueue, resultBlock, [NSArray arrayWithArray:revisionItems]);
     } failureBlock:^(CLDError *error) {
-        RunBlockOnMainThread(failureBlock, error);
+        RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, error);
     }];
+    return handle;
 }
 
-- (void)restoreItem:(CLDItem *)item
-        resultBlock:(void (^)(CLDItem *))resultBlock
-       failureBlock:(void (^)(NSError *))failureBlock {
+- (CLDRequest *)restoreItem:(CLDItem *)item
+                resultBlock:(void (^)(CLDItem *))resultBlock
+               failureBlock:(void (^)(NSError *))failureBlock {
     NSParameterAssert(item);
     NSParameterAssert(item.revision);
     NSParameterAssert(item.type == CLDItemTypeFile);
+    dispatch_queue_t callbackQueue = [self _currentCallbackQueue];
+    CLDRequest *handle = [CLDRequest new];
     
     NSString *urlString = [NSString stringWithFormat:@"Restore/%@/%@", self.accessMode, item.trimmedPath];
     NSURL *url = [self _serviceURLForEndpoint:CLDSessionEndpointPublicAPI path:urlString];
@@ -840,16 +1324,123 @@ static CLDSession *_defaultSession = nil;
     request.HTTPMethod = @"POST";
     request.HTTPBody = [self _postDataWithDictionary:@{@"rev":item.revision}];
     
-    [self _performJSONRequest:request successBlock:^(id object) {
+    [self _performJSONRequest:request handle:handle successBlock:^(id object) {
         CLDItem *restoredItem = [CLDItem itemWithDictionary:object session:self];
         if (restoredItem) {
-            RunBlockOnMainThread(resultBlock, restoredItem);
+            [self.searchIndex indexItems:@[restoredItem]];
+            RunRequestBlockOnQueue(handle, callbackQueue, resultBlock, restoredItem);
         } else {
-            RunBlockOnMainThread(failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
+            RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
         }
     } failureBlock:^(CLDError *error) {
-        RunBlockOnMainThread(failureBlock, [CLDError errorWithCode:CLDErrorCodeResourceNotFound]);
+        RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeResourceNotFound]);
     }];
+    return handle;
+}
+
+
+
+
+
+
+
+
+
+
+
+#pragma mark - Batch operations
+
+- (CLDBatchOperation *)copyItems:(NSArray *)items
+                         toPaths:(NSArray *)paths
+                         options:(CLDSessionBatchOptions)options
+                   progressBlock:(void (^)(NSUInteger, NSUInteger))progressBlock
+                 completionBlock:(void (^)(NSArray *))completionBlock {
+    return [self _batchOperationWithItems:items
+                                    paths:paths
+                                  options:options
+                            progressBlock:progressBlock
+                          completionBlock:completionBlock
+                             requestBlock:^CLDRequest *(CLDItem *item, NSString *path, void(^resultBlock)(CLDItem *item), void(^failureBlock)(NSError *error)) {
+        return [self copyItem:item toPath:path resultBlock:resultBlock failureBlock:failureBlock];
+    }];
+}
+
+- (CLDBatchOperation *)moveItems:(NSArray *)items
+                         toPaths:(NSArray *)paths
+                         options:(CLDSessionBatchOptions)options
+                   progressBlock:(void (^)(NSUInteger, NSUInteger))progressBlock
+                 completionBlock:(void (^)(NSArray *))completionBlock {
+    return [self _batchOperationWithItems:items
+                                    paths:paths
+                                  options:options
+                            progressBlock:progressBlock
+                          completionBlock:completionBlock
+                             requestBlock:^CLDRequest *(CLDItem *item, NSString *path, void(^resultBlock)(CLDItem *item), void(^failureBlock)(NSError *error)) {
+        return [self moveItem:item toPath:path resultBlock:resultBlock failureBlock:failureBlock];
+    }];
+}
+
+- (CLDBatchOperation *)deleteItems:(NSArray *)items
+                           options:(CLDSessionBatchOptions)options
+                     progressBlock:(void (^)(NSUInteger, NSUInteger))progressBlock
+                   completionBlock:(void (^)(NSArray *))completionBlock {
+    return [self _batchOperationWithItems:items
+                                    paths:nil
+                                  options:options
+                            progressBlock:progressBlock
+                          completionBlock:completionBlock
+                             requestBlock:^CLDRequest *(CLDItem *item, NSString *path, void(^resultBlock)(CLDItem *item), void(^failureBlock)(NSError *error)) {
+        return [self deleteItem:item resultBlock:resultBlock failureBlock:failureBlock];
+    }];
+}
+
+- (CLDBatchOperation *)undeleteItems:(NSArray *)items
+                             options:(CLDSessionBatchOptions)options
+                       progressBlock:(void (^)(NSUInteger, NSUInteger))progressBlock
+                     completionBlock:(void (^)(NSArray *))completionBlock {
+    return [self _batchOperationWithItems:items
+                                    paths:nil
+                                  options:options
+                            progressBlock:progressBlock
+                          completionBlock:completionBlock
+                             requestBlock:^CLDRequest *(CLDItem *item, NSString *path, void(^resultBlock)(CLDItem *item), void(^failureBlock)(NSError *error)) {
+        return [self undeleteItem:item resultBlock:resultBlock failureBlock:failureBlock];
+    }];
+}
+
+- (CLDBatchOperation *)restoreItems:(NSArray *)items
+                            options:(CLDSessionBatchOptions)options
+                      progressBlock:(void (^)(NSUInteger, NSUInteger))progressBlock
+                    completionBlock:(void (^)(NSArray *))completionBlock {
+    return [self _batchOperationWithItems:items
+                                    paths:nil
+                                  options:options
+                            progressBlock:progressBlock
+                          completionBlock:completionBlock
+                             requestBlock:^CLDRequest *(CLDItem *item, NSString *path, void(^resultBlock)(CLDItem *item), void(^failureBlock)(NSError *error)) {
+        return [self restoreItem:item resultBlock:resultBlock failureBlock:failureBlock];
+    }];
+}
+
+- (CLDBatchOperation *)_batchOperationWithItems:(NSArray *)items
+                                          paths:(NSArray *)paths
+                                        options:(CLDSessionBatchOptions)options
+                                  progressBlock:(void (^)(NSUInteger, NSUInteger))progressBlock
+                                completionBlock:(void (^)(NSArray *))completionBlock
+                                   requestBlock:(CLDBatchOperationRequestBlock)requestBlock {
+    NSParameterAssert(items);
+    NSParameterAssert(paths == nil || paths.count == items.count);
+    CLDBatchOperation *batchOperation = [[CLDBatchOperation alloc] initWithSession:self
+                                                                             items:items
+                                                                             paths:paths
+                                                                           options:options
+                                                                      requestBlock:requestBlock];
+    batchOperation.progressBlock = progressBlock;
+    batchOperation.completionBlock = completionBlock;
+    batchOperation.callbackQueue = [self _currentCallbackQueue];
+    batchOperation.lane = [self _currentRequestLane];
+    [batchOperation start];
+    return batchOperation;
 }
 
 
@@ -864,59 +1455,68 @@ static CLDSession *_defaultSession = nil;
 
 #pragma mark - Public Links
 
-- (void)fetchPublicLinksWithResultBlock:(void (^)(NSArray *))resultBlock
-                           failureBlock:(void (^)(NSError *))failureBlock {
+- (CLDRequest *)fetchPublicLinksWithResultBlock:(void (^)(NSArray *))resultBlock
+                                   failureBlock:(void (^)(NSError *))failureBlock {
+    dispatch_queue_t callbackQueue = [self _currentCallbackQueue];
+    CLDRequest *handle = [CLDRequest new];
     NSURL *url = [self _serviceURLForEndpoint:CLDSessionEndpointPublicAPI path:@"ListLinks"];
     NSURLRequest *request = [self _signedMutableURLRequestWithURL:url];
-    [self _performJSONRequest:request successBlock:^(id object) {
+    [self _performJSONRequest:request handle:handle successBlock:^(id object) {
         if ([object isKindOfClass:[NSArray class]]) {
             NSMutableArray *links = [NSMutableArray new];
             for (NSDictionary *linkDictionary in object) {
                 CLDLink *link = [CLDLink linkWithDictionary:linkDictionary session:self];
                 if (link) [links addObject:link];
             }
-            RunBlockOnMainThread(resultBlock, [NSArray arrayWithArray:links]);
+            RunRequestBlockOnQueue(handle, callbackQueue, resultBlock, [NSArray arrayWithArray:links]);
         } else {
-            RunBlockOnMainThread(failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
+            RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
         }
     } failureBlock:^(CLDError *error) {
-        RunBlockOnMainThread(failureBlock, error);
+        RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, error);
     }];
+    return handle;
 }
 
-- (void)fetchPublicLinkForItem:(CLDItem *)item
-                   resultBlock:(void (^)(CLDLink *))resultBlock
-                  failureBlock:(void (^)(NSError *))failureBlock {
+- (CLDRequest *)fetchPublicLinkForItem:(CLDItem *)item
+                           resultBlock:(void (^)(CLDLink *))resultBlock
+                          failureBlock:(void (^)(NSError *))failureBlock {
     NSParameterAssert(item);
+    dispatch_queue_t callbackQueue = [self _currentCallbackQueue];
+    CLDRequest *handle = [CLDRequest new];
     NSString *urlString = [NSString stringWithFormat:@"Shares/%@/%@", self.accessMode, item.trimmedPath];
     NSURL *url = [self _serviceURLForEndpoint:CLDSessionEndpointPublicAPI path:urlString];
     NSMutableURLRequest *request = [self _signedMutableURLRequestWithURL:url];
     request.HTTPMethod = @"POST";
-    [self _performJSONRequest:request successBlock:^(id object) {
+    [self _performJSONRequest:request handle:handle successBlock:^(id object) {
         CLDLink *link = [CLDLink linkWithDictionary:object session:self];
         if (link) {
-            RunBlockOnMainThread(resultBlock, link);
+            RunRequestBlockOnQueue(handle, callbackQueue, resultBlock, link);
         } else {
-            RunBlockOnMainThread(failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
+            RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
         }
     } failureBlock:^(CLDError *error) {
-        RunBlockOnMainThread(failureBlock, error);
+        RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, error);
     }];
+    return handle;
 }
 
-- (void)deletePublicLink:(CLDLink *)link
-             resultBlock:(void (^)())resultBlock
-            failureBlock:(void (^)(NSError *))failureBlock {
+- (CLDRequest *)deletePublicLink:(CLDLink *)link
+                     resultBlock:(void (^)())resultBlock
+                    failureBlock:(void (^)(NSError *))failureBlock {
     NSParameterAssert(link);
+    dispatch_queue_t callbackQueue = [self _currentCallbackQueue];
+    CLDRequest *handle = [CLDRequest new];
     NSURL *url = [self _serviceURLForEndpoint:CLDSessionEndpointPublicAPI path:@"DeleteLink"];
     NSMutableURLRequest *request = [self _signedMutableURLRequestWithURL:url];
     request.HTTPMethod = @"POST";
     request.HTTPBody = [self _postDataWithDictionary:@{@"shareid":link.shareId}];
-    [self _performRequest:request successBlock:^(NSData *data) {
-        RunBlockOnMainThread(resultBlock);
+    [self _performRequest:request handle:handle successBlock:^(NSData *data) {
+        RunRequestBlockOnQueue(handle, callbackQueue, resultBlock);
     } failureBlock:^(CLDError *error) {
-        RunBlockOnMainThread(failureBlock, error);
+        RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, error);
     }];
+    return handle;
 }
 
 
@@ -931,51 +1531,57 @@ static CLDSession *_defaultSession = nil;
 
 #pragma mark - Upload Links (Upload2Me)
 
-- (void)fetchUploadLinksWithResultBlock:(void (^)(NSArray *))resultBlock
-                           failureBlock:(void (^)(NSError *))failureBlock {
+- (CLDRequest *)fetchUploadLinksWithResultBlock:(void (^)(NSArray *))resultBlock
+                                   failureBlock:(void (^)(NSError *))failureBlock {
+    dispatch_queue_t callbackQueue = [self _currentCallbackQueue];
+    CLDRequest *handle = [CLDRequest new];
     NSURL *url = [self _serviceURLForEndpoint:CLDSessionEndpointPublicAPI path:@"ListUploadLinks"];
     NSURLRequest *request = [self _signedMutableURLRequestWithURL:url];
-    [self _performJSONRequest:request successBlock:^(id object) {
+    [self _performJSONRequest:request handle:handle successBlock:^(id object) {
         if ([object isKindOfClass:[NSArray class]]) {
             NSMutableArray *links = [NSMutableArray new];
             for (NSDictionary *linkDictionary in object) {
                 CLDLink *link = [CLDLink uploadLinkWithDictionary:linkDictionary session:self];
                 if (link) [links addObject:link];
             }
-            RunBlockOnMainThread(resultBlock, [NSArray arrayWithArray:links]);
+            RunRequestBlockOnQueue(handle, callbackQueue, resultBlock, [NSArray arrayWithArray:links]);
         } else {
-            RunBlockOnMainThread(failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
+            RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
         }
     } failureBlock:^(CLDError *error) {
-        RunBlockOnMainThread(failureBlock, error);
+        RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, error);
     }];
+    return handle;
 }
 
-- (void)fetchUploadLinkForItem:(CLDItem *)item
-                   resultBlock:(void (^)(CLDLink *))resultBlock
-                  failureBlock:(void (^)(NSError *))failureBlock {
+- (CLDRequest *)fetchUploadLinkForItem:(CLDItem *)item
+                           resultBlock:(void (^)(CLDLink *))resultBlock
+                          failureBlock:(void (^)(NSError *))failureBlock {
     NSParameterAssert(item);
     NSParameterAssert(item.type == CLDItemTypeFolder);
+    dispatch_queue_t callbackQueue = [self _currentCallbackQueue];
+    CLDRequest *handle = [CLDRequest new];
     NSString *urlString = [NSString stringWithFormat:@"UploadLink/%@/%@", self.accessMode, item.trimmedPath];
     NSURL *url = [self _serviceURLForEndpoint:CLDSessionEndpointPublicAPI path:urlString];
     NSMutableURLRequest *request = [self _signedMutableURLRequestWithURL:url];
     request.HTTPMethod = @"POST";
-    [self _performJSONRequest:request successBlock:^(id object) {
+    [self _performJSONRequest:request handle:handle successBlock:^(id object) {
         CLDLink *link = [CLDLink uploadLinkWithDictionary:object session:self];
         if (link) {
-            RunBlockOnMainThread(resultBlock, link);
+            RunRequestBlockOnQueue(handle, callbackQueue, resultBlock, link);
         } else {
-            RunBlockOnMainThread(failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
+            RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
         }
     } failureBlock:^(CLDError *error) {
-        RunBlockOnMainThread(failureBlock, error);
+        RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, error);
     }];
+    return handle;
 }
 
-- (void)deleteUploadLink:(CLDLink *)link
-             resultBlock:(void (^)())resultBlock
-            failureBlock:(void (^)(NSError *))failureBlock {
-    [self deletePublicLink:link resultBlock:resultBlock failureBlock:failureBlock];
+- (CLDRequest *)deleteUploadLink:(CLDLink *)link
+                     resultBlock:(void (^)())resultBlock
+                    failureBlock:(void (^)(NSError *))failureBlock {
+    return [self deletePublicLink:link resultBlock:resultBlock failureBlock:failureBlock];
 }
 
 
@@ -990,11 +1596,13 @@ static CLDSession *_defaultSession = nil;
 
 #pragma mark - Shared Folders
 
-- (void)fetchSharedItemsWithResultBlock:(void (^)(NSArray *))resultBlock
-                           failureBlock:(void (^)(NSError *))failureBlock {
+- (CLDRequest *)fetchSharedItemsWithResultBlock:(void (^)(NSArray *))resultBlock
+                                   failureBlock:(void (^)(NSError *))failureBlock {
+    dispatch_queue_t callbackQueue = [self _currentCallbackQueue];
+    CLDRequest *handle = [CLDRequest new];
     NSURL *url = [self _serviceURLForEndpoint:CLDSessionEndpointPublicAPI path:@"ListSharedFolders"];
     NSURLRequest *request = [self _signedMutableURLRequestWithURL:url];
-    [self _performJSONRequest:request successBlock:^(id object) {
+    [self _performJSONRequest:request handle:handle successBlock:^(id object) {
         if ([object isKindOfClass:[NSDictionary class]]) {
             NSMutableArray *folders = [NSMutableArray new];
             for (NSString *shareId in object) {
@@ -1003,35 +1611,39 @@ static CLDSession *_defaultSession = nil;
                 CLDSharedFolder *folder = [CLDSharedFolder sharedFolderWithDictionary:folderDictionary];
                 if (folder) [folders addObject:folder];
             }
-            RunBlockOnMainThread(resultBlock, folders);
+            RunRequestBlockOnQueue(handle, callbackQueue, resultBlock, folders);
         } else {
-            RunBlockOnMainThread(failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
+            RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
         }
     } failureBlock:^(CLDError *error) {
-        RunBlockOnMainThread(failureBlock, error);
+        RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, error);
     }];
+    return handle;
 }
 
-- (void)shareItem:(CLDItem *)item
-        withEmail:(NSString *)email
-      resultBlock:(void (^)(NSString *))resultBlock
-     failureBlock:(void (^)(NSError *))failureBlock {
+- (CLDRequest *)shareItem:(CLDItem *)item
+                withEmail:(NSString *)email
+              resultBlock:(void (^)(NSString *))resultBlock
+             failureBlock:(void (^)(NSError *))failureBlock {
     NSParameterAssert(item);
     NSParameterAssert(email);
+    dispatch_queue_t callbackQueue = [self _currentCallbackQueue];
+    CLDRequest *handle = [CLDRequest new];
     NSURL *url = [self _serviceURLForEndpoint:CLDSessionEndpointPublicAPI path:@"ShareFolder"];
     NSMutableURLRequest *request = [self _signedMutableURLRequestWithURL:url];
     request.HTTPMethod = @"POST";
     request.HTTPBody = [self _postDataWithDictionary:@{@"to_email":email}];
-    [self _performJSONRequest:request successBlock:^(id object) {
+    [self _performJSONRequest:request handle:handle successBlock:^(id object) {
         if ([object isKindOfClass:[NSDictionary class]]) {
             NSString *requestId = object[@"req_id"];
-            RunBlockOnMainThread(resultBlock, requestId);
+            RunRequestBlockOnQueue(handle, callbackQueue, resultBlock, requestId);
         } else {
-            RunBlockOnMainThread(failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
+            RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
         }
     } failureBlock:^(CLDError *error) {
-        RunBlockOnMainThread(failureBlock, error);
+        RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, error);
     }];
+    return handle;
 }
 
 
@@ -1046,42 +1658,44 @@ static CLDSession *_defaultSession = nil;
 
 #pragma mark - Search
 
-- (void)searchItem:(CLDItem *)item
-             query:(NSString *)query
-       resultBlock:(void (^)(NSArray *))resultBlock
-      failureBlock:(void (^)(NSError *))failureBlock {
-    [self searchItem:item query:query limit:1000 resultBlock:resultBlock failureBlock:failureBlock];
-}
-
-- (void)searchItem:(CLDItem *)item
-             query:(NSString *)query
-             limit:(NSUInteger)limit
-       resultBlock:(void (^)(NSArray *))resultBlock
-      failureBlock:(void (^)(NSError *))failureBlock {
-    [self searchItem:item query:query limit:limit mimeType:nil resultBlock:resultBlock failureBlock:failureBlock];
-}
-
-- (void)searchItem:(CLDItem *)item
-             query:(NSString *)query
-             limit:(NSUInteger)limit
-          mimeType:(NSString *)mimeType
-       resultBlock:(void (^)(NSArray *))resultBlock
-      failureBlock:(void (^)(NSError *))failureBlock {
-    [self searchItem:item query:query limit:limit mimeType:mimeType includeDeletedItems:NO resultBlock:resultBlock failureBlock:failureBlock];
-}
-
-- (void)searchItem:(CLDItem *)item
-             query:(NSString *)query
-             limit:(NSUInteger)limit
-          mimeType:(NSString *)mimeType
-includeDeletedItems:(BOOL)includeDeletedItems
-       resultBlock:(void (^)(NSArray *))resultBlock
-      failureBlock:(void (^)(NSError *))failureBlock {
+- (CLDRequest *)searchItem:(CLDItem *)item
+                     query:(NSString *)query
+               resultBlock:(void (^)(NSArray *))resultBlock
+              failureBlock:(void (^)(NSError *))failureBlock {
+    return [self searchItem:item query:query limit:1000 resultBlock:resultBlock failureBlock:failureBlock];
+}
+
+- (CLDRequest *)searchItem:(CLDItem *)item
+                     query:(NSString *)query
+                     limit:(NSUInteger)limit
+               resultBlock:(void (^)(NSArray *))resultBlock
+              failureBlock:(void (^)(NSError *))failureBlock {
+    return [self searchItem:item query:query limit:limit mimeType:nil resultBlock:resultBlock failureBlock:failureBlock];
+}
+
+- (CLDRequest *)searchItem:(CLDItem *)item
+                     query:(NSString *)query
+                     limit:(NSUInteger)limit
+                  mimeType:(NSString *)mimeType
+               resultBlock:(void (^)(NSArray *))resultBlock
+              failureBlock:(void (^)(NSError *))failureBlock {
+    return [self searchItem:item query:query limit:limit mimeType:mimeType includeDeletedItems:NO resultBlock:resultBlock failureBlock:failureBlock];
+}
+
+- (CLDRequest *)searchItem:(CLDItem *)item
+                     query:(NSString *)query
+                     limit:(NSUInteger)limit
+                  mimeType:(NSString *)mimeType
+       includeDeletedItems:(BOOL)includeDeletedItems
+               resultBlock:(void (^)(NSArray *))resultBlock
+              failureBlock:(void (^)(NSError *))failureBlock {
     NSParameterAssert(query);
     NSParameterAssert(query.length >= 3);
     NSParameterAssert(query.length <= 20);
     NSParameterAssert(limit >= 1);
     NSParameterAssert(limit <= 25000);
+    dispatch_queue_t callbackQueue = [self _currentCallbackQueue];
+    CLDRequest *handle = [CLDRequest new];
     NSString *urlString = [NSString stringWithFormat:@"Search/<mode>/%@", item.trimmedPath];
     NSURL *url = [self _serviceURLForEndpoint:CLDSessionEndpointPublicAPI path:urlString];
     NSMutableURLRequest *request = [self _signedMutableURLRequestWithURL:url];
@@ -1094,21 +1708,95 @@ includeDeletedItems:(BOOL)includeDeletedItems
     parameters[@"include_deleted"] = [NSNumber numberWithBool:includeDeletedItems];
     request.HTTPBody = [self _postDataWithDictionary:parameters];
     
-    [self _performJSONRequest:request successBlock:^(id object) {
+    [self _performJSONRequest:request handle:handle successBlock:^(id object) {
         if ([object isKindOfClass:[NSArray class]]) {
             NSMutableArray *items = [NSMutableArray new];
             for (NSDictionary *itemDictionary in object) {
                 CLDItem *item = [CLDItem itemWithDictionary:itemDictionary session:self];
                 if (item) [items addObject:item];
             }
-            RunBlockOnMainThread(resultBlock, items);
+            [self.searchIndex indexItems:items];
+            RunRequestBlockOnQueue(handle, callbackQueue, resultBlock, items);
         } else {
-            RunBlockOnMainThread(failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
+            RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
         }
     } failureBlock:^(CLDError *error) {
-        RunBlockOnMainThread(failureBlock, error);
+        RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, error);
     }];
+    return handle;
+}
+
+- (CLDRequest *)searchItem:(CLDItem *)item
+                     query:(NSString *)query
+                     match:(CLDSearchIndexMatch)match
+                     limit:(NSUInteger)limit
+                  mimeType:(NSString *)mimeType
+               resultBlock:(void (^)(NSArray *))resultBlock
+              failureBlock:(void (^)(NSError *))failureBlock {
+    NSParameterAssert(item);
+    NSParameterAssert(query.length > 0);
+    NSParameterAssert(limit <= 25000);
+    dispatch_queue_t callbackQueue = [self _currentCallbackQueue];
+    CLDRequestLane lane = [self _currentRequestLane];
+    CLDRequest *handle = [CLDRequest new];
+    CLDSearchIndex *searchIndex = self.searchIndex;
+    
+    // the server only matches substrings of 3 to 20 characters, anything else can only be answered locally
+    BOOL searchableOnServer = (match == CLDSearchIndexMatchSubstring && query.length >= 3 && query.length <= 20);
+    void(^searchServer)() = ^{
+        // blocks below already run on the callback queue
+        __block CLDRequest *request = nil;
+        [self performWithCallbackQueue:callbackQueue block:^{
+            [self performInRequestLane:lane block:^{
+                request = [self searchItem:item query:query limit:(limit > 0 ? limit : 1000) mimeType:mimeType resultBlock:^(NSArray *items) {
+                    if (!handle.isCancelled && resultBlock) resultBlock(items);
+                } failureBlock:^(NSError *error) {
+                    if (searchIndex == nil || ![CLDMutationQueue isConnectivityError:error]) {
+                        if (!handle.isCancelled && failureBlock) failureBlock(error);
+                        return;
+                    }
+                    // without network access, whatever the index knows is better than nothing
+                    [searchIndex queryItemsInFolder:item matchingQuery:query match:match mimeType:mimeType limit:limit onlyIfIndexed:NO block:^(NSArray *items) {
+                        RunRequestBlockOnQueue(handle, callbackQueue, resultBlock, items);
+                    }];
+                }];
+            }];
+        }];
+        handle.cancellationHandler = ^{
+            [request cancel];
+        };
+    };
     
+    if (searchIndex == nil) {
+        if (searchableOnServer) searchServer();
+        else RunRequestBlockOnQueue(handle, callbackQueue, resultBlock, @[]);
+        return handle;
+    }
+    
+    // the query runs on the index queue, which may be busy indexing a crawl
+    [searchIndex queryItemsInFolder:item matchingQuery:query match:match mimeType:mimeType limit:limit onlyIfIndexed:searchableOnServer block:^(NSArray *items) {
+        if (items) RunRequestBlockOnQueue(handle, callbackQueue, resultBlock, items);
+        else if (!handle.isCancelled) searchServer();
+    }];
+    return handle;
+}
+
+- (CLDSearchSession *)searchSessionForItem:(CLDItem *)item
+                                  mimeType:(NSString *)mimeType
+                       includeDeletedItems:(BOOL)includeDeletedItems
+                               resultBlock:(void (^)(NSString *, NSArray *))resultBlock
+                              failureBlock:(void (^)(NSString *, NSError *))failureBlock {
+    NSParameterAssert(item);
+    NSParameterAssert(item.type == CLDItemTypeFolder);
+    
+    // results are shared between search sessions, but not between accounts
+    NSCache *resultCache = self.searchResultCache ?: [NSCache new];
+    CLDSearchSession *searchSession = [[CLDSearchSession alloc] initWithSession:self item:item mimeType:mimeType
+                                                            includeDeletedItems:includeDeletedItems resultCache:resultCache];
+    searchSession.callbackQueue = [self _currentCallbackQueue];
+    searchSession.resultBlock = resultBlock;
+    searchSession.failureBlock = failureBlock;
+    return searchSession;
 }
 
 
@@ -1123,54 +1811,79 @@ includeDeletedItems:(BOOL)includeDeletedItems
 
 #pragma mark - Accessing items
 
-- (void)fetchThumbnailForItem:(CLDItem *)item
-                       format:(CLDItemThumbnailFormat)format
-                         size:(CLDItemThumbnailSize)size
-                   cropToSize:(BOOL)cropToSize
-                  resultBlock:(void (^)(CLDImage *))resultBlock
-                 failureBlock:(void (^)(NSError *))failureBlock {
+- (CLDRequest *)fetchThumbnailForItem:(CLDItem *)item
+                               format:(CLDItemThumbnailFormat)format
+                                 size:(CLDItemThumbnailSize)size
+                           cropToSize:(BOOL)cropToSize
+                          resultBlock:(void (^)(CLDImage *))resultBlock
+                         failureBlock:(void (^)(NSError *))failureBlock {
     NSParameterAssert(item);
+    dispatch_queue_t callbackQueue = [self _currentCallbackQueue];
+    CLDRequest *handle = [CLDRequest new];
     
-    NSString *urlString = [NSString stringWithFormat:@"Thumbnails/<mode>/%@", item.trimmedPath];
-    NSMutableDictionary *query = [NSMutableDictionary new];
-    switch (format) {
-        case CLDItemThumbnailFormatJPEG: query[@"format"] = @"jpeg"; break;
-        case CLDItemThumbnailFormatPNG: query[@"format"] = @"png"; break;
-    }
-    switch (size) {
-        case CLDItemThumbnailSizeXS: query[@"size"] = @"xs"; break;
-        case CLDItemThumbnailSizeS: query[@"size"] = @"s"; break;
-        case CLDItemThumbnailSizeM: query[@"size"] = @"m"; break;
-        case CLDItemThumbnailSizeL: query[@"size"] = @"l"; break;
-        case CLDItemThumbnailSizeXL: query[@"size"] = @"xl"; break;
+    CLDThumbnailCacheLoadBlock loadBlock = [self _thumbnailLoadBlockForItem:item format:format size:size cropToSize:cropToSize];
+    CLDThumbnailCache *thumbnailCache = self.thumbnailCache;
+    NSString *key = [self _thumbnailKeyForItem:item format:format size:size cropToSize:cropToSize];
+    if (thumbnailCache && key) {
+        // the cache already calls back on callbackQueue, only the cancellation check is missing
+        id token = [thumbnailCache fetchThumbnailWithKey:key callbackQueue:callbackQueue loadBlock:loadBlock resultBlock:^(CLDImage *thumbnail) {
+            if (!handle.isCancelled && resultBlock) resultBlock(thumbnail);
+        } failureBlock:^(NSError *error) {
+            if (!handle.isCancelled && failureBlock) failureBlock(error);
+        }];
+        handle.cancellationHandler = ^{
+            [thumbnailCache cancelFetchWithKey:key token:token];
+        };
+        return handle;
     }
-    query[@"crop"] = @(cropToSize);
-    
-    NSURL *url = [self _serviceURLForEndpoint:CLDSessionEndpointPublicAPI path:urlString query:query];
-    NSURLRequest *request = [self _signedMutableURLRequestWithURL:url];
     
-    [self _performRequest:request successBlock:^(NSData *data) {
-        CLDImage *thumbnail = [[CLDImage alloc] initWithData:data];
+    CLDRequest *request = loadBlock(^(NSData *data) {
+        CLDImage *thumbnail = [CLDThumbnailCache decodedImageWithData:data cost:NULL];
         if (thumbnail) {
-            RunBlockOnMainThread(resultBlock, thumbnail);
+            RunRequestBlockOnQueue(handle, callbackQueue, resultBlock, thumbnail);
         } else {
-            RunBlockOnMainThread(failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
+            RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
         }
-    } failureBlock:^(CLDError *error) {
-        if (error.statusCode == 415) {
-            RunBlockOnMainThread(failureBlock, [CLDError errorWithCode:CLDErrorCodeServerCouldNotCreateThumbnail]);
-        } else {
-            RunBlockOnMainThread(failureBlock, error);
-        }
-    }];
+    }, ^(NSError *error) {
+        RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, error);
+    });
+    handle.cancellationHandler = ^{
+        [request cancel];
+    };
+    return handle;
 }
 
-- (void)fetchURLForItem:(CLDItem *)item
-    transcodeIfPossible:(BOOL)transcode
-            resultBlock:(void(^)(NSURL *url, NSURL *transcodingURL, NSDate *expireDate))resultBlock
-           failureBlock:(void(^)(NSError *error))failureBlock {
+- (CLDRequest *)fetchURLForItem:(CLDItem *)item
+            transcodeIfPossible:(BOOL)transcode
+                    resultBlock:(void(^)(NSURL *url, NSURL *transcodingURL, NSDate *expireDate))resultBlock
+                   failureBlock:(void(^)(NSError *error))failureBlock {
     NSParameterAssert(item);
     NSParameterAssert(item.type == CLDItemTypeFile);
+    dispatch_queue_t callbackQueue = [self _currentCallbackQueue];
+    CLDRequest *handle = [CLDRequest new];
+    CLDExpiringCache *cache = self.mediaURLCache;
+    if (cache == nil) {
+        RunBlockOnQueue(callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeSessionNotLinked]);
+        return handle;
+    }
+    
+    NSString *key = [NSString stringWithFormat:@"%@\n%@\n%d", item.path.lowercaseString, item.revision ?: @"", transcode];
+    [cache valuesForKey:key handle:handle callbackQueue:callbackQueue loadBlock:^CLDRequest *(CLDExpiringCacheResultBlock cacheResultBlock, void (^cacheFailureBlock)(NSError *)) {
+        return [self _fetchURLForItem:item transcodeIfPossible:transcode resultBlock:^(NSURL *url, NSURL *transcodingURL, NSDate *expireDate) {
+            cacheResultBlock(transcodingURL ? @[url, transcodingURL] : @[url], expireDate);
+        } failureBlock:cacheFailureBlock];
+    } resultBlock:^(NSArray *values, NSDate *expireDate) {
+        RunBlock(resultBlock, values[0], values.count > 1 ? values[1] : nil, expireDate);
+    } failureBlock:failureBlock];
+    return handle;
+}
+
+- (CLDRequest *)_fetchURLForItem:(CLDItem *)item
+             transcodeIfPossible:(BOOL)transcode
+                     resultBlock:(void(^)(NSURL *url, NSURL *transcodingURL, NSDate *expireDate))resultBlock
+                    failureBlock:(void(^)(NSError *error))failureBlock {
+    dispatch_queue_t callbackQueue = [self _currentCallbackQueue];
+    CLDRequest *handle = [CLDRequest new];
     
     NSString *urlString = [NSString stringWithFormat:@"Media/<mode>/%@", item.trimmedPath];
     NSURL *url = [self _serviceURLForEndpoint:CLDSessionEndpointPublicAPI path:urlString];
@@ -1182,19 +1895,42 @@ includeDeletedItems:(BOOL)includeDeletedItems
         request.HTTPBody = [self _postDataWithDictionary:params];
     }
     
-    [self _performJSONRequest:request successBlock:^(id object) {
-        if ([object isKindOfClass:[NSDictionary class]] &&
-            object[@"url"] && object[@"expires"]) {
-            NSURL *url = [NSURL URLWithString:object[@"url"]];
-            NSURL *transcodingURL = object[@"transcode_url"] ? [NSURL URLWithString:object[@"transcode_url"]] : nil;
-            NSDate *date = [[NSDateFormatter serviceDateFormatter] dateFromString:object[@"expires"]];
-            RunBlockOnMainThread(resultBlock, url, transcodingURL, date);
+    [self _performJSONRequest:request handle:handle successBlock:^(id object) {
+        NSDictionary *dictionary = [object isKindOfClass:[NSDictionary class]] ? object : nil;
+        NSString *urlString = dictionary[@"url"];
+        NSString *transcodingURLString = dictionary[@"transcode_url"];
+        NSURL *url = [urlString isKindOfClass:[NSString class]] ? [NSURL URLWithString:urlString] : nil;
+        NSURL *transcodingURL = [transcodingURLString isKindOfClass:[NSString class]] ? [NSURL URLWithString:transcodingURLString] : nil;
+        NSDate *date = [NSDateFormatter serviceDateFromString:dictionary[@"expires"]];
+        // the URLs end up in the media URL cache, which cannot hold nil
+        if (url && date) {
+            RunRequestBlockOnQueue(handle, callbackQueue, resultBlock, url, transcodingURL, date);
         } else {
-            RunBlockOnMainThread(failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
+            RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
         }
     } failureBlock:^(CLDError *error) {
-        RunBlockOnMainThread(failureBlock, error);
+        RunRequestBlockOnQueue(handle, callbackQueue, failureBlock, error);
     }];
+    return handle;
+}
+
+- (CLDRequest *)openRemoteFileForItem:(CLDItem *)item
+                          resultBlock:(void (^)(CLDRemoteFile *))resultBlock
+                         failureBlock:(void (^)(NSError *))failureBlock {
+    NSParameterAssert(item);
+    NSParameterAssert(item.type == CLDItemTypeFile);
+    dispatch_queue_t callbackQueue = [self _currentCallbackQueue];
+    
+    // the file is pinned to the latest revision, its size has to be known as well
+    return [self fetchItem:item options:CLDSessionFetchItemOptionNone resultBlock:^(CLDItem *fetchedItem) {
+        if (fetchedItem.isDeleted || fetchedItem.type != CLDItemTypeFile || fetchedItem.revision == nil) {
+            RunBlock(failureBlock, [CLDError errorWithCode:CLDErrorCodeResourceNotFound]);
+            return;
+        }
+        CLDRemoteFile *file = [[CLDRemoteFile alloc] initWithSession:self item:fetchedItem];
+        file.callbackQueue = callbackQueue;
+        RunBlock(resultBlock, file);
+    } failureBlock:failureBlock];
 }
 
 
@@ -1215,6 +1951,7 @@ includeDeletedItems:(BOOL)includeDeletedItems
                   resultBlock:(void (^)(NSURL *))resultBlock
                  failureBlock:(void (^)(NSError *))failureBlock {
     NSParameterAssert(item);
+    dispatch_queue_t callbackQueue = [self _currentCallbackQueue];
     NSError *error = nil;
     CLDTransfer *transfer = [self.transferManager scheduleDownloadForItem:item
                                                                background:NO
@@ -1222,14 +1959,43 @@ includeDeletedItems:(BOOL)includeDeletedItems
                                                                  priority:priority
                                                                     error:&error];
     if (transfer) {
+        transfer.callbackQueue = callbackQueue;
         transfer.downloadResultBlock = resultBlock;
         transfer.failureBlock = failureBlock;
     } else {
-        RunBlockOnMainThread(failureBlock, error);
+        RunBlockOnQueue(callbackQueue, failureBlock, error);
     }
     return transfer;
 }
 
+- (CLDDownloadStream *)streamItem:(CLDItem *)item
+                     cacheFileURL:(NSURL *)cacheFileURL
+                        dataBlock:(void (^)(NSData *))dataBlock
+                      resultBlock:(void (^)())resultBlock
+                     failureBlock:(void (^)(NSError *))failureBlock {
+    NSParameterAssert(item);
+    NSParameterAssert(dataBlock);
+    CLDDownloadStream *stream = [[CLDDownloadStream alloc] initWithSession:self item:item cacheFileURL:cacheFileURL dataBlock:dataBlock];
+    stream.callbackQueue = [self _currentCallbackQueue];
+    stream.resultBlock = resultBlock;
+    stream.failureBlock = failureBlock;
+    [stream start];
+    return stream;
+}
+
+- (CLDDownloadStream *)openInputStreamForItem:(CLDItem *)item
+                                 cacheFileURL:(NSURL *)cacheFileURL
+                                  resultBlock:(void (^)())resultBlock
+                                 failureBlock:(void (^)(NSError *))failureBlock {
+    NSParameterAssert(item);
+    CLDDownloadStream *stream = [[CLDDownloadStream alloc] initWithSession:self item:item cacheFileURL:cacheFileURL dataBlock:nil];
+    stream.callbackQueue = [self _currentCallbackQueue];
+    stream.resultBlock = resultBlock;
+    stream.failureBlock = failureBlock;
+    [stream start];
+    return stream;
+}
+
 - (CLDTransfer *)uploadItem:(CLDItem *)item
             shouldOverwrite:(BOOL)overwrite
              cellularAccess:(BOOL)cellularAccess
@@ -1237,6 +2003,7 @@ includeDeletedItems:(BOOL)includeDeletedItems
                 resultBlock:(void (^)(CLDItem *))resultBlock
                failureBlock:(void (^)(NSError *))failureBlock {
     NSParameterAssert(item);
+    dispatch_queue_t callbackQueue = [self _currentCallbackQueue];
     NSError *error = nil;
     CLDTransfer *transfer = [self.transferManager scheduleUploadForItem:item
                                                               overwrite:overwrite
@@ -1245,10 +2012,11 @@ includeDeletedItems:(BOOL)includeDeletedItems
                                                                priority:priority
                                                                   error:&error];
     if (transfer) {
+        transfer.callbackQueue = callbackQueue;
         transfer.uploadResultBlock = resultBlock;
         transfer.failureBlock = failureBlock;
     } else {
-        RunBlockOnMainThread(failureBlock, error);
+        RunBlockOnQueue(callbackQueue, failureBlock, error);
     }
     return transfer;
 }
@@ -1307,12 +2075,30 @@ includeDeletedItems:(BOOL)includeDeletedItems
 
 #pragma mark - Polling for updates
 
+- (BOOL)isPollingForDeltaUpdates {
+    @synchronized(self) {
+        return self.deltaPoller.isPolling;
+    }
+}
+
 - (void)startPollingForDeltaUpdatesWithResultBlock:(void (^)())resultBlock failureBlock:(void (^)(NSError *))failureBlock {
-    [NSException raise:NSGenericException format:@"startPollingForDeltaUpdatesWithResultBlock:failureBlock: is not yet implemented."];
+    dispatch_queue_t callbackQueue = [self _currentCallbackQueue];
+    if (!self.isLinked) {
+        RunBlockOnQueue(callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeSessionNotLinked]);
+        return;
+    }
+    CLDDeltaPoller *deltaPoller = nil;
+    @synchronized(self) {
+        if (self.deltaPoller == nil) self.deltaPoller = [[CLDDeltaPoller alloc] initWithSession:self];
+        deltaPoller = self.deltaPoller;
+    }
+    [deltaPoller startWithResultBlock:resultBlock failureBlock:failureBlock];
 }
 
 - (void)stopPollingForDeltaUpdates {
-    [NSException raise:NSGenericException format:@"stopPollingForDeltaUpdates is not yet implemented."];
+    @synchronized(self) {
+        [self.deltaPoller stop];
+    }
 }
 
 
@@ -1327,19 +2113,72 @@ includeDeletedItems:(BOOL)includeDeletedItems
 
 #pragma mark - Private methods
 
+// identifies a thumbnail in the cache, nil when there is no way to tell whether a cached copy is stale
+- (NSString *)_thumbnailKeyForItem:(CLDItem *)item
+                            format:(CLDItemThumbnailFormat)format
+                              size:(CLDItemThumbnailSize)size
+                        cropToSize:(BOOL)cropToSize {
+    if (item.path == nil || item.revision == nil) return nil;
+    return [NSString stringWithFormat:@"%@\n%@\n%d\n%d\n%d", item.path.lowercaseString, item.revision, (int)format, (int)size, cropToSize];
+}
+
+- (CLDThumbnailCacheLoadBlock)_thumbnailLoadBlockForItem:(CLDItem *)item
+                                                  format:(CLDItemThumbnailFormat)format
+                                                    size:(CLDItemThumbnailSize)size
+                                              cropToSize:(BOOL)cropToSize {
+    NSString *urlString = [NSString stringWithFormat:@"Thumbnails/<mode>/%@", item.trimmedPath];
+    NSMutableDictionary *query = [NSMutableDictionary new];
+    switch (format) {
+        case CLDItemThumbnailFormatJPEG: query[@"format"] = @"jpeg"; break;
+        case CLDItemThumbnailFormatPNG: query[@"format"] = @"png"; break;
+    }
+    switch (size) {
+        case CLDItemThumbnailSizeXS: query[@"size"] = @"xs"; break;
+        case CLDItemThumbnailSizeS: query[@"size"] = @"s"; break;
+        case CLDItemThumbnailSizeM: query[@"size"] = @"m"; break;
+        case CLDItemThumbnailSizeL: query[@"size"] = @"l"; break;
+        case CLDItemThumbnailSizeXL: query[@"size"] = @"xl"; break;
+    }
+    query[@"crop"] = @(cropToSize);
+    
+    NSURL *url = [self _serviceURLForEndpoint:CLDSessionEndpointPublicAPI path:urlString query:query];
+    NSURLRequest *request = [self _signedMutableURLRequestWithURL:url];
+    
+    return ^CLDRequest *(void(^successBlock)(NSData *data), void(^failureBlock)(NSError *error)) {
+        return [self _performRequest:request successBlock:successBlock failureBlock:^(CLDError *error) {
+            if (error.statusCode == 415) {
+                failureBlock([CLDError errorWithCode:CLDErrorCodeServerCouldNotCreateThumbnail]);
+            } else {
+                failureBlock(error);
+            }
+        }];
+    };
+}
+
 // convenience method to get strings for sandbox and full access modes
 - (NSString *)accessMode {
     return self.sandbox ? [self _accessModeSandbox] : [self _accessModeFullAccess];
 }
 
 // perform a service request and parse the JSON response
-- (void)_performJSONRequest:(NSURLRequest *)request
-              successBlock:(void(^)(id object))successBlock
-              failureBlock:(void(^)(CLDError *error))failureBlock {
-    [self _performRequest:request
+- (CLDRequest *)_performJSONRequest:(NSURLRequest *)request
+                       successBlock:(void(^)(id object))successBlock
+                       failureBlock:(void(^)(CLDError *error))failureBlock {
+    return [self _performJSONRequest:request handle:[CLDRequest new] successBlock:successBlock failureBlock:failureBlock];
+}
+
+- (CLDRequest *)_performJSONRequest:(NSURLRequest *)request
+                             handle:(CLDRequest *)handle
+                       successBlock:(void(^)(id object))successBlock
+                       failureBlock:(void(^)(CLDError *error))failureBlock {
+    return [self _performRequest:request
+                  handle:handle
             successBlock:^(NSData *data) {
+                // cancelled requests never get here, so their responses are not parsed
                 NSError *error = nil;
+                uint64_t traceStart = CLDTraceBegin();
                 id object = [NSJSONSerialization JSONObjectWithData:data options:0 error:&error];
+                CLDTraceEnd(CLDTraceSpanJSONParse, traceStart);
                 if (error == nil) {
                     RunBlock(successBlock, object);
                 } else {
@@ -1350,44 +2189,118 @@ includeDeletedItems:(BOOL)includeDeletedItems
 }
 
 // perform service request with success and failure blocks
-- (void)_performRequest:(NSURLRequest *)request
-          successBlock:(void(^)(NSData *data))successBlock
-          failureBlock:(void(^)(CLDError *error))failureBlock {
+- (CLDRequest *)_performRequest:(NSURLRequest *)request
+                   successBlock:(void(^)(NSData *data))successBlock
+                   failureBlock:(void(^)(CLDError *error))failureBlock {
+    return [self _performRequest:request handle:[CLDRequest new] successBlock:successBlock failureBlock:failureBlock];
+}
+
+// the same handle can be used for several requests in a row, cancelling it cancels the current one
+- (CLDRequest *)_performRequest:(NSURLRequest *)request
+                         handle:(CLDRequest *)handle
+                   successBlock:(void(^)(NSData *data))successBlock
+                   failureBlock:(void(^)(CLDError *error))failureBlock {
     
+    if (handle.isCancelled) return handle;
     if (!self.isLinked) {
         RunBlock(failureBlock, [CLDError errorWithCode:CLDErrorCodeSessionNotLinked]);
-        return;
+        return handle;
     }
     
-    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+    // requests started in performInRequestLane:block: take its lane, unless they were given one already
+    if (handle.lane == CLDRequestLaneDefault) handle.lane = [self _currentRequestLane];
+    [self _scheduleRequest:request handle:handle attempt:0 successBlock:successBlock failureBlock:failureBlock];
+    return handle;
+}
+
+// one attempt of a request, failed attempts are scheduled again as the retry policy sees fit
+- (void)_scheduleRequest:(NSURLRequest *)request
+                  handle:(CLDRequest *)handle
+                 attempt:(NSUInteger)attempt
+            successBlock:(void(^)(NSData *data))successBlock
+            failureBlock:(void(^)(CLDError *error))failureBlock {
+    dispatch_queue_t laneQueue = [CLDRequestScheduler queueForLane:handle.lane];
+    NSString *host = request.URL.host;
+    CFAbsoluteTime scheduleTime = CFAbsoluteTimeGetCurrent();
+    uint64_t queuedTraceStart = CLDTraceBegin();
+    
+    [_requestScheduler scheduleRequest:handle startBlock:^(void(^finishBlock)(CLDRequestOutcome outcome, NSTimeInterval roundTripTime)) {
+        NSTimeInterval waitTime = CFAbsoluteTimeGetCurrent() - scheduleTime;
+        CLDTraceEnd(CLDTraceSpanRequestQueued, queuedTraceStart);
+        if (handle.isCancelled) {
+            finishBlock(CLDRequestOutcomeDropped, -1);
+            return;
+        }
         
-        // check if the token is still valid
+        // fail fast while the service is down
+        if (![CLDRetryPolicy shouldAllowRequestToHost:host]) {
+            finishBlock(CLDRequestOutcomeDropped, -1);
+            RunBlock(failureBlock, [CLDError errorWithCode:CLDErrorCodeServiceUnavailable]);
+            return;
+        }
+        
+        // check if the token is still valid, other requests may be refreshing it already
+        uint64_t refreshTraceStart = CLDTraceBegin();
         [self _refreshCredentialsIfNeeded];
+        CLDTraceEnd(CLDTraceSpanTokenRefresh, refreshTraceStart);
         
         [self incrementNumberOfActiveConnections];
-        [[self.urlSession dataTaskWithRequest:request completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+        CLDTaskTimer *timer = [CLDTaskTimer new];
+        uint64_t networkTraceStart = CLDTraceBegin();
+        NSURLSessionTask *task = [[self _urlSessionForRequest:request] dataTaskWithRequest:request completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+            CLDTraceEnd(CLDTraceSpanNetwork, networkTraceStart);
+            [timer stop];
             [self decrementNumberOfActiveConnections];
-            NSInteger statusCode = ((NSHTTPURLResponse *)response).statusCode;
-            switch (statusCode) {
-                case NSNotFound:
-                    RunBlock(failureBlock, [CLDError errorWithCode:CLDErrorCodeUnknownError]);
-                    break;
-                    
-                case 200:
-                    RunBlock(successBlock, data);
-                    break;
-                    
-                case 401:
-                    RunBlock(failureBlock, [self _errorFromStatusCode:statusCode error:error]);
-                    [self unlinkSessionWithResultBlock:NULL failureBlock:NULL];
-                    break;
-                    
-                default:
-                    RunBlock(failureBlock, [self _errorFromStatusCode:statusCode error:error]);
-                    break;
+            // the timer starts when the task is resumed, so neither waiting in the lane nor refreshing the token counts as round trip time
+            finishBlock(handle.isCancelled ? CLDRequestOutcomeDropped : [CLDRequestScheduler outcomeForResponse:response error:error], timer.totalTime);
+            // before bailing out on cancellation, a cancelled probe would otherwise keep the circuit half open
+            [CLDRetryPolicy recordResponse:response error:error forHost:host];
+            if (handle.isCancelled) return;
+            [_metricsRecorder recordTask:timer.task transfer:NO waitTime:waitTime timeToFirstByte:timer.timeToFirstByte totalTime:timer.totalTime];
+            
+            NSTimeInterval retryDelay = [[CLDRetryPolicy requestPolicy] retryDelayForRequest:request response:response error:error attempt:attempt];
+            if (retryDelay != CLDRetryPolicyNoRetry) {
+                CLDLog(@"Retrying %@ in %.1f seconds (attempt %lu)", request.URL.path, retryDelay, (unsigned long)attempt + 1);
+                [_metricsRecorder recordRetryForRequest:request transfer:NO];
+                dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(retryDelay * NSEC_PER_SEC)), laneQueue, ^{
+                    [self _scheduleRequest:request handle:handle attempt:attempt + 1 successBlock:successBlock failureBlock:failureBlock];
+                });
+                return;
             }
-        }] resume];
-    });
+            
+            // the delegate queue is shared by all lanes, responses are handled with the priority of their own
+            dispatch_async(laneQueue, ^{
+                NSInteger statusCode = ((NSHTTPURLResponse *)response).statusCode;
+                switch (statusCode) {
+                    case NSNotFound:
+                        RunBlock(failureBlock, [CLDError errorWithCode:CLDErrorCodeUnknownError]);
+                        break;
+                        
+                    case 200:
+                    case 206:
+                        RunBlock(successBlock, data);
+                        break;
+                        
+                    case 401:
+                        RunBlock(failureBlock, [self _errorFromStatusCode:statusCode error:error]);
+                        [self unlinkSessionWithResultBlock:NULL failureBlock:NULL];
+                        break;
+                        
+                    default:
+                        RunBlock(failureBlock, [self _errorFromStatusCode:statusCode error:error]);
+                        break;
+                }
+            });
+        }];
+        [timer startWithTask:task];
+        [handle startWithTask:task];
+    }];
+}
+
+// BOOL and char encodings are a single character, so there's no need for strcmp on every query parameter
+static inline BOOL CLDNumberIsBool(NSNumber *number) {
+    const char *type = [number objCType];
+    return type[0] != '\0' && type[1] == '\0' && (type[0] == @encode(BOOL)[0] || type[0] == @encode(char)[0]);
 }
 
 // generate api URL
@@ -1395,14 +2308,18 @@ includeDeletedItems:(BOOL)includeDeletedItems
     return [self _serviceURLForEndpoint:endpoint path:path query:nil];
 }
 - (NSURL *)_serviceURLForEndpoint:(CLDSessionEndpoint)endpoint path:(NSString *)path query:(NSDictionary *)queryParameters {
+    uint64_t traceStart = CLDTraceBegin();
     
 //    path = [path stringByTrimmingCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@"/"]];
     if ([path hasPrefix:@"/"]) path = [path substringFromIndex:1];
-    path = [path stringByReplacingOccurrencesOfString:@"<mode>" withString:self.accessMode];
+    if ([path rangeOfString:@"<mode>"].location != NSNotFound) {
+        path = [path stringByReplacingOccurrencesOfString:@"<mode>" withString:self.accessMode];
+    }
     
     NSURLComponents *components = [NSURLComponents new];
     components.scheme = [self _apiScheme];
     components.host = (endpoint == CLDSessionEndpointPublicAPI) ? [self _apiHost] : [self _apiContentHost];
+    components.port = (endpoint == CLDSessionEndpointPublicAPI) ? [self _apiPort] : [self _apiContentPort];
     components.path = [NSString stringWithFormat:@"/%@/%@", [self _apiVersion], path];
     
     if (queryParameters) {
@@ -1413,10 +2330,7 @@ includeDeletedItems:(BOOL)includeDeletedItems
             // This little dance is required for the BOOL parameters to be converted to "true" or "false" strings
             // The double comparison with bool and char is required to satisfy both iOS 7 and 8
             if ([value isKindOfClass:[NSNumber class]]) {
-                char *valueType = (char*)[value objCType];
-                char *boolType = (char*)@encode(BOOL);
-                char *charType = (char*)@encode(char);
-                if (strcmp(valueType, boolType) == 0 || strcmp(valueType, charType) == 0) {
+                if (CLDNumberIsBool(value)) {
                     value = [value boolValue]==YES ? @"true" : @"false";
                 } else {
                     value = [value stringValue];
@@ -1425,12 +2339,15 @@ includeDeletedItems:(BOOL)includeDeletedItems
                 value = [self _escapedURLQueryArgumentFromString:value];
             }
             
-            [query appendFormat:@"%@=%@&", key, value];
+            if (query.length > 0) [query appendString:@"&"];
+            [query appendFormat:@"%@=%@", key, value];
         }
-        components.percentEncodedQuery = [query stringByTrimmingCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@"&"]];
+        components.percentEncodedQuery = query;
     }
     
-    return components.URL;
+    NSURL *url = components.URL;
+    CLDTraceEnd(CLDTraceSpanURLBuild, traceStart);
+    return url;
 }
 
 // escape string so it can be safely used in query strings
@@ -1448,11 +2365,13 @@ includeDeletedItems:(BOOL)includeDeletedItems
 // generate a signed mutable URL request
 - (NSMutableURLRequest *)_signedMutableURLRequestWithURL:(NSURL *)url {
     NSParameterAssert(url);
+    uint64_t traceStart = CLDTraceBegin();
     NSMutableURLRequest *request = [[NSMutableURLRequest alloc] initWithURL:url];
     if (self.credentials) {
         NSString *authorization = [NSString stringWithFormat:@"%@ %@", self.credentials.tokenType, self.credentials.accessToken];
         [request setValue:authorization forHTTPHeaderField:@"Authorization"];
     }
+    CLDTraceEnd(CLDTraceSpanRequestSigning, traceStart);
     return request;
 }
 
@@ -1477,6 +2396,8 @@ includeDeletedItems:(BOOL)includeDeletedItems
                 //		case 405: break; // METHOD NOT ALLOWED (wrong http method)
             case 406: _error = [CLDError errorWithCode:CLDErrorCodeTooManyRecords userInfo:@{@"status_code": @(statusCode)}]; break; // NOT ACCEPTABLE (usually when there are more than 10k records)
                 //		case 500: break; // INTERNAL SERVER ERROR
+            case 429: _error = [CLDError errorWithCode:CLDErrorCodeServiceUnavailable userInfo:@{@"status_code": @(statusCode)}]; break; // TOO MANY REQUESTS
+            case 503: _error = [CLDError errorWithCode:CLDErrorCodeServiceUnavailable userInfo:@{@"status_code": @(statusCode)}]; break; // SERVICE UNAVAILABLE
             case 507: _error = [CLDError errorWithCode:CLDErrorCodeOverQuota userInfo:@{@"status_code": @(statusCode)}]; break; // OVER QUOTA
             default: _error = [CLDError errorWithCode:CLDErrorCodeUnknownError userInfo:@{@"status_code": @(statusCode)}]; break;
         }
@@ -1498,24 +2419,28 @@ includeDeletedItems:(BOOL)includeDeletedItems
 
 // Generate a standard POST string using an NSDictionary and converts it to NSData
 - (NSData *)_postDataWithDictionary:(NSDictionary *)dictionary {
+    uint64_t traceStart = CLDTraceBegin();
+    Class boolClass = [@YES class];
     NSMutableString *mutableString = [NSMutableString new];
-    for (NSString *key in dictionary) {
+    [dictionary enumerateKeysAndObjectsUsingBlock:^(NSString *key, id object, BOOL *stop) {
         NSString *value;
-        if ([dictionary[key] isKindOfClass:[NSNumber class]]) {
-            if ([dictionary[key] class] == [[NSNumber numberWithBool:YES] class]) {
-                value = [dictionary[key] boolValue]==YES ? @"true" : @"false";
+        if ([object isKindOfClass:[NSNumber class]]) {
+            if ([object class] == boolClass) {
+                value = [object boolValue]==YES ? @"true" : @"false";
             } else {
-                value = [dictionary[key] stringValue];
+                value = [object stringValue];
             }
         } else {
-            value = dictionary[key];
+            value = object;
         }
-        [mutableString appendFormat:@"%@=%@&",
+        if (mutableString.length > 0) [mutableString appendString:@"&"];
+        [mutableString appendFormat:@"%@=%@",
          [self _escapedURLQueryArgumentFromString:key],
          [self _escapedURLQueryArgumentFromString:value]];
-    }
-    NSString *postString = [mutableString stringByTrimmingCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@"&"]];
-    return [postString dataUsingEncoding:NSUTF8StringEncoding];
+    }];
+    NSData *data = [mutableString dataUsingEncoding:NSUTF8StringEncoding];
+    CLDTraceEnd(CLDTraceSpanRequestEncoding, traceStart);
+    return data;
 }
 
 @end
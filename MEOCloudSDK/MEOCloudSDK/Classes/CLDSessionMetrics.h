@@ -0,0 +1,90 @@
+//
+//  CLDSessionMetrics.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+@class CLDSession;
+@class CLDSessionMetrics;
+
+/**
+ Default value for <[CLDSession metricsExportInterval]>.
+ @since 1.1
+ */
+FOUNDATION_EXPORT const NSTimeInterval CLDSessionMetricsDefaultExportInterval;
+
+/**
+ The `CLDMetricsExporter` protocol is adopted by objects that send the metrics of a <CLDSession> elsewhere, e.g. to a logging
+ or analytics service.
+ @see [CLDSession metricsExporter]
+ @since 1.1
+ */
+@protocol CLDMetricsExporter <NSObject>
+
+/**
+ Called every <[CLDSession metricsExportInterval]> seconds on a background queue.
+ Metrics are cumulative, subtract the previous snapshot to get the activity of the last interval.
+ @param metrics The snapshot to be exported.
+ @param session The session the metrics belong to.
+ @since 1.1
+ */
+- (void)exportMetrics:(CLDSessionMetrics *)metrics forSession:(CLDSession *)session;
+
+@end
+
+/**
+ This class represents a snapshot of the network activity of a <CLDSession>, since it was created or its metrics were reset.
+
+ API requests and transfers are kept apart, as they are scheduled differently and their sizes are not comparable.
+ @see [CLDSession metrics]
+ @since 1.1
+ */
+@interface CLDSessionMetrics : NSObject
+
+/**
+ The date metrics started being recorded.
+ @since 1.1
+ */
+@property (readonly, strong, nonatomic) NSDate *startDate;
+
+/**
+ The date of this snapshot.
+ @since 1.1
+ */
+@property (readonly, strong, nonatomic) NSDate *date;
+
+/**
+ An `NSDictionary` with the <CLDEndpointMetrics> of API requests, keyed by their <[CLDEndpointMetrics endpoint]>.
+ @since 1.1
+ */
+@property (readonly, strong, nonatomic) NSDictionary *requestMetrics;
+
+/**
+ An `NSDictionary` with the <CLDEndpointMetrics> of the requests made by transfers of the <[CLDSession transferManager]>,
+ keyed by their <[CLDEndpointMetrics endpoint]>.
+ @since 1.1
+ */
+@property (readonly, strong, nonatomic) NSDictionary *transferMetrics;
+
+/**
+ The number of times the access token was refreshed.
+ @since 1.1
+ */
+@property (readonly, nonatomic) NSUInteger numberOfTokenRefreshes;
+
+/**
+ The number of times the access token could not be refreshed.
+ @since 1.1
+ */
+@property (readonly, nonatomic) NSUInteger numberOfFailedTokenRefreshes;
+
+/**
+ Returns a representation of the metrics made of property list types, suitable for JSON.
+ @return An `NSDictionary` with the metrics.
+ @since 1.1
+ */
+- (NSDictionary *)dictionaryRepresentation;
+
+@end
@@ -0,0 +1,50 @@
+//
+//  CLDSessionMetrics.m
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import "CLDSessionMetrics.h"
+
+const NSTimeInterval CLDSessionMetricsDefaultExportInterval = 60;
+
+@implementation CLDSessionMetrics
+
+- (instancetype)initWithStartDate:(NSDate *)startDate
+                   requestMetrics:(NSDictionary *)requestMetrics
+                  transferMetrics:(NSDictionary *)transferMetrics
+           numberOfTokenRefreshes:(NSUInteger)numberOfTokenRefreshes
+     numberOfFailedTokenRefreshes:(NSUInteger)numberOfFailedTokenRefreshes {
+    NSParameterAssert(startDate);
+    self = [super init];
+    if (self) {
+        _startDate = startDate;
+        _date = [NSDate date];
+        _requestMetrics = requestMetrics ?: @{};
+        _transferMetrics = transferMetrics ?: @{};
+        _numberOfTokenRefreshes = numberOfTokenRefreshes;
+        _numberOfFailedTokenRefreshes = numberOfFailedTokenRefreshes;
+    }
+    return self;
+}
+
+- (NSDictionary *)dictionaryRepresentation {
+    NSMutableArray *requests = [NSMutableArray new];
+    for (CLDEndpointMetrics *metrics in self.requestMetrics.allValues) {
+        [requests addObject:[metrics dictionaryRepresentation]];
+    }
+    NSMutableArray *transfers = [NSMutableArray new];
+    for (CLDEndpointMetrics *metrics in self.transferMetrics.allValues) {
+        [transfers addObject:[metrics dictionaryRepresentation]];
+    }
+    return @{@"start_date": @(self.startDate.timeIntervalSince1970),
+             @"date": @(self.date.timeIntervalSince1970),
+             @"requests": requests,
+             @"transfers": transfers,
+             @"token_refreshes": @(self.numberOfTokenRefreshes),
+             @"failed_token_refreshes": @(self.numberOfFailedTokenRefreshes)};
+}
+
+@end
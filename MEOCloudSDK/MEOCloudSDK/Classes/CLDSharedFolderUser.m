@@ -48,7 +48,7 @@
         user.owner = [dictionary[@"owner"] boolValue];
         user.user = [dictionary[@"user"] boolValue];
         user.inviteRequestId = dictionary[@"req_id"];
-        user.inviteRequestDate = [[NSDateFormatter serviceDateFormatter] dateFromString:dictionary[@"date"]];
+        user.inviteRequestDate = [NSDateFormatter serviceDateFromString:dictionary[@"date"]];
     }
     return user;
 }
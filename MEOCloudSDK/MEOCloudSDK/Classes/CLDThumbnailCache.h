@@ -0,0 +1,124 @@
+//
+//  CLDThumbnailCache.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#ifndef CLDImage
+
+#if TARGET_OS_IPHONE
+#define CLDImage UIImage
+#else
+#define CLDImage NSImage
+#endif
+
+#endif
+
+/**
+ Default value for <[CLDThumbnailCache memoryCapacity]>, in bytes.
+ @since 1.1
+ */
+FOUNDATION_EXPORT const NSUInteger CLDThumbnailCacheDefaultMemoryCapacity;
+
+/**
+ Default value for <[CLDThumbnailCache diskCapacity]>, in bytes.
+ @since 1.1
+ */
+FOUNDATION_EXPORT const NSUInteger CLDThumbnailCacheDefaultDiskCapacity;
+
+/**
+ This class caches the thumbnails fetched by <[CLDSession fetchThumbnailForItem:format:size:cropToSize:resultBlock:failureBlock:]>.
+
+ Thumbnails are identified by the item's path and revision, and by the requested format, size and crop, so a new revision of an item is always fetched again.
+ Decoded thumbnails are kept in memory and the downloaded data is kept on disk, and the least recently used ones are evicted first when either tier goes over its capacity.
+ Thumbnails are decoded on a background queue before being handed out, and several requests for the same thumbnail share a single download.
+
+ Each session has its own cache, which is emptied when the session is unlinked.
+ @since 1.1
+ */
+@interface CLDThumbnailCache : NSObject
+
+////////////////////////////////////////////////////////////////////////////////
+/// @name Cache configuration
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ The identifier of the session this cache belongs to.
+ @since 1.1
+ */
+@property (readonly, strong, nonatomic) NSString *sessionIdentifier;
+
+/**
+ The maximum number of bytes used by decoded thumbnails in memory.
+ Default value is `CLDThumbnailCacheDefaultMemoryCapacity`.
+ @since 1.1
+ */
+@property (readwrite, atomic) NSUInteger memoryCapacity;
+
+/**
+ The maximum number of bytes used by thumbnails on disk.
+ Default value is `CLDThumbnailCacheDefaultDiskCapacity`.
+ @since 1.1
+ */
+@property (readwrite, atomic) NSUInteger diskCapacity;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @name Cache usage
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ The number of bytes currently used by decoded thumbnails in memory.
+ @since 1.1
+ */
+@property (readonly, atomic) NSUInteger currentMemoryUsage;
+
+/**
+ The number of bytes currently used by thumbnails on disk.
+ @since 1.1
+ */
+@property (readonly, atomic) NSUInteger currentDiskUsage;
+
+/**
+ The number of thumbnails that did not have to be downloaded, either because they were found in memory or on disk or because they were already being downloaded.
+ @since 1.1
+ */
+@property (readonly, atomic) NSUInteger numberOfHits;
+
+/**
+ The number of thumbnails that had to be downloaded.
+ @since 1.1
+ */
+@property (readonly, atomic) NSUInteger numberOfMisses;
+
+/**
+ The fraction of thumbnails that did not have to be downloaded, between `0` and `1`.
+ @since 1.1
+ */
+@property (readonly, atomic) double hitRatio;
+
+/**
+ Resets <numberOfHits> and <numberOfMisses>.
+ @since 1.1
+ */
+- (void)resetStatistics;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @name Removing thumbnails
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ Removes all thumbnails from memory, keeping the ones on disk.
+ @note On iOS this is done automatically when the application receives a memory warning.
+ @since 1.1
+ */
+- (void)removeAllThumbnailsFromMemory;
+
+/**
+ Removes all thumbnails from memory and from disk.
+ @since 1.1
+ */
+- (void)removeAllThumbnails;
+
+@end
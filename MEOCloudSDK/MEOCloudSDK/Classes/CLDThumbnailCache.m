@@ -0,0 +1,441 @@
+//
+//  CLDThumbnailCache.m
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import "CLDThumbnailCache.h"
+#import <CommonCrypto/CommonDigest.h>
+
+const NSUInteger CLDThumbnailCacheDefaultMemoryCapacity = 20 * 1024 * 1024;
+const NSUInteger CLDThumbnailCacheDefaultDiskCapacity = 100 * 1024 * 1024;
+
+// node of the memory LRU list, most recently used first
+@interface CLDThumbnailCacheEntry : NSObject
+@property (readwrite, strong, nonatomic) NSString *key;
+@property (readwrite, strong, nonatomic) CLDImage *image;
+@property (readwrite, nonatomic) NSUInteger cost;
+@property (readwrite, strong, nonatomic) CLDThumbnailCacheEntry *next;
+@property (readwrite, weak, nonatomic) CLDThumbnailCacheEntry *previous;
+@end
+
+@implementation CLDThumbnailCacheEntry
+@end
+
+// thumbnail being loaded from disk or from the network on behalf of one or more callers
+@interface CLDThumbnailCacheFetch : NSObject
+@property (readwrite, strong, nonatomic) NSString *key;
+@property (readwrite, strong, nonatomic) NSMutableArray *completionBlocks;
+@property (readwrite, strong, nonatomic) CLDRequest *request;
+@end
+
+@implementation CLDThumbnailCacheFetch
+@end
+
+
+
+
+@interface CLDThumbnailCache ()
+@property (readwrite, strong, nonatomic) NSString *sessionIdentifier;
+@property (readwrite, atomic) NSUInteger currentMemoryUsage;
+@property (readwrite, atomic) NSUInteger currentDiskUsage;
+@property (readwrite, atomic) NSUInteger numberOfHits;
+@property (readwrite, atomic) NSUInteger numberOfMisses;
+@end
+
+@implementation CLDThumbnailCache {
+    dispatch_queue_t _queue;
+    dispatch_queue_t _diskQueue;
+    NSURL *_directoryURL;
+    NSUInteger _memoryCapacity;
+    NSUInteger _diskCapacity;
+    NSMutableDictionary *_entries;
+    CLDThumbnailCacheEntry *_head;
+    CLDThumbnailCacheEntry *_tail;
+    NSMutableDictionary *_fetches;  // key -> CLDThumbnailCacheFetch
+}
+
+#pragma mark - Initialization
+
+- (instancetype)initWithSession:(CLDSession *)session {
+    NSParameterAssert(session);
+    self = [super init];
+    if (self) {
+        _sessionIdentifier = session.sessionIdentifier;
+        _memoryCapacity = CLDThumbnailCacheDefaultMemoryCapacity;
+        _diskCapacity = CLDThumbnailCacheDefaultDiskCapacity;
+        _entries = [NSMutableDictionary new];
+        _fetches = [NSMutableDictionary new];
+        _queue = dispatch_queue_create("pt.meo.cloud.sdk.thumbnails", DISPATCH_QUEUE_SERIAL);
+        _diskQueue = dispatch_queue_create("pt.meo.cloud.sdk.thumbnails.disk", DISPATCH_QUEUE_SERIAL);
+
+        NSString *directoryName = [NSString stringWithFormat:@"pt.meo.cloud.sdk.%@.thumbnails", _sessionIdentifier];
+        _directoryURL = [[CLDUtil cachesDirectory] URLByAppendingPathComponent:directoryName isDirectory:YES];
+        dispatch_async(_diskQueue, ^{
+            [[NSFileManager defaultManager] createDirectoryAtURL:_directoryURL withIntermediateDirectories:YES attributes:nil error:nil];
+            self.currentDiskUsage = [self _diskUsageOfFiles:[self _diskFiles]];
+        });
+
+#if TARGET_OS_IPHONE
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(removeAllThumbnailsFromMemory)
+                                                     name:UIApplicationDidReceiveMemoryWarningNotification
+                                                   object:nil];
+#endif
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
+#pragma mark - Dynamic properties
+
+- (NSUInteger)memoryCapacity {
+    @synchronized(self) {
+        return _memoryCapacity;
+    }
+}
+
+- (void)setMemoryCapacity:(NSUInteger)memoryCapacity {
+    @synchronized(self) {
+        _memoryCapacity = memoryCapacity;
+    }
+    dispatch_async(_queue, ^{
+        [self _trimMemoryToCapacity:memoryCapacity];
+    });
+}
+
+- (NSUInteger)diskCapacity {
+    @synchronized(self) {
+        return _diskCapacity;
+    }
+}
+
+- (void)setDiskCapacity:(NSUInteger)diskCapacity {
+    @synchronized(self) {
+        _diskCapacity = diskCapacity;
+    }
+    dispatch_async(_diskQueue, ^{
+        [self _trimDiskToCapacity:diskCapacity];
+    });
+}
+
+- (double)hitRatio {
+    NSUInteger hits = self.numberOfHits;
+    NSUInteger total = hits + self.numberOfMisses;
+    return total > 0 ? (double)hits / total : 0;
+}
+
+#pragma mark - Public methods
+
+- (void)resetStatistics {
+    dispatch_async(_queue, ^{
+        self.numberOfHits = 0;
+        self.numberOfMisses = 0;
+    });
+}
+
+- (void)removeAllThumbnailsFromMemory {
+    dispatch_async(_queue, ^{
+        [self _trimMemoryToCapacity:0];
+    });
+}
+
+- (void)removeAllThumbnails {
+    [self removeAllThumbnailsFromMemory];
+    dispatch_async(_diskQueue, ^{
+        NSFileManager *fileManager = [NSFileManager defaultManager];
+        [fileManager removeItemAtURL:_directoryURL error:nil];
+        [fileManager createDirectoryAtURL:_directoryURL withIntermediateDirectories:YES attributes:nil error:nil];
+        self.currentDiskUsage = 0;
+    });
+}
+
+#pragma mark - Fetching thumbnails
+
+- (id)fetchThumbnailWithKey:(NSString *)key
+              callbackQueue:(dispatch_queue_t)callbackQueue
+                  loadBlock:(CLDThumbnailCacheLoadBlock)loadBlock
+                resultBlock:(CLDThumbnailCacheResultBlock)resultBlock
+               failureBlock:(CLDThumbnailCacheFailureBlock)failureBlock {
+    NSParameterAssert(key);
+    NSParameterAssert(callbackQueue);
+    NSParameterAssert(loadBlock);
+
+    // the completion block doubles as the token used to cancel the fetch
+    void(^completionBlock)(CLDImage *, NSError *) = ^(CLDImage *thumbnail, NSError *error) {
+        if (thumbnail) RunBlockOnQueue(callbackQueue, resultBlock, thumbnail);
+        else RunBlockOnQueue(callbackQueue, failureBlock, error);
+    };
+
+    dispatch_async(_queue, ^{
+        CLDThumbnailCacheEntry *entry = _entries[key];
+        if (entry) {
+            [self _moveEntryToHead:entry];
+            self.numberOfHits++;
+            completionBlock(entry.image, nil);
+            return;
+        }
+
+        // join a fetch for the same thumbnail that is already going on
+        CLDThumbnailCacheFetch *fetch = _fetches[key];
+        if (fetch) {
+            [fetch.completionBlocks addObject:completionBlock];
+            return;
+        }
+        fetch = [CLDThumbnailCacheFetch new];
+        fetch.key = key;
+        fetch.completionBlocks = [NSMutableArray arrayWithObject:completionBlock];
+        _fetches[key] = fetch;
+
+        dispatch_async(_diskQueue, ^{
+            NSURL *fileURL = [self _fileURLForKey:key];
+            NSData *data = [NSData dataWithContentsOfURL:fileURL options:NSDataReadingMappedIfSafe error:nil];
+            if (data) {
+                // modification dates keep the disk tier in least recently used order
+                [fileURL setResourceValue:[NSDate date] forKey:NSURLContentModificationDateKey error:nil];
+            }
+            dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+                NSUInteger cost = 0;
+                CLDImage *thumbnail = data ? [CLDThumbnailCache decodedImageWithData:data cost:&cost] : nil;
+                if (thumbnail) {
+                    [self _finishFetch:fetch thumbnail:thumbnail cost:cost error:nil downloaded:NO];
+                } else {
+                    [self _loadFetch:fetch loadBlock:loadBlock];
+                }
+            });
+        });
+    });
+
+    return completionBlock;
+}
+
+- (void)cancelFetchWithKey:(NSString *)key token:(id)token {
+    NSParameterAssert(key);
+    if (token == nil) return;
+    dispatch_async(_queue, ^{
+        CLDThumbnailCacheFetch *fetch = _fetches[key];
+        [fetch.completionBlocks removeObjectIdenticalTo:token];
+        if (fetch && fetch.completionBlocks.count == 0) {
+            // nobody else is waiting for this thumbnail
+            [_fetches removeObjectForKey:key];
+            [fetch.request cancel];
+        }
+    });
+}
+
+- (void)setPriority:(float)priority forFetchWithKey:(NSString *)key {
+    NSParameterAssert(key);
+    dispatch_async(_queue, ^{
+        CLDThumbnailCacheFetch *fetch = _fetches[key];
+        fetch.request.priority = priority;
+    });
+}
+
+#pragma mark - Decoding
+
++ (CLDImage *)decodedImageWithData:(NSData *)data cost:(NSUInteger *)cost {
+    CLDImage *image = [[CLDImage alloc] initWithData:data];
+#if TARGET_OS_IPHONE
+    CGImageRef imageRef = image.CGImage;
+#else
+    CGImageRef imageRef = [image CGImageForProposedRect:NULL context:nil hints:nil];
+#endif
+    if (imageRef == NULL) return nil;
+
+    // draw into a bitmap so the image is not decoded again when it is first displayed
+    size_t width = CGImageGetWidth(imageRef);
+    size_t height = CGImageGetHeight(imageRef);
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGContextRef context = CGBitmapContextCreate(NULL, width, height, 8, 0, colorSpace, kCGBitmapByteOrder32Host | kCGImageAlphaPremultipliedFirst);
+    CGColorSpaceRelease(colorSpace);
+    if (context == NULL) {
+        if (cost) *cost = width * height * 4;
+        return image;
+    }
+
+    CGContextDrawImage(context, CGRectMake(0, 0, width, height), imageRef);
+    CGImageRef decodedImageRef = CGBitmapContextCreateImage(context);
+    if (cost) *cost = CGBitmapContextGetBytesPerRow(context) * height;
+    CGContextRelease(context);
+    if (decodedImageRef == NULL) return image;
+
+#if TARGET_OS_IPHONE
+    CLDImage *decodedImage = [UIImage imageWithCGImage:decodedImageRef scale:image.scale orientation:image.imageOrientation];
+#else
+    CLDImage *decodedImage = [[NSImage alloc] initWithCGImage:decodedImageRef size:image.size];
+#endif
+    CGImageRelease(decodedImageRef);
+    return decodedImage;
+}
+
+#pragma mark - Private methods
+
+- (void)_loadFetch:(CLDThumbnailCacheFetch *)fetch loadBlock:(CLDThumbnailCacheLoadBlock)loadBlock {
+    dispatch_async(_queue, ^{
+        if (_fetches[fetch.key] != fetch) return;   // cancelled while reading from disk
+
+        self.numberOfMisses++;
+        fetch.request = loadBlock(^(NSData *data) {
+            dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+                NSUInteger cost = 0;
+                CLDImage *thumbnail = [CLDThumbnailCache decodedImageWithData:data cost:&cost];
+                if (thumbnail) {
+                    [self _storeData:data forKey:fetch.key];
+                    [self _finishFetch:fetch thumbnail:thumbnail cost:cost error:nil downloaded:YES];
+                } else {
+                    [self _finishFetch:fetch thumbnail:nil cost:0 error:[CLDError errorWithCode:CLDErrorCodeInvalidResponse] downloaded:YES];
+                }
+            });
+        }, ^(NSError *error) {
+            [self _finishFetch:fetch thumbnail:nil cost:0 error:error downloaded:YES];
+        });
+    });
+}
+
+- (void)_finishFetch:(CLDThumbnailCacheFetch *)fetch thumbnail:(CLDImage *)thumbnail cost:(NSUInteger)cost error:(NSError *)error downloaded:(BOOL)downloaded {
+    dispatch_async(_queue, ^{
+        if (thumbnail) [self _addEntryWithKey:fetch.key thumbnail:thumbnail cost:cost];
+        if (_fetches[fetch.key] != fetch) return;   // every caller went away
+        [_fetches removeObjectForKey:fetch.key];
+
+        // the caller that started a download counts as a miss, the ones that joined it as hits
+        NSArray *completionBlocks = fetch.completionBlocks;
+        self.numberOfHits += downloaded ? completionBlocks.count - 1 : completionBlocks.count;
+        for (void(^completionBlock)(CLDImage *, NSError *) in completionBlocks) {
+            completionBlock(thumbnail, error);
+        }
+    });
+}
+
+// memory methods below must be called on _queue
+
+- (void)_addEntryWithKey:(NSString *)key thumbnail:(CLDImage *)thumbnail cost:(NSUInteger)cost {
+    NSUInteger memoryCapacity = self.memoryCapacity;
+    if (cost > memoryCapacity) return;
+
+    CLDThumbnailCacheEntry *entry = _entries[key];
+    if (entry) {
+        self.currentMemoryUsage -= entry.cost;
+        [self _moveEntryToHead:entry];
+    } else {
+        entry = [CLDThumbnailCacheEntry new];
+        entry.key = key;
+        _entries[key] = entry;
+        [self _insertEntryAtHead:entry];
+    }
+    entry.image = thumbnail;
+    entry.cost = cost;
+    self.currentMemoryUsage += cost;
+    [self _trimMemoryToCapacity:memoryCapacity];
+}
+
+- (void)_trimMemoryToCapacity:(NSUInteger)capacity {
+    while (_tail && self.currentMemoryUsage > capacity) {
+        CLDThumbnailCacheEntry *entry = _tail;
+        [self _removeEntry:entry];
+        [_entries removeObjectForKey:entry.key];
+        self.currentMemoryUsage -= entry.cost;
+    }
+}
+
+- (void)_insertEntryAtHead:(CLDThumbnailCacheEntry *)entry {
+    entry.previous = nil;
+    entry.next = _head;
+    _head.previous = entry;
+    _head = entry;
+    if (_tail == nil) _tail = entry;
+}
+
+- (void)_removeEntry:(CLDThumbnailCacheEntry *)entry {
+    if (entry.previous) entry.previous.next = entry.next;
+    else _head = entry.next;
+    if (entry.next) entry.next.previous = entry.previous;
+    else _tail = entry.previous;
+    entry.previous = nil;
+    entry.next = nil;
+}
+
+- (void)_moveEntryToHead:(CLDThumbnailCacheEntry *)entry {
+    if (entry == _head) return;
+    [self _removeEntry:entry];
+    [self _insertEntryAtHead:entry];
+}
+
+// disk methods below must be called on _diskQueue, except for _storeData:forKey:
+
+- (NSURL *)_fileURLForKey:(NSString *)key {
+    NSData *keyData = [key dataUsingEncoding:NSUTF8StringEncoding];
+    unsigned char digest[CC_SHA1_DIGEST_LENGTH];
+    CC_SHA1(keyData.bytes, (CC_LONG)keyData.length, digest);
+    NSMutableString *fileName = [NSMutableString stringWithCapacity:CC_SHA1_DIGEST_LENGTH * 2];
+    for (NSUInteger i = 0; i < CC_SHA1_DIGEST_LENGTH; i++) {
+        [fileName appendFormat:@"%02x", digest[i]];
+    }
+    return [_directoryURL URLByAppendingPathComponent:fileName isDirectory:NO];
+}
+
+- (void)_storeData:(NSData *)data forKey:(NSString *)key {
+    dispatch_async(_diskQueue, ^{
+        NSUInteger diskCapacity = self.diskCapacity;
+        if (data.length > diskCapacity) return;
+
+        NSURL *fileURL = [self _fileURLForKey:key];
+        NSNumber *previousSize = nil;
+        [fileURL getResourceValue:&previousSize forKey:NSURLFileSizeKey error:nil];
+        if ([data writeToURL:fileURL options:NSDataWritingAtomic error:nil]) {
+            self.currentDiskUsage = self.currentDiskUsage - MIN(previousSize.unsignedIntegerValue, self.currentDiskUsage) + data.length;
+            if (self.currentDiskUsage > diskCapacity) [self _trimDiskToCapacity:diskCapacity];
+        }
+    });
+}
+
+- (NSArray *)_diskFiles {
+    NSArray *keys = @[NSURLFileSizeKey, NSURLContentModificationDateKey];
+    NSArray *fileURLs = [[NSFileManager defaultManager] contentsOfDirectoryAtURL:_directoryURL
+                                                      includingPropertiesForKeys:keys
+                                                                         options:NSDirectoryEnumerationSkipsHiddenFiles
+                                                                           error:nil];
+    return fileURLs ?: @[];
+}
+
+- (NSUInteger)_diskUsageOfFiles:(NSArray *)fileURLs {
+    NSUInteger diskUsage = 0;
+    for (NSURL *fileURL in fileURLs) {
+        NSNumber *size = nil;
+        [fileURL getResourceValue:&size forKey:NSURLFileSizeKey error:nil];
+        diskUsage += size.unsignedIntegerValue;
+    }
+    return diskUsage;
+}
+
+- (void)_trimDiskToCapacity:(NSUInteger)capacity {
+    if (self.currentDiskUsage <= capacity) return;
+
+    // trim below capacity so that the directory is not listed again on every write
+    NSUInteger targetUsage = capacity / 4 * 3;
+    NSArray *fileURLs = [[self _diskFiles] sortedArrayUsingComparator:^NSComparisonResult(NSURL *fileURL1, NSURL *fileURL2) {
+        NSDate *date1 = nil, *date2 = nil;
+        [fileURL1 getResourceValue:&date1 forKey:NSURLContentModificationDateKey error:nil];
+        [fileURL2 getResourceValue:&date2 forKey:NSURLContentModificationDateKey error:nil];
+        return [date1 ?: [NSDate distantPast] compare:date2 ?: [NSDate distantPast]];
+    }];
+
+    NSUInteger diskUsage = [self _diskUsageOfFiles:fileURLs];
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    for (NSURL *fileURL in fileURLs) {
+        if (diskUsage <= targetUsage) break;
+        NSNumber *size = nil;
+        [fileURL getResourceValue:&size forKey:NSURLFileSizeKey error:nil];
+        if ([fileManager removeItemAtURL:fileURL error:nil]) {
+            diskUsage -= MIN(size.unsignedIntegerValue, diskUsage);
+        }
+    }
+    self.currentDiskUsage = diskUsage;
+}
+
+@end
@@ -0,0 +1,119 @@
+//
+//  CLDThumbnailPrefetcher.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import <MEOCloudSDK/CLDSession.h>
+
+/**
+ Default value for <[CLDThumbnailPrefetcher maximumConcurrentRequests]>.
+ @since 1.1
+ */
+FOUNDATION_EXPORT const NSUInteger CLDThumbnailPrefetcherDefaultMaximumConcurrentRequests;
+
+/**
+ Priority bands for thumbnail prefetching.
+ @since 1.1
+ */
+typedef NS_ENUM(NSInteger, CLDThumbnailPrefetchPriority) {
+    /**
+     Low priority, e.g. for items a few screens away from the visible ones.
+     @since 1.1
+     */
+    CLDThumbnailPrefetchPriorityLow = -10,
+    /**
+     Normal priority, e.g. for items that are about to become visible.
+     @since 1.1
+     */
+    CLDThumbnailPrefetchPriorityNormal = 0,
+    /**
+     High priority, e.g. for visible items.
+     @since 1.1
+     */
+    CLDThumbnailPrefetchPriorityHigh = 10
+};
+
+/**
+ This class fetches thumbnails into the session's <CLDThumbnailCache> ahead of time, so that
+ <[CLDSession fetchThumbnailForItem:format:size:cropToSize:resultBlock:failureBlock:]> finds them already cached.
+
+ Each priority band holds an ordered list of items, which is replaced every time it is set, typically when a grid or a detail view scrolls.
+ Thumbnails from higher bands are fetched first and only a limited number of requests is performed at the same time.
+ Thumbnails that leave every band are dropped before being requested, and requests already in flight for them are cancelled
+ unless they were also requested through <CLDSession>. Thumbnails that move to a lower band keep their request, with a lower priority.
+
+ Items without a revision or without a thumbnail are ignored, since their thumbnails are not cached.
+ @since 1.1
+ */
+@interface CLDThumbnailPrefetcher : NSObject
+
+////////////////////////////////////////////////////////////////////////////////
+/// @name Prefetcher configuration
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ The session whose thumbnails are being prefetched.
+ @since 1.1
+ */
+@property (readonly, weak, nonatomic) CLDSession *session;
+
+/**
+ The maximum number of thumbnails being requested at the same time.
+ Default value is `CLDThumbnailPrefetcherDefaultMaximumConcurrentRequests`.
+ @since 1.1
+ */
+@property (readwrite, atomic) NSUInteger maximumConcurrentRequests;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @name Prefetching thumbnails
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ Replaces the thumbnails being prefetched with a priority.
+
+ @param items       An `NSArray` of <CLDItem> instances, in the order their thumbnails should be fetched.
+ @param format      The format of the thumbnails.
+ @param size        The size of the thumbnails.
+ @param cropToSize  `BOOL` stating if the thumbnails should be cropped to the chosen size.
+ @param priority    The priority band whose items are replaced.
+ @since 1.1
+ */
+- (void)prefetchThumbnailsForItems:(NSArray *)items
+                            format:(CLDItemThumbnailFormat)format
+                              size:(CLDItemThumbnailSize)size
+                        cropToSize:(BOOL)cropToSize
+                          priority:(CLDThumbnailPrefetchPriority)priority;
+
+/**
+ Stops prefetching the thumbnails of a priority band.
+ @param priority The priority band to be emptied.
+ @since 1.1
+ */
+- (void)cancelPrefetchingWithPriority:(CLDThumbnailPrefetchPriority)priority;
+
+/**
+ Stops prefetching all thumbnails.
+ @since 1.1
+ */
+- (void)cancelAllPrefetching;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @name Prefetcher state
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ The number of thumbnails waiting to be requested.
+ @since 1.1
+ */
+@property (readonly, atomic) NSUInteger numberOfPendingThumbnails;
+
+/**
+ The number of thumbnails being requested.
+ @since 1.1
+ */
+@property (readonly, atomic) NSUInteger numberOfActiveRequests;
+
+@end
@@ -0,0 +1,251 @@
+//
+//  CLDThumbnailPrefetcher.m
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import "CLDThumbnailPrefetcher.h"
+
+const NSUInteger CLDThumbnailPrefetcherDefaultMaximumConcurrentRequests = 4;
+
+// a thumbnail wanted by one or more priority bands
+@interface CLDThumbnailPrefetch : NSObject
+@property (readwrite, strong, nonatomic) NSString *key;
+@property (readwrite, strong, nonatomic) CLDItem *item;
+@property (readwrite, nonatomic) CLDItemThumbnailFormat format;
+@property (readwrite, nonatomic) CLDItemThumbnailSize size;
+@property (readwrite, nonatomic) BOOL cropToSize;
+@property (readwrite, atomic) float requestPriority;
+@property (readwrite, strong, nonatomic) id token;  // set while the thumbnail is being fetched
+@end
+
+@implementation CLDThumbnailPrefetch
+@end
+
+
+
+
+@interface CLDThumbnailPrefetcher ()
+@property (readwrite, weak, nonatomic) CLDSession *session;
+@property (readwrite, atomic) NSUInteger numberOfPendingThumbnails;
+@property (readwrite, atomic) NSUInteger numberOfActiveRequests;
+@end
+
+@implementation CLDThumbnailPrefetcher {
+    dispatch_queue_t _queue;
+    NSUInteger _maximumConcurrentRequests;
+    NSMutableDictionary *_bands;        // priority -> ordered set of keys
+    NSMutableDictionary *_prefetches;   // key -> CLDThumbnailPrefetch
+    NSMutableDictionary *_activePrefetches;
+}
+
+#pragma mark - Initialization
+
+- (instancetype)initWithSession:(CLDSession *)session {
+    NSParameterAssert(session);
+    self = [super init];
+    if (self) {
+        _session = session;
+        _maximumConcurrentRequests = CLDThumbnailPrefetcherDefaultMaximumConcurrentRequests;
+        _queue = dispatch_queue_create("pt.meo.cloud.sdk.prefetcher", DISPATCH_QUEUE_SERIAL);
+        _bands = [NSMutableDictionary new];
+        _prefetches = [NSMutableDictionary new];
+        _activePrefetches = [NSMutableDictionary new];
+    }
+    return self;
+}
+
+#pragma mark - Dynamic properties
+
+- (NSUInteger)maximumConcurrentRequests {
+    @synchronized(self) {
+        return _maximumConcurrentRequests;
+    }
+}
+
+- (void)setMaximumConcurrentRequests:(NSUInteger)maximumConcurrentRequests {
+    @synchronized(self) {
+        _maximumConcurrentRequests = MAX(maximumConcurrentRequests, 1);
+    }
+    dispatch_async(_queue, ^{
+        [self _scheduleRequests];
+    });
+}
+
+#pragma mark - Public methods
+
+- (void)prefetchThumbnailsForItems:(NSArray *)items
+                            format:(CLDItemThumbnailFormat)format
+                              size:(CLDItemThumbnailSize)size
+                        cropToSize:(BOOL)cropToSize
+                          priority:(CLDThumbnailPrefetchPriority)priority {
+    NSParameterAssert(items);
+    CLDSession *session = self.session;
+    if (session == nil) return;
+
+    // keys are built right away, the items may change while waiting for the queue
+    NSMutableOrderedSet *keys = [NSMutableOrderedSet orderedSetWithCapacity:items.count];
+    NSMutableDictionary *prefetches = [NSMutableDictionary dictionaryWithCapacity:items.count];
+    for (CLDItem *item in items) {
+        if (!item.hasThumbnail) continue;
+        NSString *key = [session _thumbnailKeyForItem:item format:format size:size cropToSize:cropToSize];
+        if (key == nil || [keys containsObject:key]) continue;
+        CLDThumbnailPrefetch *prefetch = [CLDThumbnailPrefetch new];
+        prefetch.key = key;
+        prefetch.item = item;
+        prefetch.format = format;
+        prefetch.size = size;
+        prefetch.cropToSize = cropToSize;
+        [keys addObject:key];
+        prefetches[key] = prefetch;
+    }
+
+    dispatch_async(_queue, ^{
+        for (NSString *key in keys) {
+            if (_prefetches[key] == nil) _prefetches[key] = prefetches[key];
+        }
+        [self _replaceBandWithPriority:priority keys:keys];
+    });
+}
+
+- (void)cancelPrefetchingWithPriority:(CLDThumbnailPrefetchPriority)priority {
+    dispatch_async(_queue, ^{
+        [self _replaceBandWithPriority:priority keys:nil];
+    });
+}
+
+- (void)cancelAllPrefetching {
+    dispatch_async(_queue, ^{
+        for (NSNumber *priority in _bands.allKeys) {
+            [self _replaceBandWithPriority:priority.integerValue keys:nil];
+        }
+    });
+}
+
+#pragma mark - Private methods
+
+// all methods below must be called on _queue
+
+- (void)_replaceBandWithPriority:(CLDThumbnailPrefetchPriority)priority keys:(NSOrderedSet *)keys {
+    NSOrderedSet *previousKeys = _bands[@(priority)];
+    if (keys.count > 0) _bands[@(priority)] = [keys mutableCopy];
+    else [_bands removeObjectForKey:@(priority)];
+
+    // thumbnails that left the band are dropped if no other band wants them, or move to a lower priority
+    for (NSString *key in previousKeys) {
+        if ([keys containsObject:key]) continue;
+        if ([self _priorityForKey:key] == nil) {
+            [self _removePrefetchWithKey:key cancel:YES];
+        } else {
+            [self _updateRequestPriorityForKey:key];
+        }
+    }
+    for (NSString *key in keys) {
+        [self _updateRequestPriorityForKey:key];
+    }
+
+    [self _scheduleRequests];
+}
+
+- (NSNumber *)_priorityForKey:(NSString *)key {
+    NSNumber *highestPriority = nil;
+    for (NSNumber *priority in _bands) {
+        if ([_bands[priority] containsObject:key] && (highestPriority == nil || priority.integerValue > highestPriority.integerValue)) {
+            highestPriority = priority;
+        }
+    }
+    return highestPriority;
+}
+
+- (void)_updateRequestPriorityForKey:(NSString *)key {
+    CLDThumbnailPrefetch *prefetch = _prefetches[key];
+    NSNumber *priority = [self _priorityForKey:key];
+    if (prefetch == nil || priority == nil) return;
+
+    float requestPriority = 0.5;
+    if (priority.integerValue > CLDThumbnailPrefetchPriorityNormal) requestPriority = 0.75;
+    else if (priority.integerValue < CLDThumbnailPrefetchPriorityNormal) requestPriority = 0.25;
+    if (prefetch.requestPriority == requestPriority) return;
+
+    prefetch.requestPriority = requestPriority;
+    if (prefetch.token) {
+        [self.session.thumbnailCache setPriority:requestPriority forFetchWithKey:key];
+    }
+}
+
+- (void)_removePrefetchWithKey:(NSString *)key cancel:(BOOL)cancel {
+    CLDThumbnailPrefetch *prefetch = _prefetches[key];
+    [_prefetches removeObjectForKey:key];
+    [_activePrefetches removeObjectForKey:key];
+    for (NSNumber *priority in _bands.allKeys) {
+        NSMutableOrderedSet *keys = _bands[priority];
+        [keys removeObject:key];
+        if (keys.count == 0) [_bands removeObjectForKey:priority];
+    }
+
+    // the cache keeps the request going if someone else is waiting for the same thumbnail
+    if (cancel && prefetch.token) {
+        [self.session.thumbnailCache cancelFetchWithKey:key token:prefetch.token];
+    }
+    prefetch.token = nil;
+}
+
+- (void)_scheduleRequests {
+    CLDSession *session = self.session;
+    CLDThumbnailCache *thumbnailCache = session.thumbnailCache;
+    if (thumbnailCache == nil) return;
+
+    NSArray *priorities = [_bands.allKeys sortedArrayUsingComparator:^NSComparisonResult(NSNumber *priority1, NSNumber *priority2) {
+        return [priority2 compare:priority1];
+    }];
+
+    NSUInteger maximumConcurrentRequests = self.maximumConcurrentRequests;
+    for (NSNumber *priority in priorities) {
+        for (NSString *key in _bands[priority]) {
+            if (_activePrefetches.count >= maximumConcurrentRequests) break;
+            if (_activePrefetches[key]) continue;
+            [self _startPrefetch:_prefetches[key] session:session thumbnailCache:thumbnailCache];
+        }
+    }
+
+    self.numberOfActiveRequests = _activePrefetches.count;
+    self.numberOfPendingThumbnails = _prefetches.count - _activePrefetches.count;
+}
+
+- (void)_startPrefetch:(CLDThumbnailPrefetch *)prefetch session:(CLDSession *)session thumbnailCache:(CLDThumbnailCache *)thumbnailCache {
+    NSString *key = prefetch.key;
+    _activePrefetches[key] = prefetch;
+
+    CLDThumbnailCacheLoadBlock sessionLoadBlock = [session _thumbnailLoadBlockForItem:prefetch.item
+                                                                               format:prefetch.format
+                                                                                 size:prefetch.size
+                                                                           cropToSize:prefetch.cropToSize];
+    CLDThumbnailCacheLoadBlock loadBlock = ^CLDRequest *(void(^successBlock)(NSData *data), void(^failureBlock)(NSError *error)) {
+        __block CLDRequest *request = nil;
+        [session performInRequestLane:CLDRequestLanePrefetch block:^{
+            request = sessionLoadBlock(successBlock, failureBlock);
+        }];
+        request.priority = prefetch.requestPriority;
+        return request;
+    };
+
+    // results come back on _queue, whatever the outcome the thumbnail is no longer pending
+    void(^finishBlock)() = ^{
+        if (_prefetches[key] != prefetch) return;
+        [self _removePrefetchWithKey:key cancel:NO];
+        [self _scheduleRequests];
+    };
+    prefetch.token = [thumbnailCache fetchThumbnailWithKey:key
+                                             callbackQueue:_queue
+                                                 loadBlock:loadBlock
+                                               resultBlock:^(CLDImage *thumbnail) {
+                                                   finishBlock();
+                                               } failureBlock:^(NSError *error) {
+                                                   CLDLog(@"Could not prefetch thumbnail for %@: %@", prefetch.item.path, error);
+                                                   finishBlock();
+                                               }];
+}
+
+@end
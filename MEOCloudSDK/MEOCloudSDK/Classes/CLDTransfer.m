@@ -41,6 +41,7 @@ static void *kCLDTransferKVOContext = &kCLDTransferKVOContext;
 @property (readwrite, copy, nonatomic) CLDTransferDownloadResultBlock downloadResultBlock;
 @property (readwrite, copy, nonatomic) CLDTransferUploadResultBlock uploadResultBlock;
 @property (readwrite, copy, nonatomic) CLDTransferFailureBlock failureBlock;
+@property (readwrite, strong, nonatomic) dispatch_queue_t callbackQueue;
 
 // private properties
 @property (readwrite, weak, nonatomic) CLDTransferManager *manager;
@@ -142,7 +143,7 @@ static void *kCLDTransferKVOContext = &kCLDTransferKVOContext;
             
         case CLDTransferStateFailed: {
             [CLDUtil postNotificationNamed:kCLDTransferFinishedNotification object:self.manager userInfo:@{kCLDTransferKey:self}];
-            RunBlockOnMainThread(self.failureBlock, self.error);
+            RunBlockOnQueue(self.callbackQueue ?: dispatch_get_main_queue(), self.failureBlock, self.error);
             break;
         }
             
@@ -150,17 +151,22 @@ static void *kCLDTransferKVOContext = &kCLDTransferKVOContext;
             NSString *filePath = self.downloadedFileURL.filePathURL.path;
             [CLDUtil postNotificationNamed:kCLDTransferFinishedNotification object:self.manager userInfo:@{kCLDTransferKey:self} synchronous:YES];
             if (self.type == CLDTransferTypeDownload) {
-                RunBlockSynchronouslyOnMainThread(self.downloadResultBlock, self.downloadedFileURL);
-                if ([filePath isEqual:self.downloadedFileURL.filePathURL.path]) {
-                    NSError *error = nil;
-                    [[NSFileManager defaultManager] removeItemAtURL:self.downloadedFileURL error:&error];
-                    if (error) CLDLog(@"Error deleting temporary downloaded file: %@", error.userInfo[NSLocalizedFailureReasonErrorKey]);
-                    else CLDLog(@"Deleted temporary file at location: %@", self.downloadedFileURL);
-                } else {
-                    CLDLog(@"Temporary file was moved!");
-                }
+                // the file is removed on the callback queue once the result block returns, waiting for it here could deadlock
+                CLDTransferDownloadResultBlock downloadResultBlock = self.downloadResultBlock;
+                NSURL *downloadedFileURL = self.downloadedFileURL;
+                CLDTraceDispatchAsync(self.callbackQueue ?: dispatch_get_main_queue(), ^{
+                    RunBlock(downloadResultBlock, downloadedFileURL);
+                    if ([filePath isEqual:downloadedFileURL.filePathURL.path]) {
+                        NSError *error = nil;
+                        [[NSFileManager defaultManager] removeItemAtURL:downloadedFileURL error:&error];
+                        if (error) CLDLog(@"Error deleting temporary downloaded file: %@", error.userInfo[NSLocalizedFailureReasonErrorKey]);
+                        else CLDLog(@"Deleted temporary file at location: %@", downloadedFileURL);
+                    } else {
+                        CLDLog(@"Temporary file was moved!");
+                    }
+                });
             } else {
-                RunBlockOnMainThread(self.uploadResultBlock, self.uploadedItem);
+                RunBlockOnQueue(self.callbackQueue ?: dispatch_get_main_queue(), self.uploadResultBlock, self.uploadedItem);
             }
             break;
         }
@@ -18,6 +18,12 @@ FOUNDATION_EXPORT NSString* const kCLDTransferFinishedNotification;
 FOUNDATION_EXPORT NSString* const kCLDTransferUpdatedProgressNotification;
 FOUNDATION_EXPORT NSString* const kCLDTransferKey;
 
+/**
+ Default value for <[CLDTransferManager quotaRefreshInterval]>.
+ @since 1.1
+ */
+FOUNDATION_EXPORT const NSTimeInterval CLDTransferManagerDefaultQuotaRefreshInterval;
+
 /**
  This class is used to manage all transfers created by instances of `CLDSession`.
  */
@@ -46,6 +52,41 @@ FOUNDATION_EXPORT NSString* const kCLDTransferKey;
  */
 - (NSArray *)transfersOfType:(CLDTransferType)type;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @name Account quota
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ The free space on the user's account, as last reported by <[CLDSession fetchAccountInformationWithResultBlock:failureBlock:]>,
+ or `nil` if it was not fetched yet.
+ 
+ Uploads reserve their size before sending any data. An upload that could never fit in the available space is rejected when
+ it is scheduled. One that does not fit next to the uploads ahead of it waits for its turn, and fails with an over quota
+ error only if there is still not enough space by then.
+ @see reservedQuota
+ @since 1.1
+ */
+@property (readonly, strong, atomic) NSDecimalNumber *quotaAvailable;
+
+/**
+ The number of bytes reserved by uploads that are being sent and have not been committed yet.
+ @since 1.1
+ */
+@property (readonly, atomic) uint64_t reservedQuota;
+
+/**
+ How long the available quota is trusted before it is fetched again.
+ Default value is `CLDTransferManagerDefaultQuotaRefreshInterval`.
+ @since 1.1
+ */
+@property (readwrite, atomic) NSTimeInterval quotaRefreshInterval;
+
+/**
+ Fetches the available quota again, without waiting for <quotaRefreshInterval> to pass.
+ @since 1.1
+ */
+- (void)refreshQuota;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @name Clearing transfers
 ////////////////////////////////////////////////////////////////////////////////
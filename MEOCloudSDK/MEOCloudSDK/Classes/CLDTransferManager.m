@@ -16,6 +16,8 @@ NSString* const kCLDTransferFinishedNotification = @"kCLDTransferFinishedNotific
 NSString* const kCLDTransferUpdatedProgressNotification = @"kCLDTransferUpdatedProgressNotification";
 NSString* const kCLDTransferKey = @"kCLDTransferKey";
 
+const NSTimeInterval CLDTransferManagerDefaultQuotaRefreshInterval = 5 * 60;
+
 // CLDTransfer category to expose private properties
 @interface CLDTransfer (TransferManager)
 @property (readwrite, nonatomic) BOOL allowsCellularAccess;
@@ -48,6 +50,13 @@ NSString* const kCLDTransferKey = @"kCLDTransferKey";
 
 @implementation CLDTransferManager {
     NSUInteger _backgroundTaskIdentifier;
+    dispatch_queue_t _quotaQueue;
+    NSDecimalNumber *_quotaAvailable;
+    NSDate *_quotaRefreshDate;
+    NSTimeInterval _quotaRefreshInterval;
+    BOOL _refreshingQuota;
+    NSMutableArray *_quotaRefreshBlocks;
+    NSMutableDictionary *_quotaReservations; // transfer identifier -> bytes
 }
 
 #pragma mark - Initialization
@@ -71,6 +80,11 @@ NSString* const kCLDTransferKey = @"kCLDTransferKey";
         
         [self _registerForApplicationStateChangeNotification];
         
+        _quotaQueue = dispatch_queue_create("pt.meo.cloud.sdk.transfermanager.quota", DISPATCH_QUEUE_SERIAL);
+        _quotaRefreshInterval = CLDTransferManagerDefaultQuotaRefreshInterval;
+        _quotaRefreshBlocks = [NSMutableArray new];
+        _quotaReservations = [NSMutableDictionary new];
+        
         _backgroundTaskIdentifier = NSNotFound;
         [self _registerForTransferNotifications];
     }
@@ -90,8 +104,10 @@ NSString* const kCLDTransferKey = @"kCLDTransferKey";
 }
 
 - (void)_loadTransfersIfTheyExist {
+    uint64_t traceStart = CLDTraceBegin();
     NSString *filePath = [self _transfersArchiveURL].path;
     NSArray *transfers = [NSKeyedUnarchiver unarchiveObjectWithFile:filePath];
+    CLDTraceEnd(CLDTraceSpanArchiveLoad, traceStart);
     for (CLDTransfer *transfer in transfers) {
         transfer.manager = self;
         
@@ -107,6 +123,7 @@ NSString* const kCLDTransferKey = @"kCLDTransferKey";
 //#ifdef DEBUG
 //    NSDate *date = [NSDate date];
 //#endif
+    uint64_t traceStart = CLDTraceBegin();
     @try {
         NSString *filePath = [self _transfersArchiveURL].path;
         [NSKeyedArchiver archiveRootObject:self.transfers toFile:filePath];
@@ -114,6 +131,7 @@ NSString* const kCLDTransferKey = @"kCLDTransferKey";
     @catch (NSException *exception) {
         CLDLog(@"Could not save. Error: %@", exception.description);
     }
+    CLDTraceEnd(CLDTraceSpanArchiveSave, traceStart);
 //#ifdef DEBUG
 //    double elapsedTime = [[NSDate date] timeIntervalSinceDate:date];
 //    CLDLog(@"Saved transfer list. Took %f seconds", elapsedTime);
@@ -174,6 +192,7 @@ NSString* const kCLDTransferKey = @"kCLDTransferKey";
                 });
             }];
         } else if ([notification.name isEqualToString:kCLDTransferFinishedNotification]) {
+            if (notification.object == self) [self _releaseQuotaForTransfer:notification.userInfo[kCLDTransferKey]];
 
             BOOL hasPendingTransfer = NO;
             for (CLDTransfer *transfer in self.transfers) {
@@ -254,6 +273,10 @@ NSString* const kCLDTransferKey = @"kCLDTransferKey";
         if (error) *error = [CLDError errorWithCode:CLDErrorCodeInvalidItem];
         return nil;
     }
+    if (![self _quotaCouldFitBytes:item.size]) {
+        if (error) *error = [CLDError errorWithCode:CLDErrorCodeOverQuota];
+        return nil;
+    }
     CLDTransfer *transfer = [[CLDTransfer alloc] initWithManager:self];
     transfer.type = CLDTransferTypeUpload;
     transfer.item = item;
@@ -285,6 +308,167 @@ NSString* const kCLDTransferKey = @"kCLDTransferKey";
     return transfer;
 }
 
+#pragma mark - Account quota
+
+- (NSDecimalNumber *)quotaAvailable {
+    @synchronized(self) {
+        return _quotaAvailable;
+    }
+}
+
+- (uint64_t)reservedQuota {
+    @synchronized(self) {
+        return [self _reservedQuota];
+    }
+}
+
+- (NSTimeInterval)quotaRefreshInterval {
+    @synchronized(self) {
+        return _quotaRefreshInterval;
+    }
+}
+
+- (void)setQuotaRefreshInterval:(NSTimeInterval)quotaRefreshInterval {
+    @synchronized(self) {
+        _quotaRefreshInterval = quotaRefreshInterval;
+    }
+}
+
+- (void)refreshQuota {
+    [self _refreshQuotaWithCompletionBlock:nil];
+}
+
+- (void)admitUploadTransfer:(CLDTransfer *)transfer completionBlock:(void (^)(BOOL))completionBlock {
+    NSParameterAssert(transfer);
+    NSParameterAssert(completionBlock);
+    // only the first chunk of an upload has to wait, a stale quota is not worth holding back the others
+    BOOL reserved = NO;
+    @synchronized(self) {
+        reserved = (_quotaReservations[transfer.transferIdentifier] != nil);
+    }
+    if (reserved) {
+        completionBlock(YES);
+        return;
+    }
+
+    void(^admitBlock)() = ^{
+        BOOL admitted = YES;
+        @synchronized(self) {
+            NSString *identifier = transfer.transferIdentifier;
+            // the upload may have given up waiting and be over by now, its reservation would never be released
+            BOOL over = (transfer.state == CLDTransferStateFinished || transfer.state == CLDTransferStateFailed);
+            if (_quotaReservations[identifier] == nil && !over) {
+                // an unknown quota does not hold uploads back, the server has the last word
+                if (_quotaAvailable) {
+                    NSDecimalNumber *reserved = [NSDecimalNumber decimalNumberWithMantissa:[self _reservedQuota] exponent:0 isNegative:NO];
+                    NSDecimalNumber *bytes = [NSDecimalNumber decimalNumberWithMantissa:transfer.bytesTotal exponent:0 isNegative:NO];
+                    NSDecimalNumber *unreserved = [_quotaAvailable decimalNumberBySubtracting:reserved];
+                    admitted = ([unreserved compare:bytes] != NSOrderedAscending);
+                }
+                if (admitted) _quotaReservations[identifier] = @(transfer.bytesTotal);
+            }
+        }
+        completionBlock(admitted);
+    };
+    
+    if ([self _isQuotaStale]) {
+        [self _refreshQuotaWithCompletionBlock:admitBlock];
+    } else {
+        admitBlock();
+    }
+}
+
+- (void)reserveQuotaForUploadTransfer:(CLDTransfer *)transfer {
+    NSParameterAssert(transfer);
+    @synchronized(self) {
+        _quotaReservations[transfer.transferIdentifier] = @(transfer.bytesTotal);
+    }
+}
+
+// must be called inside @synchronized(self)
+- (uint64_t)_reservedQuota {
+    uint64_t reserved = 0;
+    for (NSNumber *bytes in _quotaReservations.allValues) {
+        reserved += bytes.unsignedLongLongValue;
+    }
+    return reserved;
+}
+
+- (BOOL)_isQuotaStale {
+    @synchronized(self) {
+        return _quotaRefreshDate == nil || -_quotaRefreshDate.timeIntervalSinceNow > _quotaRefreshInterval;
+    }
+}
+
+// NO only for uploads that would not fit even if nothing else was being uploaded
+- (BOOL)_quotaCouldFitBytes:(uint64_t)bytes {
+    if ([self _isQuotaStale]) [self refreshQuota];
+    NSDecimalNumber *quotaAvailable = self.quotaAvailable;
+    if (quotaAvailable == nil) return YES;
+    NSDecimalNumber *decimalBytes = [NSDecimalNumber decimalNumberWithMantissa:bytes exponent:0 isNegative:NO];
+    return ([quotaAvailable compare:decimalBytes] != NSOrderedAscending);
+}
+
+- (void)_refreshQuotaWithCompletionBlock:(void(^)())completionBlock {
+    @synchronized(self) {
+        if (completionBlock) [_quotaRefreshBlocks addObject:[completionBlock copy]];
+        if (_refreshingQuota) return;
+        _refreshingQuota = YES;
+    }
+    CLDSession *session = self.session;
+    if (session == nil) {
+        [self _finishQuotaRefreshWithQuotaAvailable:nil];
+        return;
+    }
+    
+    [session performWithCallbackQueue:_quotaQueue block:^{
+        [session performInRequestLane:CLDRequestLaneBackground block:^{
+            [session fetchAccountInformationWithResultBlock:^(CLDAccountUser *user) {
+                [self _finishQuotaRefreshWithQuotaAvailable:user.quotaAvailable];
+            } failureBlock:^(NSError *error) {
+                CLDLog(@"Could not refresh quota. Error: %@", error);
+                [self _finishQuotaRefreshWithQuotaAvailable:nil];
+            }];
+        }];
+    }];
+}
+
+- (void)_finishQuotaRefreshWithQuotaAvailable:(NSDecimalNumber *)quotaAvailable {
+    NSArray *blocks = nil;
+    @synchronized(self) {
+        if (quotaAvailable) {
+            _quotaAvailable = quotaAvailable;
+            _quotaRefreshDate = [NSDate date];
+        }
+        _refreshingQuota = NO;
+        blocks = [_quotaRefreshBlocks copy];
+        [_quotaRefreshBlocks removeAllObjects];
+    }
+    for (void(^block)() in blocks) {
+        block();
+    }
+}
+
+- (void)_releaseQuotaForTransfer:(CLDTransfer *)transfer {
+    if (transfer.type != CLDTransferTypeUpload) return;
+    @synchronized(self) {
+        // the server knows better than whatever quota was fetched, reserved or not
+        if ([transfer.error.domain isEqualToString:CLDErrorDomain] && transfer.error.code == CLDErrorCodeOverQuota) {
+            _quotaRefreshDate = nil;
+        }
+
+        NSNumber *bytes = _quotaReservations[transfer.transferIdentifier];
+        if (bytes == nil) return;
+        [_quotaReservations removeObjectForKey:transfer.transferIdentifier];
+        
+        if (transfer.state == CLDTransferStateFinished && _quotaAvailable) {
+            // the server counts the file now, the next refresh settles overwritten revisions
+            NSDecimalNumber *decimalBytes = [NSDecimalNumber decimalNumberWithMantissa:bytes.unsignedLongLongValue exponent:0 isNegative:NO];
+            _quotaAvailable = [_quotaAvailable decimalNumberBySubtracting:decimalBytes];
+        }
+    }
+}
+
 #pragma mark - Obtaining transfers
 
 - (NSArray *)transfersOfType:(CLDTransferType)type {
@@ -331,15 +515,15 @@ NSString* const kCLDTransferKey = @"kCLDTransferKey";
 //        NSURLSession *backgroundURLSessionWithCellularAccess = [NSURLSession sessionWithConfiguration:backgroundConfigurationWithCellularAccess delegate:self delegateQueue:nil];
         
         // create foreground session
-        NSURLSessionConfiguration *foregroundConfiguration = [NSURLSessionConfiguration defaultSessionConfiguration];
+        NSURLSessionConfiguration *foregroundConfiguration = [self _foregroundConfiguration];
         foregroundConfiguration.allowsCellularAccess = NO;
         foregroundConfiguration.HTTPAdditionalHeaders = additionalHeaders;
         NSURLSession *foregroundURLSession = [NSURLSession sessionWithConfiguration:foregroundConfiguration delegate:self delegateQueue:nil];
         
         // create foreground session with cellular access
-        NSURLSessionConfiguration *foregroundConfigurationWithCellularAccess = [NSURLSessionConfiguration defaultSessionConfiguration];
-        foregroundConfiguration.allowsCellularAccess = YES;
-        foregroundConfiguration.HTTPAdditionalHeaders = additionalHeaders;
+        NSURLSessionConfiguration *foregroundConfigurationWithCellularAccess = [self _foregroundConfiguration];
+        foregroundConfigurationWithCellularAccess.allowsCellularAccess = YES;
+        foregroundConfigurationWithCellularAccess.HTTPAdditionalHeaders = additionalHeaders;
         NSURLSession *foregroundURLSessionWithCellularAccess = [NSURLSession sessionWithConfiguration:foregroundConfigurationWithCellularAccess delegate:self delegateQueue:nil];
         
 //        [self.backgroundURLSession invalidateAndCancel];
@@ -357,6 +541,33 @@ NSString* const kCLDTransferKey = @"kCLDTransferKey";
     }
 }
 
+// transfers only time out when they stall, the resource timeout just bounds a transfer that keeps crawling
+- (NSURLSessionConfiguration *)_foregroundConfiguration {
+    NSURLSessionConfiguration *configuration = [NSURLSessionConfiguration defaultSessionConfiguration];
+    configuration.requestCachePolicy = NSURLRequestReloadIgnoringLocalCacheData;
+    configuration.URLCache = nil;
+    configuration.HTTPShouldSetCookies = NO;
+    configuration.HTTPMaximumConnectionsPerHost = 2; // one transfer per priority queue
+    configuration.timeoutIntervalForRequest = 60;
+    configuration.timeoutIntervalForResource = 24 * 60 * 60;
+    return configuration;
+}
+
+- (void)warmUpConnections {
+    NSURL *url = [self.session _serviceURLForEndpoint:CLDSessionEndpointContentAPI path:@""];
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:url];
+    request.HTTPMethod = @"HEAD";
+    
+    NSArray *urlSessions = nil;
+    @synchronized(self) {
+        urlSessions = @[self.foregroundURLSession, self.foregroundURLSessionWithCellularAccess];
+    }
+    for (NSURLSession *urlSession in urlSessions) {
+        // the delegate methods ignore tasks without an operation
+        [[urlSession dataTaskWithRequest:request] resume];
+    }
+}
+
 - (NSURLSession *)urlSessionForTransfer:(CLDTransfer *)transfer {
 //    if (transfer.isBackgroundTransfer) {
 //        if (transfer.allowsCellularAccess) {
@@ -425,6 +636,8 @@ NSString* const kCLDTransferKey = @"kCLDTransferKey";
         NSString *tempFilePath = [NSTemporaryDirectory() stringByAppendingPathComponent:tempFileName];
         NSURL *tempFileLocation = [NSURL fileURLWithPath:tempFilePath];
         NSError *error = nil;
+        // left over by an earlier attempt that turned out to be incomplete
+        [[NSFileManager defaultManager] removeItemAtURL:tempFileLocation error:nil];
         [[NSFileManager defaultManager] moveItemAtURL:location toURL:tempFileLocation error:&error];
         operation.temporaryDownloadedFileURL = [tempFileLocation fileReferenceURL];
     } else {
@@ -470,6 +683,9 @@ NSString* const kCLDTransferKey = @"kCLDTransferKey";
         [transfer cancel];
     }
     [self.transfers removeAllObjects];
+    @synchronized(self) {
+        [_quotaReservations removeAllObjects];
+    }
 }
 
 
@@ -0,0 +1,122 @@
+//
+//  CLDTreeCrawler.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+@class CLDItem;
+
+/**
+ Default value for <[CLDTreeCrawler maximumConcurrentRequests]>.
+ @since 1.1
+ */
+FOUNDATION_EXPORT const NSUInteger CLDTreeCrawlerDefaultMaximumConcurrentRequests;
+
+/**
+ This class represents the progress of a <CLDTreeCrawler>.
+
+ Checkpoints can be archived using `NSKeyedArchiver` and given back to
+ <[CLDSession crawlItem:options:checkpoint:folderBlock:resultBlock:failureBlock:]> to resume an interrupted crawl
+ or to start a new pass that only lists folders that changed since the last one.
+ @since 1.1
+ */
+@interface CLDTreeCrawlerCheckpoint : NSObject <NSCoding, NSCopying>
+
+/**
+ The path of the folder at the top of the crawled tree.
+ @since 1.1
+ */
+@property (readonly, strong, nonatomic) NSString *path;
+
+/**
+ `BOOL` stating whether the crawl that produced this checkpoint went through the whole tree.
+ @since 1.1
+ */
+@property (readonly, nonatomic, getter = isFinished) BOOL finished;
+
+/**
+ The number of folders whose hash is known by this checkpoint.
+ @since 1.1
+ */
+@property (readonly, nonatomic) NSUInteger numberOfKnownFolders;
+
+/**
+ The number of folders still waiting to be listed.
+ @since 1.1
+ */
+@property (readonly, nonatomic) NSUInteger numberOfPendingFolders;
+
+/**
+ The errors of the folders that could not be listed, keyed by folder path.
+ A folder that fails does not stop the crawl, its subfolders are left out and the next pass lists it again.
+ @since 1.1
+ */
+@property (readonly, strong, nonatomic) NSDictionary *folderErrors;
+
+@end
+
+/**
+ This class walks a folder tree breadth-first, listing several folders at a time.
+
+ Folders whose hash did not change since the checkpoint the crawl started from are not listed again, and their items are not reported.
+ Nor are the subfolders the checkpoint knows below them: what it knows about the subtree is kept, and only subfolders it has no hash for are listed.
+ A folder hash only reflects the folder's own contents, so changes deeper in an unchanged folder are not picked up by such a pass;
+ they are reported by delta polling, or by a crawl that starts without a checkpoint.
+
+ Crawlers are created by <[CLDSession crawlItem:options:checkpoint:folderBlock:resultBlock:failureBlock:]>.
+ @since 1.1
+ */
+@interface CLDTreeCrawler : NSObject
+
+/**
+ The identifier of the session this crawler belongs to.
+ @since 1.1
+ */
+@property (readonly, strong, nonatomic) NSString *sessionIdentifier;
+
+/**
+ The folder at the top of the crawled tree.
+ @since 1.1
+ */
+@property (readonly, strong, nonatomic) CLDItem *item;
+
+/**
+ The maximum number of folders being listed at the same time.
+ Default value is `CLDTreeCrawlerDefaultMaximumConcurrentRequests`.
+ @since 1.1
+ */
+@property (readwrite, atomic) NSUInteger maximumConcurrentRequests;
+
+/**
+ The number of folders listed so far.
+ @since 1.1
+ */
+@property (readonly, atomic) NSUInteger numberOfListedFolders;
+
+/**
+ The number of folders skipped so far because they, or a folder above them, did not change.
+ @since 1.1
+ */
+@property (readonly, atomic) NSUInteger numberOfUnchangedFolders;
+
+/**
+ `BOOL` stating whether the crawler was cancelled.
+ @since 1.1
+ */
+@property (readonly, atomic, getter = isCancelled) BOOL cancelled;
+
+/**
+ Returns a snapshot of the crawler's progress that can be used to resume it later.
+ @since 1.1
+ */
+- (CLDTreeCrawlerCheckpoint *)checkpoint;
+
+/**
+ Cancels the crawler. Requests already sent are ignored and the failure block is called with a `CLDErrorCancelledByUser` error.
+ @since 1.1
+ */
+- (void)cancel;
+
+@end
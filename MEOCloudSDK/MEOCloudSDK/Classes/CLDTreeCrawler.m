@@ -0,0 +1,390 @@
+//
+//  CLDTreeCrawler.m
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import "CLDTreeCrawler.h"
+
+const NSUInteger CLDTreeCrawlerDefaultMaximumConcurrentRequests = 4;
+
+@interface CLDTreeCrawlerCheckpoint ()
+@property (readwrite, strong, nonatomic) NSString *path;
+@property (readwrite, nonatomic, getter = isFinished) BOOL finished;
+@property (readwrite, strong, nonatomic) NSDictionary *folderHashes;    // folder path -> folder hash
+@property (readwrite, strong, nonatomic) NSDictionary *childFolders;    // folder path -> subfolder paths
+@property (readwrite, strong, nonatomic) NSArray *pendingPaths;
+@property (readwrite, strong, nonatomic) NSArray *visitedPaths;
+@property (readwrite, strong, nonatomic) NSDictionary *folderErrors;    // folder path -> error listing it
+@end
+
+@implementation CLDTreeCrawlerCheckpoint
+
+#pragma mark - NSCoding
+
+- (id)initWithCoder:(NSCoder *)aDecoder {
+    self = [super init];
+    _path = [aDecoder decodeObjectForKey:@"path"];
+    _finished = [aDecoder decodeBoolForKey:@"finished"];
+    _folderHashes = [aDecoder decodeObjectForKey:@"folderHashes"];
+    _childFolders = [aDecoder decodeObjectForKey:@"childFolders"];
+    _pendingPaths = [aDecoder decodeObjectForKey:@"pendingPaths"];
+    _visitedPaths = [aDecoder decodeObjectForKey:@"visitedPaths"];
+    _folderErrors = [aDecoder decodeObjectForKey:@"folderErrors"] ?: @{};
+    return self;
+}
+
+- (void)encodeWithCoder:(NSCoder *)aCoder {
+    [aCoder encodeObject:self.path forKey:@"path"];
+    [aCoder encodeBool:self.isFinished forKey:@"finished"];
+    [aCoder encodeObject:self.folderHashes forKey:@"folderHashes"];
+    [aCoder encodeObject:self.childFolders forKey:@"childFolders"];
+    [aCoder encodeObject:self.pendingPaths forKey:@"pendingPaths"];
+    [aCoder encodeObject:self.visitedPaths forKey:@"visitedPaths"];
+    [aCoder encodeObject:self.folderErrors forKey:@"folderErrors"];
+}
+
+#pragma mark - NSCopying
+
+- (id)copyWithZone:(NSZone *)zone {
+    // checkpoints are immutable
+    return self;
+}
+
+#pragma mark - Dynamic properties
+
+- (NSUInteger)numberOfKnownFolders {
+    return self.folderHashes.count;
+}
+
+- (NSUInteger)numberOfPendingFolders {
+    return self.pendingPaths.count;
+}
+
+@end
+
+
+
+
+@interface CLDTreeCrawler ()
+@property (readwrite, strong, nonatomic) NSString *sessionIdentifier;
+@property (readwrite, strong, nonatomic) CLDItem *item;
+@property (readwrite, atomic) NSUInteger numberOfListedFolders;
+@property (readwrite, atomic) NSUInteger numberOfUnchangedFolders;
+@property (readwrite, atomic, getter = isCancelled) BOOL cancelled;
+
+@property (readwrite, strong, nonatomic) CLDSession *session;
+@property (readwrite, nonatomic) CLDSessionFetchItemOptions options;
+@property (readwrite, copy, nonatomic) CLDTreeCrawlerFolderBlock folderBlock;
+@property (readwrite, copy, nonatomic) CLDTreeCrawlerResultBlock resultBlock;
+@property (readwrite, copy, nonatomic) CLDTreeCrawlerFailureBlock failureBlock;
+@property (readwrite, strong, nonatomic) dispatch_queue_t callbackQueue;
+@end
+
+@implementation CLDTreeCrawler {
+    dispatch_queue_t _queue;
+    NSUInteger _maximumConcurrentRequests;
+    NSMutableDictionary *_folderHashes;
+    NSMutableDictionary *_childFolders;
+    NSMutableOrderedSet *_pendingPaths;
+    NSMutableOrderedSet *_activePaths;
+    NSMutableDictionary *_requests;     // folder path -> CLDRequest listing it
+    NSMutableSet *_visitedPaths;
+    NSMutableDictionary *_folderErrors;
+    BOOL _started;
+    BOOL _stopped;
+}
+
+#pragma mark - Initialization
+
+- (instancetype)initWithSession:(CLDSession *)session
+                           item:(CLDItem *)item
+                        options:(CLDSessionFetchItemOptions)options
+                     checkpoint:(CLDTreeCrawlerCheckpoint *)checkpoint {
+    NSParameterAssert(session);
+    NSParameterAssert(item.path);
+    NSParameterAssert(checkpoint == nil || [checkpoint.path isEqualToString:item.path]);
+    self = [super init];
+    if (self) {
+        _session = session;
+        _sessionIdentifier = session.sessionIdentifier;
+        _item = item;
+        _options = options;
+        _maximumConcurrentRequests = CLDTreeCrawlerDefaultMaximumConcurrentRequests;
+        _queue = dispatch_queue_create("pt.meo.cloud.sdk.crawler", DISPATCH_QUEUE_SERIAL);
+        _callbackQueue = dispatch_get_main_queue();
+
+        _folderHashes = checkpoint.folderHashes ? [checkpoint.folderHashes mutableCopy] : [NSMutableDictionary new];
+        _childFolders = checkpoint.childFolders ? [checkpoint.childFolders mutableCopy] : [NSMutableDictionary new];
+        _activePaths = [NSMutableOrderedSet new];
+        _requests = [NSMutableDictionary new];
+
+        // unfinished checkpoints resume where they stopped, finished ones start a new pass
+        if (checkpoint && !checkpoint.isFinished) {
+            _pendingPaths = [NSMutableOrderedSet orderedSetWithArray:checkpoint.pendingPaths];
+            _visitedPaths = [NSMutableSet setWithArray:checkpoint.visitedPaths];
+            _folderErrors = checkpoint.folderErrors ? [checkpoint.folderErrors mutableCopy] : [NSMutableDictionary new];
+        } else {
+            _pendingPaths = [NSMutableOrderedSet orderedSetWithObject:item.path];
+            _visitedPaths = [NSMutableSet new];
+            _folderErrors = [NSMutableDictionary new];
+        }
+    }
+    return self;
+}
+
+- (void)start {
+    dispatch_async(_queue, ^{
+        _started = YES;
+        [self _scheduleRequests];
+    });
+}
+
+#pragma mark - Dynamic properties
+
+- (NSUInteger)maximumConcurrentRequests {
+    @synchronized(self) {
+        return _maximumConcurrentRequests;
+    }
+}
+
+- (void)setMaximumConcurrentRequests:(NSUInteger)maximumConcurrentRequests {
+    @synchronized(self) {
+        _maximumConcurrentRequests = MAX(maximumConcurrentRequests, 1);
+    }
+    dispatch_async(_queue, ^{
+        [self _scheduleRequests];
+    });
+}
+
+#pragma mark - Public methods
+
+- (CLDTreeCrawlerCheckpoint *)checkpoint {
+    __block CLDTreeCrawlerCheckpoint *checkpoint = nil;
+    dispatch_sync(_queue, ^{
+        checkpoint = [self _checkpoint];
+    });
+    return checkpoint;
+}
+
+- (void)cancel {
+    self.cancelled = YES;
+    dispatch_async(_queue, ^{
+        [self _stopWithError:[CLDError errorWithCode:CLDErrorCancelledByUser]];
+    });
+}
+
+#pragma mark - Private methods
+
+// all methods below must be called on _queue
+
+- (CLDTreeCrawlerCheckpoint *)_checkpoint {
+    CLDTreeCrawlerCheckpoint *checkpoint = [CLDTreeCrawlerCheckpoint new];
+    checkpoint.path = self.item.path;
+    checkpoint.finished = _stopped && _pendingPaths.count == 0 && _activePaths.count == 0;
+    checkpoint.folderHashes = [_folderHashes copy];
+    checkpoint.childFolders = [_childFolders copy];
+
+    // folders being listed have to be listed again when resuming
+    NSMutableArray *pendingPaths = [NSMutableArray arrayWithArray:_activePaths.array];
+    [pendingPaths addObjectsFromArray:_pendingPaths.array];
+    checkpoint.pendingPaths = pendingPaths;
+    checkpoint.visitedPaths = _visitedPaths.allObjects;
+    checkpoint.folderErrors = [_folderErrors copy];
+    return checkpoint;
+}
+
+- (void)_scheduleRequests {
+    if (!_started || _stopped) return;
+
+    if (_pendingPaths.count == 0 && _activePaths.count == 0) {
+        [self _finish];
+        return;
+    }
+
+    NSUInteger maximumConcurrentRequests = self.maximumConcurrentRequests;
+    while (_activePaths.count < maximumConcurrentRequests && _pendingPaths.count > 0) {
+        NSString *path = _pendingPaths.firstObject;
+        [_pendingPaths removeObjectAtIndex:0];
+        [_activePaths addObject:path];
+        [self _listFolderAtPath:path];
+    }
+}
+
+- (void)_enqueuePaths:(NSArray *)paths {
+    for (NSString *path in paths) {
+        if ([_visitedPaths containsObject:path] || [_activePaths containsObject:path]) continue;
+        [_pendingPaths addObject:path];
+    }
+}
+
+- (void)_listFolderAtPath:(NSString *)path {
+    // only send the hash if we also know the subfolders, otherwise a 304 would leave us stuck
+    NSString *folderHash = _childFolders[path] ? _folderHashes[path] : nil;
+    BOOL includeDeletedItems = (self.options & CLDSessionFetchItemOptionIncludeDeletedItems) != 0;
+    CLDSession *session = self.session;
+
+    NSMutableDictionary *query = [NSMutableDictionary new];
+    query[@"file_limit"] = @(session.itemLimit);
+    if (folderHash) query[@"hash"] = folderHash;
+    query[@"list"] = @"true";
+    query[@"include_deleted"] = includeDeletedItems ? @"true" : @"false";
+
+    NSString *trimmedPath = [path stringByTrimmingCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@"/"]];
+    NSString *urlPath = [NSString stringWithFormat:@"Metadata/<mode>/%@", trimmedPath];
+    NSURL *url = [session _serviceURLForEndpoint:CLDSessionEndpointPublicAPI path:urlPath query:query];
+    NSMutableURLRequest *request = [session _signedMutableURLRequestWithURL:url];
+    CLDRequest *handle = [CLDRequest new];
+    handle.lane = CLDRequestLaneBackground;
+    _requests[path] = handle;
+
+    [session _performJSONRequest:request handle:handle successBlock:^(id object) {
+        if (self.isCancelled) return;
+        CLDItem *folder = [CLDItem itemWithDictionary:object session:session];
+        dispatch_async(_queue, ^{
+            [_requests removeObjectForKey:path];
+            [self _didListFolder:folder atPath:path];
+        });
+    } failureBlock:^(CLDError *error) {
+        dispatch_async(_queue, ^{
+            [_requests removeObjectForKey:path];
+            if (folderHash && error.statusCode == 304) {
+                [self _didSkipFolderAtPath:path];
+            } else if (error.statusCode == 404 && ![path isEqualToString:self.item.path]) {
+                [self _didRemoveFolderAtPath:path];
+            } else if ([self _isFolderError:error] && ![path isEqualToString:self.item.path]) {
+                [self _didFailFolderAtPath:path error:error];
+            } else {
+                [self _stopWithError:error];
+            }
+        });
+    }];
+}
+
+- (void)_didListFolder:(CLDItem *)folder atPath:(NSString *)path {
+    if (_stopped) return;
+    if (folder == nil || folder.type != CLDItemTypeFolder) {
+        CLDError *error = [CLDError errorWithCode:CLDErrorCodeInvalidResponse];
+        if ([path isEqualToString:self.item.path]) [self _stopWithError:error];
+        else [self _didFailFolderAtPath:path error:error];
+        return;
+    }
+
+    NSMutableArray *childFolders = [NSMutableArray new];
+    for (CLDItem *child in folder.contents) {
+        if (child.type == CLDItemTypeFolder && !child.isDeleted && child.path) {
+            [childFolders addObject:child.path];
+        }
+    }
+
+    if (folder.folderHash) _folderHashes[path] = folder.folderHash;
+    else [_folderHashes removeObjectForKey:path];
+    _childFolders[path] = [NSArray arrayWithArray:childFolders];
+    [_activePaths removeObject:path];
+    [_visitedPaths addObject:path];
+    [self _enqueuePaths:childFolders];
+    self.numberOfListedFolders++;
+    [self.session.searchIndex indexFolder:folder];
+
+    CLDTreeCrawlerFolderBlock folderBlock = self.folderBlock;
+    RunBlockOnQueue(self.callbackQueue, folderBlock, folder);
+    [self _scheduleRequests];
+}
+
+- (void)_didSkipFolderAtPath:(NSString *)path {
+    if (_stopped) return;
+    [_activePaths removeObject:path];
+
+    // keep what the checkpoint knows about the subtree, only subfolders it has no hash for are listed
+    NSMutableArray *paths = [NSMutableArray arrayWithObject:path];
+    NSMutableArray *unknownPaths = [NSMutableArray new];
+    while (paths.count > 0) {
+        NSString *folderPath = paths.lastObject;
+        [paths removeLastObject];
+        if ([_visitedPaths containsObject:folderPath] || [_activePaths containsObject:folderPath]) continue;
+        if (_folderHashes[folderPath] == nil || _childFolders[folderPath] == nil) {
+            [unknownPaths addObject:folderPath];
+            continue;
+        }
+        [_pendingPaths removeObject:folderPath];
+        [_visitedPaths addObject:folderPath];
+        [paths addObjectsFromArray:_childFolders[folderPath]];
+        self.numberOfUnchangedFolders++;
+    }
+    [self _enqueuePaths:unknownPaths];
+    [self _scheduleRequests];
+}
+
+- (void)_didRemoveFolderAtPath:(NSString *)path {
+    if (_stopped) return;
+    [_activePaths removeObject:path];
+    [_folderHashes removeObjectForKey:path];
+    [_childFolders removeObjectForKey:path];
+    [self.session.searchIndex removeItemsAtPaths:@[path]];
+    [self _scheduleRequests];
+}
+
+// the folder could not be listed, its siblings can
+- (void)_didFailFolderAtPath:(NSString *)path error:(NSError *)error {
+    if (_stopped) return;
+    [_activePaths removeObject:path];
+    _folderErrors[path] = error;
+    [self _scheduleRequests];
+}
+
+// errors that have to do with the folder itself rather than with the session or the connection
+- (BOOL)_isFolderError:(CLDError *)error {
+    if (![error.domain isEqualToString:CLDErrorDomain]) return NO;
+    switch (error.code) {
+        case CLDErrorCodeAccessForbidden:
+        case CLDErrorCodeInvalidResponse:
+        case CLDErrorCodeTooManyRecords:
+            return YES;
+        case CLDErrorCodeUnknownError:
+            return error.statusCode >= 500;
+        default:
+            return NO;
+    }
+}
+
+- (void)_finish {
+    // forget about folders that no longer exist in the tree, or could not be listed, so that the next pass lists them
+    for (NSString *path in _folderHashes.allKeys) {
+        if (![_visitedPaths containsObject:path]) [_folderHashes removeObjectForKey:path];
+    }
+    for (NSString *path in _childFolders.allKeys) {
+        if (![_visitedPaths containsObject:path]) [_childFolders removeObjectForKey:path];
+    }
+    _stopped = YES;
+
+    CLDTreeCrawlerResultBlock resultBlock = self.resultBlock;
+    CLDTreeCrawlerCheckpoint *checkpoint = [self _checkpoint];
+    RunBlockOnQueue(self.callbackQueue, resultBlock, checkpoint);
+    [self _releaseBlocks];
+}
+
+- (void)_stopWithError:(NSError *)error {
+    if (_stopped) return;
+    _stopped = YES;
+
+    // folders still being listed stay pending in the checkpoint
+    for (CLDRequest *request in _requests.allValues) [request cancel];
+    [_requests removeAllObjects];
+
+    CLDTreeCrawlerFailureBlock failureBlock = self.failureBlock;
+    CLDTreeCrawlerCheckpoint *checkpoint = [self _checkpoint];
+    RunBlockOnQueue(self.callbackQueue, failureBlock, error, checkpoint);
+    [self _releaseBlocks];
+}
+
+// blocks usually capture the crawler, break the cycle once we're done
+- (void)_releaseBlocks {
+    self.folderBlock = nil;
+    self.resultBlock = nil;
+    self.failureBlock = nil;
+    self.session = nil;
+}
+
+@end
@@ -73,7 +73,9 @@ static NSMutableDictionary * CLDKeychainQueryDictionaryWithIdentifier(NSString *
     if (status != errSecSuccess) CLDLog(@"Unable to fetch credential with identifier \"%@\" (Error %li)", identifier, (long int)status);
     else {
         NSData *data = (__bridge_transfer NSData *)result;
+        uint64_t traceStart = CLDTraceBegin();
         credential = [NSKeyedUnarchiver unarchiveObjectWithData:data];
+        CLDTraceEnd(CLDTraceSpanArchiveLoad, traceStart);
     }
     return credential;
 }
@@ -84,13 +86,15 @@ static NSMutableDictionary * CLDKeychainQueryDictionaryWithIdentifier(NSString *
     if (!credential) return [self deleteCredentialWithIdentifier:identifier];
     
     NSMutableDictionary *updateDictionary = [NSMutableDictionary new];
+    uint64_t traceStart = CLDTraceBegin();
     NSData *data = [NSKeyedArchiver archivedDataWithRootObject:credential];
+    CLDTraceEnd(CLDTraceSpanArchiveSave, traceStart);
     updateDictionary[(__bridge id)kSecValueData] = data;
     
     updateDictionary[(__bridge id)kSecAttrAccessible] = (__bridge id)(kSecAttrAccessibleAlways);
     
     OSStatus status;
-    BOOL exists = ([self credentialWithIdentifier:identifier] != nil);
+    BOOL exists = [self _credentialExistsWithIdentifier:identifier];
     
     if (exists) {
         status = SecItemUpdate((__bridge CFDictionaryRef)queryDictionary, (__bridge CFDictionaryRef)updateDictionary);
@@ -103,6 +107,13 @@ static NSMutableDictionary * CLDKeychainQueryDictionaryWithIdentifier(NSString *
     return (status == errSecSuccess);
 }
 
+// only asks the keychain for the item's attributes, so the stored credential isn't fetched and unarchived
++ (BOOL)_credentialExistsWithIdentifier:(NSString *)identifier {
+    NSMutableDictionary *queryDictionary = CLDKeychainQueryDictionaryWithIdentifier(identifier);
+    queryDictionary[(__bridge id)kSecMatchLimit] = (__bridge id)kSecMatchLimitOne;
+    return (SecItemCopyMatching((__bridge CFDictionaryRef)queryDictionary, NULL) == errSecSuccess);
+}
+
 + (BOOL)deleteCredentialWithIdentifier:(NSString *)identifier {
     NSMutableDictionary *queryDictionary = CLDKeychainQueryDictionaryWithIdentifier(identifier);
     OSStatus status = SecItemDelete((__bridge CFDictionaryRef)queryDictionary);
@@ -0,0 +1,29 @@
+//
+//  CLDBatchOperation+Private.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import <MEOCloudSDK/CLDBatchOperation.h>
+#import <MEOCloudSDK/CLDSession.h>
+
+typedef CLDRequest *(^CLDBatchOperationRequestBlock)(CLDItem *item, NSString *path, void(^resultBlock)(CLDItem *item), void(^failureBlock)(NSError *error));
+typedef void(^CLDBatchOperationProgressBlock)(NSUInteger numberOfFinishedItems, NSUInteger numberOfItems);
+typedef void(^CLDBatchOperationCompletionBlock)(NSArray *results);
+
+@interface CLDBatchOperation (Private)
+@property (readwrite, copy, nonatomic) CLDBatchOperationProgressBlock progressBlock;
+@property (readwrite, copy, nonatomic) CLDBatchOperationCompletionBlock completionBlock;
+@property (readwrite, strong, nonatomic) dispatch_queue_t callbackQueue;
+@property (readwrite, nonatomic) CLDRequestLane lane;
+
+// paths must be as many as items, or nil
+- (instancetype)initWithSession:(CLDSession *)session
+                          items:(NSArray *)items
+                          paths:(NSArray *)paths
+                        options:(CLDSessionBatchOptions)options
+                   requestBlock:(CLDBatchOperationRequestBlock)requestBlock;
+- (void)start;
+@end
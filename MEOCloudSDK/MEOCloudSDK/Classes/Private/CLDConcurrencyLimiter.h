@@ -0,0 +1,26 @@
+//
+//  CLDConcurrencyLimiter.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+// Finds how many requests can be in flight without overloading the server (AIMD).
+// The window grows by one request per round trip while latency stays close to the lowest seen recently,
+// and shrinks by 30%, at most once per round trip, on timeouts, 5xx responses or rising latency.
+// Not thread safe, CLDRequestScheduler calls it from its own queue.
+@interface CLDConcurrencyLimiter : NSObject
+
+@property (readonly, nonatomic) NSUInteger limit;
+@property (readwrite, nonatomic) NSUInteger maximumLimit;   // the window never grows past what can actually be sent
+@property (readonly, nonatomic) NSTimeInterval smoothedRoundTripTime;
+
+- (instancetype)initWithInitialLimit:(NSUInteger)initialLimit minimumLimit:(NSUInteger)minimumLimit maximumLimit:(NSUInteger)maximumLimit;
+
+// roundTripTime must not include any time spent before the request was sent
+// windowLimited means requests are waiting that only the window holds back, it only grows when it is fully used
+- (void)requestDidCompleteWithRoundTripTime:(NSTimeInterval)roundTripTime windowLimited:(BOOL)windowLimited;
+- (void)requestDidOverload;
+
+@end
@@ -0,0 +1,82 @@
+//
+//  CLDConcurrencyLimiter.m
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import "CLDConcurrencyLimiter.h"
+
+static const double CLDConcurrencyLimiterDecreaseFactor = 0.7;
+static const double CLDConcurrencyLimiterLatencyTolerance = 2;        // times the baseline round trip time
+static const NSTimeInterval CLDConcurrencyLimiterLatencySlack = 0.05;  // keeps tiny round trip times from looking like congestion
+static const NSTimeInterval CLDConcurrencyLimiterBaselineLifetime = 30;
+
+@implementation CLDConcurrencyLimiter {
+    double _window;
+    NSUInteger _minimumLimit;
+    NSUInteger _maximumLimit;
+    NSTimeInterval _baselineRoundTripTime;
+    CFAbsoluteTime _baselineTime;
+    CFAbsoluteTime _lastDecreaseTime;
+}
+
+- (instancetype)initWithInitialLimit:(NSUInteger)initialLimit minimumLimit:(NSUInteger)minimumLimit maximumLimit:(NSUInteger)maximumLimit {
+    NSParameterAssert(minimumLimit > 0 && minimumLimit <= initialLimit && initialLimit <= maximumLimit);
+    self = [super init];
+    if (self) {
+        _window = initialLimit;
+        _minimumLimit = minimumLimit;
+        _maximumLimit = maximumLimit;
+    }
+    return self;
+}
+
+- (NSUInteger)limit {
+    return (NSUInteger)_window;
+}
+
+- (NSUInteger)maximumLimit {
+    return _maximumLimit;
+}
+
+- (void)setMaximumLimit:(NSUInteger)maximumLimit {
+    _maximumLimit = MAX(maximumLimit, _minimumLimit);
+    _window = MIN(_window, _maximumLimit);
+}
+
+- (void)requestDidCompleteWithRoundTripTime:(NSTimeInterval)roundTripTime windowLimited:(BOOL)windowLimited {
+    if (roundTripTime < 0) return;
+    CFAbsoluteTime now = CFAbsoluteTimeGetCurrent();
+    _smoothedRoundTripTime = (_smoothedRoundTripTime == 0) ? roundTripTime : (7 * _smoothedRoundTripTime + roundTripTime) / 8;
+
+    // the baseline is the lowest round trip time seen recently, so it follows changes of network
+    if (_baselineRoundTripTime == 0 || roundTripTime < _baselineRoundTripTime) {
+        _baselineRoundTripTime = roundTripTime;
+        _baselineTime = now;
+    } else if (now - _baselineTime > CLDConcurrencyLimiterBaselineLifetime) {
+        _baselineRoundTripTime = MIN(_smoothedRoundTripTime, roundTripTime);
+        _baselineTime = now;
+    }
+
+    if (_smoothedRoundTripTime > _baselineRoundTripTime * CLDConcurrencyLimiterLatencyTolerance + CLDConcurrencyLimiterLatencySlack) {
+        [self _decreaseWindow];
+    } else if (windowLimited) {
+        _window = MIN(_window + 1 / _window, _maximumLimit);
+    }
+}
+
+- (void)requestDidOverload {
+    [self _decreaseWindow];
+}
+
+- (void)_decreaseWindow {
+    // requests already in flight when the window shrank report the same congestion, only react once per round trip
+    CFAbsoluteTime now = CFAbsoluteTimeGetCurrent();
+    if (now - _lastDecreaseTime < MAX(_smoothedRoundTripTime, CLDConcurrencyLimiterLatencySlack)) return;
+    _lastDecreaseTime = now;
+    _window = MAX(_window * CLDConcurrencyLimiterDecreaseFactor, _minimumLimit);
+}
+
+@end
@@ -0,0 +1,27 @@
+//
+//  CLDDeltaPoller.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+@class CLDSession;
+
+// Polls the Delta endpoint and posts batched change notifications on behalf of a session.
+// The cursor and the revision of every known path are archived in Application Support, with a journal
+// of the changes since, so polling resumes where it stopped and changes can be told apart from new items.
+@interface CLDDeltaPoller : NSObject
+
+@property (readonly, weak, nonatomic) CLDSession *session;
+@property (readonly, atomic, getter = isPolling) BOOL polling;
+@property (readwrite, atomic) NSTimeInterval minimumInterval;
+@property (readwrite, atomic) NSTimeInterval maximumInterval;
+
+- (instancetype)initWithSession:(CLDSession *)session;
+- (void)startWithResultBlock:(void(^)())resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
+- (void)stop;
+
++ (void)removeStateForSessionIdentifier:(NSString *)sessionIdentifier;
+
+@end
@@ -0,0 +1,535 @@
+//
+//  CLDDeltaPoller.m
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import "CLDDeltaPoller.h"
+
+#define CLDDeltaPollerDefaultMinimumInterval 10
+#define CLDDeltaPollerDefaultMaximumInterval 300
+#define CLDDeltaPollerBackoffFactor 2
+#define CLDDeltaPollerMaximumBatchSize 2000
+#define CLDDeltaPollerMaximumJournalLength (4 * 1024 * 1024)
+
+// The revision and original path of every known item, indexed by lowercase path.
+// Children are indexed by their parent, so deleting a folder only touches what is below it.
+@interface CLDDeltaTree : NSObject
+@property (readonly, nonatomic) NSUInteger count;
+- (instancetype)initWithRevisions:(NSDictionary *)revisions paths:(NSDictionary *)paths;
+- (NSString *)revisionForKey:(NSString *)key;
+- (NSString *)pathForKey:(NSString *)key;
+- (NSArray *)allKeys;
+- (void)setRevision:(NSString *)revision path:(NSString *)path forKey:(NSString *)key;
+- (void)removeSubtreeForKey:(NSString *)key;
+- (NSDictionary *)revisions;
+- (NSDictionary *)paths;
+@end
+
+@implementation CLDDeltaTree {
+    NSMutableDictionary *_revisions;    // lowercase path -> revision
+    NSMutableDictionary *_paths;        // lowercase path -> path as the service spells it
+    NSMutableDictionary *_children;     // lowercase path -> NSMutableSet of lowercase child paths
+}
+
+- (instancetype)init {
+    return [self initWithRevisions:nil paths:nil];
+}
+
+- (instancetype)initWithRevisions:(NSDictionary *)revisions paths:(NSDictionary *)paths {
+    self = [super init];
+    if (self) {
+        _revisions = revisions ? [revisions mutableCopy] : [NSMutableDictionary new];
+        _paths = paths ? [paths mutableCopy] : [NSMutableDictionary new];
+        _children = [NSMutableDictionary new];
+        for (NSString *key in _revisions) [self _addChildKey:key];
+    }
+    return self;
+}
+
+- (NSUInteger)count {
+    return _revisions.count;
+}
+
+- (NSString *)revisionForKey:(NSString *)key {
+    return _revisions[key];
+}
+
+- (NSString *)pathForKey:(NSString *)key {
+    // state saved by older versions only has lowercase paths
+    return _revisions[key] ? (_paths[key] ?: key) : nil;
+}
+
+- (NSArray *)allKeys {
+    return _revisions.allKeys;
+}
+
+- (NSDictionary *)revisions {
+    return _revisions;
+}
+
+- (NSDictionary *)paths {
+    return _paths;
+}
+
+- (void)setRevision:(NSString *)revision path:(NSString *)path forKey:(NSString *)key {
+    if (_revisions[key] == nil) [self _addChildKey:key];
+    _revisions[key] = revision ?: @"";
+    _paths[key] = path ?: key;
+}
+
+- (void)removeSubtreeForKey:(NSString *)key {
+    NSMutableArray *keys = [NSMutableArray arrayWithObject:key];
+    while (keys.count > 0) {
+        NSString *removedKey = keys.lastObject;
+        [keys removeLastObject];
+        [keys addObjectsFromArray:[_children[removedKey] allObjects]];
+        [_children removeObjectForKey:removedKey];
+        [_revisions removeObjectForKey:removedKey];
+        [_paths removeObjectForKey:removedKey];
+    }
+    [_children[[key stringByDeletingLastPathComponent]] removeObject:key];
+}
+
+- (void)_addChildKey:(NSString *)key {
+    NSString *parentKey = [key stringByDeletingLastPathComponent];
+    if ([parentKey isEqualToString:key]) return;
+    NSMutableSet *children = _children[parentKey];
+    if (children == nil) {
+        children = [NSMutableSet new];
+        _children[parentKey] = children;
+    }
+    [children addObject:key];
+}
+
+@end
+
+
+
+
+@interface CLDDeltaPoller ()
+@property (readwrite, weak, nonatomic) CLDSession *session;
+@property (readwrite, atomic, getter = isPolling) BOOL polling;
+@end
+
+@implementation CLDDeltaPoller {
+    dispatch_queue_t _queue;
+    NSUInteger _generation;
+    NSTimeInterval _interval;
+    NSString *_sessionIdentifier;
+
+    // persisted state, a snapshot plus a journal of what changed since
+    NSString *_cursor;
+    NSString *_savedCursor;
+    CLDDeltaTree *_tree;
+    CLDDeltaTree *_treeBeforeReset;         // kept, and persisted, until a cycle that went through a reset is complete
+    NSMutableArray *_journalChanges;        // @[key, path, revision] or @[key] if removed, not yet journaled
+    BOOL _journalReset;
+    BOOL _journalResetFinished;
+
+    // current poll cycle
+    NSMutableDictionary *_changes;          // lowercase path -> CLDItem, or the deleted item's path
+    NSMutableArray *_changedPaths;          // keeps the order in which paths changed
+    NSMutableDictionary *_existedBefore;    // lowercase path -> @(BOOL)
+    BOOL _cycleHadChanges;
+    NSMutableArray *_deferredNotifications; // notifications held back until polling has started
+}
+
+#pragma mark - Initialization
+
+- (instancetype)initWithSession:(CLDSession *)session {
+    NSParameterAssert(session);
+    self = [super init];
+    if (self) {
+        _session = session;
+        _sessionIdentifier = session.sessionIdentifier;
+        _queue = dispatch_queue_create("pt.meo.cloud.sdk.delta", DISPATCH_QUEUE_SERIAL);
+        _minimumInterval = CLDDeltaPollerDefaultMinimumInterval;
+        _maximumInterval = CLDDeltaPollerDefaultMaximumInterval;
+        _journalChanges = [NSMutableArray new];
+    }
+    return self;
+}
+
+#pragma mark - Loading / saving state
+
++ (NSURL *)_stateArchiveURLForSessionIdentifier:(NSString *)sessionIdentifier {
+    NSURL *applicationSupport = [CLDUtil applicationSupportDirectory];
+    NSString *fileName = [NSString stringWithFormat:@"pt.meo.cloud.sdk.%@.delta", sessionIdentifier];
+    return [applicationSupport URLByAppendingPathComponent:fileName];
+}
+
++ (NSURL *)_journalURLForSessionIdentifier:(NSString *)sessionIdentifier {
+    NSURL *applicationSupport = [CLDUtil applicationSupportDirectory];
+    NSString *fileName = [NSString stringWithFormat:@"pt.meo.cloud.sdk.%@.delta-journal", sessionIdentifier];
+    return [applicationSupport URLByAppendingPathComponent:fileName];
+}
+
++ (void)removeStateForSessionIdentifier:(NSString *)sessionIdentifier {
+    [[NSFileManager defaultManager] removeItemAtURL:[self _stateArchiveURLForSessionIdentifier:sessionIdentifier] error:nil];
+    [[NSFileManager defaultManager] removeItemAtURL:[self _journalURLForSessionIdentifier:sessionIdentifier] error:nil];
+}
+
+- (void)_loadState {
+    NSString *filePath = [[self class] _stateArchiveURLForSessionIdentifier:_sessionIdentifier].path;
+    NSDictionary *state = nil;
+    uint64_t traceStart = CLDTraceBegin();
+    @try {
+        state = [NSKeyedUnarchiver unarchiveObjectWithFile:filePath];
+    }
+    @catch (NSException *exception) {
+        CLDLog(@"Could not load delta state. Error: %@", exception.description);
+    }
+    _cursor = state[@"cursor"];
+    _tree = [[CLDDeltaTree alloc] initWithRevisions:state[@"revisions"] paths:state[@"paths"]];
+    if (state[@"revisionsBeforeReset"]) {
+        _treeBeforeReset = [[CLDDeltaTree alloc] initWithRevisions:state[@"revisionsBeforeReset"] paths:state[@"pathsBeforeReset"]];
+    }
+    [self _replayJournal];
+    _savedCursor = _cursor;
+    CLDTraceEnd(CLDTraceSpanArchiveLoad, traceStart);
+}
+
+// the snapshot holds everything, so the journal can start over
+- (void)_saveState {
+    @try {
+        NSMutableDictionary *state = [NSMutableDictionary new];
+        if (_cursor) state[@"cursor"] = _cursor;
+        state[@"revisions"] = [_tree revisions];
+        state[@"paths"] = [_tree paths];
+        if (_treeBeforeReset) {
+            state[@"revisionsBeforeReset"] = [_treeBeforeReset revisions];
+            state[@"pathsBeforeReset"] = [_treeBeforeReset paths];
+        }
+        NSString *filePath = [[self class] _stateArchiveURLForSessionIdentifier:_sessionIdentifier].path;
+        uint64_t traceStart = CLDTraceBegin();
+        BOOL saved = [NSKeyedArchiver archiveRootObject:state toFile:filePath];
+        CLDTraceEnd(CLDTraceSpanArchiveSave, traceStart);
+        if (saved) {
+            [[NSFileManager defaultManager] removeItemAtURL:[[self class] _journalURLForSessionIdentifier:_sessionIdentifier] error:nil];
+            _savedCursor = _cursor;
+        }
+    }
+    @catch (NSException *exception) {
+        CLDLog(@"Could not save delta state. Error: %@", exception.description);
+    }
+}
+
+// Appends what changed since the last record, together with the cursor it was fetched with.
+// Each record is a length-prefixed keyed archive, so its cost only depends on the size of the batch.
+- (void)_appendJournal {
+    BOOL cursorChanged = (_cursor && ![_cursor isEqualToString:_savedCursor]);
+    if (_journalChanges.count == 0 && !_journalReset && !_journalResetFinished && !cursorChanged) return;
+
+    NSMutableDictionary *record = [NSMutableDictionary new];
+    if (_cursor) record[@"cursor"] = _cursor;
+    if (_journalReset) record[@"reset"] = @YES;
+    if (_journalResetFinished) record[@"resetFinished"] = @YES;
+    record[@"changes"] = [_journalChanges copy];
+
+    NSURL *journalURL = [[self class] _journalURLForSessionIdentifier:_sessionIdentifier];
+    uint64_t traceStart = CLDTraceBegin();
+    @try {
+        NSData *data = [NSKeyedArchiver archivedDataWithRootObject:record];
+        uint32_t length = CFSwapInt32HostToBig((uint32_t)data.length);
+        if (![[NSFileManager defaultManager] fileExistsAtPath:journalURL.path]) {
+            [[NSData data] writeToURL:journalURL atomically:NO];
+        }
+        NSFileHandle *fileHandle = [NSFileHandle fileHandleForWritingToURL:journalURL error:nil];
+        [fileHandle seekToEndOfFile];
+        [fileHandle writeData:[NSData dataWithBytes:&length length:sizeof(length)]];
+        [fileHandle writeData:data];
+        [fileHandle synchronizeFile];
+        [fileHandle closeFile];
+        _savedCursor = _cursor;
+    }
+    @catch (NSException *exception) {
+        CLDLog(@"Could not save delta changes. Error: %@", exception.description);
+    }
+    CLDTraceEnd(CLDTraceSpanArchiveSave, traceStart);
+
+    [_journalChanges removeAllObjects];
+    _journalReset = NO;
+    _journalResetFinished = NO;
+}
+
+- (void)_replayJournal {
+    NSURL *journalURL = [[self class] _journalURLForSessionIdentifier:_sessionIdentifier];
+    NSData *journal = [NSData dataWithContentsOfURL:journalURL options:NSDataReadingMappedIfSafe error:nil];
+    NSUInteger offset = 0;
+    while (offset + sizeof(uint32_t) <= journal.length) {
+        uint32_t length;
+        [journal getBytes:&length range:NSMakeRange(offset, sizeof(length))];
+        length = CFSwapInt32BigToHost(length);
+        if (offset + sizeof(length) + length > journal.length) break;
+
+        NSDictionary *record = nil;
+        @try {
+            record = [NSKeyedUnarchiver unarchiveObjectWithData:[journal subdataWithRange:NSMakeRange(offset + sizeof(length), length)]];
+        }
+        @catch (NSException *exception) {
+            CLDLog(@"Could not load delta changes. Error: %@", exception.description);
+        }
+        if (![record isKindOfClass:[NSDictionary class]]) break;
+        offset += sizeof(length) + length;
+
+        if ([record[@"reset"] boolValue]) [self _beginReset];
+        for (NSArray *change in record[@"changes"]) {
+            if (change.count == 3) [_tree setRevision:change[2] path:change[1] forKey:change[0]];
+            else [_tree removeSubtreeForKey:change[0]];
+        }
+        if (record[@"cursor"]) _cursor = record[@"cursor"];
+        if ([record[@"resetFinished"] boolValue]) _treeBeforeReset = nil;
+    }
+
+    // a record cut short by a crash is dropped, along with its cursor
+    if (offset < journal.length) {
+        NSFileHandle *fileHandle = [NSFileHandle fileHandleForWritingToURL:journalURL error:nil];
+        [fileHandle truncateFileAtOffset:offset];
+        [fileHandle closeFile];
+    }
+}
+
+- (unsigned long long)_journalLength {
+    NSString *journalPath = [[self class] _journalURLForSessionIdentifier:_sessionIdentifier].path;
+    return [[[NSFileManager defaultManager] attributesOfItemAtPath:journalPath error:nil] fileSize];
+}
+
+#pragma mark - Public methods
+
+- (void)startWithResultBlock:(void (^)())resultBlock failureBlock:(void (^)(NSError *))failureBlock {
+    dispatch_queue_t callbackQueue = [self.session _currentCallbackQueue] ?: dispatch_get_main_queue();
+    dispatch_async(_queue, ^{
+        if (self.isPolling) {
+            RunBlockOnQueue(callbackQueue, failureBlock, [CLDError errorWithCode:CLDErrorCodeAlreadyPolling]);
+            return;
+        }
+        self.polling = YES;
+        _interval = self.minimumInterval;
+        if (_tree == nil) [self _loadState];
+
+        NSUInteger generation = ++_generation;
+        _deferredNotifications = [NSMutableArray new];
+        [self _beginCycleWithCompletionBlock:^(NSError *error) {
+            // the first cycle decides whether polling started at all
+            if (error) {
+                [self stop];
+                RunBlockOnQueue(callbackQueue, failureBlock, error);
+            } else {
+                RunBlockOnQueue(callbackQueue, resultBlock);
+                [self _scheduleCycleForGeneration:generation];
+            }
+            
+            // changes were already applied and saved, so they are posted either way
+            NSArray *notifications = _deferredNotifications;
+            _deferredNotifications = nil;
+            for (NSDictionary *notification in notifications) {
+                [CLDUtil postNotificationNamed:notification[@"name"] object:self.session userInfo:notification[@"userInfo"]];
+            }
+        }];
+    });
+}
+
+- (void)stop {
+    dispatch_async(_queue, ^{
+        // outstanding requests and timers belong to an older generation and will be ignored
+        _generation++;
+        _changes = nil;
+        self.polling = NO;
+    });
+}
+
+#pragma mark - Polling
+
+- (void)_scheduleCycleForGeneration:(NSUInteger)generation {
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(_interval * NSEC_PER_SEC)), _queue, ^{
+        if (generation != _generation) return;
+        [self _beginCycleWithCompletionBlock:^(NSError *error) {
+            if (error.code == CLDErrorCodeSessionNotLinked || error.code == CLDErrorCodeUnauthorized) {
+                [self stop];
+                return;
+            }
+            // back off while nothing is happening or the service is failing
+            if (_cycleHadChanges && error == nil) {
+                _interval = self.minimumInterval;
+            } else {
+                _interval = MIN(_interval * CLDDeltaPollerBackoffFactor, self.maximumInterval);
+            }
+            [self _scheduleCycleForGeneration:generation];
+        }];
+    });
+}
+
+- (void)_beginCycleWithCompletionBlock:(void(^)(NSError *error))completionBlock {
+    _changes = [NSMutableDictionary new];
+    _changedPaths = [NSMutableArray new];
+    _existedBefore = [NSMutableDictionary new];
+    _cycleHadChanges = NO;
+    [self _fetchPageForGeneration:_generation completionBlock:completionBlock];
+}
+
+- (void)_fetchPageForGeneration:(NSUInteger)generation completionBlock:(void(^)(NSError *error))completionBlock {
+    CLDSession *session = self.session;
+    if (session == nil) {
+        completionBlock([CLDError errorWithCode:CLDErrorCodeSessionNotLinked]);
+        return;
+    }
+
+    NSMutableDictionary *parameters = [NSMutableDictionary new];
+    if (_cursor) parameters[@"cursor"] = _cursor;
+
+    NSURL *url = [session _serviceURLForEndpoint:CLDSessionEndpointPublicAPI path:@"Delta"];
+    NSMutableURLRequest *request = [session _signedMutableURLRequestWithURL:url];
+    request.HTTPMethod = @"POST";
+    request.HTTPBody = [session _postDataWithDictionary:parameters];
+    CLDRequest *handle = [CLDRequest new];
+    handle.lane = CLDRequestLaneBackground;
+
+    [session _performJSONRequest:request handle:handle successBlock:^(id object) {
+        dispatch_async(_queue, ^{
+            if (generation != _generation) return;
+            if (![object isKindOfClass:[NSDictionary class]] || ![object[@"entries"] isKindOfClass:[NSArray class]]) {
+                completionBlock([CLDError errorWithCode:CLDErrorCodeInvalidResponse]);
+                return;
+            }
+            [self _applyPage:object session:session];
+            if ([object[@"has_more"] boolValue]) {
+                [self _fetchPageForGeneration:generation completionBlock:completionBlock];
+            } else {
+                [self _finishCycle];
+                completionBlock(nil);
+            }
+        });
+    } failureBlock:^(CLDError *error) {
+        dispatch_async(_queue, ^{
+            if (generation != _generation) return;
+            // changes already applied are kept, the cursor is only saved with them
+            [self _flushChanges];
+            completionBlock(error);
+        });
+    }];
+}
+
+- (void)_applyPage:(NSDictionary *)page session:(CLDSession *)session {
+    if ([page[@"reset"] boolValue]) {
+        // the service is sending the whole tree again, anything not in it was deleted
+        [self _flushChanges];
+        [self _beginReset];
+        _journalReset = YES;
+    }
+
+    for (NSArray *entry in page[@"entries"]) {
+        if (![entry isKindOfClass:[NSArray class]] || entry.count < 2 || ![entry[0] isKindOfClass:[NSString class]]) continue;
+        NSString *path = [entry[0] lowercaseString];
+        id metadata = entry[1];
+
+        NSString *previousRevision = [_tree revisionForKey:path];
+        NSString *revisionBeforeReset = previousRevision ? nil : [_treeBeforeReset revisionForKey:path];
+        if (_existedBefore[path] == nil) {
+            _existedBefore[path] = @(previousRevision != nil || revisionBeforeReset != nil);
+        }
+
+        if ([metadata isKindOfClass:[NSDictionary class]]) {
+            CLDItem *item = [CLDItem itemWithDictionary:metadata session:session];
+            NSString *revision = item.revision ?: @"";
+            NSString *itemPath = item.path ?: entry[0];
+            [_tree setRevision:revision path:itemPath forKey:path];
+            [_journalChanges addObject:@[path, itemPath, revision]];
+
+            // a reset sends every item again, only those whose revision changed were modified
+            if (revisionBeforeReset && [revisionBeforeReset isEqualToString:revision] && _changes[path] == nil) continue;
+            [self _recordChange:item forPath:path];
+        } else {
+            NSString *deletedPath = [_tree pathForKey:path] ?: [_treeBeforeReset pathForKey:path] ?: entry[0];
+            [_tree removeSubtreeForKey:path];
+            [_journalChanges addObject:@[path]];
+            [self _recordChange:deletedPath forPath:path];
+        }
+    }
+
+    if ([page[@"cursor"] isKindOfClass:[NSString class]]) {
+        _cursor = page[@"cursor"];
+    }
+
+    if (_changes.count >= CLDDeltaPollerMaximumBatchSize || _journalChanges.count >= CLDDeltaPollerMaximumBatchSize) {
+        [self _flushChanges];
+    }
+}
+
+// what was known before the reset is kept aside until the whole tree has been sent again
+- (void)_beginReset {
+    // a reset during a reset still compares against what the app was last told about
+    if (_treeBeforeReset == nil) _treeBeforeReset = _tree;
+    _tree = [CLDDeltaTree new];
+}
+
+- (void)_recordChange:(id)change forPath:(NSString *)path {
+    if (_changes[path] == nil) [_changedPaths addObject:path];
+    _changes[path] = change;
+}
+
+- (void)_finishCycle {
+    if (_treeBeforeReset) {
+        for (NSString *path in [_treeBeforeReset allKeys]) {
+            if ([_tree revisionForKey:path] || _changes[path]) continue;
+            _existedBefore[path] = @YES;
+            [self _recordChange:[_treeBeforeReset pathForKey:path] forPath:path];
+        }
+        _treeBeforeReset = nil;
+        _journalResetFinished = YES;
+    }
+    [self _flushChanges];
+    if ([self _journalLength] > CLDDeltaPollerMaximumJournalLength) [self _saveState];
+}
+
+// post one notification per kind of change and persist the cursor that goes with them
+- (void)_flushChanges {
+    // the cursor is only persisted together with the changes that came with it
+    [self _appendJournal];
+    if (_changes.count == 0) return;
+    _cycleHadChanges = YES;
+
+    NSMutableArray *createdItems = [NSMutableArray new];
+    NSMutableArray *modifiedItems = [NSMutableArray new];
+    NSMutableArray *deletedItems = [NSMutableArray new];
+
+    for (NSString *path in _changedPaths) {
+        id change = _changes[path];
+        BOOL existed = [_existedBefore[path] boolValue];
+        if ([change isKindOfClass:[NSString class]]) {
+            // items created and deleted in the same batch are never reported
+            if (existed) [deletedItems addObject:[CLDItem itemWithPath:change]];
+        } else if (existed) {
+            [modifiedItems addObject:change];
+        } else {
+            [createdItems addObject:change];
+        }
+    }
+
+    [_changes removeAllObjects];
+    [_changedPaths removeAllObjects];
+    [_existedBefore removeAllObjects];
+
+    NSMutableArray *notifications = [NSMutableArray new];
+    if (createdItems.count > 0) {
+        [notifications addObject:@{@"name": kCLDSessionItemsCreatedNotification, @"userInfo": @{kCLDSessionItemsKey: createdItems}}];
+    }
+    if (modifiedItems.count > 0) {
+        [notifications addObject:@{@"name": kCLDSessionItemsModifiedNotification, @"userInfo": @{kCLDSessionItemsKey: modifiedItems}}];
+    }
+    if (deletedItems.count > 0) {
+        [notifications addObject:@{@"name": kCLDSessionItemsDeletedNotification, @"userInfo": @{kCLDSessionItemsKey: deletedItems}}];
+    }
+    
+    if (_deferredNotifications) {
+        [_deferredNotifications addObjectsFromArray:notifications];
+    } else {
+        for (NSDictionary *notification in notifications) {
+            [CLDUtil postNotificationNamed:notification[@"name"] object:self.session userInfo:notification[@"userInfo"]];
+        }
+    }
+}
+
+@end
@@ -0,0 +1,24 @@
+//
+//  CLDDownloadStream+Private.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import <MEOCloudSDK/CLDDownloadStream.h>
+
+typedef void(^CLDDownloadStreamDataBlock)(NSData *data);
+
+@interface CLDDownloadStream (Private)
+@property (readwrite, copy, nonatomic) void(^resultBlock)();
+@property (readwrite, copy, nonatomic) void(^failureBlock)(NSError *error);
+@property (readwrite, strong, nonatomic) dispatch_queue_t callbackQueue;
+
+// bytes go to dataBlock if there is one, to inputStream otherwise
+- (instancetype)initWithSession:(CLDSession *)session
+                           item:(CLDItem *)item
+                   cacheFileURL:(NSURL *)cacheFileURL
+                      dataBlock:(CLDDownloadStreamDataBlock)dataBlock;
+- (void)start;
+@end
@@ -0,0 +1,24 @@
+//
+//  CLDEndpointMetrics+Private.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import <MEOCloudSDK/CLDEndpointMetrics.h>
+
+@interface CLDEndpointMetrics (Private)
+- (instancetype)initWithEndpoint:(NSString *)endpoint
+                numberOfRequests:(NSUInteger)numberOfRequests
+          numberOfFailedRequests:(NSUInteger)numberOfFailedRequests
+                 numberOfRetries:(NSUInteger)numberOfRetries
+                     bytesResent:(uint64_t)bytesResent
+                statusCodeCounts:(NSDictionary *)statusCodeCounts
+                       bytesSent:(uint64_t)bytesSent
+                   bytesReceived:(uint64_t)bytesReceived
+                        waitTime:(CLDLatencyHistogram *)waitTime
+                 timeToFirstByte:(CLDLatencyHistogram *)timeToFirstByte
+                       totalTime:(CLDLatencyHistogram *)totalTime
+                    recoveryTime:(CLDLatencyHistogram *)recoveryTime;
+@end
@@ -32,7 +32,9 @@ CLDPrintableEnum(CLDErrorCode, NSInteger,
                  CLDErrorCodeServerCouldNotCreateThumbnail,
                  CLDErrorCodeInvalidItem,
                  CLDErrorCodeInvalidParameters,
-                 CLDErrorCancelledByUser
+                 CLDErrorCancelledByUser,
+                 CLDErrorCodeAlreadyPolling,
+                 CLDErrorCodeServiceUnavailable
                  );
 
 @interface CLDError : NSError
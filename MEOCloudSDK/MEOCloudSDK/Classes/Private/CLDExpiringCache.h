@@ -0,0 +1,31 @@
+//
+//  CLDExpiringCache.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+@class CLDSession;
+@class CLDRequest;
+
+typedef void(^CLDExpiringCacheResultBlock)(NSArray *values, NSDate *expireDate);
+typedef CLDRequest *(^CLDExpiringCacheLoadBlock)(CLDExpiringCacheResultBlock resultBlock, void(^failureBlock)(NSError *error));
+
+// Values the server hands out with an expiry date, such as media URLs and copy references.
+// Values are served until shortly before they expire and refreshed in the background as that time approaches.
+// Concurrent misses for the same key share a single load.
+@interface CLDExpiringCache : NSObject
+
+- (instancetype)initWithSession:(CLDSession *)session;
+
+// loadBlock is only called on a miss, or to refresh values about to expire
+- (void)valuesForKey:(NSString *)key
+              handle:(CLDRequest *)handle
+       callbackQueue:(dispatch_queue_t)callbackQueue
+           loadBlock:(CLDExpiringCacheLoadBlock)loadBlock
+         resultBlock:(CLDExpiringCacheResultBlock)resultBlock
+        failureBlock:(void(^)(NSError *error))failureBlock;
+- (void)removeAllValues;
+
+@end
@@ -0,0 +1,174 @@
+//
+//  CLDExpiringCache.m
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import "CLDExpiringCache.h"
+
+#define CLDExpiringCacheMaximumSafetyMargin 60     // values are dropped this long before they expire, at most
+#define CLDExpiringCacheSafetyFraction 0.1         // ...or this fraction of their lifetime, if shorter
+#define CLDExpiringCacheRefreshFraction 0.25       // values are refreshed once this fraction of their lifetime is left
+#define CLDExpiringCachePruneThreshold 500
+
+// someone waiting for a load
+@interface CLDExpiringCacheWaiter : NSObject
+@property (readwrite, strong, nonatomic) CLDRequest *handle;
+@property (readwrite, strong, nonatomic) dispatch_queue_t callbackQueue;
+@property (readwrite, copy, nonatomic) CLDExpiringCacheResultBlock resultBlock;
+@property (readwrite, copy, nonatomic) void(^failureBlock)(NSError *error);
+@end
+
+@implementation CLDExpiringCacheWaiter
+@end
+
+
+
+
+@interface CLDExpiringCacheEntry : NSObject
+@property (readwrite, strong, nonatomic) NSArray *values;
+@property (readwrite, strong, nonatomic) NSDate *expireDate;
+@property (readwrite, strong, nonatomic) NSDate *usableUntilDate;
+@property (readwrite, strong, nonatomic) NSDate *refreshDate;
+@property (readwrite, strong, nonatomic) NSMutableArray *waiters;  // non-nil while loading
+@end
+
+@implementation CLDExpiringCacheEntry
+
+- (BOOL)isUsable {
+    return self.values && self.usableUntilDate.timeIntervalSinceNow > 0;
+}
+
+- (void)setValues:(NSArray *)values expireDate:(NSDate *)expireDate {
+    NSTimeInterval lifetime = MAX(expireDate.timeIntervalSinceNow, 0);
+    NSTimeInterval safetyMargin = MIN(CLDExpiringCacheMaximumSafetyMargin, lifetime * CLDExpiringCacheSafetyFraction);
+    self.values = values;
+    self.expireDate = expireDate;
+    self.usableUntilDate = [expireDate dateByAddingTimeInterval:-safetyMargin];
+    self.refreshDate = [expireDate dateByAddingTimeInterval:-lifetime * CLDExpiringCacheRefreshFraction];
+}
+
+@end
+
+
+
+
+@interface CLDExpiringCache ()
+@property (readwrite, weak, nonatomic) CLDSession *session;
+@end
+
+@implementation CLDExpiringCache {
+    dispatch_queue_t _queue;
+    NSMutableDictionary *_entries;
+}
+
+- (instancetype)initWithSession:(CLDSession *)session {
+    NSParameterAssert(session);
+    self = [super init];
+    if (self) {
+        _session = session;
+        _queue = dispatch_queue_create("pt.meo.cloud.sdk.expiringcache", DISPATCH_QUEUE_SERIAL);
+        _entries = [NSMutableDictionary new];
+    }
+    return self;
+}
+
+- (void)valuesForKey:(NSString *)key
+              handle:(CLDRequest *)handle
+       callbackQueue:(dispatch_queue_t)callbackQueue
+           loadBlock:(CLDExpiringCacheLoadBlock)loadBlock
+         resultBlock:(CLDExpiringCacheResultBlock)resultBlock
+        failureBlock:(void (^)(NSError *))failureBlock {
+    NSParameterAssert(key);
+    NSParameterAssert(loadBlock);
+    CLDRequestLane lane = [self.session _currentRequestLane];
+    dispatch_async(_queue, ^{
+        CLDExpiringCacheEntry *entry = _entries[key];
+        if (entry == nil) {
+            [self _pruneEntries];
+            entry = [CLDExpiringCacheEntry new];
+            _entries[key] = entry;
+        }
+
+        if ([entry isUsable]) {
+            RunRequestBlockOnQueue(handle, callbackQueue, resultBlock, entry.values, entry.expireDate);
+            // close to expiring, whoever asks next gets fresh values without waiting
+            if (entry.waiters == nil && entry.refreshDate.timeIntervalSinceNow <= 0) {
+                [self _loadEntry:entry forKey:key loadBlock:loadBlock lane:CLDRequestLaneBackground];
+            }
+            return;
+        }
+
+        CLDExpiringCacheWaiter *waiter = [CLDExpiringCacheWaiter new];
+        waiter.handle = handle;
+        waiter.callbackQueue = callbackQueue;
+        waiter.resultBlock = resultBlock;
+        waiter.failureBlock = failureBlock;
+        BOOL loading = (entry.waiters != nil);
+        if (!loading) entry.waiters = [NSMutableArray new];
+        [entry.waiters addObject:waiter];
+        if (!loading) [self _loadEntry:entry forKey:key loadBlock:loadBlock lane:lane];
+    });
+}
+
+- (void)removeAllValues {
+    dispatch_async(_queue, ^{
+        // loads in flight still report to their waiters
+        for (NSString *key in _entries.allKeys) {
+            CLDExpiringCacheEntry *entry = _entries[key];
+            if (entry.waiters) entry.values = nil;
+            else [_entries removeObjectForKey:key];
+        }
+    });
+}
+
+#pragma mark - Private methods
+
+// all methods below must be called on _queue
+
+- (void)_loadEntry:(CLDExpiringCacheEntry *)entry forKey:(NSString *)key loadBlock:(CLDExpiringCacheLoadBlock)loadBlock lane:(CLDRequestLane)lane {
+    if (entry.waiters == nil) entry.waiters = [NSMutableArray new];
+    CLDSession *session = self.session;
+    if (session == nil) {
+        [self _finishEntry:entry values:nil expireDate:nil error:[CLDError errorWithCode:CLDErrorCodeSessionNotLinked]];
+        return;
+    }
+
+    // results come back on _queue
+    [session performWithCallbackQueue:_queue block:^{
+        [session performInRequestLane:lane block:^{
+            loadBlock(^(NSArray *values, NSDate *expireDate) {
+                [self _finishEntry:entry values:values expireDate:expireDate error:nil];
+            }, ^(NSError *error) {
+                CLDLog(@"Could not load %@. Error: %@", [key stringByReplacingOccurrencesOfString:@"\n" withString:@" "], error);
+                [self _finishEntry:entry values:nil expireDate:nil error:error];
+            });
+        }];
+    }];
+}
+
+- (void)_finishEntry:(CLDExpiringCacheEntry *)entry values:(NSArray *)values expireDate:(NSDate *)expireDate error:(NSError *)error {
+    NSArray *waiters = entry.waiters;
+    entry.waiters = nil;
+    if (values) [entry setValues:values expireDate:expireDate];
+
+    for (CLDExpiringCacheWaiter *waiter in waiters) {
+        if (values) {
+            RunRequestBlockOnQueue(waiter.handle, waiter.callbackQueue, waiter.resultBlock, values, expireDate);
+        } else {
+            RunRequestBlockOnQueue(waiter.handle, waiter.callbackQueue, waiter.failureBlock, error);
+        }
+    }
+}
+
+- (void)_pruneEntries {
+    if (_entries.count <= CLDExpiringCachePruneThreshold) return;
+    for (NSString *key in _entries.allKeys) {
+        CLDExpiringCacheEntry *entry = _entries[key];
+        if (entry.waiters == nil && ![entry isUsable]) [_entries removeObjectForKey:key];
+    }
+}
+
+@end
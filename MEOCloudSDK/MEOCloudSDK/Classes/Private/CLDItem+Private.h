@@ -8,8 +8,21 @@
 
 #import <MEOCloudSDK/CLDItem.h>
 
+@class CLDItemListing;
+
 @interface CLDItem (Private)
 @property (readonly, strong, nonatomic) NSURL *uploadURL;
 + (instancetype)itemWithDictionary:(NSDictionary *)dictionary session:(CLDSession *)session;
++ (instancetype)itemWithListing:(CLDItemListing *)listing index:(NSUInteger)index;
+// not hollow, although contents and folder hashes are unknown
++ (instancetype)itemWithPath:(NSString *)path
+                    revision:(NSString *)revision
+                        type:(CLDItemType)type
+                        size:(uint64_t)size
+                lastModified:(NSDate *)lastModified
+                    mimeType:(NSString *)mimeType
+                    iconName:(NSString *)iconName
+                hasThumbnail:(BOOL)hasThumbnail
+                     session:(CLDSession *)session;
 - (NSString *)trimmedPath;
 @end
\ No newline at end of file
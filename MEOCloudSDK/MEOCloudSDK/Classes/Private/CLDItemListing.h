@@ -0,0 +1,53 @@
+//
+//  CLDItemListing.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+@class CLDSession;
+
+#define CLDItemListingNotFound UINT32_MAX
+
+typedef NS_OPTIONS(uint16_t, CLDItemListingFlags) {
+    CLDItemListingFlagFolder        = 1 << 0,
+    CLDItemListingFlagSandbox       = 1 << 1,
+    CLDItemListingFlagOwner         = 1 << 2,
+    CLDItemListingFlagHasThumbnail  = 1 << 3,
+    CLDItemListingFlagDeleted       = 1 << 4,
+    CLDItemListingFlagPublicLink    = 1 << 5,
+    CLDItemListingFlagUploadLink    = 1 << 6
+};
+
+// One packed record per listed item.
+// Strings that repeat across a listing (parent path, mime type, icon) are interned,
+// strings that are unique per item (name, revision, folder hash) live in a single UTF-8 pool.
+typedef struct {
+    uint64_t size;
+    NSTimeInterval lastModified;        // since reference date, NAN if missing
+    NSTimeInterval lastModifiedMTime;   // since reference date, NAN if missing
+    uint32_t parentPath;                // interned string index
+    uint32_t mimeType;                  // interned string index
+    uint32_t iconName;                  // interned string index
+    uint32_t name;                      // pool offset
+    uint32_t revision;                  // pool offset
+    uint32_t folderHash;                // pool offset
+    uint16_t flags;
+    uint8_t folderType;
+} CLDItemListingEntry;
+
+// Compact, immutable list of CLDItem instances.
+// Items are only created when first accessed and are kept from then on, so every access to an index
+// returns the same instance, as with a plain array, and entries nobody looks at never become a CLDItem.
+@interface CLDItemListing : NSArray
+
+@property (readonly, strong, nonatomic) NSString *sessionIdentifier;
+
++ (instancetype)listingWithDictionaries:(NSArray *)dictionaries session:(CLDSession *)session;
+
+- (const CLDItemListingEntry *)entryAtIndex:(NSUInteger)index;
+- (NSString *)internedStringAtIndex:(uint32_t)index;
+- (NSString *)pooledStringAtOffset:(uint32_t)offset;
+
+@end
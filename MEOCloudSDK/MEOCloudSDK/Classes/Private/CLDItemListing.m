@@ -0,0 +1,181 @@
+//
+//  CLDItemListing.m
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import "CLDItemListing.h"
+
+@interface CLDSession (CLDItemListing)
+- (NSString *)_accessModeSandbox;
+@end
+
+@interface CLDItemListing () {
+    CLDItemListingEntry *_entries;
+    NSUInteger _count;
+    NSData *_pool;
+    NSArray *_strings;
+    NSPointerArray *_items;
+}
+@property (readwrite, strong, nonatomic) NSString *sessionIdentifier;
+@end
+
+@implementation CLDItemListing
+
++ (instancetype)listingWithDictionaries:(NSArray *)dictionaries session:(CLDSession *)session {
+    NSParameterAssert([dictionaries isKindOfClass:[NSArray class]]);
+    NSParameterAssert(session);
+
+    CLDItemListing *listing = [self new];
+    listing.sessionIdentifier = session.sessionIdentifier;
+    listing->_count = dictionaries.count;
+    listing->_entries = calloc(MAX(listing->_count, 1), sizeof(CLDItemListingEntry));
+    listing->_items = [NSPointerArray strongObjectsPointerArray];
+    listing->_items.count = listing->_count;
+
+    NSString *sandbox = [session _accessModeSandbox];
+    NSMutableData *pool = [NSMutableData dataWithCapacity:listing->_count * 64];
+    NSMutableArray *strings = [NSMutableArray new];
+    NSMutableDictionary *stringIndexes = [NSMutableDictionary new];
+
+    uint32_t (^intern)(NSString *) = ^uint32_t(NSString *string) {
+        if (![string isKindOfClass:[NSString class]]) return CLDItemListingNotFound;
+        NSNumber *index = stringIndexes[string];
+        if (index == nil) {
+            index = @(strings.count);
+            stringIndexes[string] = index;
+            [strings addObject:string];
+        }
+        return index.unsignedIntValue;
+    };
+
+    uint32_t (^append)(NSString *) = ^uint32_t(NSString *string) {
+        if (![string isKindOfClass:[NSString class]]) return CLDItemListingNotFound;
+        uint32_t offset = (uint32_t)pool.length;
+        const char *utf8 = string.UTF8String;
+        [pool appendBytes:utf8 length:strlen(utf8) + 1];
+        return offset;
+    };
+
+    [dictionaries enumerateObjectsUsingBlock:^(NSDictionary *dictionary, NSUInteger idx, BOOL *stop) {
+        NSParameterAssert([dictionary isKindOfClass:[NSDictionary class]]);
+        CLDItemListingEntry *entry = &listing->_entries[idx];
+
+        // split path in a shared parent and a per-item name so it can be rebuilt verbatim
+        NSString *path = dictionary[@"path"];
+        if ([path isKindOfClass:[NSString class]]) {
+            NSRange separator = [path rangeOfString:@"/" options:NSBackwardsSearch];
+            NSUInteger split = separator.location == NSNotFound ? 0 : NSMaxRange(separator);
+            entry->parentPath = intern([path substringToIndex:split]);
+            entry->name = append([path substringFromIndex:split]);
+        } else {
+            entry->parentPath = CLDItemListingNotFound;
+            entry->name = CLDItemListingNotFound;
+        }
+
+        entry->revision = append(dictionary[@"rev"]);
+        entry->size = [dictionary[@"bytes"] unsignedLongLongValue];
+        entry->iconName = intern(dictionary[@"icon"]);
+        entry->lastModified = [NSDateFormatter serviceTimeIntervalFromString:dictionary[@"modified"]];
+        entry->lastModifiedMTime = [NSDateFormatter serviceTimeIntervalFromString:dictionary[@"client_mtime"]];
+        entry->mimeType = CLDItemListingNotFound;
+        entry->folderHash = CLDItemListingNotFound;
+        entry->folderType = CLDItemFolderTypeUnknown;
+
+        CLDItemListingFlags flags = 0;
+        if ([dictionary[@"is_owner"] boolValue]) flags |= CLDItemListingFlagOwner;
+        if ([dictionary[@"root"] isEqual:sandbox]) flags |= CLDItemListingFlagSandbox;
+        if ([dictionary[@"thumb_exists"] boolValue]) flags |= CLDItemListingFlagHasThumbnail;
+        if ([dictionary[@"is_deleted"] boolValue]) flags |= CLDItemListingFlagDeleted;
+        if ([dictionary[@"is_link"] boolValue]) flags |= CLDItemListingFlagPublicLink;
+
+        if ([dictionary[@"is_dir"] boolValue]) {
+            flags |= CLDItemListingFlagFolder;
+            if ([dictionary[@"is_upload"] boolValue]) flags |= CLDItemListingFlagUploadLink;
+            NSString *folderType = dictionary[@"folder_type"];
+            if (folderType == nil) {
+                entry->folderType = CLDItemFolderTypeNormal;
+            } else if ([folderType isEqual:@"shared"]) {
+                entry->folderType = CLDItemFolderTypeShared;
+            }
+            entry->folderHash = append(dictionary[@"hash"]);
+        } else {
+            entry->mimeType = intern(dictionary[@"mime_type"]);
+        }
+        entry->flags = flags;
+    }];
+
+    listing->_pool = [NSData dataWithData:pool];
+    listing->_strings = [NSArray arrayWithArray:strings];
+    return listing;
+}
+
+- (void)dealloc {
+    free(_entries);
+}
+
+#pragma mark - NSArray primitives
+
+- (NSUInteger)count {
+    return _count;
+}
+
+- (id)objectAtIndex:(NSUInteger)index {
+    if (index >= _count) {
+        [NSException raise:NSRangeException format:@"index %lu beyond bounds [0 .. %lu]", (unsigned long)index, (unsigned long)_count];
+    }
+
+    CLDItem *item = nil;
+    @synchronized(_items) {
+        item = [_items pointerAtIndex:index];
+    }
+    if (item) return item;
+
+    // materialize outside the lock, first one to store wins
+    item = [CLDItem itemWithListing:self index:index];
+    @synchronized(_items) {
+        CLDItem *existingItem = [_items pointerAtIndex:index];
+        if (existingItem) return existingItem;
+        [_items replacePointerAtIndex:index withPointer:(__bridge void *)item];
+    }
+    return item;
+}
+
+#pragma mark - NSCopying
+
+// immutable, a copy would only create every item
+- (id)copyWithZone:(NSZone *)zone {
+    return self;
+}
+
+#pragma mark - NSCoding
+
+// archives are written as plain arrays so they stay readable by older versions
+- (Class)classForCoder {
+    return [NSArray class];
+}
+
+- (Class)classForKeyedArchiver {
+    return [NSArray class];
+}
+
+#pragma mark - Entry access
+
+- (const CLDItemListingEntry *)entryAtIndex:(NSUInteger)index {
+    NSParameterAssert(index < _count);
+    return &_entries[index];
+}
+
+- (NSString *)internedStringAtIndex:(uint32_t)index {
+    if (index == CLDItemListingNotFound) return nil;
+    return _strings[index];
+}
+
+- (NSString *)pooledStringAtOffset:(uint32_t)offset {
+    if (offset == CLDItemListingNotFound) return nil;
+    return [NSString stringWithUTF8String:(const char *)_pool.bytes + offset];
+}
+
+@end
@@ -0,0 +1,21 @@
+//
+//  CLDLatencyHistogram+Private.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import <MEOCloudSDK/CLDLatencyHistogram.h>
+
+#define CLDLatencyHistogramBucketCount 13
+
+@interface CLDLatencyHistogram (Private)
++ (NSUInteger)_bucketForTime:(NSTimeInterval)time;
+
+// bucketCounts must hold CLDLatencyHistogramBucketCount values
+- (instancetype)initWithBucketCounts:(const NSUInteger *)bucketCounts
+                           totalTime:(NSTimeInterval)totalTime
+                         minimumTime:(NSTimeInterval)minimumTime
+                         maximumTime:(NSTimeInterval)maximumTime;
+@end
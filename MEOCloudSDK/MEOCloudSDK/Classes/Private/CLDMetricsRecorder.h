@@ -0,0 +1,50 @@
+//
+//  CLDMetricsRecorder.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+@class CLDSession;
+@class CLDSessionMetrics;
+@protocol CLDMetricsExporter;
+
+// Times a task from the moment it is started, the first byte being when its response headers arrive.
+// stop must be called from the task's completion handler.
+@interface CLDTaskTimer : NSObject
+@property (readonly, weak, nonatomic) NSURLSessionTask *task;
+@property (readonly, nonatomic) NSTimeInterval timeToFirstByte;  // negative if there was no response
+@property (readonly, nonatomic) NSTimeInterval totalTime;
+
+- (void)startWithTask:(NSURLSessionTask *)task;
+- (void)stop;
+@end
+
+
+
+
+// Accumulates the metrics of a session. Recording is asynchronous and only touches a few counters.
+// Times are in seconds, negative ones are not known and not recorded.
+@interface CLDMetricsRecorder : NSObject
+@property (readwrite, strong, atomic) id<CLDMetricsExporter> exporter;
+@property (readwrite, atomic) NSTimeInterval exportInterval;
+
+- (instancetype)initWithSession:(CLDSession *)session;
+
+// method and first path component after the API version, e.g. "GET Metadata"
++ (NSString *)endpointForRequest:(NSURLRequest *)request;
+
+- (void)recordTask:(NSURLSessionTask *)task
+          transfer:(BOOL)transfer
+          waitTime:(NSTimeInterval)waitTime
+   timeToFirstByte:(NSTimeInterval)timeToFirstByte
+         totalTime:(NSTimeInterval)totalTime;
+- (void)recordRetryForRequest:(NSURLRequest *)request transfer:(BOOL)transfer;
+- (void)recordRetryForRequest:(NSURLRequest *)request transfer:(BOOL)transfer bytesResent:(int64_t)bytesResent;
+- (void)recordRecoveryForRequest:(NSURLRequest *)request transfer:(BOOL)transfer recoveryTime:(NSTimeInterval)recoveryTime;
+- (void)recordTokenRefreshWithSuccess:(BOOL)success;
+
+- (CLDSessionMetrics *)metrics;
+- (void)reset;
+@end
@@ -0,0 +1,342 @@
+//
+//  CLDMetricsRecorder.m
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import "CLDMetricsRecorder.h"
+#import "CLDLatencyHistogram+Private.h"
+#import "CLDEndpointMetrics+Private.h"
+#import "CLDSessionMetrics+Private.h"
+
+static void *kCLDTaskTimerKVOContext = &kCLDTaskTimerKVOContext;
+
+@interface CLDTaskTimer ()
+@property (readwrite, weak, nonatomic) NSURLSessionTask *task;
+@end
+
+@implementation CLDTaskTimer {
+    CFAbsoluteTime _startTime;
+    CFAbsoluteTime _responseTime;
+    CFAbsoluteTime _stopTime;
+    BOOL _observing;
+}
+
+- (void)startWithTask:(NSURLSessionTask *)task {
+    NSParameterAssert(task);
+    @synchronized(self) {
+        self.task = task;
+        _startTime = CFAbsoluteTimeGetCurrent();
+        [task addObserver:self forKeyPath:@"response" options:NSKeyValueObservingOptionNew context:kCLDTaskTimerKVOContext];
+        _observing = YES;
+    }
+}
+
+- (void)stop {
+    @synchronized(self) {
+        if (_stopTime > 0) return;
+        _stopTime = CFAbsoluteTimeGetCurrent();
+        if (_responseTime == 0 && self.task.response) _responseTime = _stopTime;
+        if (_observing) [self.task removeObserver:self forKeyPath:@"response"];
+        _observing = NO;
+    }
+}
+
+- (NSTimeInterval)timeToFirstByte {
+    @synchronized(self) {
+        return _responseTime > 0 ? _responseTime - _startTime : -1;
+    }
+}
+
+- (NSTimeInterval)totalTime {
+    @synchronized(self) {
+        return _stopTime > 0 ? _stopTime - _startTime : -1;
+    }
+}
+
+- (void)observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary *)change context:(void *)context {
+    if (context == kCLDTaskTimerKVOContext) {
+        @synchronized(self) {
+            if (_responseTime == 0) _responseTime = CFAbsoluteTimeGetCurrent();
+        }
+    } else {
+        [super observeValueForKeyPath:keyPath ofObject:object change:change context:context];
+    }
+}
+
+@end
+
+
+
+
+// a histogram being recorded
+typedef struct {
+    NSUInteger counts[CLDLatencyHistogramBucketCount];
+    NSTimeInterval total;
+    NSTimeInterval minimum;
+    NSTimeInterval maximum;
+} CLDHistogramCounters;
+
+static void CLDHistogramCountersRecord(CLDHistogramCounters *counters, NSTimeInterval time) {
+    if (time < 0) return;
+    NSUInteger count = 0;
+    for (NSUInteger bucket = 0; bucket < CLDLatencyHistogramBucketCount; bucket++) count += counters->counts[bucket];
+    counters->counts[[CLDLatencyHistogram _bucketForTime:time]]++;
+    counters->total += time;
+    counters->minimum = (count == 0) ? time : MIN(counters->minimum, time);
+    counters->maximum = MAX(counters->maximum, time);
+}
+
+static CLDLatencyHistogram *CLDHistogramCountersSnapshot(const CLDHistogramCounters *counters) {
+    return [[CLDLatencyHistogram alloc] initWithBucketCounts:counters->counts
+                                                   totalTime:counters->total
+                                                 minimumTime:counters->minimum
+                                                 maximumTime:counters->maximum];
+}
+
+@interface CLDEndpointCounters : NSObject {
+@public
+    NSUInteger _numberOfRequests;
+    NSUInteger _numberOfFailedRequests;
+    NSUInteger _numberOfRetries;
+    uint64_t _bytesResent;
+    uint64_t _bytesSent;
+    uint64_t _bytesReceived;
+    CLDHistogramCounters _waitTime;
+    CLDHistogramCounters _timeToFirstByte;
+    CLDHistogramCounters _totalTime;
+    CLDHistogramCounters _recoveryTime;
+}
+@property (readonly, strong, nonatomic) NSMutableDictionary *statusCodeCounts;
+@end
+
+@implementation CLDEndpointCounters
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _statusCodeCounts = [NSMutableDictionary new];
+    }
+    return self;
+}
+
+- (CLDEndpointMetrics *)metricsForEndpoint:(NSString *)endpoint {
+    return [[CLDEndpointMetrics alloc] initWithEndpoint:endpoint
+                                       numberOfRequests:_numberOfRequests
+                                 numberOfFailedRequests:_numberOfFailedRequests
+                                        numberOfRetries:_numberOfRetries
+                                            bytesResent:_bytesResent
+                                       statusCodeCounts:[_statusCodeCounts copy]
+                                              bytesSent:_bytesSent
+                                          bytesReceived:_bytesReceived
+                                               waitTime:CLDHistogramCountersSnapshot(&_waitTime)
+                                        timeToFirstByte:CLDHistogramCountersSnapshot(&_timeToFirstByte)
+                                              totalTime:CLDHistogramCountersSnapshot(&_totalTime)
+                                           recoveryTime:CLDHistogramCountersSnapshot(&_recoveryTime)];
+}
+
+@end
+
+
+
+
+@interface CLDMetricsRecorder ()
+@property (readwrite, weak, nonatomic) CLDSession *session;
+@end
+
+@implementation CLDMetricsRecorder {
+    dispatch_queue_t _queue;
+    NSDate *_startDate;
+    NSMutableDictionary *_requestCounters;
+    NSMutableDictionary *_transferCounters;
+    NSUInteger _numberOfTokenRefreshes;
+    NSUInteger _numberOfFailedTokenRefreshes;
+    id<CLDMetricsExporter> _exporter;
+    NSTimeInterval _exportInterval;
+    dispatch_source_t _exportTimer;
+}
+
+- (instancetype)initWithSession:(CLDSession *)session {
+    NSParameterAssert(session);
+    self = [super init];
+    if (self) {
+        _session = session;
+        _queue = dispatch_queue_create("pt.meo.cloud.sdk.metrics", DISPATCH_QUEUE_SERIAL);
+        _startDate = [NSDate date];
+        _requestCounters = [NSMutableDictionary new];
+        _transferCounters = [NSMutableDictionary new];
+        _exportInterval = CLDSessionMetricsDefaultExportInterval;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    if (_exportTimer) dispatch_source_cancel(_exportTimer);
+}
+
++ (NSString *)endpointForRequest:(NSURLRequest *)request {
+    // paths look like /<version>/<endpoint>/...
+    NSArray *pathComponents = request.URL.path.pathComponents;
+    NSString *endpoint = (pathComponents.count > 2) ? pathComponents[2] : request.URL.path;
+    return [NSString stringWithFormat:@"%@ %@", request.HTTPMethod ?: @"GET", endpoint];
+}
+
+#pragma mark - Recording
+
+- (void)recordTask:(NSURLSessionTask *)task
+          transfer:(BOOL)transfer
+          waitTime:(NSTimeInterval)waitTime
+   timeToFirstByte:(NSTimeInterval)timeToFirstByte
+         totalTime:(NSTimeInterval)totalTime {
+    if (task == nil) return;
+    NSString *endpoint = [[self class] endpointForRequest:task.originalRequest];
+    NSInteger statusCode = [task.response isKindOfClass:[NSHTTPURLResponse class]] ? ((NSHTTPURLResponse *)task.response).statusCode : 0;
+    int64_t bytesSent = MAX(task.countOfBytesSent, 0);
+    int64_t bytesReceived = MAX(task.countOfBytesReceived, 0);
+
+    dispatch_async(_queue, ^{
+        CLDEndpointCounters *counters = [self _countersForEndpoint:endpoint transfer:transfer];
+        counters->_numberOfRequests++;
+        if (statusCode > 0) {
+            counters.statusCodeCounts[@(statusCode)] = @([counters.statusCodeCounts[@(statusCode)] unsignedIntegerValue] + 1);
+        } else {
+            counters->_numberOfFailedRequests++;
+        }
+        counters->_bytesSent += bytesSent;
+        counters->_bytesReceived += bytesReceived;
+        CLDHistogramCountersRecord(&counters->_waitTime, waitTime);
+        CLDHistogramCountersRecord(&counters->_timeToFirstByte, timeToFirstByte);
+        CLDHistogramCountersRecord(&counters->_totalTime, totalTime);
+    });
+}
+
+- (void)recordRetryForRequest:(NSURLRequest *)request transfer:(BOOL)transfer {
+    [self recordRetryForRequest:request transfer:transfer bytesResent:0];
+}
+
+- (void)recordRetryForRequest:(NSURLRequest *)request transfer:(BOOL)transfer bytesResent:(int64_t)bytesResent {
+    if (request == nil) return;
+    NSString *endpoint = [[self class] endpointForRequest:request];
+    dispatch_async(_queue, ^{
+        CLDEndpointCounters *counters = [self _countersForEndpoint:endpoint transfer:transfer];
+        counters->_numberOfRetries++;
+        counters->_bytesResent += MAX(bytesResent, 0);
+    });
+}
+
+- (void)recordRecoveryForRequest:(NSURLRequest *)request transfer:(BOOL)transfer recoveryTime:(NSTimeInterval)recoveryTime {
+    if (request == nil) return;
+    NSString *endpoint = [[self class] endpointForRequest:request];
+    dispatch_async(_queue, ^{
+        CLDHistogramCountersRecord(&[self _countersForEndpoint:endpoint transfer:transfer]->_recoveryTime, recoveryTime);
+    });
+}
+
+- (void)recordTokenRefreshWithSuccess:(BOOL)success {
+    dispatch_async(_queue, ^{
+        if (success) _numberOfTokenRefreshes++;
+        else _numberOfFailedTokenRefreshes++;
+    });
+}
+
+// must be called on _queue
+- (CLDEndpointCounters *)_countersForEndpoint:(NSString *)endpoint transfer:(BOOL)transfer {
+    NSMutableDictionary *countersByEndpoint = transfer ? _transferCounters : _requestCounters;
+    CLDEndpointCounters *counters = countersByEndpoint[endpoint];
+    if (counters == nil) {
+        counters = [CLDEndpointCounters new];
+        countersByEndpoint[endpoint] = counters;
+    }
+    return counters;
+}
+
+#pragma mark - Snapshots
+
+- (CLDSessionMetrics *)metrics {
+    __block CLDSessionMetrics *metrics = nil;
+    dispatch_sync(_queue, ^{
+        metrics = [self _metrics];
+    });
+    return metrics;
+}
+
+// must be called on _queue
+- (CLDSessionMetrics *)_metrics {
+    NSMutableDictionary *requestMetrics = [NSMutableDictionary dictionaryWithCapacity:_requestCounters.count];
+    for (NSString *endpoint in _requestCounters) {
+        requestMetrics[endpoint] = [_requestCounters[endpoint] metricsForEndpoint:endpoint];
+    }
+    NSMutableDictionary *transferMetrics = [NSMutableDictionary dictionaryWithCapacity:_transferCounters.count];
+    for (NSString *endpoint in _transferCounters) {
+        transferMetrics[endpoint] = [_transferCounters[endpoint] metricsForEndpoint:endpoint];
+    }
+    return [[CLDSessionMetrics alloc] initWithStartDate:_startDate
+                                         requestMetrics:requestMetrics
+                                        transferMetrics:transferMetrics
+                                 numberOfTokenRefreshes:_numberOfTokenRefreshes
+                           numberOfFailedTokenRefreshes:_numberOfFailedTokenRefreshes];
+}
+
+- (void)reset {
+    dispatch_async(_queue, ^{
+        _startDate = [NSDate date];
+        [_requestCounters removeAllObjects];
+        [_transferCounters removeAllObjects];
+        _numberOfTokenRefreshes = 0;
+        _numberOfFailedTokenRefreshes = 0;
+    });
+}
+
+#pragma mark - Exporting
+
+- (id<CLDMetricsExporter>)exporter {
+    @synchronized(self) {
+        return _exporter;
+    }
+}
+
+- (void)setExporter:(id<CLDMetricsExporter>)exporter {
+    @synchronized(self) {
+        _exporter = exporter;
+        [self _updateExportTimer];
+    }
+}
+
+- (NSTimeInterval)exportInterval {
+    @synchronized(self) {
+        return _exportInterval;
+    }
+}
+
+- (void)setExportInterval:(NSTimeInterval)exportInterval {
+    @synchronized(self) {
+        _exportInterval = MAX(exportInterval, 1);
+        [self _updateExportTimer];
+    }
+}
+
+// must be called inside @synchronized(self)
+- (void)_updateExportTimer {
+    if (_exportTimer) {
+        dispatch_source_cancel(_exportTimer);
+        _exportTimer = nil;
+    }
+    if (_exporter == nil) return;
+
+    uint64_t interval = (uint64_t)(_exportInterval * NSEC_PER_SEC);
+    _exportTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, _queue);
+    dispatch_source_set_timer(_exportTimer, dispatch_time(DISPATCH_TIME_NOW, (int64_t)interval), interval, interval / 10);
+    __weak typeof(self) weakSelf = self;
+    dispatch_source_set_event_handler(_exportTimer, ^{
+        CLDMetricsRecorder *strongSelf = weakSelf;
+        CLDSession *session = strongSelf.session;
+        id<CLDMetricsExporter> exporter = strongSelf.exporter;
+        if (session == nil || exporter == nil) return;
+        [exporter exportMetrics:[strongSelf _metrics] forSession:session];
+    });
+    dispatch_resume(_exportTimer);
+}
+
+@end
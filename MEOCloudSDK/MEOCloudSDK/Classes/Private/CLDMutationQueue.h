@@ -0,0 +1,61 @@
+//
+//  CLDMutationQueue.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+@class CLDSession;
+@class CLDItem;
+@class CLDRequest;
+
+typedef NS_ENUM(NSInteger, CLDMutationType) {
+    CLDMutationTypeCopy,
+    CLDMutationTypeMove,
+    CLDMutationTypeDelete,
+    CLDMutationTypeCreateFolder
+};
+
+// A copy, move, delete or folder creation waiting for the connection to come back.
+// Only the type and paths are archived, result and failure blocks only live as long as the process.
+@interface CLDMutation : NSObject <NSCoding>
+
+@property (readonly, nonatomic) CLDMutationType type;
+@property (readonly, strong, nonatomic) CLDItem *item;      // nil for folder creation
+@property (readonly, strong, nonatomic) NSString *path;     // destination path, nil for deletes
+
++ (instancetype)mutationWithType:(CLDMutationType)type item:(CLDItem *)item path:(NSString *)path;
+- (void)addCallbackWithHandle:(CLDRequest *)handle
+                callbackQueue:(dispatch_queue_t)callbackQueue
+                  resultBlock:(void(^)(CLDItem *item))resultBlock
+                 failureBlock:(void(^)(NSError *error))failureBlock;
+
+@end
+
+
+// Keeps the mutations a session could not perform while offline, archived in Application Support,
+// and replays them in order once the network is reachable again. Mutations on unrelated paths
+// are replayed at the same time, up to a small limit, and redundant ones are merged as they are queued.
+@interface CLDMutationQueue : NSObject
+
+@property (readonly, weak, nonatomic) CLDSession *session;
+@property (readonly, atomic) NSUInteger numberOfMutations;
+
+- (instancetype)initWithSession:(CLDSession *)session;
+
+// Queues the mutation while offline, or while earlier mutations are still waiting or on their way, so that it does not
+// overtake them, and returns NO. Otherwise returns YES: the mutation may be sent right away, and holds its place in the
+// queue until -endMutation:error: is called, or its request is cancelled.
+- (BOOL)beginMutation:(CLDMutation *)mutation;
+// returns YES if the mutation failed without reaching the server and stays in its place, to be replayed later,
+// its callbacks are then called once it is done
+- (BOOL)endMutation:(CLDMutation *)mutation error:(NSError *)error;
+- (void)replay;
+- (void)removeAllMutationsWithError:(NSError *)error;  // failure blocks are called with error
+
+// errors of requests that never reached the server
++ (BOOL)isConnectivityError:(NSError *)error;
++ (void)removeStateForSessionIdentifier:(NSString *)sessionIdentifier;
+
+@end
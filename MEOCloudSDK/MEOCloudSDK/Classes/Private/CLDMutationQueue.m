@@ -0,0 +1,603 @@
+//
+//  CLDMutationQueue.m
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import "CLDMutationQueue.h"
+#import <netinet/in.h>
+@import SystemConfiguration;
+
+#define CLDMutationQueueMaximumConcurrentMutations 2
+#define CLDMutationQueueRetryInterval 30
+
+// service paths are case insensitive
+static BOOL CLDPathContainsPath(NSString *path, NSString *otherPath) {
+    NSString *lowercasePath = path.lowercaseString;
+    NSString *otherLowercasePath = otherPath.lowercaseString;
+    if ([lowercasePath isEqualToString:otherLowercasePath]) return YES;
+    if (![lowercasePath hasSuffix:@"/"]) lowercasePath = [lowercasePath stringByAppendingString:@"/"];
+    return [otherLowercasePath hasPrefix:lowercasePath];
+}
+
+// result and failure blocks of one call to the session
+@interface CLDMutationCallback : NSObject
+@property (readwrite, strong, nonatomic) CLDRequest *handle;
+@property (readwrite, strong, nonatomic) dispatch_queue_t callbackQueue;
+@property (readwrite, copy, nonatomic) void(^resultBlock)(CLDItem *item);
+@property (readwrite, copy, nonatomic) void(^failureBlock)(NSError *error);
+@end
+
+@implementation CLDMutationCallback
+@end
+
+
+
+
+@interface CLDMutation ()
+@property (readwrite, nonatomic) CLDMutationType type;
+@property (readwrite, strong, nonatomic) CLDItem *item;
+@property (readwrite, strong, nonatomic) NSString *path;
+@property (readwrite, strong, nonatomic) NSMutableArray *callbacks;
+@property (readwrite, nonatomic, getter = isRunning) BOOL running;
+@property (readwrite, nonatomic, getter = isDirect) BOOL direct;        // sent by the session itself, not archived
+@property (readwrite, nonatomic, getter = isCoalesced) BOOL coalesced;  // holds the callbacks of other mutations
+@property (readonly, nonatomic) NSString *sourcePath;
+@property (readonly, nonatomic) NSString *destinationPath;
+@property (readonly, nonatomic) NSArray *paths;
+@property (readonly, nonatomic, getter = isCancelled) BOOL cancelled;
+- (BOOL)overlapsMutation:(CLDMutation *)mutation;
+- (BOOL)isContainedInPath:(NSString *)path;
+- (CLDItem *)hollowItem;
+- (void)addCallbacksFromMutation:(CLDMutation *)mutation;
+- (BOOL)finishWithItem:(CLDItem *)item error:(NSError *)error;
+@end
+
+@implementation CLDMutation
+
++ (instancetype)mutationWithType:(CLDMutationType)type item:(CLDItem *)item path:(NSString *)path {
+    CLDMutation *mutation = [self new];
+    mutation.type = type;
+    // only the path and type are needed, contents would make the archive grow for nothing
+    if (item) mutation.item = [CLDItem itemWithPath:item.path revision:item.revision type:item.type folderType:item.folderType];
+    mutation.path = path;
+    return mutation;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _callbacks = [NSMutableArray new];
+    }
+    return self;
+}
+
+#pragma mark - NSCoding
+
+- (id)initWithCoder:(NSCoder *)aDecoder {
+    self = [self init];
+    _type = [aDecoder decodeIntegerForKey:@"type"];
+    _item = [aDecoder decodeObjectForKey:@"item"];
+    _path = [aDecoder decodeObjectForKey:@"path"];
+    return self;
+}
+
+- (void)encodeWithCoder:(NSCoder *)aCoder {
+    [aCoder encodeInteger:self.type forKey:@"type"];
+    [aCoder encodeObject:self.item forKey:@"item"];
+    [aCoder encodeObject:self.path forKey:@"path"];
+}
+
+#pragma mark - Paths
+
+- (NSString *)sourcePath {
+    return self.type == CLDMutationTypeCreateFolder ? nil : self.item.path;
+}
+
+- (NSString *)destinationPath {
+    return self.type == CLDMutationTypeDelete ? nil : self.path;
+}
+
+- (NSArray *)paths {
+    NSMutableArray *paths = [NSMutableArray arrayWithCapacity:2];
+    if (self.sourcePath) [paths addObject:self.sourcePath];
+    if (self.destinationPath) [paths addObject:self.destinationPath];
+    return paths;
+}
+
+- (BOOL)overlapsMutation:(CLDMutation *)mutation {
+    for (NSString *path in self.paths) {
+        for (NSString *otherPath in mutation.paths) {
+            if (CLDPathContainsPath(path, otherPath) || CLDPathContainsPath(otherPath, path)) return YES;
+        }
+    }
+    return NO;
+}
+
+- (BOOL)isContainedInPath:(NSString *)path {
+    for (NSString *mutationPath in self.paths) {
+        if (!CLDPathContainsPath(path, mutationPath)) return NO;
+    }
+    return YES;
+}
+
+// item handed to result blocks when the mutation never reaches the server
+- (CLDItem *)hollowItem {
+    if (self.type == CLDMutationTypeDelete) return self.item;
+    CLDItemType type = self.type == CLDMutationTypeCreateFolder ? CLDItemTypeFolder : self.item.type;
+    return [CLDItem itemWithPath:self.path revision:nil type:type];
+}
+
+#pragma mark - Callbacks
+
+- (void)addCallbackWithHandle:(CLDRequest *)handle
+                callbackQueue:(dispatch_queue_t)callbackQueue
+                  resultBlock:(void (^)(CLDItem *))resultBlock
+                 failureBlock:(void (^)(NSError *))failureBlock {
+    CLDMutationCallback *callback = [CLDMutationCallback new];
+    callback.handle = handle;
+    callback.callbackQueue = callbackQueue;
+    callback.resultBlock = resultBlock;
+    callback.failureBlock = failureBlock;
+    [self.callbacks addObject:callback];
+}
+
+- (void)addCallbacksFromMutation:(CLDMutation *)mutation {
+    [self.callbacks addObjectsFromArray:mutation.callbacks];
+    [mutation.callbacks removeAllObjects];
+    self.coalesced = YES;
+}
+
+- (BOOL)isCancelled {
+    for (CLDMutationCallback *callback in self.callbacks) {
+        if (!callback.handle.isCancelled) return NO;
+    }
+    return self.callbacks.count > 0;
+}
+
+// returns NO if nobody was waiting for the mutation, e.g. when it was queued before the app was relaunched
+- (BOOL)finishWithItem:(CLDItem *)item error:(NSError *)error {
+    BOOL hadCallbacks = (self.callbacks.count > 0);
+    for (CLDMutationCallback *callback in self.callbacks) {
+        if (error) {
+            RunRequestBlockOnQueue(callback.handle, callback.callbackQueue, callback.failureBlock, error);
+        } else {
+            RunRequestBlockOnQueue(callback.handle, callback.callbackQueue, callback.resultBlock, item);
+        }
+    }
+    [self.callbacks removeAllObjects];
+    return hadCallbacks;
+}
+
+@end
+
+
+
+
+// reachability callbacks may still be on their way when the queue goes away
+@interface CLDMutationQueueReachabilityTarget : NSObject
+@property (readwrite, weak, nonatomic) CLDMutationQueue *mutationQueue;
+@end
+
+@implementation CLDMutationQueueReachabilityTarget
+@end
+
+@interface CLDMutationQueue ()
+@property (readwrite, weak, nonatomic) CLDSession *session;
+@property (readwrite, atomic) NSUInteger numberOfMutations;
+- (void)_reachabilityDidChangeWithFlags:(SCNetworkReachabilityFlags)flags;
+@end
+
+static void CLDMutationQueueReachabilityCallback(SCNetworkReachabilityRef target, SCNetworkReachabilityFlags flags, void *info) {
+    CLDMutationQueueReachabilityTarget *reachabilityTarget = (__bridge CLDMutationQueueReachabilityTarget *)info;
+    [reachabilityTarget.mutationQueue _reachabilityDidChangeWithFlags:flags];
+}
+
+@implementation CLDMutationQueue {
+    dispatch_queue_t _queue;
+    NSString *_sessionIdentifier;
+    NSMutableArray *_mutations;     // in the order they were requested, including the ones being replayed
+    SCNetworkReachabilityRef _reachability;
+    BOOL _reachable;
+    BOOL _paused;                   // set after a transient failure, until the network changes or some time passes
+}
+
+#pragma mark - Initialization
+
+- (instancetype)initWithSession:(CLDSession *)session {
+    NSParameterAssert(session);
+    self = [super init];
+    if (self) {
+        _session = session;
+        _sessionIdentifier = session.sessionIdentifier;
+        _queue = dispatch_queue_create("pt.meo.cloud.sdk.mutations", DISPATCH_QUEUE_SERIAL);
+        _reachable = YES;
+        [self _loadState];
+        [self _startMonitoringReachability];
+
+        // mutations left over from a previous launch
+        if (_mutations.count > 0) [self replay];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    if (_reachability) {
+        SCNetworkReachabilitySetDispatchQueue(_reachability, NULL);
+        CFRelease(_reachability);
+    }
+}
+
+#pragma mark - Loading / saving state
+
++ (NSURL *)_stateArchiveURLForSessionIdentifier:(NSString *)sessionIdentifier {
+    NSURL *applicationSupport = [CLDUtil applicationSupportDirectory];
+    NSString *fileName = [NSString stringWithFormat:@"pt.meo.cloud.sdk.%@.mutations", sessionIdentifier];
+    return [applicationSupport URLByAppendingPathComponent:fileName];
+}
+
++ (void)removeStateForSessionIdentifier:(NSString *)sessionIdentifier {
+    NSURL *url = [self _stateArchiveURLForSessionIdentifier:sessionIdentifier];
+    [[NSFileManager defaultManager] removeItemAtURL:url error:nil];
+}
+
+- (void)_loadState {
+    NSString *filePath = [[self class] _stateArchiveURLForSessionIdentifier:_sessionIdentifier].path;
+    NSArray *mutations = nil;
+    uint64_t traceStart = CLDTraceBegin();
+    @try {
+        mutations = [NSKeyedUnarchiver unarchiveObjectWithFile:filePath];
+    }
+    @catch (NSException *exception) {
+        CLDLog(@"Could not load queued mutations. Error: %@", exception.description);
+    }
+    CLDTraceEnd(CLDTraceSpanArchiveLoad, traceStart);
+    _mutations = mutations ? [mutations mutableCopy] : [NSMutableArray new];
+    self.numberOfMutations = _mutations.count;
+}
+
+// must be called on _queue
+- (void)_saveState {
+    NSString *filePath = [[self class] _stateArchiveURLForSessionIdentifier:_sessionIdentifier].path;
+    // mutations sent directly may have reached the server, replaying them after a relaunch could apply them twice
+    NSArray *mutations = [_mutations filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"direct == NO"]];
+    if (mutations.count > 0) {
+        uint64_t traceStart = CLDTraceBegin();
+        [NSKeyedArchiver archiveRootObject:mutations toFile:filePath];
+        CLDTraceEnd(CLDTraceSpanArchiveSave, traceStart);
+    } else {
+        [[NSFileManager defaultManager] removeItemAtPath:filePath error:nil];
+    }
+    self.numberOfMutations = mutations.count;
+}
+
+#pragma mark - Reachability
+
+- (void)_startMonitoringReachability {
+    // the zero address stands for the internet in general and its flags are known without any lookup
+    struct sockaddr_in address;
+    bzero(&address, sizeof(address));
+    address.sin_len = sizeof(address);
+    address.sin_family = AF_INET;
+    _reachability = SCNetworkReachabilityCreateWithAddress(kCFAllocatorDefault, (const struct sockaddr *)&address);
+    if (_reachability == NULL) return;
+
+    SCNetworkReachabilityFlags flags;
+    if (SCNetworkReachabilityGetFlags(_reachability, &flags)) {
+        _reachable = [[self class] _isReachableWithFlags:flags];
+    }
+
+    CLDMutationQueueReachabilityTarget *target = [CLDMutationQueueReachabilityTarget new];
+    target.mutationQueue = self;
+    SCNetworkReachabilityContext context = {0, (__bridge void *)target, CFRetain, CFRelease, NULL};
+    SCNetworkReachabilitySetCallback(_reachability, CLDMutationQueueReachabilityCallback, &context);
+    SCNetworkReachabilitySetDispatchQueue(_reachability, _queue);
+}
+
++ (BOOL)_isReachableWithFlags:(SCNetworkReachabilityFlags)flags {
+    if ((flags & kSCNetworkReachabilityFlagsReachable) == 0) return NO;
+    if ((flags & kSCNetworkReachabilityFlagsConnectionRequired) == 0) return YES;
+
+    // connections made on demand are fine, unless the user has to do something first (e.g. type a VPN password)
+    BOOL onDemand = (flags & (kSCNetworkReachabilityFlagsConnectionOnDemand | kSCNetworkReachabilityFlagsConnectionOnTraffic)) != 0;
+    return onDemand && (flags & kSCNetworkReachabilityFlagsInterventionRequired) == 0;
+}
+
+// called on _queue
+- (void)_reachabilityDidChangeWithFlags:(SCNetworkReachabilityFlags)flags {
+    _reachable = [[self class] _isReachableWithFlags:flags];
+    CLDLog(@"Network is %@, %lu mutations queued", _reachable ? @"reachable" : @"unreachable", (unsigned long)_mutations.count);
+    if (_reachable) {
+        _paused = NO;
+        [self _replayMutations];
+    }
+}
+
+#pragma mark - Public methods
+
+- (BOOL)beginMutation:(CLDMutation *)mutation {
+    NSParameterAssert(mutation);
+    // synchronous, so that the next mutation knows it has to wait for this one
+    __block BOOL direct = NO;
+    dispatch_sync(_queue, ^{
+        direct = (_reachable && _mutations.count == 0);
+        if (direct) {
+            mutation.direct = YES;
+            mutation.running = YES;
+            [_mutations addObject:mutation];
+        } else {
+            [self _addMutation:mutation];
+            [self _saveState];
+            [self _replayMutations];
+        }
+    });
+
+    __weak CLDMutationQueue *weakSelf = self;
+    for (CLDMutationCallback *callback in mutation.callbacks) {
+        callback.handle.cancellationHandler = direct ? ^{
+            // the session does not report cancelled requests, nobody else would let go of its place
+            [weakSelf endMutation:mutation error:nil];
+        } : ^{
+            [weakSelf _cancelMutation:mutation];
+        };
+    }
+    return direct;
+}
+
+- (BOOL)endMutation:(CLDMutation *)mutation error:(NSError *)error {
+    NSParameterAssert(mutation);
+    BOOL keep = [[self class] isConnectivityError:error];
+    __block BOOL kept = NO;
+    dispatch_sync(_queue, ^{
+        if (!mutation.isDirect || [_mutations indexOfObjectIdenticalTo:mutation] == NSNotFound) return;
+        mutation.running = NO;
+        if (keep) {
+            CLDLog(@"Could not perform mutation, will try again later. Error: %@", error);
+            mutation.direct = NO;
+            kept = YES;
+            [self _saveState];
+            [self _pauseReplay];
+        } else {
+            // the session calls the blocks of mutations sent directly
+            [_mutations removeObjectIdenticalTo:mutation];
+            [self _saveState];
+            [self _replayMutations];
+        }
+    });
+    if (kept) {
+        __weak CLDMutationQueue *weakSelf = self;
+        for (CLDMutationCallback *callback in mutation.callbacks) {
+            callback.handle.cancellationHandler = ^{
+                [weakSelf _cancelMutation:mutation];
+            };
+        }
+    }
+    return kept;
+}
+
+- (void)replay {
+    dispatch_async(_queue, ^{
+        _paused = NO;
+        [self _replayMutations];
+    });
+}
+
+- (void)removeAllMutationsWithError:(NSError *)error {
+    NSParameterAssert(error);
+    dispatch_sync(_queue, ^{
+        NSArray *mutations = _mutations;
+        _mutations = [NSMutableArray new];
+        [self _saveState];
+        for (CLDMutation *mutation in mutations) {
+            // the requests of mutations sent directly still report to their callers
+            if (!mutation.isDirect) [mutation finishWithItem:nil error:error];
+        }
+    });
+}
+
++ (BOOL)isConnectivityError:(NSError *)error {
+    if ([error.domain isEqualToString:CLDErrorDomain]) error = error.userInfo[NSUnderlyingErrorKey];
+    if (![error.domain isEqualToString:NSURLErrorDomain]) return NO;
+
+    // the request was never sent, so it can be safely performed again later
+    switch (error.code) {
+        case NSURLErrorNotConnectedToInternet:
+        case NSURLErrorCannotFindHost:
+        case NSURLErrorCannotConnectToHost:
+        case NSURLErrorDNSLookupFailed:
+        case NSURLErrorInternationalRoamingOff:
+        case NSURLErrorCallIsActive:
+        case NSURLErrorDataNotAllowed:
+            return YES;
+        default:
+            return NO;
+    }
+}
+
+#pragma mark - Private methods
+
+// all methods below must be called on _queue
+
+- (void)_addMutation:(CLDMutation *)mutation {
+    NSString *sourcePath = mutation.sourcePath;
+    if (sourcePath == nil || mutation.type == CLDMutationTypeCopy) {
+        [_mutations addObject:mutation];
+        return;
+    }
+
+    // look for the queued mutation that put the item where this one moves or deletes it from
+    CLDMutation *previousMutation = nil;
+    NSMutableArray *laterMutations = [NSMutableArray new];
+    for (CLDMutation *queuedMutation in _mutations.reverseObjectEnumerator) {
+        NSString *destinationPath = queuedMutation.destinationPath;
+        if (destinationPath && [destinationPath.lowercaseString isEqualToString:sourcePath.lowercaseString]) {
+            previousMutation = queuedMutation;
+            break;
+        }
+        if ([queuedMutation overlapsMutation:mutation]) [laterMutations addObject:queuedMutation];
+    }
+    if (previousMutation == nil || previousMutation.isRunning) {
+        [_mutations addObject:mutation];
+        return;
+    }
+    NSUInteger previousIndex = [_mutations indexOfObjectIdenticalTo:previousMutation];
+    for (NSUInteger index = previousIndex + 1; index < _mutations.count; index++) {
+        CLDMutation *queuedMutation = _mutations[index];
+        if ([queuedMutation overlapsMutation:previousMutation] && ![laterMutations containsObject:queuedMutation]) {
+            [laterMutations addObject:queuedMutation];
+        }
+    }
+
+    if (mutation.type == CLDMutationTypeDelete) {
+        // whatever happened inside the item since it got there goes away with it, as long as nothing was taken out of it
+        for (CLDMutation *laterMutation in laterMutations) {
+            if (laterMutation.isRunning || ![laterMutation isContainedInPath:sourcePath]) {
+                [_mutations addObject:mutation];
+                return;
+            }
+        }
+        for (CLDMutation *laterMutation in laterMutations) {
+            [_mutations removeObjectIdenticalTo:laterMutation];
+            [self _finishMutation:laterMutation item:[laterMutation hollowItem] error:nil];
+        }
+
+        [previousMutation addCallbacksFromMutation:mutation];
+        if (previousMutation.type == CLDMutationTypeMove) {
+            // moved and then deleted, delete it where it was
+            previousMutation.type = CLDMutationTypeDelete;
+            previousMutation.path = nil;
+        } else {
+            // created or copied and then deleted, the server never needs to know
+            [_mutations removeObjectIdenticalTo:previousMutation];
+            [self _finishMutation:previousMutation item:mutation.item error:nil];
+        }
+        CLDLog(@"Coalesced delete of %@ with an earlier mutation", sourcePath);
+        return;
+    }
+
+    // a move can only take the place of the previous mutation if nothing in between depends on either of them
+    if (laterMutations.count > 0) {
+        [_mutations addObject:mutation];
+        return;
+    }
+    [previousMutation addCallbacksFromMutation:mutation];
+    if (previousMutation.type == CLDMutationTypeMove && [previousMutation.item.path.lowercaseString isEqualToString:mutation.path.lowercaseString]) {
+        // moved back to where it was
+        [_mutations removeObjectIdenticalTo:previousMutation];
+        [self _finishMutation:previousMutation item:previousMutation.item error:nil];
+    } else {
+        previousMutation.path = mutation.path;
+    }
+    CLDLog(@"Coalesced move of %@ to %@ with an earlier mutation", sourcePath, mutation.path);
+}
+
+- (void)_cancelMutation:(CLDMutation *)mutation {
+    dispatch_async(_queue, ^{
+        // mutations holding callbacks of others, or already on their way, still have to reach the server
+        if (mutation.isRunning || mutation.isCoalesced || !mutation.isCancelled) return;
+        NSUInteger index = [_mutations indexOfObjectIdenticalTo:mutation];
+        if (index == NSNotFound) return;
+        [_mutations removeObjectAtIndex:index];
+        [self _saveState];
+        [self _replayMutations];
+    });
+}
+
+- (void)_replayMutations {
+    CLDSession *session = self.session;
+    if (session == nil || !_reachable || _paused) return;
+
+    NSUInteger numberOfRunningMutations = 0;
+    for (CLDMutation *mutation in _mutations) {
+        if (mutation.isRunning) numberOfRunningMutations++;
+    }
+
+    // a mutation may only start once every earlier mutation on the same paths is done
+    NSMutableArray *earlierMutations = [NSMutableArray new];
+    for (CLDMutation *mutation in [_mutations copy]) {
+        if (numberOfRunningMutations >= CLDMutationQueueMaximumConcurrentMutations) break;
+        BOOL blocked = NO;
+        for (CLDMutation *earlierMutation in earlierMutations) {
+            if ([earlierMutation overlapsMutation:mutation]) {
+                blocked = YES;
+                break;
+            }
+        }
+        [earlierMutations addObject:mutation];
+        if (blocked || mutation.isRunning) continue;
+
+        [self _startMutation:mutation session:session];
+        numberOfRunningMutations++;
+    }
+}
+
+- (void)_startMutation:(CLDMutation *)mutation session:(CLDSession *)session {
+    mutation.running = YES;
+    void(^resultBlock)(CLDItem *item) = ^(CLDItem *item) {
+        [self _mutation:mutation didFinishWithItem:item error:nil];
+    };
+    void(^failureBlock)(NSError *error) = ^(NSError *error) {
+        [self _mutation:mutation didFinishWithItem:nil error:error];
+    };
+
+    [session _performWithoutQueueingMutations:^{
+        [session performWithCallbackQueue:_queue block:^{
+            switch (mutation.type) {
+                case CLDMutationTypeCopy:
+                    [session copyItem:mutation.item toPath:mutation.path resultBlock:resultBlock failureBlock:failureBlock];
+                    break;
+                case CLDMutationTypeMove:
+                    [session moveItem:mutation.item toPath:mutation.path resultBlock:resultBlock failureBlock:failureBlock];
+                    break;
+                case CLDMutationTypeDelete:
+                    [session deleteItem:mutation.item resultBlock:resultBlock failureBlock:failureBlock];
+                    break;
+                case CLDMutationTypeCreateFolder:
+                    [session createFolderAtPath:mutation.path resultBlock:resultBlock failureBlock:failureBlock];
+                    break;
+            }
+        }];
+    }];
+}
+
+- (void)_mutation:(CLDMutation *)mutation didFinishWithItem:(CLDItem *)item error:(NSError *)error {
+    mutation.running = NO;
+    if ([_mutations indexOfObjectIdenticalTo:mutation] == NSNotFound) return;
+
+    BOOL transient = [[self class] isConnectivityError:error] || ([error.domain isEqualToString:CLDErrorDomain] && error.code == CLDErrorCodeServiceUnavailable);
+    if (transient) {
+        // keep it where it is and try again once the network changes, or after a while
+        CLDLog(@"Could not replay mutation, will try again later. Error: %@", error);
+        [self _pauseReplay];
+        return;
+    }
+
+    [_mutations removeObjectIdenticalTo:mutation];
+    [self _saveState];
+    [self _finishMutation:mutation item:item error:error];
+    [self _replayMutations];
+}
+
+- (void)_pauseReplay {
+    if (_paused) return;
+    _paused = YES;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(CLDMutationQueueRetryInterval * NSEC_PER_SEC)), _queue, ^{
+        _paused = NO;
+        [self _replayMutations];
+    });
+}
+
+- (void)_finishMutation:(CLDMutation *)mutation item:(CLDItem *)item error:(NSError *)error {
+    BOOL hadCallbacks = [mutation finishWithItem:item error:error];
+    if (error && !hadCallbacks) {
+        CLDLog(@"Queued mutation of %@ failed. Error: %@", mutation.item.path ?: mutation.path, error);
+        CLDItem *failedItem = mutation.item ?: [mutation hollowItem];
+        [CLDUtil postNotificationNamed:kCLDSessionQueuedMutationFailedNotification
+                                object:self.session
+                              userInfo:@{kCLDSessionItemsKey: @[failedItem], kCLDSessionErrorKey: error}];
+    }
+}
+
+@end
@@ -0,0 +1,16 @@
+//
+//  CLDRemoteFile+Private.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import <MEOCloudSDK/CLDRemoteFile.h>
+
+@interface CLDRemoteFile (Private)
+@property (readwrite, strong, nonatomic) dispatch_queue_t callbackQueue;
+
+// item must have a revision and a known size
+- (instancetype)initWithSession:(CLDSession *)session item:(CLDItem *)item;
+@end
@@ -0,0 +1,17 @@
+//
+//  CLDRequest+Private.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import <MEOCloudSDK/CLDRequest.h>
+
+@interface CLDRequest (Private)
+// called once the task is created, resumes it unless the request was cancelled in the meantime
+- (void)startWithTask:(NSURLSessionTask *)task;
+// called once, on cancellation, for work that is not backed by a task
+@property (readwrite, copy, atomic) void(^cancellationHandler)();
+@property (readwrite, atomic) CLDRequestLane lane;
+@end
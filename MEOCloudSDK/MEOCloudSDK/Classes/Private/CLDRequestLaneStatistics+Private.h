@@ -0,0 +1,18 @@
+//
+//  CLDRequestLaneStatistics+Private.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import <MEOCloudSDK/CLDRequestLaneStatistics.h>
+
+@interface CLDRequestLaneStatistics (Private)
+- (instancetype)initWithLane:(CLDRequestLane)lane
+     numberOfPendingRequests:(NSUInteger)numberOfPendingRequests
+      numberOfActiveRequests:(NSUInteger)numberOfActiveRequests
+     numberOfStartedRequests:(NSUInteger)numberOfStartedRequests
+             averageWaitTime:(NSTimeInterval)averageWaitTime
+             maximumWaitTime:(NSTimeInterval)maximumWaitTime;
+@end
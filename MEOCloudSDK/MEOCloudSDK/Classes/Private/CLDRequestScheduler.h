@@ -0,0 +1,47 @@
+//
+//  CLDRequestScheduler.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import <MEOCloudSDK/CLDRequest.h>
+
+@class CLDRequestLaneStatistics;
+
+#define CLDRequestLaneCount 4
+#define CLDRequestSchedulerMaximumConcurrencyLimit 24
+
+typedef NS_ENUM(NSInteger, CLDRequestOutcome) {
+    CLDRequestOutcomeCompleted,   // the server answered, the round trip time is meaningful
+    CLDRequestOutcomeOverloaded,  // timeout, 429 or 5xx
+    CLDRequestOutcomeDropped      // cancelled or no connectivity, tells nothing about the server
+};
+
+// Admits the requests of a session in lane order, within a limit per lane and an adaptive limit for the whole session.
+// The last session slot is kept for interactive requests, so they never wait behind background work.
+// The session limit never exceeds the sum of the lane limits, nor CLDRequestSchedulerMaximumConcurrencyLimit,
+// which is the size of the session's connection pools.
+// Each lane runs its requests on a global queue of matching priority (QoS on iOS 8 and OS X 10.10).
+@interface CLDRequestScheduler : NSObject
+
+- (NSUInteger)maximumConcurrentRequestsForLane:(CLDRequestLane)lane;
+- (void)setMaximumConcurrentRequests:(NSUInteger)maximumConcurrentRequests forLane:(CLDRequestLane)lane;
+
+// startBlock runs on the lane's queue once admitted and must call finishBlock exactly once, when the request is done,
+// with the time since its task was resumed, or a negative time if it never was
+// requests cancelled while pending are dropped without running startBlock
+- (void)scheduleRequest:(CLDRequest *)request startBlock:(void(^)(void(^finishBlock)(CLDRequestOutcome outcome, NSTimeInterval roundTripTime)))startBlock;
+
+// for work that is not scheduled here but talks to the same server, e.g. transfers
+- (void)reportOverload;
+- (NSUInteger)concurrencyLimit;
+
+- (CLDRequestLaneStatistics *)statisticsForLane:(CLDRequestLane)lane;
+- (void)resetStatistics;
+
++ (dispatch_queue_t)queueForLane:(CLDRequestLane)lane;
++ (CLDRequestOutcome)outcomeForResponse:(NSURLResponse *)response error:(NSError *)error;
+
+@end
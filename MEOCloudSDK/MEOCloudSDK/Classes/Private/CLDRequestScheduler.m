@@ -0,0 +1,230 @@
+//
+//  CLDRequestScheduler.m
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import "CLDRequestScheduler.h"
+#import "CLDRequestLaneStatistics+Private.h"
+#import "CLDConcurrencyLimiter.h"
+
+static const NSUInteger CLDRequestSchedulerInitialConcurrencyLimit = 6;
+static const NSUInteger CLDRequestSchedulerDefaultMaximumConcurrentRequests[CLDRequestLaneCount] = {6, 4, 2, 2};
+
+@interface CLDScheduledRequest : NSObject
+@property (readwrite, strong, nonatomic) CLDRequest *request;
+@property (readwrite, copy, nonatomic) void(^startBlock)(void(^finishBlock)(CLDRequestOutcome outcome, NSTimeInterval roundTripTime));
+@property (readwrite, nonatomic) CFAbsoluteTime scheduleTime;
+@end
+
+@implementation CLDScheduledRequest
+@end
+
+
+
+
+@implementation CLDRequestScheduler {
+    dispatch_queue_t _queue;
+    NSMutableArray *_pendingRequests[CLDRequestLaneCount];
+    NSUInteger _maximumConcurrentRequests[CLDRequestLaneCount];
+    NSUInteger _numberOfActiveRequests[CLDRequestLaneCount];
+    NSUInteger _numberOfStartedRequests[CLDRequestLaneCount];
+    NSTimeInterval _totalWaitTime[CLDRequestLaneCount];
+    NSTimeInterval _maximumWaitTime[CLDRequestLaneCount];
+    NSUInteger _totalNumberOfActiveRequests;
+    CLDConcurrencyLimiter *_limiter;
+}
+
+#pragma mark - Initialization
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _queue = dispatch_queue_create("pt.meo.cloud.sdk.scheduler", DISPATCH_QUEUE_SERIAL);
+        for (NSUInteger lane = 0; lane < CLDRequestLaneCount; lane++) {
+            _pendingRequests[lane] = [NSMutableArray new];
+            _maximumConcurrentRequests[lane] = CLDRequestSchedulerDefaultMaximumConcurrentRequests[lane];
+        }
+        _limiter = [[CLDConcurrencyLimiter alloc] initWithInitialLimit:CLDRequestSchedulerInitialConcurrencyLimit
+                                                          minimumLimit:1
+                                                          maximumLimit:CLDRequestSchedulerMaximumConcurrencyLimit];
+        [self _updateMaximumConcurrencyLimit];
+    }
+    return self;
+}
+
+#pragma mark - Lanes
+
++ (dispatch_queue_t)queueForLane:(CLDRequestLane)lane {
+    // global queue priorities are mapped to QoS classes on iOS 8 and OS X 10.10
+    switch (lane) {
+        case CLDRequestLaneInteractive: return dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_HIGH, 0);
+        case CLDRequestLaneDefault: return dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+        case CLDRequestLaneBackground: return dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_LOW, 0);
+        case CLDRequestLanePrefetch: return dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0);
+    }
+    return dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+}
+
++ (CLDRequestOutcome)outcomeForResponse:(NSURLResponse *)response error:(NSError *)error {
+    if ([error.domain isEqualToString:NSURLErrorDomain]) {
+        return (error.code == NSURLErrorTimedOut) ? CLDRequestOutcomeOverloaded : CLDRequestOutcomeDropped;
+    }
+    if (![response isKindOfClass:[NSHTTPURLResponse class]]) return CLDRequestOutcomeDropped;
+    NSInteger statusCode = ((NSHTTPURLResponse *)response).statusCode;
+    // 507 means over quota, the server is fine
+    if (statusCode == 429 || (statusCode >= 500 && statusCode != 507)) return CLDRequestOutcomeOverloaded;
+    return CLDRequestOutcomeCompleted;
+}
+
+- (NSUInteger)maximumConcurrentRequestsForLane:(CLDRequestLane)lane {
+    NSParameterAssert(lane >= 0 && lane < CLDRequestLaneCount);
+    __block NSUInteger maximumConcurrentRequests = 0;
+    dispatch_sync(_queue, ^{
+        maximumConcurrentRequests = _maximumConcurrentRequests[lane];
+    });
+    return maximumConcurrentRequests;
+}
+
+- (void)setMaximumConcurrentRequests:(NSUInteger)maximumConcurrentRequests forLane:(CLDRequestLane)lane {
+    NSParameterAssert(lane >= 0 && lane < CLDRequestLaneCount);
+    dispatch_async(_queue, ^{
+        _maximumConcurrentRequests[lane] = MAX(maximumConcurrentRequests, 1);
+        [self _updateMaximumConcurrencyLimit];
+        [self _admitRequests];
+    });
+}
+
+// must be called on _queue
+- (void)_updateMaximumConcurrencyLimit {
+    // a window larger than the lanes can fill would never be tested, and could not shrink back in time
+    NSUInteger maximumConcurrencyLimit = 0;
+    for (NSUInteger lane = 0; lane < CLDRequestLaneCount; lane++) maximumConcurrencyLimit += _maximumConcurrentRequests[lane];
+    _limiter.maximumLimit = MIN(maximumConcurrencyLimit, CLDRequestSchedulerMaximumConcurrencyLimit);
+}
+
+#pragma mark - Scheduling
+
+- (void)scheduleRequest:(CLDRequest *)request startBlock:(void (^)(void (^)(CLDRequestOutcome, NSTimeInterval)))startBlock {
+    NSParameterAssert(request);
+    NSParameterAssert(startBlock);
+    CLDScheduledRequest *scheduledRequest = [CLDScheduledRequest new];
+    scheduledRequest.request = request;
+    scheduledRequest.startBlock = startBlock;
+    scheduledRequest.scheduleTime = CFAbsoluteTimeGetCurrent();
+    CLDRequestLane lane = request.lane;
+    dispatch_async(_queue, ^{
+        [_pendingRequests[lane] addObject:scheduledRequest];
+        [self _admitRequests];
+    });
+}
+
+// must be called on _queue
+- (void)_admitRequests {
+    NSUInteger concurrencyLimit = _limiter.limit;
+    for (NSUInteger lane = 0; lane < CLDRequestLaneCount; lane++) {
+        NSMutableArray *pendingRequests = _pendingRequests[lane];
+        NSUInteger maximumTotal = (lane == CLDRequestLaneInteractive || concurrencyLimit == 1) ? concurrencyLimit : concurrencyLimit - 1;
+        while (pendingRequests.count > 0 &&
+               _numberOfActiveRequests[lane] < _maximumConcurrentRequests[lane] &&
+               _totalNumberOfActiveRequests < maximumTotal) {
+            CLDScheduledRequest *scheduledRequest = pendingRequests.firstObject;
+            [pendingRequests removeObjectAtIndex:0];
+            if (scheduledRequest.request.isCancelled) continue;
+            [self _startRequest:scheduledRequest lane:lane];
+        }
+    }
+}
+
+// must be called on _queue
+// requests are waiting that their lane would admit, so the session window is what holds them back
+- (BOOL)_isWindowLimited {
+    for (NSUInteger lane = 0; lane < CLDRequestLaneCount; lane++) {
+        if (_pendingRequests[lane].count > 0 && _numberOfActiveRequests[lane] < _maximumConcurrentRequests[lane]) return YES;
+    }
+    return NO;
+}
+
+// must be called on _queue
+- (void)_startRequest:(CLDScheduledRequest *)scheduledRequest lane:(CLDRequestLane)lane {
+    NSTimeInterval waitTime = CFAbsoluteTimeGetCurrent() - scheduledRequest.scheduleTime;
+    _numberOfActiveRequests[lane]++;
+    _totalNumberOfActiveRequests++;
+    _numberOfStartedRequests[lane]++;
+    _totalWaitTime[lane] += waitTime;
+    _maximumWaitTime[lane] = MAX(_maximumWaitTime[lane], waitTime);
+
+    __block BOOL finished = NO;
+    void(^finishBlock)(CLDRequestOutcome outcome, NSTimeInterval roundTripTime) = ^(CLDRequestOutcome outcome, NSTimeInterval roundTripTime) {
+        dispatch_async(_queue, ^{
+            if (finished) return;
+            finished = YES;
+            switch (outcome) {
+                case CLDRequestOutcomeCompleted:
+                    [_limiter requestDidCompleteWithRoundTripTime:roundTripTime windowLimited:[self _isWindowLimited]];
+                    break;
+                case CLDRequestOutcomeOverloaded:
+                    [_limiter requestDidOverload];
+                    break;
+                case CLDRequestOutcomeDropped:
+                    break;
+            }
+            _numberOfActiveRequests[lane]--;
+            _totalNumberOfActiveRequests--;
+            [self _admitRequests];
+        });
+    };
+    void(^startBlock)(void(^finishBlock)(CLDRequestOutcome outcome, NSTimeInterval roundTripTime)) = scheduledRequest.startBlock;
+    dispatch_async([[self class] queueForLane:lane], ^{
+        startBlock(finishBlock);
+    });
+}
+
+- (void)reportOverload {
+    dispatch_async(_queue, ^{
+        [_limiter requestDidOverload];
+    });
+}
+
+- (NSUInteger)concurrencyLimit {
+    __block NSUInteger concurrencyLimit = 0;
+    dispatch_sync(_queue, ^{
+        concurrencyLimit = _limiter.limit;
+    });
+    return concurrencyLimit;
+}
+
+#pragma mark - Statistics
+
+- (CLDRequestLaneStatistics *)statisticsForLane:(CLDRequestLane)lane {
+    NSParameterAssert(lane >= 0 && lane < CLDRequestLaneCount);
+    __block CLDRequestLaneStatistics *statistics = nil;
+    dispatch_sync(_queue, ^{
+        NSUInteger numberOfPendingRequests = 0;
+        for (CLDScheduledRequest *scheduledRequest in _pendingRequests[lane]) {
+            if (!scheduledRequest.request.isCancelled) numberOfPendingRequests++;
+        }
+        NSUInteger numberOfStartedRequests = _numberOfStartedRequests[lane];
+        statistics = [[CLDRequestLaneStatistics alloc] initWithLane:lane
+                                            numberOfPendingRequests:numberOfPendingRequests
+                                             numberOfActiveRequests:_numberOfActiveRequests[lane]
+                                            numberOfStartedRequests:numberOfStartedRequests
+                                                    averageWaitTime:numberOfStartedRequests > 0 ? _totalWaitTime[lane] / numberOfStartedRequests : 0
+                                                    maximumWaitTime:_maximumWaitTime[lane]];
+    });
+    return statistics;
+}
+
+- (void)resetStatistics {
+    dispatch_async(_queue, ^{
+        for (NSUInteger lane = 0; lane < CLDRequestLaneCount; lane++) {
+            _numberOfStartedRequests[lane] = 0;
+            _totalWaitTime[lane] = 0;
+            _maximumWaitTime[lane] = 0;
+        }
+    });
+}
+
+@end
@@ -0,0 +1,43 @@
+//
+//  CLDRetryPolicy.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+FOUNDATION_EXPORT const NSTimeInterval CLDRetryPolicyNoRetry;
+
+// Decides whether and when a failed request is tried again, for API requests and transfers alike.
+// - delays grow exponentially from baseDelay up to maximumDelay, with jitter so that clients do not retry in lockstep
+// - Retry-After is honored on 429 and 503, and waiting longer than maximumDelay means giving up
+// - requests that may have reached the server (timeouts, 500, 502, 504) are only retried if idempotent,
+//   requests the server turned down (429, 503) or that never left the device are always retried
+// - a circuit breaker per host, shared by every session, fails requests fast after consecutive timeouts and 5xx responses,
+//   and lets a single probe through once its cooldown is over, or another one if the probe does not report back in time
+@interface CLDRetryPolicy : NSObject
+
+@property (readonly, nonatomic) NSUInteger maximumNumberOfAttempts;
+@property (readonly, nonatomic) NSTimeInterval baseDelay;
+@property (readonly, nonatomic) NSTimeInterval maximumDelay;
+@property (readonly, nonatomic) BOOL retriesWhenOffline;
+
++ (instancetype)requestPolicy;   // API requests, the user is usually waiting
++ (instancetype)transferPolicy;  // transfer chunks and downloads, which used to retry forever
+
+- (instancetype)initWithMaximumNumberOfAttempts:(NSUInteger)maximumNumberOfAttempts
+                                      baseDelay:(NSTimeInterval)baseDelay
+                                   maximumDelay:(NSTimeInterval)maximumDelay
+                             retriesWhenOffline:(BOOL)retriesWhenOffline;
+
+// attempt is zero based, returns CLDRetryPolicyNoRetry when the request should fail
+- (NSTimeInterval)retryDelayForRequest:(NSURLRequest *)request response:(NSURLResponse *)response error:(NSError *)error attempt:(NSUInteger)attempt;
+
++ (BOOL)isIdempotentRequest:(NSURLRequest *)request;
+
+// circuit breaker
+// every request allowed through must be recorded, cancelled ones included, or a probe is never released
++ (BOOL)shouldAllowRequestToHost:(NSString *)host;
++ (void)recordResponse:(NSURLResponse *)response error:(NSError *)error forHost:(NSString *)host;
+
+@end
@@ -0,0 +1,272 @@
+//
+//  CLDRetryPolicy.m
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import "CLDRetryPolicy.h"
+
+const NSTimeInterval CLDRetryPolicyNoRetry = -1;
+
+static const NSUInteger CLDCircuitBreakerFailureThreshold = 5;
+static const NSTimeInterval CLDCircuitBreakerInitialCooldown = 10;
+static const NSTimeInterval CLDCircuitBreakerMaximumCooldown = 120;
+static const NSTimeInterval CLDCircuitBreakerProbeTimeout = 60;    // a probe that never reports back must not keep the host closed off
+
+typedef NS_ENUM(NSInteger, CLDCircuitState) {
+    CLDCircuitStateClosed,
+    CLDCircuitStateOpen,
+    CLDCircuitStateHalfOpen    // a probe is in flight
+};
+
+@interface CLDCircuitBreaker : NSObject
+@property (readwrite, nonatomic) CLDCircuitState state;
+@property (readwrite, nonatomic) NSUInteger numberOfFailures;
+@property (readwrite, nonatomic) NSTimeInterval cooldown;
+@property (readwrite, nonatomic) CFAbsoluteTime openUntil;
+@property (readwrite, nonatomic) CFAbsoluteTime probeTime;
+@end
+
+@implementation CLDCircuitBreaker
+@end
+
+
+
+
+@implementation CLDRetryPolicy
+
+#pragma mark - Initialization
+
++ (instancetype)requestPolicy {
+    static CLDRetryPolicy *_requestPolicy = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        _requestPolicy = [[self alloc] initWithMaximumNumberOfAttempts:4 baseDelay:0.5 maximumDelay:30 retriesWhenOffline:NO];
+    });
+    return _requestPolicy;
+}
+
++ (instancetype)transferPolicy {
+    static CLDRetryPolicy *_transferPolicy = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        _transferPolicy = [[self alloc] initWithMaximumNumberOfAttempts:10 baseDelay:1 maximumDelay:300 retriesWhenOffline:YES];
+    });
+    return _transferPolicy;
+}
+
+- (instancetype)initWithMaximumNumberOfAttempts:(NSUInteger)maximumNumberOfAttempts
+                                      baseDelay:(NSTimeInterval)baseDelay
+                                   maximumDelay:(NSTimeInterval)maximumDelay
+                             retriesWhenOffline:(BOOL)retriesWhenOffline {
+    NSParameterAssert(maximumNumberOfAttempts > 0);
+    NSParameterAssert(baseDelay > 0 && baseDelay <= maximumDelay);
+    self = [super init];
+    if (self) {
+        _maximumNumberOfAttempts = maximumNumberOfAttempts;
+        _baseDelay = baseDelay;
+        _maximumDelay = maximumDelay;
+        _retriesWhenOffline = retriesWhenOffline;
+    }
+    return self;
+}
+
+#pragma mark - Retrying
+
+- (NSTimeInterval)retryDelayForRequest:(NSURLRequest *)request response:(NSURLResponse *)response error:(NSError *)error attempt:(NSUInteger)attempt {
+    if (attempt + 1 >= self.maximumNumberOfAttempts) return CLDRetryPolicyNoRetry;
+
+    BOOL retry = NO;
+    NSTimeInterval retryAfter = 0;
+    NSInteger statusCode = [response isKindOfClass:[NSHTTPURLResponse class]] ? ((NSHTTPURLResponse *)response).statusCode : 0;
+    if ([error.domain isEqualToString:NSURLErrorDomain]) {
+        switch (error.code) {
+            case NSURLErrorNotConnectedToInternet:
+            case NSURLErrorInternationalRoamingOff:
+            case NSURLErrorDataNotAllowed:
+                retry = self.retriesWhenOffline;
+                break;
+            case NSURLErrorCannotFindHost:
+            case NSURLErrorCannotConnectToHost:
+            case NSURLErrorDNSLookupFailed:
+                retry = YES; // the request never left the device
+                break;
+            case NSURLErrorTimedOut:
+            case NSURLErrorNetworkConnectionLost:
+                retry = [[self class] isIdempotentRequest:request];
+                break;
+            default:
+                break;
+        }
+    } else if (statusCode == 429 || statusCode == 503) {
+        retry = YES; // turned down by the server, nothing was done
+        retryAfter = [self _retryAfterIntervalFromResponse:(NSHTTPURLResponse *)response];
+    } else if (statusCode == 500 || statusCode == 502 || statusCode == 504) {
+        retry = [[self class] isIdempotentRequest:request];
+    }
+    if (!retry) return CLDRetryPolicyNoRetry;
+
+    // equal jitter: never retry right away, never all at once
+    NSTimeInterval backoff = MIN(self.baseDelay * pow(2, attempt), self.maximumDelay);
+    NSTimeInterval delay = backoff / 2 + [self _randomIntervalUpTo:backoff / 2];
+    if (retryAfter > 0) {
+        delay = retryAfter + [self _randomIntervalUpTo:self.baseDelay];
+    }
+
+    // a request to a host whose circuit is open would fail right away
+    NSTimeInterval openInterval = [[self class] _remainingOpenIntervalForHost:request.URL.host];
+    delay = MAX(delay, openInterval);
+
+    return (delay > self.maximumDelay) ? CLDRetryPolicyNoRetry : delay;
+}
+
+- (NSTimeInterval)_retryAfterIntervalFromResponse:(NSHTTPURLResponse *)response {
+    NSString *retryAfter = nil;
+    for (NSString *header in response.allHeaderFields) {
+        if ([header caseInsensitiveCompare:@"Retry-After"] == NSOrderedSame) {
+            retryAfter = response.allHeaderFields[header];
+            break;
+        }
+    }
+    if (retryAfter.length == 0) return 0;
+
+    // either a number of seconds or an HTTP date
+    NSScanner *scanner = [NSScanner scannerWithString:retryAfter];
+    NSInteger seconds = 0;
+    if ([scanner scanInteger:&seconds] && scanner.isAtEnd) return MAX(seconds, 0);
+
+    static NSDateFormatter *_dateFormatter = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        _dateFormatter = [NSDateFormatter new];
+        _dateFormatter.locale = [[NSLocale alloc] initWithLocaleIdentifier:@"en_US_POSIX"];
+        _dateFormatter.timeZone = [NSTimeZone timeZoneWithAbbreviation:@"GMT"];
+        _dateFormatter.dateFormat = @"EEE',' dd MMM yyyy HH':'mm':'ss 'GMT'";
+    });
+    NSDate *date = nil;
+    @synchronized(_dateFormatter) {
+        date = [_dateFormatter dateFromString:retryAfter];
+    }
+    return date ? MAX([date timeIntervalSinceNow], 0) : 0;
+}
+
+- (NSTimeInterval)_randomIntervalUpTo:(NSTimeInterval)interval {
+    return interval * arc4random_uniform(1001) / 1000;
+}
+
+#pragma mark - Idempotency
+
++ (BOOL)isIdempotentRequest:(NSURLRequest *)request {
+    NSString *method = request.HTTPMethod.uppercaseString ?: @"GET";
+    if ([method isEqualToString:@"GET"] || [method isEqualToString:@"HEAD"]) return YES;
+
+    // POST endpoints that only read or that can be repeated without side effects
+    // (chunks are uploaded at an offset, the server skips those it already has)
+    static NSSet *_idempotentEndpoints = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        _idempotentEndpoints = [NSSet setWithArray:@[@"Metadata", @"Search", @"Revisions", @"Thumbnails", @"Media", @"Delta",
+                                                     @"ListLinks", @"ListUploadLinks", @"ListSharedFolders", @"CopyRefDetails",
+                                                     @"SetLinkTTL", @"RemoveLinkTTL", @"ChunkedUpload"]];
+    });
+    NSArray *pathComponents = request.URL.pathComponents;
+    NSString *endpoint = pathComponents.count > 2 ? pathComponents[2] : nil; // "/", API version, endpoint
+    return endpoint && [_idempotentEndpoints containsObject:endpoint];
+}
+
+#pragma mark - Circuit breaker
+
++ (NSMutableDictionary *)_circuitBreakers {
+    static NSMutableDictionary *_circuitBreakers = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        _circuitBreakers = [NSMutableDictionary new];
+    });
+    return _circuitBreakers;
+}
+
++ (CLDCircuitBreaker *)_circuitBreakerForHost:(NSString *)host {
+    NSMutableDictionary *circuitBreakers = [self _circuitBreakers];
+    CLDCircuitBreaker *circuitBreaker = circuitBreakers[host];
+    if (circuitBreaker == nil) {
+        circuitBreaker = [CLDCircuitBreaker new];
+        circuitBreaker.cooldown = CLDCircuitBreakerInitialCooldown;
+        circuitBreakers[host] = circuitBreaker;
+    }
+    return circuitBreaker;
+}
+
++ (BOOL)shouldAllowRequestToHost:(NSString *)host {
+    if (host == nil) return YES;
+    @synchronized(self) {
+        CLDCircuitBreaker *circuitBreaker = [self _circuitBreakerForHost:host];
+        switch (circuitBreaker.state) {
+            case CLDCircuitStateClosed:
+                return YES;
+            case CLDCircuitStateOpen:
+                if (CFAbsoluteTimeGetCurrent() < circuitBreaker.openUntil) return NO;
+                circuitBreaker.state = CLDCircuitStateHalfOpen;
+                circuitBreaker.probeTime = CFAbsoluteTimeGetCurrent();
+                return YES;
+            case CLDCircuitStateHalfOpen:
+                if (CFAbsoluteTimeGetCurrent() < circuitBreaker.probeTime + CLDCircuitBreakerProbeTimeout) return NO;
+                CLDLog(@"Circuit breaker probe for %@ timed out, probing again", host);
+                circuitBreaker.probeTime = CFAbsoluteTimeGetCurrent();
+                return YES;
+        }
+    }
+    return YES;
+}
+
++ (NSTimeInterval)_remainingOpenIntervalForHost:(NSString *)host {
+    if (host == nil) return 0;
+    @synchronized(self) {
+        CLDCircuitBreaker *circuitBreaker = [self _circuitBreakerForHost:host];
+        if (circuitBreaker.state != CLDCircuitStateOpen) return 0;
+        return MAX(circuitBreaker.openUntil - CFAbsoluteTimeGetCurrent(), 0);
+    }
+}
+
++ (void)recordResponse:(NSURLResponse *)response error:(NSError *)error forHost:(NSString *)host {
+    if (host == nil) return;
+    CLDRequestOutcome outcome = [CLDRequestScheduler outcomeForResponse:response error:error];
+    @synchronized(self) {
+        CLDCircuitBreaker *circuitBreaker = [self _circuitBreakerForHost:host];
+        switch (outcome) {
+            case CLDRequestOutcomeCompleted:
+                circuitBreaker.state = CLDCircuitStateClosed;
+                circuitBreaker.numberOfFailures = 0;
+                circuitBreaker.cooldown = CLDCircuitBreakerInitialCooldown;
+                break;
+
+            case CLDRequestOutcomeOverloaded:
+                circuitBreaker.numberOfFailures++;
+                if (circuitBreaker.state == CLDCircuitStateHalfOpen) {
+                    // the probe failed, stay away longer this time
+                    circuitBreaker.cooldown = MIN(circuitBreaker.cooldown * 2, CLDCircuitBreakerMaximumCooldown);
+                    [self _openCircuitBreaker:circuitBreaker host:host];
+                } else if (circuitBreaker.state == CLDCircuitStateClosed && circuitBreaker.numberOfFailures >= CLDCircuitBreakerFailureThreshold) {
+                    [self _openCircuitBreaker:circuitBreaker host:host];
+                }
+                break;
+
+            case CLDRequestOutcomeDropped:
+                // the probe told nothing, let the next request probe again
+                if (circuitBreaker.state == CLDCircuitStateHalfOpen) {
+                    circuitBreaker.state = CLDCircuitStateOpen;
+                    circuitBreaker.openUntil = CFAbsoluteTimeGetCurrent();
+                }
+                break;
+        }
+    }
+}
+
++ (void)_openCircuitBreaker:(CLDCircuitBreaker *)circuitBreaker host:(NSString *)host {
+    CLDLog(@"Circuit breaker for %@ open for %.0f seconds", host, circuitBreaker.cooldown);
+    circuitBreaker.state = CLDCircuitStateOpen;
+    circuitBreaker.openUntil = CFAbsoluteTimeGetCurrent() + circuitBreaker.cooldown;
+}
+
+@end
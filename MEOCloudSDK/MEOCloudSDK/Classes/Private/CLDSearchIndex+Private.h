@@ -0,0 +1,26 @@
+//
+//  CLDSearchIndex+Private.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import <MEOCloudSDK/CLDSearchIndex.h>
+
+@interface CLDSearchIndex (Private)
+- (instancetype)initWithSession:(CLDSession *)session;
+- (void)indexItems:(NSArray *)items;
+- (void)indexFolder:(CLDItem *)folder;  // the folder's contents are complete, anything else known inside it is gone
+- (void)removeItemsAtPaths:(NSArray *)paths;  // subfolders and their contents are removed as well
+- (void)moveItemAtPath:(NSString *)path toItem:(CLDItem *)item;
+// asynchronous, block is called on the index queue, with nil if onlyIfIndexed and the folder is not fully indexed
+- (void)queryItemsInFolder:(CLDItem *)folder
+             matchingQuery:(NSString *)query
+                     match:(CLDSearchIndexMatch)match
+                  mimeType:(NSString *)mimeType
+                     limit:(NSUInteger)limit
+             onlyIfIndexed:(BOOL)onlyIfIndexed
+                     block:(void(^)(NSArray *items))block;
++ (void)removeStateForSessionIdentifier:(NSString *)sessionIdentifier;
+@end
@@ -0,0 +1,25 @@
+//
+//  CLDSearchSession+Private.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import <MEOCloudSDK/CLDSearchSession.h>
+
+typedef void(^CLDSearchSessionResultBlock)(NSString *query, NSArray *items);
+typedef void(^CLDSearchSessionFailureBlock)(NSString *query, NSError *error);
+
+@interface CLDSearchSession (Private)
+@property (readwrite, copy, nonatomic) CLDSearchSessionResultBlock resultBlock;
+@property (readwrite, copy, nonatomic) CLDSearchSessionFailureBlock failureBlock;
+@property (readwrite, strong, nonatomic) dispatch_queue_t callbackQueue;
+
+// resultCache is shared by every search session of the same CLDSession
+- (instancetype)initWithSession:(CLDSession *)session
+                           item:(CLDItem *)item
+                       mimeType:(NSString *)mimeType
+            includeDeletedItems:(BOOL)includeDeletedItems
+                    resultCache:(NSCache *)resultCache;
+@end
@@ -7,23 +7,54 @@
 //
 
 #import <MEOCloudSDK/CLDSession.h>
+#import "CLDThumbnailCache+Private.h"
+
+@class CLDMetricsRecorder;
 
 typedef NS_ENUM(NSUInteger, CLDSessionEndpoint) {
     CLDSessionEndpointPublicAPI,
     CLDSessionEndpointContentAPI
 };
 
+#ifdef DEBUG
+// faults a subclass can inject into finished transfer tasks, to measure how transfers recover from them
+typedef NS_ENUM(NSInteger, CLDTransferFault) {
+    CLDTransferFaultNone,
+    CLDTransferFaultConnectionLost,     // the connection dropped before the response was complete, with no resume data
+    CLDTransferFaultBadRequest,         // the server answered 400, e.g. an unknown upload id on commit
+    CLDTransferFaultUnauthorized,       // the server answered 401, e.g. the token expired mid-transfer
+    CLDTransferFaultTruncatedBody       // only part of the response body arrived
+};
+#endif
+
 @interface CLDSession (Private)
 @property (readonly, nonatomic) NSString *accessMode;
 - (NSString *)_serviceName;
-- (void)_performJSONRequest:(NSURLRequest *)request successBlock:(void(^)(id object))successBlock failureBlock:(void(^)(CLDError *error))failureBlock;
-- (void)_performRequest:(NSURLRequest *)request successBlock:(void(^)(NSData *data))successBlock failureBlock:(void(^)(CLDError *error))failureBlock;
+- (dispatch_queue_t)_currentCallbackQueue;
+- (CLDRequestLane)_currentRequestLane;
+- (void)_reportServerOverload;
+- (CLDMetricsRecorder *)_metricsRecorder;
+- (void)incrementNumberOfActiveConnections;
+- (void)decrementNumberOfActiveConnections;
+// tasks on the shared connection pools that report to delegate as data arrives, on the session's delegate queue,
+// delegate is held until the task completes and its redirects are signed by the session
+- (NSURLSessionDataTask *)_dataTaskWithRequest:(NSURLRequest *)request delegate:(id<NSURLSessionDataDelegate>)delegate;
+- (void)_performWithoutQueueingMutations:(void(^)())block;  // for replaying queued mutations
+- (CLDRequest *)_performJSONRequest:(NSURLRequest *)request successBlock:(void(^)(id object))successBlock failureBlock:(void(^)(CLDError *error))failureBlock;
+- (CLDRequest *)_performJSONRequest:(NSURLRequest *)request handle:(CLDRequest *)handle successBlock:(void(^)(id object))successBlock failureBlock:(void(^)(CLDError *error))failureBlock;
+- (CLDRequest *)_performRequest:(NSURLRequest *)request successBlock:(void(^)(NSData *data))successBlock failureBlock:(void(^)(CLDError *error))failureBlock;
+- (CLDRequest *)_performRequest:(NSURLRequest *)request handle:(CLDRequest *)handle successBlock:(void(^)(NSData *data))successBlock failureBlock:(void(^)(CLDError *error))failureBlock;
 - (NSURL *)_serviceURLForEndpoint:(CLDSessionEndpoint)endpoint path:(NSString *)path;
 - (NSURL *)_serviceURLForEndpoint:(CLDSessionEndpoint)endpoint path:(NSString *)path query:(NSDictionary *)queryParameters;
 - (NSMutableURLRequest *)_signedMutableURLRequestWithURL:(NSURL *)url;
 - (CLDError *)_errorFromStatusCode:(NSInteger)statusCode;
 - (CLDError *)_errorFromStatusCode:(NSInteger)statusCode error:(NSError *)error;
 - (NSData *)_postDataWithDictionary:(NSDictionary *)dictionary;
+#ifdef DEBUG
+- (CLDTransferFault)_transferFaultForRequest:(NSURLRequest *)request;
+#endif
+- (NSString *)_thumbnailKeyForItem:(CLDItem *)item format:(CLDItemThumbnailFormat)format size:(CLDItemThumbnailSize)size cropToSize:(BOOL)cropToSize;
+- (CLDThumbnailCacheLoadBlock)_thumbnailLoadBlockForItem:(CLDItem *)item format:(CLDItemThumbnailFormat)format size:(CLDItemThumbnailSize)size cropToSize:(BOOL)cropToSize;
 @end
 
 ///**
@@ -38,33 +69,3 @@ typedef NS_ENUM(NSUInteger, CLDSessionEndpoint) {
 // @since 1.0
 // */
 //- (void)fetchStreamingURLForItem:(CLDItem *)item protocol:(CLDItemStreamingProtocol)protocol fallbackToDownload:(BOOL)fallback resultBlock:(void(^)(NSURL *url, NSDate *expireDate))resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
-
-
-//////////////////////////////////////////////////////////////////////////////////
-///// @name Polling for updates
-//////////////////////////////////////////////////////////////////////////////////
-//
-///**
-// Starts polling the service for changes.
-// 
-// The session will post notifications whenever items are created, edited or removed.
-// Each notification will include one or more instance of <CLDItem> in their `userInfo` property.
-// 
-// @note If polling has already started for this session, `failureBlock` will be called with a corresponding error.
-// 
-// @param resultBlock  The block to be executed once polling began. Notifications will only be posted after this.
-// @param failureBlock The block to be executed if polling could not begin. This block takes an `NSError` argument containing the error.
-// @since 1.0
-// */
-//- (void)startPollingForDeltaUpdatesWithResultBlock:(void(^)())resultBlock failureBlock:(void(^)(NSError *error))failureBlock;
-//
-///**
-// Stops polling the service for changes.
-// 
-// @warning Do not call <stopPollingForDeltaUpdates> and <startPollingForDeltaUpdatesWithResultBlock:failureBlock:> repeatedly in an attempt to obtain faster updates.
-// Doing so may result in denial of service for undetermined amounts of time.
-// The SDK is already optimized to continuously poll the service without hitting any limits.
-// 
-// @since 1.0
-// */
-//- (void)stopPollingForDeltaUpdates;
\ No newline at end of file
@@ -0,0 +1,17 @@
+//
+//  CLDSessionMetrics+Private.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import <MEOCloudSDK/CLDSessionMetrics.h>
+
+@interface CLDSessionMetrics (Private)
+- (instancetype)initWithStartDate:(NSDate *)startDate
+                   requestMetrics:(NSDictionary *)requestMetrics
+                  transferMetrics:(NSDictionary *)transferMetrics
+           numberOfTokenRefreshes:(NSUInteger)numberOfTokenRefreshes
+     numberOfFailedTokenRefreshes:(NSUInteger)numberOfFailedTokenRefreshes;
+@end
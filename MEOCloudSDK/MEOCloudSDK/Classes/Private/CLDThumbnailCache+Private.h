@@ -0,0 +1,27 @@
+//
+//  CLDThumbnailCache+Private.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import <MEOCloudSDK/CLDThumbnailCache.h>
+
+@class CLDSession;
+
+typedef void(^CLDThumbnailCacheResultBlock)(CLDImage *thumbnail);
+typedef void(^CLDThumbnailCacheFailureBlock)(NSError *error);
+typedef CLDRequest *(^CLDThumbnailCacheLoadBlock)(void(^successBlock)(NSData *data), void(^failureBlock)(NSError *error));
+
+@interface CLDThumbnailCache (Private)
+- (instancetype)initWithSession:(CLDSession *)session;
+- (id)fetchThumbnailWithKey:(NSString *)key
+              callbackQueue:(dispatch_queue_t)callbackQueue
+                  loadBlock:(CLDThumbnailCacheLoadBlock)loadBlock
+                resultBlock:(CLDThumbnailCacheResultBlock)resultBlock
+               failureBlock:(CLDThumbnailCacheFailureBlock)failureBlock;
+- (void)cancelFetchWithKey:(NSString *)key token:(id)token;  // the fetch's blocks are not called
+- (void)setPriority:(float)priority forFetchWithKey:(NSString *)key;
++ (CLDImage *)decodedImageWithData:(NSData *)data cost:(NSUInteger *)cost;
+@end
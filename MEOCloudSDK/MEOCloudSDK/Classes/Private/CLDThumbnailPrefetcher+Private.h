@@ -0,0 +1,13 @@
+//
+//  CLDThumbnailPrefetcher+Private.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import <MEOCloudSDK/CLDThumbnailPrefetcher.h>
+
+@interface CLDThumbnailPrefetcher (Private)
+- (instancetype)initWithSession:(CLDSession *)session;
+@end
@@ -0,0 +1,45 @@
+//
+//  CLDTrace.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+// Always-on tracing of the SDK's internal spans, e.g. to find out where the time went when a folder "loads slowly".
+// Spans go to a fixed-size ring buffer shared by all sessions, the oldest ones being overwritten. Recording takes
+// two clock reads and one atomic increment, so these are plain C functions called right where the work happens:
+//
+//     uint64_t traceStart = CLDTraceBegin();
+//     ...
+//     CLDTraceEnd(CLDTraceSpanJSONParse, traceStart);
+
+typedef NS_ENUM(uint16_t, CLDTraceSpan) {
+    CLDTraceSpanURLBuild,
+    CLDTraceSpanRequestSigning,
+    CLDTraceSpanRequestQueued,
+    CLDTraceSpanTokenRefresh,
+    CLDTraceSpanNetwork,
+    CLDTraceSpanJSONParse,
+    CLDTraceSpanItemMaterialization,
+    CLDTraceSpanMainThreadHop,
+    CLDTraceSpanChunkPrepare,
+    CLDTraceSpanChunkSend,
+    CLDTraceSpanChunkCommit,
+    CLDTraceSpanDownload,
+    CLDTraceSpanArchiveSave,
+    CLDTraceSpanArchiveLoad,
+    CLDTraceSpanRequestEncoding,
+    CLDTraceSpanCount
+};
+
+#define CLDTraceBufferCapacity 8192
+
+FOUNDATION_EXTERN uint64_t CLDTraceBegin(void);
+FOUNDATION_EXTERN void CLDTraceEnd(CLDTraceSpan span, uint64_t startTime);
+
+// dispatch_async, tracing how long the block waited when it goes to the main queue
+FOUNDATION_EXTERN void CLDTraceDispatchAsync(dispatch_queue_t queue, dispatch_block_t block);
+
+// the spans in the buffer as Chrome trace event JSON, for chrome://tracing
+FOUNDATION_EXTERN NSData *CLDTraceCopyChromeTraceData(void);
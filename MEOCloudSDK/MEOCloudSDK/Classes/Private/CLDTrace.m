@@ -0,0 +1,114 @@
+//
+//  CLDTrace.m
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import "CLDTrace.h"
+#import <libkern/OSAtomic.h>
+#import <mach/mach_time.h>
+#import <pthread.h>
+
+typedef struct {
+    volatile int64_t sequence; // index + 1 once written, 0 while being written
+    uint64_t startTime;
+    uint64_t duration;
+    uint32_t thread;
+    uint16_t span;
+    uint16_t mainThread;
+} CLDTraceEvent;
+
+static CLDTraceEvent CLDTraceEvents[CLDTraceBufferCapacity];
+static volatile int64_t CLDTraceNextIndex = 0;
+
+static NSString *CLDTraceSpanName(CLDTraceSpan span) {
+    switch (span) {
+        case CLDTraceSpanURLBuild: return @"URL build";
+        case CLDTraceSpanRequestSigning: return @"Request signing";
+        case CLDTraceSpanRequestQueued: return @"Request queued";
+        case CLDTraceSpanTokenRefresh: return @"Token refresh";
+        case CLDTraceSpanNetwork: return @"Network";
+        case CLDTraceSpanJSONParse: return @"JSON parse";
+        case CLDTraceSpanItemMaterialization: return @"Item materialization";
+        case CLDTraceSpanMainThreadHop: return @"Main thread hop";
+        case CLDTraceSpanChunkPrepare: return @"Chunk prepare";
+        case CLDTraceSpanChunkSend: return @"Chunk send";
+        case CLDTraceSpanChunkCommit: return @"Chunk commit";
+        case CLDTraceSpanDownload: return @"Download";
+        case CLDTraceSpanArchiveSave: return @"Archive save";
+        case CLDTraceSpanArchiveLoad: return @"Archive load";
+        case CLDTraceSpanRequestEncoding: return @"Request encoding";
+        case CLDTraceSpanCount: break;
+    }
+    return @"Unknown";
+}
+
+uint64_t CLDTraceBegin(void) {
+    return mach_absolute_time();
+}
+
+void CLDTraceEnd(CLDTraceSpan span, uint64_t startTime) {
+    uint64_t endTime = mach_absolute_time();
+    int64_t index = OSAtomicIncrement64Barrier(&CLDTraceNextIndex) - 1;
+    CLDTraceEvent *event = &CLDTraceEvents[index % CLDTraceBufferCapacity];
+
+    // readers skip the slot until its sequence is set again
+    event->sequence = 0;
+    OSMemoryBarrier();
+    event->startTime = startTime;
+    event->duration = endTime - startTime;
+    event->thread = pthread_mach_thread_np(pthread_self());
+    event->span = span;
+    event->mainThread = pthread_main_np() != 0;
+    OSMemoryBarrier();
+    event->sequence = index + 1;
+}
+
+void CLDTraceDispatchAsync(dispatch_queue_t queue, dispatch_block_t block) {
+    if (queue != dispatch_get_main_queue()) {
+        dispatch_async(queue, block);
+        return;
+    }
+    uint64_t traceStart = CLDTraceBegin();
+    dispatch_async(queue, ^{
+        CLDTraceEnd(CLDTraceSpanMainThreadHop, traceStart);
+        block();
+    });
+}
+
+NSData *CLDTraceCopyChromeTraceData(void) {
+    mach_timebase_info_data_t timebase;
+    mach_timebase_info(&timebase);
+    double microsecondsPerTick = (double)timebase.numer / timebase.denom / 1000;
+    int pid = [NSProcessInfo processInfo].processIdentifier;
+
+    NSMutableArray *traceEvents = [NSMutableArray new];
+    NSMutableSet *mainThreads = [NSMutableSet new];
+    int64_t endIndex = CLDTraceNextIndex;
+    int64_t startIndex = MAX(endIndex - CLDTraceBufferCapacity, 0);
+    for (int64_t index = startIndex; index < endIndex; index++) {
+        CLDTraceEvent *slot = &CLDTraceEvents[index % CLDTraceBufferCapacity];
+        int64_t sequence = slot->sequence;
+        OSMemoryBarrier();
+        CLDTraceEvent event = *slot;
+        OSMemoryBarrier();
+        // still being written, or overwritten while copying
+        if (sequence != index + 1 || slot->sequence != sequence || event.span >= CLDTraceSpanCount) continue;
+
+        if (event.mainThread) [mainThreads addObject:@(event.thread)];
+        [traceEvents addObject:@{@"name": CLDTraceSpanName(event.span),
+                                 @"cat": @"MEOCloudSDK",
+                                 @"ph": @"X",
+                                 @"ts": @(event.startTime * microsecondsPerTick),
+                                 @"dur": @(event.duration * microsecondsPerTick),
+                                 @"pid": @(pid),
+                                 @"tid": @(event.thread)}];
+    }
+    for (NSNumber *thread in mainThreads) {
+        [traceEvents addObject:@{@"name": @"thread_name", @"ph": @"M", @"pid": @(pid), @"tid": thread, @"args": @{@"name": @"Main thread"}}];
+    }
+
+    return [NSJSONSerialization dataWithJSONObject:@{@"traceEvents": traceEvents, @"displayTimeUnit": @"ms"} options:0 error:nil];
+}
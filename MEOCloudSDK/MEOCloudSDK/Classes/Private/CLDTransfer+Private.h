@@ -27,6 +27,7 @@ typedef void(^CLDTransferFailureBlock)(NSError *error);
 @property (readwrite, copy, nonatomic) CLDTransferDownloadResultBlock downloadResultBlock;
 @property (readwrite, copy, nonatomic) CLDTransferUploadResultBlock uploadResultBlock;
 @property (readwrite, copy, nonatomic) CLDTransferFailureBlock failureBlock;
+@property (readwrite, strong, nonatomic) dispatch_queue_t callbackQueue;
 
 - (instancetype)initWithManager:(CLDTransferManager *)manager;
 - (void)cancelWithError:(NSError *)error;
@@ -17,6 +17,7 @@ typedef void(^CLDTransferBackgroundEventsCompletionHandler)();
 
 - (instancetype)initWithSession:(CLDSession *)session;
 - (BOOL)save;
+- (void)warmUpConnections;
 
 // creating / adding transfers
 - (CLDTransfer *)scheduleUploadForItem:(CLDItem *)item
@@ -30,4 +31,10 @@ typedef void(^CLDTransferBackgroundEventsCompletionHandler)();
                           cellularAccess:(BOOL)cellularAccess
                                 priority:(CLDTransferPriority)priority
                                    error:(NSError **)error;
+
+// reserves quota for an upload before it sends data, refreshing the quota first if it is stale,
+// uploads holding a reservation already are admitted right away
+- (void)admitUploadTransfer:(CLDTransfer *)transfer completionBlock:(void(^)(BOOL admitted))completionBlock;
+// for uploads that went ahead without waiting for admission, so that their quota is accounted for all the same
+- (void)reserveQuotaForUploadTransfer:(CLDTransfer *)transfer;
 @end
\ No newline at end of file
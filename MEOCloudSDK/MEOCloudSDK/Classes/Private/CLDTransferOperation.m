@@ -36,6 +36,7 @@ static void *kCLDTransferOperationKVOContext = &kCLDTransferOperationKVOContext;
 @property (readwrite, nonatomic) uint64_t byteOffset;
 @property (readwrite, strong, nonatomic) NSURL *temporaryDownloadedFileURL;
 @property (readwrite, strong, nonatomic) NSMutableData *receivedData; // uploads only
+@property (readwrite, strong, atomic) CLDRequest *validationRequest; // uploads only
 @end
 
 @implementation CLDTransferOperation {
@@ -44,6 +45,14 @@ static void *kCLDTransferOperationKVOContext = &kCLDTransferOperationKVOContext;
     NSUInteger _backgroundTaskIdentifier;
     NSCondition *_stateCondition;
     CLDTransferOperationState _state;
+    NSUInteger _numberOfFailedAttempts;
+    CFAbsoluteTime _taskStartTime;
+    CFAbsoluteTime _taskResponseTime;
+    CFAbsoluteTime _firstFailureTime;
+    uint64_t _taskTraceStart;
+#ifdef DEBUG
+    NSHTTPURLResponse *_injectedResponse;
+#endif
 }
 
 #pragma mark - Initialization
@@ -119,6 +128,24 @@ static void *kCLDTransferOperationKVOContext = &kCLDTransferOperationKVOContext;
 }
 
 - (void)finishOperationWithError:(NSError *)error {
+    CLDSession *session = [CLDSession sessionWithIdentifier:self.transfer.sessionIdentifier];
+#ifdef DEBUG
+    error = [self _injectFaultWithError:error];
+#endif
+    NSURLResponse *response = [self _responseForTask:self.task];
+    
+    // transfers are not scheduled with API requests, but a struggling server should slow those down too
+    if ([CLDRequestScheduler outcomeForResponse:response error:error] == CLDRequestOutcomeOverloaded) {
+        [session _reportServerOverload];
+    }
+    if (self.transfer.type == CLDTransferTypeDownload) CLDTraceEnd(CLDTraceSpanDownload, _taskTraceStart);
+    else if ([self _isChunkCommit]) CLDTraceEnd(CLDTraceSpanChunkCommit, _taskTraceStart);
+    else CLDTraceEnd(CLDTraceSpanChunkSend, _taskTraceStart);
+    if (!self.isCancelled) {
+        NSTimeInterval timeToFirstByte = _taskResponseTime > 0 ? _taskResponseTime - _taskStartTime : -1;
+        [[session _metricsRecorder] recordTask:self.task transfer:YES waitTime:-1 timeToFirstByte:timeToFirstByte totalTime:CFAbsoluteTimeGetCurrent() - _taskStartTime];
+    }
+    [CLDRetryPolicy recordResponse:response error:error forHost:self.task.originalRequest.URL.host];
     switch (self.transfer.type) {
         case CLDTransferTypeDownload:
             [self finishDownloadWithError:error];
@@ -141,13 +168,28 @@ static void *kCLDTransferOperationKVOContext = &kCLDTransferOperationKVOContext;
     [_stateCondition signalWithBlock:^{
         _state = state;
     }];
+    
+    // an attempt succeeded after others failed
+    if (state == CLDTransferOperationStateFinished && _firstFailureTime > 0) {
+        CLDSession *session = [CLDSession sessionWithIdentifier:self.transfer.sessionIdentifier];
+        [[session _metricsRecorder] recordRecoveryForRequest:self.task.originalRequest transfer:YES recoveryTime:CFAbsoluteTimeGetCurrent() - _firstFailureTime];
+        _firstFailureTime = 0;
+    }
 }
 
 - (void)setTask:(NSURLSessionTask *)task {
     @synchronized(self) {
         if (_task) [self endObservingTask:_task];
         _task = task;
-        if (_task) [self beginObservingTask:_task];
+        if (_task) {
+            _taskStartTime = CFAbsoluteTimeGetCurrent();
+            _taskResponseTime = 0;
+            _taskTraceStart = CLDTraceBegin();
+#ifdef DEBUG
+            _injectedResponse = nil;
+#endif
+            [self beginObservingTask:_task];
+        }
     }
 }
 
@@ -191,6 +233,31 @@ static void *kCLDTransferOperationKVOContext = &kCLDTransferOperationKVOContext;
 - (void)createUploadTask {
     [self validate];
     
+    // hold back uploads that cannot fit in the account's quota before any data is sent
+    NSCondition *quotaCondition = [NSCondition new];
+    __block BOOL admissionFinished = NO;
+    __block BOOL admitted = NO;
+    [self.transfer.manager admitUploadTransfer:self.transfer completionBlock:^(BOOL result) {
+        [quotaCondition signalWithBlock:^{
+            admissionFinished = YES;
+            admitted = result;
+        }];
+    }];
+    [quotaCondition waitUntilDate:[NSDate dateWithTimeIntervalSinceNow:10] whileCondition:^BOOL{ return !admissionFinished && !self.isCancelled; } timeOutBlock:^{
+        // if the quota could not be fetched in time we let the server decide,
+        // the upload still counts against the quota and is not held back again for its next chunks
+        admitted = YES;
+        [self.transfer.manager reserveQuotaForUploadTransfer:self.transfer];
+    }];
+    if (self.isCancelled) {
+        return;
+    }
+    if (!admitted) {
+        CLDLog(@"Cancelling transfer because it does not fit in the available quota!");
+        [self.transfer cancelWithError:[CLDError errorWithCode:CLDErrorCodeOverQuota]];
+        return;
+    }
+    
     // validate if upload path is available before uploading data
     // valid = if metadata fetch for that folder does not return CLDErrorCodeResourceNotFound
     NSCondition *condition = [NSCondition new];
@@ -199,7 +266,7 @@ static void *kCLDTransferOperationKVOContext = &kCLDTransferOperationKVOContext;
     NSString *path = [self.transfer.item.path stringByDeletingLastPathComponent];
     CLDItem *item = [CLDItem itemWithPath:path];
     CLDSession *session = self.transfer.manager.session;
-    [session fetchItem:item options:CLDSessionFetchItemOptionNone resultBlock:^(CLDItem *item) {
+    self.validationRequest = [session fetchItem:item options:CLDSessionFetchItemOptionNone resultBlock:^(CLDItem *item) {
         [condition signalWithBlock:^{
             finished = YES;
             if (item.isDeleted == NO) {
@@ -214,10 +281,15 @@ static void *kCLDTransferOperationKVOContext = &kCLDTransferOperationKVOContext;
             }
         }];
     }];
-    [condition waitUntilDate:[NSDate dateWithTimeIntervalSinceNow:10] whileCondition:^BOOL{ return !finished; } timeOutBlock:^{
+    [condition waitUntilDate:[NSDate dateWithTimeIntervalSinceNow:10] whileCondition:^BOOL{ return !finished && !self.isCancelled; } timeOutBlock:^{
         // if the condition times out we assume the path is valid and let NSURLSession deal with the rest
         pathIsValid = YES;
     }];
+    [self.validationRequest cancel];
+    self.validationRequest = nil;
+    if (self.isCancelled) {
+        return;
+    }
     if (!pathIsValid) {
         CLDLog(@"Cancelling transfer because path for upload is invalid!");
         [self.transfer cancelWithError:[CLDError errorWithCode:CLDErrorCodeResourceNotFound]];
@@ -245,6 +317,7 @@ static void *kCLDTransferOperationKVOContext = &kCLDTransferOperationKVOContext;
     
     // temporary file already exists (from previous attempts)?
     if ([[NSFileManager defaultManager] fileExistsAtPath:fileURL.path] == NO) {
+        uint64_t traceStart = CLDTraceBegin();
         // is it a file or an asset?
         BOOL errorAccessingFileOrAsset = NO;
         if ([item.uploadURL isFileURL]) {
@@ -295,6 +368,7 @@ static void *kCLDTransferOperationKVOContext = &kCLDTransferOperationKVOContext;
         
         // save data to temporary file
         NSAssert([dataToSend writeToURL:fileURL atomically:YES], @"Could not create chunk file!");
+        CLDTraceEnd(CLDTraceSpanChunkPrepare, traceStart);
     }
     
     // generate URL
@@ -372,18 +446,11 @@ static void *kCLDTransferOperationKVOContext = &kCLDTransferOperationKVOContext;
 - (void)finishUploadWithError:(NSError *)error {
     
     if (error) {
+        NSURLSessionTask *task = self.task;
         self.task = nil;
-        if ([error.domain isEqualToString:NSURLErrorDomain]) {
-            unsigned int sleepAmount;
-            if (error.code == NSURLErrorNotConnectedToInternet) {
-                CLDLog(@"Not connected to internet, retrying in 5 seconds...");
-                sleepAmount = 5;
-            } else {
-                CLDLog(@"Failed to upload due to connectivity problems, retrying...");
-                sleepAmount = 1;
-            }
-            sleep(sleepAmount);
-            [self createUploadTask];
+        if (self.isCancelled) return;
+        if ([self _retryTask:task error:error retryBlock:^{ [self createUploadTask]; }]) {
+            CLDLog(@"Failed to upload due to connectivity problems, retrying...");
         } else {
             CLDLog(@"Task failed due to error: %@", error);
             
@@ -400,7 +467,7 @@ static void *kCLDTransferOperationKVOContext = &kCLDTransferOperationKVOContext;
         // no error? delete previously created temporary file
         [[NSFileManager defaultManager] removeItemAtURL:[self _temporaryChunkFileURL] error:nil];
         
-        NSHTTPURLResponse *response = (NSHTTPURLResponse *)self.task.response;
+        NSHTTPURLResponse *response = (NSHTTPURLResponse *)[self _responseForTask:self.task];
         NSUInteger statusCode = response.statusCode;
         switch (statusCode) {
             case 200:
@@ -445,6 +512,10 @@ static void *kCLDTransferOperationKVOContext = &kCLDTransferOperationKVOContext;
                 break;
                 
             default: {
+                if ([self _retryTask:self.task error:nil retryBlock:^{ [self createUploadTask]; }]) {
+                    CLDLog(@"Failed to upload due to server error %lu, retrying...", (unsigned long)statusCode);
+                    break;
+                }
                 CLDSession *session = [CLDSession sessionWithIdentifier:self.transfer.sessionIdentifier];
                 CLDError *standardError = [session _errorFromStatusCode:response.statusCode error:nil];
                 [self.transfer cancelWithError:standardError];
@@ -489,13 +560,16 @@ static void *kCLDTransferOperationKVOContext = &kCLDTransferOperationKVOContext;
 
 - (void)finishDownloadWithError:(NSError *)error {
     if (error) {
-        if (error.userInfo[NSURLSessionDownloadTaskResumeData]) {
-            CLDLog(@"Task failed with resume data. Attempting to resume...");
-            [self createDownloadTaskWithResumeData:error.userInfo[NSURLSessionDownloadTaskResumeData]];
-        } else if ([error.domain isEqualToString:NSURLErrorDomain]) {
-            CLDLog(@"Failed to download due to connectivity problems, retrying...");
-            sleep(1);
-            [self createDownloadTask];
+        NSData *resumeData = error.userInfo[NSURLSessionDownloadTaskResumeData];
+        if (self.isCancelled) {
+            self.task = nil;
+            return;
+        }
+        if ([self _retryTask:self.task error:error retryBlock:^{
+            if (resumeData) [self createDownloadTaskWithResumeData:resumeData];
+            else [self createDownloadTask];
+        }]) {
+            CLDLog(@"Failed to download due to connectivity problems, retrying%@...", resumeData ? @" with resume data" : @"");
         } else {
             CLDLog(@"Task failed due to error: %@", error);
             CLDSession *session = [CLDSession sessionWithIdentifier:self.transfer.sessionIdentifier];
@@ -503,16 +577,34 @@ static void *kCLDTransferOperationKVOContext = &kCLDTransferOperationKVOContext;
             [self.transfer cancelWithError:standardError];
         }
     } else {
-        NSHTTPURLResponse *response = (NSHTTPURLResponse *)self.task.response;
+        NSHTTPURLResponse *response = (NSHTTPURLResponse *)[self _responseForTask:self.task];
         NSUInteger statusCode = response.statusCode;
         switch (statusCode) {
             case 200:
             case 206:
+                // a connection that ends early without the transport noticing leaves a short file behind,
+                // which must not pass for the item
+                if (![self _isDownloadedFileCompleteForResponse:response]) {
+                    CLDLog(@"Downloaded file of %@ is incomplete", self.transfer.item.path);
+                    if (self.temporaryDownloadedFileURL) [[NSFileManager defaultManager] removeItemAtURL:self.temporaryDownloadedFileURL error:nil];
+                    self.temporaryDownloadedFileURL = nil;
+                    NSError *truncationError = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorNetworkConnectionLost userInfo:nil];
+                    if ([self _retryTask:self.task error:truncationError retryBlock:^{ [self createDownloadTask]; }]) {
+                        CLDLog(@"Retrying incomplete download...");
+                    } else {
+                        [self.transfer cancelWithError:[CLDError errorWithCode:CLDErrorCodeInvalidResponse]];
+                    }
+                    break;
+                }
                 self.transfer.downloadedFileURL = self.temporaryDownloadedFileURL;
                 self.state = CLDTransferOperationStateFinished;
                 break;
                 
             default: {
+                if ([self _retryTask:self.task error:nil retryBlock:^{ [self createDownloadTask]; }]) {
+                    CLDLog(@"Failed to download due to server error %lu, retrying...", (unsigned long)statusCode);
+                    break;
+                }
                 CLDSession *session = [CLDSession sessionWithIdentifier:self.transfer.sessionIdentifier];
                 CLDError *standardError = [session _errorFromStatusCode:response.statusCode error:nil];
                 [self.transfer cancelWithError:standardError];
@@ -524,6 +616,101 @@ static void *kCLDTransferOperationKVOContext = &kCLDTransferOperationKVOContext;
     self.task = nil;
 }
 
+// the whole file is expected, also after resuming, when the response only carried the rest of it
+- (BOOL)_isDownloadedFileCompleteForResponse:(NSHTTPURLResponse *)response {
+    NSNumber *fileSize = nil;
+    if (![self.temporaryDownloadedFileURL getResourceValue:&fileSize forKey:NSURLFileSizeKey error:nil] || fileSize == nil) return NO;
+    
+    int64_t expectedSize = NSURLResponseUnknownLength;
+    if (response.statusCode == 206) {
+        // "bytes start-end/size"
+        NSString *contentRange = response.allHeaderFields[@"Content-Range"];
+        NSRange slash = [contentRange rangeOfString:@"/" options:NSBackwardsSearch];
+        if (slash.location != NSNotFound) {
+            NSString *size = [contentRange substringFromIndex:NSMaxRange(slash)];
+            if (![size isEqualToString:@"*"]) expectedSize = size.longLongValue;
+        }
+    } else {
+        expectedSize = response.expectedContentLength;
+    }
+    // the size of the item is only known to be the size of the file if its revision was requested,
+    // it also catches a body cut short along with its Content-Length, e.g. by a proxy
+    CLDItem *item = self.transfer.item;
+    if (item.revision && item.size > 0 && fileSize.longLongValue != (int64_t)item.size) return NO;
+    return expectedSize < 0 || fileSize.longLongValue == expectedSize;
+}
+
+#pragma mark - Retrying
+
+// schedules retryBlock if the transfer retry policy allows another attempt, the operation keeps executing meanwhile
+- (BOOL)_retryTask:(NSURLSessionTask *)task error:(NSError *)error retryBlock:(void(^)())retryBlock {
+    NSTimeInterval delay = [[CLDRetryPolicy transferPolicy] retryDelayForRequest:task.originalRequest
+                                                                        response:[self _responseForTask:task]
+                                                                           error:error
+                                                                         attempt:_numberOfFailedAttempts];
+    if (delay == CLDRetryPolicyNoRetry) return NO;
+    
+    // what the failed attempt transferred is sent again, unless a download can resume where it stopped
+    int64_t bytesResent = task.countOfBytesSent;
+    if (self.transfer.type == CLDTransferTypeDownload) {
+        bytesResent = error.userInfo[NSURLSessionDownloadTaskResumeData] ? 0 : task.countOfBytesReceived;
+    }
+    [[[CLDSession sessionWithIdentifier:self.transfer.sessionIdentifier] _metricsRecorder] recordRetryForRequest:task.originalRequest transfer:YES bytesResent:bytesResent];
+    if (_firstFailureTime == 0) _firstFailureTime = CFAbsoluteTimeGetCurrent();
+    _numberOfFailedAttempts++;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_LOW, 0), ^{
+        if (self.isCancelled || self.state != CLDTransferOperationStateExecuting) return;
+        retryBlock();
+    });
+    return YES;
+}
+
+- (NSURLResponse *)_responseForTask:(NSURLSessionTask *)task {
+#ifdef DEBUG
+    if (_injectedResponse) return _injectedResponse;
+#endif
+    return task.response;
+}
+
+#ifdef DEBUG
+#pragma mark - Fault injection
+
+// replaces the outcome of a task that finished well with the fault the session asks for, if any
+- (NSError *)_injectFaultWithError:(NSError *)error {
+    NSURLSessionTask *task = self.task;
+    if (error || task == nil || self.isCancelled) return error;
+    
+    CLDSession *session = [CLDSession sessionWithIdentifier:self.transfer.sessionIdentifier];
+    CLDTransferFault fault = [session _transferFaultForRequest:task.originalRequest];
+    switch (fault) {
+        case CLDTransferFaultNone:
+            break;
+        case CLDTransferFaultConnectionLost:
+            CLDLog(@"Injecting a lost connection into %@", task.originalRequest.URL.path);
+            return [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorNetworkConnectionLost userInfo:nil];
+        case CLDTransferFaultBadRequest:
+        case CLDTransferFaultUnauthorized:
+            CLDLog(@"Injecting a %@ response into %@", (fault == CLDTransferFaultBadRequest) ? @"400" : @"401", task.originalRequest.URL.path);
+            _injectedResponse = [[NSHTTPURLResponse alloc] initWithURL:task.originalRequest.URL
+                                                            statusCode:(fault == CLDTransferFaultBadRequest) ? 400 : 401
+                                                           HTTPVersion:@"HTTP/1.1"
+                                                          headerFields:nil];
+            break;
+        case CLDTransferFaultTruncatedBody:
+            CLDLog(@"Injecting a truncated body into %@", task.originalRequest.URL.path);
+            if (self.transfer.type == CLDTransferTypeUpload) {
+                self.receivedData.length = self.receivedData.length / 2;
+            } else if (self.temporaryDownloadedFileURL) {
+                NSFileHandle *fileHandle = [NSFileHandle fileHandleForWritingToURL:self.temporaryDownloadedFileURL error:nil];
+                [fileHandle truncateFileAtOffset:[fileHandle seekToEndOfFile] / 2];
+                [fileHandle closeFile];
+            }
+            break;
+    }
+    return error;
+}
+#endif
+
 #pragma mark - Task observing
 
 - (void)beginObservingTask:(NSURLSessionTask *)task {
@@ -548,6 +735,7 @@ static void *kCLDTransferOperationKVOContext = &kCLDTransferOperationKVOContext;
         NSURLSessionTask *task = object;
         
         if ([keyPath isEqualToString:@"response"]) {
+            if (_taskResponseTime == 0) _taskResponseTime = CFAbsoluteTimeGetCurrent();
             if (self.transfer.type == CLDTransferTypeDownload && self.transfer.bytesTotal == 0) {
                 self.transfer.bytesTotal = task.response.expectedContentLength;
             }
@@ -581,6 +769,7 @@ static void *kCLDTransferOperationKVOContext = &kCLDTransferOperationKVOContext;
 #pragma mark - Cancelling
 
 - (void)cancel {
+    [self.validationRequest cancel];
     [self.task cancel];
     self.state = CLDTransferOperationStateCancelled;
     [super cancel];
@@ -0,0 +1,27 @@
+//
+//  CLDTreeCrawler+Private.h
+//  MEOCloudSDK
+//
+//  Created by Hugo Sousa on 19/10/26.
+//
+//
+
+#import <MEOCloudSDK/CLDTreeCrawler.h>
+#import <MEOCloudSDK/CLDSession.h>
+
+typedef void(^CLDTreeCrawlerFolderBlock)(CLDItem *folder);
+typedef void(^CLDTreeCrawlerResultBlock)(CLDTreeCrawlerCheckpoint *checkpoint);
+typedef void(^CLDTreeCrawlerFailureBlock)(NSError *error, CLDTreeCrawlerCheckpoint *checkpoint);
+
+@interface CLDTreeCrawler (Private)
+@property (readwrite, copy, nonatomic) CLDTreeCrawlerFolderBlock folderBlock;
+@property (readwrite, copy, nonatomic) CLDTreeCrawlerResultBlock resultBlock;
+@property (readwrite, copy, nonatomic) CLDTreeCrawlerFailureBlock failureBlock;
+@property (readwrite, strong, nonatomic) dispatch_queue_t callbackQueue;
+
+- (instancetype)initWithSession:(CLDSession *)session
+                           item:(CLDItem *)item
+                        options:(CLDSessionFetchItemOptions)options
+                     checkpoint:(CLDTreeCrawlerCheckpoint *)checkpoint;
+- (void)start;
+@end
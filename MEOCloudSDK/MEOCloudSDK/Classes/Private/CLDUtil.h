@@ -13,6 +13,7 @@
 
 + (NSBundle *)frameworkBundle;
 + (NSURL*)applicationSupportDirectory;
++ (NSURL *)cachesDirectory;
 + (NSString *)generateIdentifier;
 + (void)postNotificationNamed:(NSString *)aName object:(id)anObject userInfo:(NSDictionary *)aUserInfo;
 + (void)postNotificationNamed:(NSString *)aName object:(id)anObject userInfo:(NSDictionary *)aUserInfo synchronous:(BOOL)synchronous;
@@ -47,6 +47,29 @@
     return dirPath;
 }
 
++ (NSURL *)cachesDirectory
+{
+    static NSURL *dirPath = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSString* bundleID = [[NSBundle mainBundle] bundleIdentifier];
+        NSFileManager *fm = [NSFileManager defaultManager];
+        
+        // Find the caches directory in the home directory.
+        NSArray* cachesDir = [fm URLsForDirectory:NSCachesDirectory inDomains:NSUserDomainMask];
+        if ([cachesDir count] > 0)
+        {
+            // Append the bundle ID to the URL for the Caches directory
+            dirPath = [[cachesDir objectAtIndex:0] URLByAppendingPathComponent:bundleID];
+            
+            NSError *error = nil;
+            [fm createDirectoryAtURL:dirPath withIntermediateDirectories:YES attributes:nil error:&error];
+            NSAssert(error == nil, @"Could not create app directory in Caches. Error: %@", error.description);
+        }
+    });
+    return dirPath;
+}
+
 + (NSString *)generateIdentifier {
     CFUUIDRef theUUID = CFUUIDCreate(NULL);
     CFStringRef string = CFUUIDCreateString(NULL, theUUID);
@@ -22,14 +22,27 @@ FOUNDATION_EXPORT const unsigned char MEOCloudSDK_VersionString[];
 // In this header, you should import all the public headers of your framework using statements like #import <MEOCloudSDK_OSX/PublicHeader.h>
 
 #import <MEOCloudSDK/CLDAccountUser.h>
+#import <MEOCloudSDK/CLDBatchOperation.h>
+#import <MEOCloudSDK/CLDDownloadStream.h>
+#import <MEOCloudSDK/CLDEndpointMetrics.h>
 #import <MEOCloudSDK/CLDItem.h>
+#import <MEOCloudSDK/CLDLatencyHistogram.h>
 #import <MEOCloudSDK/CLDLink.h>
+#import <MEOCloudSDK/CLDRemoteFile.h>
+#import <MEOCloudSDK/CLDRequest.h>
+#import <MEOCloudSDK/CLDRequestLaneStatistics.h>
+#import <MEOCloudSDK/CLDSearchIndex.h>
+#import <MEOCloudSDK/CLDSearchSession.h>
 #import <MEOCloudSDK/CLDSession.h>
 #import <MEOCloudSDK/CLDSessionConfiguration.h>
+#import <MEOCloudSDK/CLDSessionMetrics.h>
 #import <MEOCloudSDK/CLDSharedFolder.h>
 #import <MEOCloudSDK/CLDSharedFolderUser.h>
+#import <MEOCloudSDK/CLDThumbnailCache.h>
+#import <MEOCloudSDK/CLDThumbnailPrefetcher.h>
 #import <MEOCloudSDK/CLDTransfer.h>
 #import <MEOCloudSDK/CLDTransferManager.h>
+#import <MEOCloudSDK/CLDTreeCrawler.h>
 #import <MEOCloudSDK/CLDUser.h>
 
 FOUNDATION_EXPORT const unsigned char MEOCloudSDKVersionString[];
@@ -58,5 +71,7 @@ typedef NS_ENUM(NSInteger, CLDErrorCode) {
     CLDErrorCodeServerCouldNotCreateThumbnail,
     CLDErrorCodeInvalidItem,
     CLDErrorCodeInvalidParameters,
-    CLDErrorCancelledByUser
+    CLDErrorCancelledByUser,
+    CLDErrorCodeAlreadyPolling,
+    CLDErrorCodeServiceUnavailable
 };
\ No newline at end of file
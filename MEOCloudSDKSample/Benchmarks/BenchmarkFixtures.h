@@ -0,0 +1,26 @@
+//
+//  BenchmarkFixtures.h
+//  MEOCloudSDKSample
+//
+//  Created by Hugo Sousa on 19/10/26.
+//  Copyright (c) 2026 SAPO. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+// Deterministic API responses, shaped like the ones the service returns, so that runs can be compared.
+@interface BenchmarkFixtures : NSObject
+
+// Metadata entries of the items in a folder, one in ten is a folder, the rest are files of a few common types.
++ (NSArray *)itemDictionariesWithCount:(NSUInteger)count inFolder:(NSString *)folderPath;
+
+// Metadata of a folder, with its contents.
++ (NSDictionary *)folderDictionaryWithPath:(NSString *)path numberOfItems:(NSUInteger)numberOfItems;
+
+// Metadata of a single file.
++ (NSDictionary *)fileDictionaryWithPath:(NSString *)path size:(uint64_t)size;
+
+// Dates as the service formats them, e.g. "Wed, 12 Mar 2014 10:23:45 +0000".
++ (NSString *)serviceDateStringWithDate:(NSDate *)date;
+
+@end
@@ -0,0 +1,118 @@
+//
+//  BenchmarkFixtures.m
+//  MEOCloudSDKSample
+//
+//  Created by Hugo Sousa on 19/10/26.
+//  Copyright (c) 2026 SAPO. All rights reserved.
+//
+
+#import "BenchmarkFixtures.h"
+
+// all fixture dates fall in the year after this one
+#define BenchmarkFixturesReferenceDate 1388534400 // 1 Jan 2014 00:00:00 GMT
+
+@implementation BenchmarkFixtures
+
++ (NSString *)serviceDateStringWithDate:(NSDate *)date {
+    static NSDateFormatter *formatter = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        formatter = [NSDateFormatter new];
+        formatter.locale = [[NSLocale alloc] initWithLocaleIdentifier:@"en_US_POSIX"];
+        formatter.timeZone = [NSTimeZone timeZoneForSecondsFromGMT:0];
+        formatter.dateFormat = @"EEE, dd MMM yyyy HH:mm:ss ZZZ";
+    });
+    @synchronized(formatter) {
+        return [formatter stringFromDate:date];
+    }
+}
+
++ (NSArray *)itemDictionariesWithCount:(NSUInteger)count inFolder:(NSString *)folderPath {
+    NSParameterAssert(folderPath);
+    static NSString * const mimeTypes[] = { @"image/jpeg", @"image/png", @"application/pdf", @"video/mp4", @"text/plain" };
+    static NSString * const icons[] = { @"page_white_picture", @"page_white_picture", @"page_white_acrobat", @"page_white_film", @"page_white_text" };
+    static NSString * const extensions[] = { @"jpg", @"png", @"pdf", @"mp4", @"txt" };
+    NSString *parentPath = [folderPath hasSuffix:@"/"] ? folderPath : [folderPath stringByAppendingString:@"/"];
+
+    NSMutableArray *dictionaries = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        // spread modification dates over a year, a few seconds apart from the client's
+        NSDate *modified = [NSDate dateWithTimeIntervalSince1970:BenchmarkFixturesReferenceDate + (i * 7919) % (365 * 24 * 3600)];
+        NSDate *clientModified = [modified dateByAddingTimeInterval:-(NSTimeInterval)(i % 60)];
+        NSString *revision = [NSString stringWithFormat:@"%08lx%08lx", (unsigned long)(i * 2654435761u), (unsigned long)i];
+
+        NSMutableDictionary *dictionary = [NSMutableDictionary new];
+        dictionary[@"rev"] = revision;
+        dictionary[@"root"] = @"meocloud";
+        dictionary[@"is_owner"] = @YES;
+        dictionary[@"is_deleted"] = @NO;
+        dictionary[@"is_link"] = @(i % 13 == 0);
+        dictionary[@"modified"] = [self serviceDateStringWithDate:modified];
+        dictionary[@"client_mtime"] = [self serviceDateStringWithDate:clientModified];
+        if (i % 10 == 0) {
+            dictionary[@"path"] = [NSString stringWithFormat:@"%@Folder %lu", parentPath, (unsigned long)i];
+            dictionary[@"is_dir"] = @YES;
+            dictionary[@"bytes"] = @0;
+            dictionary[@"size"] = @"0 bytes";
+            dictionary[@"icon"] = @"folder";
+            dictionary[@"thumb_exists"] = @NO;
+            dictionary[@"is_upload"] = @NO;
+            dictionary[@"hash"] = [revision stringByAppendingString:revision];
+            if (i % 30 == 0) dictionary[@"folder_type"] = @"shared";
+        } else {
+            NSUInteger kind = i % 5;
+            uint64_t size = 1024 + (i * 104729) % (8 * 1024 * 1024);
+            dictionary[@"path"] = [NSString stringWithFormat:@"%@IMG_%05lu.%@", parentPath, (unsigned long)i, extensions[kind]];
+            dictionary[@"is_dir"] = @NO;
+            dictionary[@"bytes"] = @(size);
+            dictionary[@"size"] = [NSByteCountFormatter stringFromByteCount:(long long)size countStyle:NSByteCountFormatterCountStyleFile];
+            dictionary[@"icon"] = icons[kind];
+            dictionary[@"mime_type"] = mimeTypes[kind];
+            dictionary[@"thumb_exists"] = @(kind < 2);
+        }
+        [dictionaries addObject:dictionary];
+    }
+    return dictionaries;
+}
+
++ (NSDictionary *)folderDictionaryWithPath:(NSString *)path numberOfItems:(NSUInteger)numberOfItems {
+    NSParameterAssert(path);
+    NSString *date = [self serviceDateStringWithDate:[NSDate dateWithTimeIntervalSince1970:BenchmarkFixturesReferenceDate]];
+    return @{@"rev": @"00000000deadbeef",
+             @"path": path,
+             @"root": @"meocloud",
+             @"is_dir": @YES,
+             @"is_owner": @YES,
+             @"is_deleted": @NO,
+             @"is_link": @NO,
+             @"is_upload": @NO,
+             @"bytes": @0,
+             @"size": @"0 bytes",
+             @"icon": @"folder",
+             @"thumb_exists": @NO,
+             @"hash": [NSString stringWithFormat:@"%032lx", (unsigned long)path.hash],
+             @"modified": date,
+             @"client_mtime": date,
+             @"contents": [self itemDictionariesWithCount:numberOfItems inFolder:path]};
+}
+
++ (NSDictionary *)fileDictionaryWithPath:(NSString *)path size:(uint64_t)size {
+    NSParameterAssert(path);
+    NSString *date = [self serviceDateStringWithDate:[NSDate dateWithTimeIntervalSince1970:BenchmarkFixturesReferenceDate]];
+    return @{@"rev": [NSString stringWithFormat:@"%016llx", (unsigned long long)(path.hash ^ size)],
+             @"path": path,
+             @"root": @"meocloud",
+             @"is_dir": @NO,
+             @"is_owner": @YES,
+             @"is_deleted": @NO,
+             @"is_link": @NO,
+             @"bytes": @(size),
+             @"size": [NSByteCountFormatter stringFromByteCount:(long long)size countStyle:NSByteCountFormatterCountStyleFile],
+             @"icon": @"page_white",
+             @"mime_type": @"application/octet-stream",
+             @"thumb_exists": @NO,
+             @"modified": date,
+             @"client_mtime": date};
+}
+
+@end
@@ -0,0 +1,42 @@
+//
+//  BenchmarkRunner.h
+//  MEOCloudSDKSample
+//
+//  Created by Hugo Sousa on 19/10/26.
+//  Copyright (c) 2026 SAPO. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+// Runs the benchmarks of a suite and keeps their results, so that runs can be compared over time.
+//
+// Results are written to Application Support/Benchmarks/<suite>.json, which holds every run of the suite.
+// When a run finishes, each result is logged next to the one from the previous run on the same system
+// and build configuration, and the ones that got worse by more than 10% are flagged as regressions.
+// Numbers from Debug builds are kept apart from Release ones, but only Release numbers are meaningful.
+@interface BenchmarkRunner : NSObject
+
+@property (readonly, strong, nonatomic) NSString *suiteName;
+@property (readonly, strong, nonatomic) NSURL *historyURL;
+
+- (instancetype)initWithSuiteName:(NSString *)suiteName;
+
+// Runs block a few times, each time asked to perform the given number of iterations, and records
+// the median ns/op. An extra run counts the heap allocations made by the process, for allocs/op and bytes/op,
+// so the process should be otherwise idle while benchmarks run.
+- (void)measure:(NSString *)name iterations:(NSUInteger)iterations block:(void(^)(NSUInteger iterations))block;
+
+// Records the heap bytes still held once block returns, i.e. what the object it returns costs to keep around.
+// The object is released afterwards.
+- (void)measureRetainedBytes:(NSString *)name block:(id(^)())block;
+
+// Records a result measured by the benchmark itself, e.g. MB/s or latency percentiles.
+- (void)record:(NSString *)name value:(double)value unit:(NSString *)unit lowerIsBetter:(BOOL)lowerIsBetter;
+
+// Stores the run, logs it against the previous one and returns the descriptions of the regressions found.
+- (NSArray *)finish;
+
+@end
+
+// Measures how long a block takes, in seconds.
+extern NSTimeInterval BenchmarkTime(void(^block)());
@@ -0,0 +1,332 @@
+//
+//  BenchmarkRunner.m
+//  MEOCloudSDKSample
+//
+//  Created by Hugo Sousa on 19/10/26.
+//  Copyright (c) 2026 SAPO. All rights reserved.
+//
+
+#import "BenchmarkRunner.h"
+
+#import <libkern/OSAtomic.h>
+#import <mach/mach.h>
+#import <mach/mach_time.h>
+#import <malloc/malloc.h>
+#import <sys/utsname.h>
+
+#define BenchmarkNumberOfSamples        5
+#define BenchmarkRegressionThreshold    0.10
+#define BenchmarkMaximumNumberOfRuns    100
+
+#pragma mark - Allocation counting
+
+// Only the default zone is hooked. It serves malloc, calloc and every Objective-C allocation,
+// and hands larger blocks over to its helper zone by itself, so nothing is counted twice.
+static void *(*_zoneMalloc)(malloc_zone_t *zone, size_t size);
+static void *(*_zoneCalloc)(malloc_zone_t *zone, size_t count, size_t size);
+static void *(*_zoneValloc)(malloc_zone_t *zone, size_t size);
+static void *(*_zoneRealloc)(malloc_zone_t *zone, void *pointer, size_t size);
+static void *(*_zoneMemalign)(malloc_zone_t *zone, size_t alignment, size_t size);
+static void (*_zoneFree)(malloc_zone_t *zone, void *pointer);
+static void (*_zoneFreeDefiniteSize)(malloc_zone_t *zone, void *pointer, size_t size);
+
+static volatile int32_t _counting;
+static volatile int64_t _allocations;
+static volatile int64_t _allocatedBytes;
+static volatile int64_t _freedBytes;
+
+typedef struct {
+    int64_t allocations;
+    int64_t allocatedBytes;
+    int64_t freedBytes;
+} BenchmarkAllocationCounts;
+
+static inline void BenchmarkCountAllocation(malloc_zone_t *zone, void *pointer) {
+    if (_counting == 0 || pointer == NULL) return;
+    OSAtomicIncrement64(&_allocations);
+    OSAtomicAdd64((int64_t)zone->size(zone, pointer), &_allocatedBytes);
+}
+
+static inline void BenchmarkCountFree(malloc_zone_t *zone, void *pointer) {
+    if (_counting == 0 || pointer == NULL) return;
+    OSAtomicAdd64((int64_t)zone->size(zone, pointer), &_freedBytes);
+}
+
+static void *BenchmarkMalloc(malloc_zone_t *zone, size_t size) {
+    void *pointer = _zoneMalloc(zone, size);
+    BenchmarkCountAllocation(zone, pointer);
+    return pointer;
+}
+
+static void *BenchmarkCalloc(malloc_zone_t *zone, size_t count, size_t size) {
+    void *pointer = _zoneCalloc(zone, count, size);
+    BenchmarkCountAllocation(zone, pointer);
+    return pointer;
+}
+
+static void *BenchmarkValloc(malloc_zone_t *zone, size_t size) {
+    void *pointer = _zoneValloc(zone, size);
+    BenchmarkCountAllocation(zone, pointer);
+    return pointer;
+}
+
+static void *BenchmarkRealloc(malloc_zone_t *zone, void *pointer, size_t size) {
+    BenchmarkCountFree(zone, pointer);
+    void *newPointer = _zoneRealloc(zone, pointer, size);
+    BenchmarkCountAllocation(zone, newPointer);
+    return newPointer;
+}
+
+static void *BenchmarkMemalign(malloc_zone_t *zone, size_t alignment, size_t size) {
+    void *pointer = _zoneMemalign(zone, alignment, size);
+    BenchmarkCountAllocation(zone, pointer);
+    return pointer;
+}
+
+static void BenchmarkFree(malloc_zone_t *zone, void *pointer) {
+    BenchmarkCountFree(zone, pointer);
+    _zoneFree(zone, pointer);
+}
+
+static void BenchmarkFreeDefiniteSize(malloc_zone_t *zone, void *pointer, size_t size) {
+    BenchmarkCountFree(zone, pointer);
+    _zoneFreeDefiniteSize(zone, pointer, size);
+}
+
+// The hooks stay installed for the life of the process, they only count while a measurement is running.
+// Returns NO if the zone could not be hooked, e.g. because its functions cannot be made writable.
+static BOOL BenchmarkInstallAllocationCounting(void) {
+    static BOOL installed = NO;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        vm_address_t *zones = NULL;
+        unsigned int count = 0;
+        if (malloc_get_all_zones(mach_task_self(), NULL, &zones, &count) != KERN_SUCCESS || count == 0) return;
+        malloc_zone_t *zone = (malloc_zone_t *)zones[0];
+
+        vm_address_t page = trunc_page((vm_address_t)zone);
+        vm_size_t length = round_page((vm_address_t)zone + sizeof(malloc_zone_t)) - page;
+        if (vm_protect(mach_task_self(), page, length, FALSE, VM_PROT_READ | VM_PROT_WRITE) != KERN_SUCCESS) return;
+
+        _zoneMalloc = zone->malloc;
+        _zoneCalloc = zone->calloc;
+        _zoneValloc = zone->valloc;
+        _zoneRealloc = zone->realloc;
+        _zoneFree = zone->free;
+        zone->malloc = BenchmarkMalloc;
+        zone->calloc = BenchmarkCalloc;
+        zone->valloc = BenchmarkValloc;
+        zone->realloc = BenchmarkRealloc;
+        zone->free = BenchmarkFree;
+        if (zone->version >= 5 && zone->memalign) {
+            _zoneMemalign = zone->memalign;
+            zone->memalign = BenchmarkMemalign;
+        }
+        if (zone->version >= 6 && zone->free_definite_size) {
+            _zoneFreeDefiniteSize = zone->free_definite_size;
+            zone->free_definite_size = BenchmarkFreeDefiniteSize;
+        }
+
+        vm_protect(mach_task_self(), page, length, FALSE, VM_PROT_READ);
+        installed = YES;
+    });
+    return installed;
+}
+
+static BenchmarkAllocationCounts BenchmarkCountAllocations(void(^block)()) {
+    OSAtomicIncrement32Barrier(&_counting);
+    BenchmarkAllocationCounts before = { _allocations, _allocatedBytes, _freedBytes };
+    block();
+    BenchmarkAllocationCounts after = { _allocations, _allocatedBytes, _freedBytes };
+    OSAtomicDecrement32Barrier(&_counting);
+    return (BenchmarkAllocationCounts){
+        after.allocations - before.allocations,
+        after.allocatedBytes - before.allocatedBytes,
+        after.freedBytes - before.freedBytes
+    };
+}
+
+#pragma mark - Timing
+
+NSTimeInterval BenchmarkTime(void(^block)()) {
+    static mach_timebase_info_data_t timebase;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        mach_timebase_info(&timebase);
+    });
+    uint64_t start = mach_absolute_time();
+    block();
+    uint64_t elapsed = mach_absolute_time() - start;
+    return (double)elapsed * timebase.numer / timebase.denom / NSEC_PER_SEC;
+}
+
+#pragma mark - Runner
+
+@interface BenchmarkRunner ()
+@property (readwrite, strong, nonatomic) NSString *suiteName;
+@property (readwrite, strong, nonatomic) NSURL *historyURL;
+@end
+
+@implementation BenchmarkRunner {
+    NSMutableArray *_results;   // dictionaries with name, unit, value and lowerIsBetter
+}
+
+- (instancetype)initWithSuiteName:(NSString *)suiteName {
+    NSParameterAssert(suiteName);
+    self = [super init];
+    if (self) {
+        _suiteName = suiteName;
+        _results = [NSMutableArray new];
+
+        NSFileManager *fileManager = [NSFileManager defaultManager];
+        NSURL *applicationSupport = [[fileManager URLsForDirectory:NSApplicationSupportDirectory inDomains:NSUserDomainMask] firstObject];
+        NSURL *directory = [[applicationSupport URLByAppendingPathComponent:[[NSBundle mainBundle] bundleIdentifier]]
+                            URLByAppendingPathComponent:@"Benchmarks"];
+        [fileManager createDirectoryAtURL:directory withIntermediateDirectories:YES attributes:nil error:nil];
+        _historyURL = [directory URLByAppendingPathComponent:[suiteName stringByAppendingPathExtension:@"json"]];
+    }
+    return self;
+}
+
+#pragma mark - Measuring
+
+- (void)measure:(NSString *)name iterations:(NSUInteger)iterations block:(void(^)(NSUInteger iterations))block {
+    NSParameterAssert(name);
+    NSParameterAssert(iterations > 0);
+    NSParameterAssert(block);
+
+    // warm up caches and anything created lazily
+    @autoreleasepool {
+        block(iterations);
+    }
+
+    NSMutableArray *samples = [NSMutableArray new];
+    for (NSUInteger i = 0; i < BenchmarkNumberOfSamples; i++) {
+        NSTimeInterval time = BenchmarkTime(^{
+            @autoreleasepool {
+                block(iterations);
+            }
+        });
+        [samples addObject:@(time)];
+    }
+    [samples sortUsingSelector:@selector(compare:)];
+    double nanosecondsPerOperation = [samples[samples.count / 2] doubleValue] * NSEC_PER_SEC / iterations;
+    [self record:name value:nanosecondsPerOperation unit:@"ns/op" lowerIsBetter:YES];
+
+    if (BenchmarkInstallAllocationCounting()) {
+        BenchmarkAllocationCounts counts = BenchmarkCountAllocations(^{
+            @autoreleasepool {
+                block(iterations);
+            }
+        });
+        [self record:name value:(double)counts.allocations / iterations unit:@"allocs/op" lowerIsBetter:YES];
+        [self record:name value:(double)counts.allocatedBytes / iterations unit:@"B/op" lowerIsBetter:YES];
+    }
+}
+
+- (void)measureRetainedBytes:(NSString *)name block:(id(^)())block {
+    NSParameterAssert(name);
+    NSParameterAssert(block);
+    if (!BenchmarkInstallAllocationCounting()) {
+        NSLog(@"[%@] %@: allocations cannot be counted on this system", self.suiteName, name);
+        return;
+    }
+
+    __block id object = nil;
+    BenchmarkAllocationCounts counts = BenchmarkCountAllocations(^{
+        @autoreleasepool {
+            object = block();
+        }
+    });
+    object = nil;
+    [self record:name value:(double)(counts.allocatedBytes - counts.freedBytes) unit:@"B retained" lowerIsBetter:YES];
+}
+
+- (void)record:(NSString *)name value:(double)value unit:(NSString *)unit lowerIsBetter:(BOOL)lowerIsBetter {
+    NSParameterAssert(name);
+    NSParameterAssert(unit);
+    @synchronized(_results) {
+        [_results addObject:@{@"name": name, @"unit": unit, @"value": @(value), @"lowerIsBetter": @(lowerIsBetter)}];
+    }
+}
+
+#pragma mark - History
+
+static NSString *BenchmarkSystemDescription(void) {
+    struct utsname name;
+    uname(&name);
+    return [NSString stringWithFormat:@"%s, %@", name.machine, [[NSProcessInfo processInfo] operatingSystemVersionString]];
+}
+
+static NSString *BenchmarkConfiguration(void) {
+#ifdef DEBUG
+    return @"Debug";
+#else
+    return @"Release";
+#endif
+}
+
+- (NSDictionary *)_previousRunInHistory:(NSDictionary *)history {
+    for (NSDictionary *run in [history[@"runs"] reverseObjectEnumerator]) {
+        if ([run[@"system"] isEqualToString:BenchmarkSystemDescription()] &&
+            [run[@"configuration"] isEqualToString:BenchmarkConfiguration()]) return run;
+    }
+    return nil;
+}
+
+- (NSArray *)finish {
+    NSArray *results = nil;
+    @synchronized(_results) {
+        results = [_results copy];
+    }
+
+    NSDictionary *history = nil;
+    NSData *historyData = [NSData dataWithContentsOfURL:self.historyURL];
+    if (historyData) history = [NSJSONSerialization JSONObjectWithData:historyData options:0 error:nil];
+    if (![history isKindOfClass:[NSDictionary class]]) history = @{@"suite": self.suiteName, @"runs": @[]};
+    NSDictionary *previousRun = [self _previousRunInHistory:history];
+
+    NSDateFormatter *dateFormatter = [NSDateFormatter new];
+    dateFormatter.locale = [[NSLocale alloc] initWithLocaleIdentifier:@"en_US_POSIX"];
+    dateFormatter.dateFormat = @"yyyy-MM-dd'T'HH:mm:ssZ";
+
+    NSMutableDictionary *values = [NSMutableDictionary new];
+    NSMutableArray *regressions = [NSMutableArray new];
+    NSLog(@"[%@] %@ build on %@, compared with %@", self.suiteName, BenchmarkConfiguration(), BenchmarkSystemDescription(),
+          previousRun ? previousRun[@"date"] : @"nothing, first run");
+    for (NSDictionary *result in results) {
+        NSString *key = [NSString stringWithFormat:@"%@ [%@]", result[@"name"], result[@"unit"]];
+        double value = [result[@"value"] doubleValue];
+        values[key] = result[@"value"];
+
+        NSString *change = @"";
+        NSNumber *previousValue = previousRun[@"results"][key];
+        if (previousValue && previousValue.doubleValue != 0) {
+            double delta = (value - previousValue.doubleValue) / fabs(previousValue.doubleValue);
+            BOOL regressed = [result[@"lowerIsBetter"] boolValue] ? (delta > BenchmarkRegressionThreshold) : (delta < -BenchmarkRegressionThreshold);
+            change = [NSString stringWithFormat:@"%+7.1f%%%@", delta * 100, regressed ? @"  REGRESSION" : @""];
+            if (regressed) {
+                [regressions addObject:[NSString stringWithFormat:@"%@: %.2f -> %.2f", key, previousValue.doubleValue, value]];
+            }
+        }
+        NSLog(@"[%@] %-56s %14.2f %-12s %@", self.suiteName, [result[@"name"] UTF8String], value, [result[@"unit"] UTF8String], change);
+    }
+
+    NSMutableArray *runs = [history[@"runs"] mutableCopy];
+    [runs addObject:@{@"date": [dateFormatter stringFromDate:[NSDate date]],
+                      @"system": BenchmarkSystemDescription(),
+                      @"configuration": BenchmarkConfiguration(),
+                      @"results": values}];
+    if (runs.count > BenchmarkMaximumNumberOfRuns) {
+        [runs removeObjectsInRange:NSMakeRange(0, runs.count - BenchmarkMaximumNumberOfRuns)];
+    }
+    NSData *data = [NSJSONSerialization dataWithJSONObject:@{@"suite": self.suiteName, @"runs": runs} options:NSJSONWritingPrettyPrinted error:nil];
+    if (![data writeToURL:self.historyURL atomically:YES]) {
+        NSLog(@"[%@] Could not write results to %@", self.suiteName, self.historyURL.path);
+    }
+
+    NSLog(@"[%@] %lu results, %lu regressions, history in %@", self.suiteName, (unsigned long)results.count, (unsigned long)regressions.count, self.historyURL.path);
+    return regressions;
+}
+
+@end
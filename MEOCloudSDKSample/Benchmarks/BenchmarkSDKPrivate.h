@@ -0,0 +1,68 @@
+//
+//  BenchmarkSDKPrivate.h
+//  MEOCloudSDKSample
+//
+//  Created by Hugo Sousa on 19/10/26.
+//  Copyright (c) 2026 SAPO. All rights reserved.
+//
+
+#import <MEOCloudSDK/MEOCloudSDK.h>
+
+// Private SDK interfaces the benchmarks drive directly.
+// They are not part of the framework's public headers, so they are redeclared here,
+// the same way MyCLDSession overrides the session's private configuration, and must be kept in sync with the SDK.
+
+// CLDSession+Private.h
+typedef NS_ENUM(NSUInteger, CLDSessionEndpoint) {
+    CLDSessionEndpointPublicAPI,
+    CLDSessionEndpointContentAPI
+};
+
+@interface CLDSession (BenchmarkPrivate)
+- (NSURL *)_serviceURLForEndpoint:(CLDSessionEndpoint)endpoint path:(NSString *)path query:(NSDictionary *)queryParameters;
+- (NSData *)_postDataWithDictionary:(NSDictionary *)dictionary;
+- (void)setCredentials:(id)credentials;     // links the session, or unlinks it when nil
+@end
+
+// CLDItem+Private.h
+@interface CLDItem (BenchmarkPrivate)
++ (instancetype)itemWithDictionary:(NSDictionary *)dictionary session:(CLDSession *)session;
+@end
+
+// CLDItemListing.h, the class itself is private so it is looked up at run time
+@protocol BenchmarkItemListing <NSObject>
++ (NSArray *)listingWithDictionaries:(NSArray *)dictionaries session:(CLDSession *)session;
+@end
+
+#define BenchmarkItemListingClass ((Class<BenchmarkItemListing>)NSClassFromString(@"CLDItemListing"))
+
+// CLDTransferManager+Private.h
+@interface CLDTransferManager (BenchmarkPrivate)
+@property (readonly, strong, nonatomic) NSMutableArray *transfers;
+- (instancetype)initWithSession:(CLDSession *)session;
+- (BOOL)save;
+- (void)_loadTransfersIfTheyExist;
+- (NSURL *)_transfersArchiveURL;
+@end
+
+// NSDateFormatter+CLDAdditions.h
+@interface NSDateFormatter (BenchmarkPrivate)
++ (NSDateFormatter *)serviceDateFormatter;
++ (NSDate *)serviceDateFromString:(NSString *)string;
++ (NSString *)serviceStringFromDate:(NSDate *)date;
+@end
+
+// CLDAuthCredential.h, the class itself is private so it is looked up at run time
+@protocol BenchmarkAuthCredential <NSObject, NSCoding>
++ (instancetype)credentialWithAccessToken:(NSString *)accessToken
+                                tokenType:(NSString *)tokenType
+                             refreshToken:(NSString *)refreshToken
+                                    scope:(NSString *)scope
+                           expirationDate:(NSDate *)expirationDate
+                              consumerKey:(NSString *)consumerKey
+                           consumerSecret:(NSString *)consumerSecret
+                              callbackURL:(NSURL *)callbackURL
+                                  sandbox:(BOOL)sandbox;
+@end
+
+#define BenchmarkAuthCredentialClass ((Class<BenchmarkAuthCredential>)NSClassFromString(@"CLDAuthCredential"))
@@ -0,0 +1,24 @@
+//
+//  BenchmarkSuites.h
+//  MEOCloudSDKSample
+//
+//  Created by Hugo Sousa on 19/10/26.
+//  Copyright (c) 2026 SAPO. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+// Runs the suites asked for in the launch arguments, one after the other on a background queue:
+//
+//   -RunBenchmarks YES             parsing, URL building and persistence microbenchmarks, see MicroBenchmarks.h
+//   -RunEndToEndBenchmarks YES     latency and throughput against a stub server, see EndToEndBenchmarks.h
+//   -RunFaultScenarios YES         cost of recovering transfers from injected faults, see FaultScenarios.h
+//
+// Add -ExitAfterBenchmarks YES to quit once they are done, with status 1 if any result regressed or any check or scenario failed,
+// e.g. to run them from a script with the Release build of the OS X sample.
+@interface BenchmarkSuites : NSObject
+
+// Returns NO when the launch arguments did not ask for any suite.
++ (BOOL)runRequestedSuites;
+
+@end
@@ -0,0 +1,57 @@
+//
+//  BenchmarkSuites.m
+//  MEOCloudSDKSample
+//
+//  Created by Hugo Sousa on 19/10/26.
+//  Copyright (c) 2026 SAPO. All rights reserved.
+//
+
+#import "BenchmarkSuites.h"
+
+#import "BenchmarkRunner.h"
+#import "EndToEndBenchmarks.h"
+#import "FaultScenarios.h"
+#import "MicroBenchmarks.h"
+
+@implementation BenchmarkSuites
+
++ (BOOL)runRequestedSuites {
+    NSUserDefaults *defaults = [NSUserDefaults standardUserDefaults];
+    BOOL runMicroBenchmarks = [defaults boolForKey:@"RunBenchmarks"];
+    BOOL runEndToEndBenchmarks = [defaults boolForKey:@"RunEndToEndBenchmarks"];
+    BOOL runFaultScenarios = [defaults boolForKey:@"RunFaultScenarios"];
+    if (!runMicroBenchmarks && !runEndToEndBenchmarks && !runFaultScenarios) return NO;
+    BOOL exitWhenDone = [defaults boolForKey:@"ExitAfterBenchmarks"];
+
+    dispatch_queue_t queue = dispatch_queue_create("pt.meo.cloud.sdk.sample.benchmarks", DISPATCH_QUEUE_SERIAL);
+    dispatch_async(queue, ^{
+        NSMutableArray *regressions = [NSMutableArray new];
+        NSMutableArray *failures = [NSMutableArray new];
+        if (runMicroBenchmarks) {
+            BenchmarkRunner *runner = [[BenchmarkRunner alloc] initWithSuiteName:@"MicroBenchmarks"];
+            [failures addObjectsFromArray:[MicroBenchmarks runWithRunner:runner]];
+            [regressions addObjectsFromArray:[runner finish]];
+        }
+        if (runEndToEndBenchmarks) {
+            BenchmarkRunner *runner = [[BenchmarkRunner alloc] initWithSuiteName:@"EndToEndBenchmarks"];
+            [EndToEndBenchmarks runWithRunner:runner];
+            [regressions addObjectsFromArray:[runner finish]];
+        }
+        if (runFaultScenarios) {
+            BenchmarkRunner *runner = [[BenchmarkRunner alloc] initWithSuiteName:@"FaultScenarios"];
+            [failures addObjectsFromArray:[FaultScenarios runWithRunner:runner]];
+            [regressions addObjectsFromArray:[runner finish]];
+        }
+
+        for (NSString *regression in regressions) {
+            NSLog(@"Regression: %@", regression);
+        }
+        for (NSString *failure in failures) {
+            NSLog(@"Failure: %@", failure);
+        }
+        if (exitWhenDone) exit(regressions.count > 0 || failures.count > 0 ? 1 : 0);
+    });
+    return YES;
+}
+
+@end
@@ -0,0 +1,26 @@
+//
+//  EndToEndBenchmarks.h
+//  MEOCloudSDKSample
+//
+//  Created by Hugo Sousa on 19/10/26.
+//  Copyright (c) 2026 SAPO. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@class BenchmarkRunner;
+
+// The SDK against a StubServer on the loopback interface: listing, search and thumbnail latency percentiles,
+// upload and download throughput and the CPU time the SDK spends per MB transferred.
+//
+// Network conditions are read from the launch arguments, and are part of every result's name so that only runs
+// under the same conditions are compared:
+//
+//   -StubLatency 0.05          seconds added before every response
+//   -StubBandwidth 1048576     bytes per second per connection and direction
+//   -StubLossRate 0.01         chance of a response being cut short
+@interface EndToEndBenchmarks : NSObject
+
++ (void)runWithRunner:(BenchmarkRunner *)runner;
+
+@end
@@ -0,0 +1,307 @@
+//
+//  EndToEndBenchmarks.m
+//  MEOCloudSDKSample
+//
+//  Created by Hugo Sousa on 19/10/26.
+//  Copyright (c) 2026 SAPO. All rights reserved.
+//
+
+#import "EndToEndBenchmarks.h"
+
+#import "BenchmarkRunner.h"
+#import "StubCLDSession.h"
+#import "StubServer.h"
+
+#import <sys/resource.h>
+
+#define EndToEndBenchmarksSessionIdentifier @"pt.meo.cloud.sdk.sample.benchmarks.endtoend"
+#define EndToEndBenchmarksTimeout           (10 * 60)
+#define EndToEndBenchmarksTransferSize      (32 * 1024 * 1024)
+#define EndToEndBenchmarksMegabyte          (1024.0 * 1024.0)
+
+// CPU time of the whole process, the stub server's included
+static NSTimeInterval EndToEndBenchmarksProcessCPUTime(void) {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+// Calls block, which starts a request and calls done once it finishes, and waits for it. Returns NO if it timed out.
+static BOOL EndToEndBenchmarksWait(void(^block)(dispatch_block_t done)) {
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    block(^{
+        dispatch_semaphore_signal(semaphore);
+    });
+    return dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(EndToEndBenchmarksTimeout * NSEC_PER_SEC))) == 0;
+}
+
+// nearest rank
+static double EndToEndBenchmarksPercentile(NSArray *sortedSamples, double percentile) {
+    if (sortedSamples.count == 0) return 0;
+    NSUInteger rank = (NSUInteger)ceil(percentile / 100.0 * sortedSamples.count);
+    rank = MAX(MIN(rank, sortedSamples.count), (NSUInteger)1);
+    return [sortedSamples[rank - 1] doubleValue];
+}
+
+@implementation EndToEndBenchmarks
+
++ (void)runWithRunner:(BenchmarkRunner *)runner {
+    NSParameterAssert(runner);
+    NSUserDefaults *defaults = [NSUserDefaults standardUserDefaults];
+    StubServer *server = [[StubServer alloc] initWithAccessToken:[[NSUUID UUID] UUIDString]];
+    server.latency = [defaults doubleForKey:@"StubLatency"];
+    server.bandwidth = [defaults doubleForKey:@"StubBandwidth"];
+    server.lossRate = [defaults doubleForKey:@"StubLossRate"];
+    NSError *error = nil;
+    if (![server start:&error]) {
+        NSLog(@"[%@] Could not start the stub server, skipping end-to-end benchmarks: %@", runner.suiteName, error);
+        return;
+    }
+    [StubCLDSession setServer:server];
+
+    // results arrive on a queue of their own, this one waits for them
+    StubCLDSession *session = [StubCLDSession sessionWithIdentifier:EndToEndBenchmarksSessionIdentifier];
+    session.callbackQueue = dispatch_queue_create("pt.meo.cloud.sdk.sample.benchmarks.callbacks", DISPATCH_QUEUE_SERIAL);
+    [session linkWithStubServer];
+
+    NSString *conditions = [self _conditionsOfServer:server];
+    [self _runListingBenchmarksWithRunner:runner session:session conditions:conditions];
+    [self _runSearchBenchmarksWithRunner:runner session:session conditions:conditions];
+    [self _runThumbnailBenchmarksWithRunner:runner session:session conditions:conditions];
+    [self _runUploadBenchmarksWithRunner:runner session:session conditions:conditions];
+    [self _runDownloadBenchmarksWithRunner:runner session:session conditions:conditions];
+
+    [session setCredentials:nil];
+    [server stop];
+    [StubCLDSession setServer:nil];
+}
+
++ (NSString *)_conditionsOfServer:(StubServer *)server {
+    NSMutableArray *conditions = [NSMutableArray new];
+    if (server.latency > 0) [conditions addObject:[NSString stringWithFormat:@"%.0f ms", server.latency * 1000]];
+    if (server.bandwidth > 0) [conditions addObject:[NSString stringWithFormat:@"%.2f MB/s", server.bandwidth / EndToEndBenchmarksMegabyte]];
+    if (server.lossRate > 0) [conditions addObject:[NSString stringWithFormat:@"%g%% loss", server.lossRate * 100]];
+    return (conditions.count > 0) ? [conditions componentsJoinedByString:@", "] : @"loopback";
+}
+
+#pragma mark - Latency
+
+// Times rounds + 1 requests one after the other and leaves out the first, which opens the connections.
+// request starts a request and calls done once it finishes. Returns the latencies of the requests that succeeded.
++ (NSArray *)_latenciesOfRounds:(NSUInteger)rounds request:(void(^)(NSUInteger round, void(^done)(BOOL succeeded)))request {
+    NSMutableArray *latencies = [NSMutableArray arrayWithCapacity:rounds];
+    for (NSUInteger round = 0; round <= rounds; round++) {
+        __block BOOL succeeded = NO;
+        CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+        BOOL finished = EndToEndBenchmarksWait(^(dispatch_block_t done) {
+            request(round, ^(BOOL success) {
+                succeeded = success;
+                done();
+            });
+        });
+        if (!finished) break;
+        if (round > 0 && succeeded) [latencies addObject:@(CFAbsoluteTimeGetCurrent() - startTime)];
+    }
+    return latencies;
+}
+
++ (void)_recordLatencies:(NSArray *)latencies name:(NSString *)name conditions:(NSString *)conditions runner:(BenchmarkRunner *)runner {
+    if (latencies.count == 0) {
+        NSLog(@"[%@] %@ failed every time, not recording it", runner.suiteName, name);
+        return;
+    }
+    NSArray *sortedLatencies = [latencies sortedArrayUsingSelector:@selector(compare:)];
+    for (NSNumber *percentile in @[@50, @90, @99]) {
+        NSString *resultName = [NSString stringWithFormat:@"%@ p%@ (%@)", name, percentile, conditions];
+        [runner record:resultName value:EndToEndBenchmarksPercentile(sortedLatencies, percentile.doubleValue) * 1000 unit:@"ms" lowerIsBetter:YES];
+    }
+}
+
++ (void)_runListingBenchmarksWithRunner:(BenchmarkRunner *)runner session:(CLDSession *)session conditions:(NSString *)conditions {
+    StubServer *server = [StubCLDSession server];
+    NSDictionary *roundsByCount = @{@1000: @50, @25000: @10};
+    for (NSNumber *count in @[@1000, @25000]) {
+        NSString *path = [NSString stringWithFormat:@"/Listing %luk", (unsigned long)(count.unsignedIntegerValue / 1000)];
+        [server addFolderAtPath:path numberOfItems:count.unsignedIntegerValue];
+        CLDItem *folder = [CLDItem itemWithPath:path];
+        NSArray *latencies = [self _latenciesOfRounds:[roundsByCount[count] unsignedIntegerValue] request:^(NSUInteger round, void (^done)(BOOL)) {
+            [session fetchItem:folder options:CLDSessionFetchItemOptionListContents resultBlock:^(CLDItem *item) {
+                done(item.contents.count == count.unsignedIntegerValue);
+            } failureBlock:^(NSError *error) {
+                NSLog(@"[%@] Could not list %@: %@", runner.suiteName, path, error);
+                done(NO);
+            }];
+        }];
+        NSString *name = [NSString stringWithFormat:@"Listing %luk entries", (unsigned long)(count.unsignedIntegerValue / 1000)];
+        [self _recordLatencies:latencies name:name conditions:conditions runner:runner];
+    }
+}
+
++ (void)_runSearchBenchmarksWithRunner:(BenchmarkRunner *)runner session:(CLDSession *)session conditions:(NSString *)conditions {
+    // a different query every round, so that no result comes from a cache
+    NSArray *latencies = [self _latenciesOfRounds:50 request:^(NSUInteger round, void (^done)(BOOL)) {
+        NSString *query = [NSString stringWithFormat:@"IMG_%03lu", (unsigned long)round];
+        [session searchItem:[CLDItem rootFolderItem] query:query limit:1000 resultBlock:^(NSArray *items) {
+            done(items.count > 0);
+        } failureBlock:^(NSError *error) {
+            NSLog(@"[%@] Could not search for %@: %@", runner.suiteName, query, error);
+            done(NO);
+        }];
+    }];
+    [self _recordLatencies:latencies name:@"Search" conditions:conditions runner:runner];
+}
+
++ (void)_runThumbnailBenchmarksWithRunner:(BenchmarkRunner *)runner session:(CLDSession *)session conditions:(NSString *)conditions {
+    // a different item every round, so that no thumbnail comes from the cache
+    NSMutableArray *items = [NSMutableArray new];
+    EndToEndBenchmarksWait(^(dispatch_block_t done) {
+        [session fetchItem:[CLDItem itemWithPath:@"/Listing 1k"] options:CLDSessionFetchItemOptionListContents resultBlock:^(CLDItem *folder) {
+            for (CLDItem *item in folder.contents) {
+                if (item.hasThumbnail) [items addObject:item];
+            }
+            done();
+        } failureBlock:^(NSError *error) {
+            done();
+        }];
+    });
+    if (items.count < 2) {
+        NSLog(@"[%@] No items with thumbnails, skipping thumbnail benchmarks", runner.suiteName);
+        return;
+    }
+    NSUInteger rounds = MIN(items.count, (NSUInteger)101) - 1;
+    NSArray *latencies = [self _latenciesOfRounds:rounds request:^(NSUInteger round, void (^done)(BOOL)) {
+        [session fetchThumbnailForItem:items[round] format:CLDItemThumbnailFormatJPEG size:CLDItemThumbnailSizeM cropToSize:NO resultBlock:^(CLDImage *thumbnail) {
+            done(thumbnail != nil);
+        } failureBlock:^(NSError *error) {
+            NSLog(@"[%@] Could not fetch the thumbnail of %@: %@", runner.suiteName, [items[round] path], error);
+            done(NO);
+        }];
+    }];
+    [self _recordLatencies:latencies name:@"Thumbnail" conditions:conditions runner:runner];
+}
+
+#pragma mark - Throughput
+
++ (NSData *)_randomDataWithLength:(NSUInteger)length {
+    NSMutableData *data = [NSMutableData dataWithLength:length];
+    arc4random_buf(data.mutableBytes, length);
+    return data;
+}
+
+// what the SDK costs per MB is the process' CPU time minus the stub server's
++ (void)_recordTransfer:(NSString *)name length:(uint64_t)length time:(NSTimeInterval)time cpuTime:(NSTimeInterval)cpuTime conditions:(NSString *)conditions runner:(BenchmarkRunner *)runner {
+    double megabytes = length / EndToEndBenchmarksMegabyte;
+    [runner record:[NSString stringWithFormat:@"%@ throughput (%@)", name, conditions] value:megabytes / time unit:@"MB/s" lowerIsBetter:NO];
+    [runner record:[NSString stringWithFormat:@"%@ CPU (%@)", name, conditions] value:MAX(cpuTime, 0) * 1000 / megabytes unit:@"ms/MB" lowerIsBetter:YES];
+}
+
++ (void)_runUploadBenchmarksWithRunner:(BenchmarkRunner *)runner session:(CLDSession *)session conditions:(NSString *)conditions {
+    StubServer *server = [StubCLDSession server];
+    NSData *data = [self _randomDataWithLength:EndToEndBenchmarksTransferSize];
+    NSURL *fileURL = [[NSURL fileURLWithPath:NSTemporaryDirectory()] URLByAppendingPathComponent:@"pt.meo.cloud.sdk.sample.benchmarks.upload"];
+    if (![data writeToURL:fileURL atomically:YES]) {
+        NSLog(@"[%@] Could not write %@, skipping upload benchmarks", runner.suiteName, fileURL.path);
+        return;
+    }
+    NSString *path = @"/Upload.bin";
+    CLDItem *item = [CLDItem itemForUploadingWithURL:fileURL path:path revision:nil];
+
+    [server resetStatistics];
+    __block BOOL uploaded = NO;
+    NSTimeInterval cpuTime = EndToEndBenchmarksProcessCPUTime();
+    NSTimeInterval time = BenchmarkTime(^{
+        EndToEndBenchmarksWait(^(dispatch_block_t done) {
+            [session uploadItem:item shouldOverwrite:YES cellularAccess:YES priority:CLDTransferPriorityHigh resultBlock:^(CLDItem *newItem) {
+                uploaded = YES;
+                done();
+            } failureBlock:^(NSError *error) {
+                NSLog(@"[%@] Could not upload %@: %@", runner.suiteName, path, error);
+                done();
+            }];
+        });
+    });
+    cpuTime = EndToEndBenchmarksProcessCPUTime() - cpuTime - server.cpuTime;
+    [[NSFileManager defaultManager] removeItemAtURL:fileURL error:nil];
+
+    if (!uploaded || ![[server dataForFileAtPath:path] isEqualToData:data]) {
+        NSLog(@"[%@] %@ did not arrive intact, not recording the upload", runner.suiteName, path);
+        return;
+    }
+    [self _recordTransfer:@"Upload" length:data.length time:time cpuTime:cpuTime conditions:conditions runner:runner];
+}
+
++ (void)_runDownloadBenchmarksWithRunner:(BenchmarkRunner *)runner session:(CLDSession *)session conditions:(NSString *)conditions {
+    StubServer *server = [StubCLDSession server];
+    NSData *data = [self _randomDataWithLength:EndToEndBenchmarksTransferSize];
+    NSString *path = @"/Download.bin";
+    [server addFileAtPath:path data:data];
+
+    // the revision and size the downloads are checked against
+    __block CLDItem *item = nil;
+    EndToEndBenchmarksWait(^(dispatch_block_t done) {
+        [session fetchItem:[CLDItem itemWithPath:path] options:CLDSessionFetchItemOptionNone resultBlock:^(CLDItem *fetchedItem) {
+            item = fetchedItem;
+            done();
+        } failureBlock:^(NSError *error) {
+            done();
+        }];
+    });
+    if (item == nil) {
+        NSLog(@"[%@] Could not fetch %@, skipping download benchmarks", runner.suiteName, path);
+        return;
+    }
+
+    // to a file, which is compared once the transfer finishes
+    [server resetStatistics];
+    __block BOOL intact = NO;
+    NSTimeInterval cpuTime = EndToEndBenchmarksProcessCPUTime();
+    NSTimeInterval time = BenchmarkTime(^{
+        EndToEndBenchmarksWait(^(dispatch_block_t done) {
+            [session downloadItem:item cellularAccess:YES priority:CLDTransferPriorityHigh resultBlock:^(NSURL *fileURL) {
+                // the file is deleted once this block returns
+                intact = [[NSData dataWithContentsOfURL:fileURL options:NSDataReadingMappedIfSafe error:nil] isEqualToData:data];
+                done();
+            } failureBlock:^(NSError *error) {
+                NSLog(@"[%@] Could not download %@: %@", runner.suiteName, path, error);
+                done();
+            }];
+        });
+    });
+    cpuTime = EndToEndBenchmarksProcessCPUTime() - cpuTime - server.cpuTime;
+    if (intact) {
+        [self _recordTransfer:@"Download" length:data.length time:time cpuTime:cpuTime conditions:conditions runner:runner];
+    } else {
+        NSLog(@"[%@] %@ was not downloaded intact, not recording the download", runner.suiteName, path);
+    }
+
+    // streamed, each chunk compared as it arrives
+    [server resetStatistics];
+    __block BOOL streamed = NO;
+    __block NSUInteger offset = 0;
+    cpuTime = EndToEndBenchmarksProcessCPUTime();
+    time = BenchmarkTime(^{
+        EndToEndBenchmarksWait(^(dispatch_block_t done) {
+            [session streamItem:item cacheFileURL:nil dataBlock:^(NSData *chunk) {
+                if (offset + chunk.length <= data.length && memcmp((const uint8_t *)data.bytes + offset, chunk.bytes, chunk.length) == 0) {
+                    offset += chunk.length;
+                } else {
+                    offset = NSNotFound;
+                }
+            } resultBlock:^{
+                streamed = (offset == data.length);
+                done();
+            } failureBlock:^(NSError *error) {
+                NSLog(@"[%@] Could not stream %@: %@", runner.suiteName, path, error);
+                done();
+            }];
+        });
+    });
+    cpuTime = EndToEndBenchmarksProcessCPUTime() - cpuTime - server.cpuTime;
+    if (streamed) {
+        [self _recordTransfer:@"Stream" length:data.length time:time cpuTime:cpuTime conditions:conditions runner:runner];
+    } else {
+        NSLog(@"[%@] %@ was not streamed intact, not recording the stream", runner.suiteName, path);
+    }
+}
+
+@end
@@ -0,0 +1,29 @@
+//
+//  FaultScenarios.h
+//  MEOCloudSDKSample
+//
+//  Created by Hugo Sousa on 19/10/26.
+//  Copyright (c) 2026 SAPO. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@class BenchmarkRunner;
+
+// Transfers against a StubServer that injects faults, to measure what recovering from them costs.
+//
+// The scenarios are a connection dropped mid-chunk and mid-download, 400 on commit, 401 mid-upload and mid-download,
+// truncated chunk and download responses, and the process restarting mid-queue. A restart is simulated by unlinking
+// the session, which stops every transfer, putting the transfers archive back as it was on disk and linking again,
+// so that a new transfer manager picks the queue up from it.
+//
+// Each scenario runs its transfers twice, once without the fault for reference and once with it, and reports:
+// - the bytes sent again, as the server counted them and as the SDK's transfer metrics count them
+// - the time to recover, how much longer the transfers took with the fault than without it
+// - whether every transfer ended up with the right contents
+@interface FaultScenarios : NSObject
+
+// Returns the descriptions of the scenarios whose transfers did not all end correctly.
++ (NSArray *)runWithRunner:(BenchmarkRunner *)runner;
+
+@end
@@ -0,0 +1,312 @@
+//
+//  FaultScenarios.m
+//  MEOCloudSDKSample
+//
+//  Created by Hugo Sousa on 19/10/26.
+//  Copyright (c) 2026 SAPO. All rights reserved.
+//
+
+#import "FaultScenarios.h"
+
+#import "BenchmarkRunner.h"
+#import "BenchmarkSDKPrivate.h"
+#import "StubCLDSession.h"
+#import "StubServer.h"
+
+#define FaultScenariosSessionIdentifier @"pt.meo.cloud.sdk.sample.benchmarks.faults"
+#define FaultScenariosFileSize          (10 * 1024 * 1024)  // three chunks, the last one short
+#define FaultScenariosTimeout           (5 * 60)
+#define FaultScenariosPollInterval      0.05
+#define FaultScenariosFailedPolls       10                  // a 400 on commit fails the transfer and retries it right away
+
+#pragma mark - Scenarios
+
+// A fault, the request it hits and the transfers it hits it in.
+@interface FaultScenario : NSObject
+@property (readwrite, strong, nonatomic) NSString *name;
+@property (readwrite, nonatomic) CLDTransferType type;
+@property (readwrite, nonatomic) NSUInteger numberOfFiles;
+@property (readwrite, nonatomic) StubServerFault fault;
+@property (readwrite, strong, nonatomic) NSString *endpoint;
+@property (readwrite, nonatomic) NSUInteger requestIndex;   // the fault hits this request to endpoint, counting from 0
+@property (readwrite, nonatomic) BOOL restartsOnFault;      // the process restarts while the request is on its way
+@end
+
+@implementation FaultScenario
+
++ (instancetype)scenarioWithName:(NSString *)name
+                            type:(CLDTransferType)type
+                   numberOfFiles:(NSUInteger)numberOfFiles
+                           fault:(StubServerFault)fault
+                        endpoint:(NSString *)endpoint
+                    requestIndex:(NSUInteger)requestIndex {
+    FaultScenario *scenario = [self new];
+    scenario.name = name;
+    scenario.type = type;
+    scenario.numberOfFiles = numberOfFiles;
+    scenario.fault = fault;
+    scenario.endpoint = endpoint;
+    scenario.requestIndex = requestIndex;
+    return scenario;
+}
+
+@end
+
+// What one run of a scenario's transfers came to.
+@interface FaultScenarioOutcome : NSObject
+@property (readwrite, nonatomic, getter = isCorrect) BOOL correct;
+@property (readwrite, nonatomic) NSTimeInterval duration;
+@property (readwrite, nonatomic) uint64_t bytesOnTheWire;   // transfer bodies as the server counted them, cut short ones included
+@property (readwrite, nonatomic) uint64_t bytesResent;      // as the SDK counted them
+@property (readwrite, nonatomic) NSUInteger numberOfRetries;
+@property (readwrite, nonatomic) NSTimeInterval recoveryTime;  // the longest a transfer operation took to recover
+@end
+
+@implementation FaultScenarioOutcome
+@end
+
+#pragma mark - Runner
+
+@implementation FaultScenarios
+
++ (NSArray *)_scenarios {
+    FaultScenario *restart = [FaultScenario scenarioWithName:@"Restart mid-queue" type:CLDTransferTypeUpload numberOfFiles:3
+                                                       fault:StubServerFaultDropRequestBody endpoint:@"ChunkedUpload" requestIndex:4];
+    restart.restartsOnFault = YES;
+    return @[[FaultScenario scenarioWithName:@"Connection dropped mid-chunk" type:CLDTransferTypeUpload numberOfFiles:1
+                                       fault:StubServerFaultDropRequestBody endpoint:@"ChunkedUpload" requestIndex:1],
+             [FaultScenario scenarioWithName:@"Connection dropped mid-download" type:CLDTransferTypeDownload numberOfFiles:1
+                                       fault:StubServerFaultDropResponseBody endpoint:@"Files" requestIndex:0],
+             [FaultScenario scenarioWithName:@"400 on commit" type:CLDTransferTypeUpload numberOfFiles:1
+                                       fault:StubServerFaultBadRequest endpoint:@"CommitChunkedUpload" requestIndex:0],
+             [FaultScenario scenarioWithName:@"401 mid-upload" type:CLDTransferTypeUpload numberOfFiles:1
+                                       fault:StubServerFaultUnauthorized endpoint:@"ChunkedUpload" requestIndex:1],
+             [FaultScenario scenarioWithName:@"401 mid-download" type:CLDTransferTypeDownload numberOfFiles:1
+                                       fault:StubServerFaultUnauthorized endpoint:@"Files" requestIndex:0],
+             [FaultScenario scenarioWithName:@"Truncated chunk response" type:CLDTransferTypeUpload numberOfFiles:1
+                                       fault:StubServerFaultTruncatedBody endpoint:@"ChunkedUpload" requestIndex:0],
+             [FaultScenario scenarioWithName:@"Truncated download" type:CLDTransferTypeDownload numberOfFiles:1
+                                       fault:StubServerFaultTruncatedBody endpoint:@"Files" requestIndex:0],
+             restart];
+}
+
++ (NSArray *)runWithRunner:(BenchmarkRunner *)runner {
+    NSParameterAssert(runner);
+    NSMutableArray *failures = [NSMutableArray new];
+    StubServer *server = [[StubServer alloc] initWithAccessToken:[[NSUUID UUID] UUIDString]];
+    NSError *error = nil;
+    if (![server start:&error]) {
+        NSLog(@"[%@] Could not start the stub server, skipping fault scenarios: %@", runner.suiteName, error);
+        return @[[NSString stringWithFormat:@"%@: the stub server did not start", runner.suiteName]];
+    }
+    [StubCLDSession setServer:server];
+
+    for (FaultScenario *scenario in [self _scenarios]) {
+        @autoreleasepool {
+            // the same contents with and without the fault
+            NSMutableArray *contents = [NSMutableArray new];
+            NSMutableArray *fileURLs = [NSMutableArray new];
+            for (NSUInteger i = 0; i < scenario.numberOfFiles; i++) {
+                NSMutableData *data = [NSMutableData dataWithLength:FaultScenariosFileSize];
+                arc4random_buf(data.mutableBytes, data.length);
+                [contents addObject:data];
+                NSString *fileName = [NSString stringWithFormat:@"pt.meo.cloud.sdk.sample.benchmarks.faults.%lu", (unsigned long)i];
+                NSURL *fileURL = [[NSURL fileURLWithPath:NSTemporaryDirectory()] URLByAppendingPathComponent:fileName];
+                [data writeToURL:fileURL atomically:YES];
+                [fileURLs addObject:fileURL];
+            }
+
+            FaultScenarioOutcome *reference = [self _runScenario:scenario withFault:NO contents:contents fileURLs:fileURLs runner:runner];
+            FaultScenarioOutcome *outcome = [self _runScenario:scenario withFault:YES contents:contents fileURLs:fileURLs runner:runner];
+            for (NSURL *fileURL in fileURLs) {
+                [[NSFileManager defaultManager] removeItemAtURL:fileURL error:nil];
+            }
+
+            if (!reference.isCorrect) {
+                NSLog(@"[%@] %@: the transfers did not end correctly even without the fault", runner.suiteName, scenario.name);
+                [failures addObject:[NSString stringWithFormat:@"%@: failed without the fault", scenario.name]];
+                continue;
+            }
+            uint64_t bytesResent = (outcome.bytesOnTheWire > reference.bytesOnTheWire) ? outcome.bytesOnTheWire - reference.bytesOnTheWire : 0;
+            NSTimeInterval recoveryTime = MAX(outcome.duration - reference.duration, 0);
+            NSLog(@"[%@] %@: %@, %llu bytes resent (%llu by the SDK's count), %.0f ms to recover (%.0f ms by the SDK's count), %lu retries",
+                  runner.suiteName, scenario.name, outcome.isCorrect ? @"correct" : @"INCORRECT",
+                  bytesResent, outcome.bytesResent, recoveryTime * 1000, outcome.recoveryTime * 1000, (unsigned long)outcome.numberOfRetries);
+            [runner record:[NSString stringWithFormat:@"%@, bytes resent", scenario.name] value:bytesResent unit:@"B" lowerIsBetter:YES];
+            [runner record:[NSString stringWithFormat:@"%@, time to recover", scenario.name] value:recoveryTime * 1000 unit:@"ms" lowerIsBetter:YES];
+            if (!outcome.isCorrect) {
+                [failures addObject:[NSString stringWithFormat:@"%@: the transfers did not end correctly", scenario.name]];
+            }
+        }
+    }
+
+    [server stop];
+    [StubCLDSession setServer:nil];
+    return failures;
+}
+
+// Runs the transfers of scenario on a session of their own, and waits for them to end.
++ (FaultScenarioOutcome *)_runScenario:(FaultScenario *)scenario withFault:(BOOL)withFault contents:(NSArray *)contents fileURLs:(NSArray *)fileURLs runner:(BenchmarkRunner *)runner {
+    StubServer *server = [StubCLDSession server];
+    NSString *identifier = [NSString stringWithFormat:@"%@.%@", FaultScenariosSessionIdentifier, [[NSUUID UUID] UUIDString]];
+    StubCLDSession *session = [StubCLDSession sessionWithIdentifier:identifier];
+    session.callbackQueue = dispatch_queue_create("pt.meo.cloud.sdk.sample.benchmarks.faults.callbacks", DISPATCH_QUEUE_SERIAL);
+    [session linkWithStubServer];
+    NSURL *archiveURL = [session.transferManager _transfersArchiveURL];
+
+    // a run of its own, so that files left by the other run do not pass for these
+    NSMutableArray *paths = [NSMutableArray new];
+    for (NSUInteger i = 0; i < contents.count; i++) {
+        [paths addObject:[NSString stringWithFormat:@"/Faults/%@/%@ %lu.bin", withFault ? @"Fault" : @"Reference", scenario.name, (unsigned long)i]];
+    }
+    NSMutableArray *items = [NSMutableArray new];
+    if (scenario.type == CLDTransferTypeDownload) {
+        for (NSUInteger i = 0; i < contents.count; i++) {
+            [server addFileAtPath:paths[i] data:contents[i]];
+            // with its revision and size, which the downloaded file is checked against
+            CLDItem *item = [self _fetchItemAtPath:paths[i] session:session];
+            if (item == nil) {
+                NSLog(@"[%@] Could not fetch %@", runner.suiteName, paths[i]);
+                [session setCredentials:nil];
+                return [FaultScenarioOutcome new];
+            }
+            [items addObject:item];
+        }
+    }
+
+    // the fault hits a single request, and a restart happens while it is on its way
+    dispatch_semaphore_t restartSemaphore = dispatch_semaphore_create(0);
+    dispatch_semaphore_t restartedSemaphore = dispatch_semaphore_create(0);
+    __block NSUInteger numberOfRequests = 0;
+    [server resetStatistics];
+    if (withFault) {
+        server.faultBlock = ^StubServerFault(StubServerRequest *request) {
+            if (![request.endpoint isEqualToString:scenario.endpoint]) return StubServerFaultNone;
+            NSUInteger index;
+            @synchronized(scenario) {
+                index = numberOfRequests++;
+            }
+            if (index != scenario.requestIndex) return StubServerFaultNone;
+            if (scenario.restartsOnFault) {
+                dispatch_semaphore_signal(restartSemaphore);
+                dispatch_semaphore_wait(restartedSemaphore, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(FaultScenariosTimeout * NSEC_PER_SEC)));
+            }
+            return scenario.fault;
+        };
+    }
+
+    // downloaded files are deleted once their result block returns, so they are checked in it
+    NSMutableArray *intactDownloads = [NSMutableArray new];
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    for (NSUInteger i = 0; i < contents.count; i++) {
+        if (scenario.type == CLDTransferTypeUpload) {
+            CLDItem *item = [CLDItem itemForUploadingWithURL:fileURLs[i] path:paths[i] revision:nil];
+            [session uploadItem:item shouldOverwrite:YES cellularAccess:YES priority:CLDTransferPriorityNormal resultBlock:nil failureBlock:nil];
+        } else {
+            NSData *data = contents[i];
+            [session downloadItem:items[i] cellularAccess:YES priority:CLDTransferPriorityNormal resultBlock:^(NSURL *fileURL) {
+                if ([[NSData dataWithContentsOfURL:fileURL options:NSDataReadingMappedIfSafe error:nil] isEqualToData:data]) {
+                    @synchronized(intactDownloads) {
+                        [intactDownloads addObject:@(i)];
+                    }
+                }
+            } failureBlock:nil];
+        }
+    }
+    if (withFault && scenario.restartsOnFault) {
+        if (dispatch_semaphore_wait(restartSemaphore, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(FaultScenariosTimeout * NSEC_PER_SEC))) == 0) {
+            [self _restartSession:session archiveURL:archiveURL];
+        } else {
+            NSLog(@"[%@] %@: the request to restart on never arrived", runner.suiteName, scenario.name);
+        }
+        dispatch_semaphore_signal(restartedSemaphore);
+    }
+    BOOL finished = [self _waitForTransfersOfSession:session type:scenario.type count:contents.count];
+
+    FaultScenarioOutcome *outcome = [FaultScenarioOutcome new];
+    outcome.duration = CFAbsoluteTimeGetCurrent() - startTime;
+    outcome.bytesOnTheWire = (scenario.type == CLDTransferTypeUpload) ? [server bytesReceivedForEndpoint:@"ChunkedUpload"] : [server bytesSentForEndpoint:@"Files"];
+    for (CLDEndpointMetrics *metrics in session.metrics.transferMetrics.allValues) {
+        outcome.bytesResent += metrics.bytesResent;
+        outcome.numberOfRetries += metrics.numberOfRetries;
+        outcome.recoveryTime = MAX(outcome.recoveryTime, metrics.recoveryTime.maximumTime);
+    }
+    BOOL correct = finished;
+    for (NSUInteger i = 0; correct && i < contents.count; i++) {
+        if (scenario.type == CLDTransferTypeUpload) {
+            correct = [[server dataForFileAtPath:paths[i]] isEqualToData:contents[i]];
+        } else {
+            @synchronized(intactDownloads) {
+                correct = [intactDownloads containsObject:@(i)];
+            }
+        }
+    }
+    outcome.correct = correct;
+
+    server.faultBlock = nil;
+    [session setCredentials:nil];
+    [[NSFileManager defaultManager] removeItemAtURL:archiveURL error:nil];
+    return outcome;
+}
+
++ (CLDItem *)_fetchItemAtPath:(NSString *)path session:(CLDSession *)session {
+    __block CLDItem *item = nil;
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    [session fetchItem:[CLDItem itemWithPath:path] options:CLDSessionFetchItemOptionNone resultBlock:^(CLDItem *fetchedItem) {
+        item = fetchedItem;
+        dispatch_semaphore_signal(semaphore);
+    } failureBlock:^(NSError *error) {
+        dispatch_semaphore_signal(semaphore);
+    }];
+    dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(FaultScenariosTimeout * NSEC_PER_SEC)));
+    return item;
+}
+
+// What relaunching the app comes to for the transfer queue: whatever was in flight stops,
+// and a new transfer manager loads the transfers as they were last saved.
+// Unlinking cancels the transfers and saves them as failed, so the archive is put back afterwards.
++ (void)_restartSession:(StubCLDSession *)session archiveURL:(NSURL *)archiveURL {
+    NSData *archive = [NSData dataWithContentsOfURL:archiveURL];
+    [session setCredentials:nil];
+    if (archive) [archive writeToURL:archiveURL atomically:YES];
+    [session linkWithStubServer];
+}
+
+// Waits until every transfer of the session finished, or failed for good. Returns YES if they all finished.
+// A transfer that failed because the token was rejected is retried once, after linking again, the way an app would
+// after signing the user back in.
++ (BOOL)_waitForTransfersOfSession:(StubCLDSession *)session type:(CLDTransferType)type count:(NSUInteger)count {
+    NSHashTable *retriedTransfers = [NSHashTable weakObjectsHashTable];
+    NSUInteger failedPolls = 0;
+    CFAbsoluteTime deadline = CFAbsoluteTimeGetCurrent() + FaultScenariosTimeout;
+    while (CFAbsoluteTimeGetCurrent() < deadline) {
+        NSArray *transfers = [session.transferManager transfersOfType:type];
+        NSUInteger numberOfFinishedTransfers = 0;
+        NSUInteger numberOfFailedTransfers = 0;
+        for (CLDTransfer *transfer in transfers) {
+            if (transfer.state == CLDTransferStateFinished) {
+                numberOfFinishedTransfers++;
+            } else if (transfer.state == CLDTransferStateFailed) {
+                if (transfer.error.code == CLDErrorCodeUnauthorized && ![retriedTransfers containsObject:transfer]) {
+                    [retriedTransfers addObject:transfer];
+                    [session linkWithStubServer];
+                    [transfer retry];
+                } else {
+                    numberOfFailedTransfers++;
+                }
+            }
+        }
+        if (numberOfFinishedTransfers == count) return YES;
+
+        // a failed transfer may be retried right away, e.g. after a 400 on commit, so it has to stay failed for a while
+        if (numberOfFailedTransfers > 0 && numberOfFinishedTransfers + numberOfFailedTransfers == transfers.count) {
+            if (++failedPolls >= FaultScenariosFailedPolls) return NO;
+        } else {
+            failedPolls = 0;
+        }
+        [NSThread sleepForTimeInterval:FaultScenariosPollInterval];
+    }
+    return NO;
+}
+
+@end
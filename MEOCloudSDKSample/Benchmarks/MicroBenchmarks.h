@@ -0,0 +1,21 @@
+//
+//  MicroBenchmarks.h
+//  MEOCloudSDKSample
+//
+//  Created by Hugo Sousa on 19/10/26.
+//  Copyright (c) 2026 SAPO. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@class BenchmarkRunner;
+
+// CPU-bound hot paths of the SDK: parsing, URL building and persistence,
+// and checks that the faster paths behave like the ones they replace.
+// Nothing here touches the network, the session they run on is never linked.
+@interface MicroBenchmarks : NSObject
+
+// Returns the descriptions of the correctness checks that failed along the way.
++ (NSArray *)runWithRunner:(BenchmarkRunner *)runner;
+
+@end
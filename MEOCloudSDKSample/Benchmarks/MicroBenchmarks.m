@@ -0,0 +1,306 @@
+//
+//  MicroBenchmarks.m
+//  MEOCloudSDKSample
+//
+//  Created by Hugo Sousa on 19/10/26.
+//  Copyright (c) 2026 SAPO. All rights reserved.
+//
+
+#import "MicroBenchmarks.h"
+
+#import "BenchmarkFixtures.h"
+#import "BenchmarkRunner.h"
+#import "BenchmarkSDKPrivate.h"
+
+#define MicroBenchmarksSessionIdentifier @"pt.meo.cloud.sdk.sample.benchmarks"
+
+@implementation MicroBenchmarks
+
++ (NSArray *)runWithRunner:(BenchmarkRunner *)runner {
+    NSParameterAssert(runner);
+    NSMutableArray *failures = [NSMutableArray new];
+    CLDSession *session = [CLDSession sessionWithIdentifier:MicroBenchmarksSessionIdentifier];
+    [self _runItemBenchmarksWithRunner:runner session:session];
+    [self _runListingBenchmarksWithRunner:runner session:session];
+    [self _checkListingItemsWithSession:session failures:failures];
+    [self _runURLBenchmarksWithRunner:runner session:session];
+    [self _runDateBenchmarksWithRunner:runner];
+    [self _checkServiceDatesWithFailures:failures];
+    [self _runTransferPersistenceBenchmarksWithRunner:runner session:session];
+    [self _runCredentialBenchmarksWithRunner:runner];
+    return failures;
+}
+
+#pragma mark - Items
+
++ (void)_runItemBenchmarksWithRunner:(BenchmarkRunner *)runner session:(CLDSession *)session {
+    for (NSNumber *count in @[@1000, @25000]) {
+        NSArray *dictionaries = [BenchmarkFixtures itemDictionariesWithCount:count.unsignedIntegerValue inFolder:@"/Photos"];
+        NSString *name = [NSString stringWithFormat:@"CLDItem itemWithDictionary:session: (%luk)", (unsigned long)(count.unsignedIntegerValue / 1000)];
+        [runner measure:name iterations:dictionaries.count block:^(NSUInteger iterations) {
+            for (NSUInteger i = 0; i < iterations; i++) {
+                (void)[CLDItem itemWithDictionary:dictionaries[i % dictionaries.count] session:session];
+            }
+        }];
+    }
+}
+
+// A 25k entry folder parsed the way listings used to be, one CLDItem per entry,
+// against the compact listing that creates items only when they are accessed
++ (void)_runListingBenchmarksWithRunner:(BenchmarkRunner *)runner session:(CLDSession *)session {
+    Class<BenchmarkItemListing> listingClass = BenchmarkItemListingClass;
+    if (listingClass == Nil) {
+        NSLog(@"[%@] CLDItemListing not found, skipping listing benchmarks", runner.suiteName);
+        return;
+    }
+    NSArray *dictionaries = [BenchmarkFixtures itemDictionariesWithCount:25000 inFolder:@"/Photos/2014"];
+    NSArray *(^itemsBlock)() = ^NSArray *{
+        NSMutableArray *items = [NSMutableArray arrayWithCapacity:dictionaries.count];
+        for (NSDictionary *dictionary in dictionaries) {
+            [items addObject:[CLDItem itemWithDictionary:dictionary session:session]];
+        }
+        return items;
+    };
+    NSArray *(^listingBlock)() = ^NSArray *{
+        return [listingClass listingWithDictionaries:dictionaries session:session];
+    };
+
+    [runner measure:@"25k listing parse, CLDItem per entry" iterations:1 block:^(NSUInteger iterations) {
+        for (NSUInteger i = 0; i < iterations; i++) {
+            (void)itemsBlock();
+        }
+    }];
+    [runner measure:@"25k listing parse, CLDItemListing" iterations:1 block:^(NSUInteger iterations) {
+        for (NSUInteger i = 0; i < iterations; i++) {
+            (void)listingBlock();
+        }
+    }];
+    [runner measureRetainedBytes:@"25k listing memory, CLDItem per entry" block:itemsBlock];
+    [runner measureRetainedBytes:@"25k listing memory, CLDItemListing" block:listingBlock];
+
+    // what a table view pays for the listing being lazy, once per visible row
+    NSArray *items = itemsBlock();
+    NSArray *listing = listingBlock();
+    [runner measure:@"25k listing item name, CLDItem per entry" iterations:items.count block:^(NSUInteger iterations) {
+        for (NSUInteger i = 0; i < iterations; i++) {
+            (void)[items[i % items.count] name];
+        }
+    }];
+    [runner measure:@"25k listing item name, CLDItemListing" iterations:listing.count block:^(NSUInteger iterations) {
+        for (NSUInteger i = 0; i < iterations; i++) {
+            (void)[listing[i % listing.count] name];
+        }
+    }];
+}
+
+// Code written against plain arrays compares items by identity, the listing has to hand out the same instance every time
++ (void)_checkListingItemsWithSession:(CLDSession *)session failures:(NSMutableArray *)failures {
+    Class<BenchmarkItemListing> listingClass = BenchmarkItemListingClass;
+    if (listingClass == Nil) return;
+    NSArray *listing = [listingClass listingWithDictionaries:[BenchmarkFixtures itemDictionariesWithCount:100 inFolder:@"/Photos"] session:session];
+
+    CLDItem *heldItem = listing[7];
+    __weak CLDItem *droppedItem = nil;
+    @autoreleasepool {
+        droppedItem = listing[8];
+        for (CLDItem *item in listing) {
+            (void)item.name;
+        }
+    }
+    if (listing[7] != heldItem || [listing indexOfObject:heldItem] != 7 || ![listing containsObject:heldItem]) {
+        [failures addObject:@"CLDItemListing: an item the caller holds is not found again"];
+    }
+    if (droppedItem == nil || listing[8] != droppedItem) {
+        [failures addObject:@"CLDItemListing: an item the caller dropped is created again"];
+    }
+    if (![listing[9] isEqual:listing[9]] || [listing indexOfObject:listing[9]] != 9) {
+        [failures addObject:@"CLDItemListing: an item is not equal to itself across accesses"];
+    }
+    NSArray *copy = [listing copy];
+    if (copy != listing || ![[NSArray arrayWithArray:listing] isEqualToArray:listing]) {
+        [failures addObject:@"CLDItemListing: a copy does not hold the same items"];
+    }
+}
+
+#pragma mark - Requests
+
++ (void)_runURLBenchmarksWithRunner:(BenchmarkRunner *)runner session:(CLDSession *)session {
+    [runner measure:@"CLDSession _serviceURLForEndpoint: (no query)" iterations:10000 block:^(NSUInteger iterations) {
+        for (NSUInteger i = 0; i < iterations; i++) {
+            (void)[session _serviceURLForEndpoint:CLDSessionEndpointPublicAPI path:@"Account/Info" query:nil];
+        }
+    }];
+
+    // what a folder listing asks for, booleans, numbers and a string that needs escaping
+    NSDictionary *query = @{@"list": @YES,
+                            @"file_limit": @10000,
+                            @"include_deleted": @NO,
+                            @"hash": @"0123456789abcdef",
+                            @"locale": @"pt_PT"};
+    [runner measure:@"CLDSession _serviceURLForEndpoint: (<mode>, 5 parameters)" iterations:10000 block:^(NSUInteger iterations) {
+        for (NSUInteger i = 0; i < iterations; i++) {
+            (void)[session _serviceURLForEndpoint:CLDSessionEndpointPublicAPI path:@"Metadata/<mode>/Photos/2014/IMG_0001.JPG" query:query];
+        }
+    }];
+
+    NSDictionary *parameters = @{@"root": @"meocloud",
+                                 @"from_path": @"/Photos/2014/IMG 0001.JPG",
+                                 @"to_path": @"/Backup/Photos/2014/IMG 0001.JPG",
+                                 @"overwrite": @NO};
+    [runner measure:@"CLDSession _postDataWithDictionary: (4 parameters)" iterations:10000 block:^(NSUInteger iterations) {
+        for (NSUInteger i = 0; i < iterations; i++) {
+            (void)[session _postDataWithDictionary:parameters];
+        }
+    }];
+}
+
+#pragma mark - Dates
+
++ (void)_runDateBenchmarksWithRunner:(BenchmarkRunner *)runner {
+    NSArray *dictionaries = [BenchmarkFixtures itemDictionariesWithCount:1000 inFolder:@"/Photos"];
+    NSArray *dateStrings = [dictionaries valueForKey:@"modified"];
+    NSDateFormatter *formatter = [NSDateFormatter serviceDateFormatter];
+    [runner measure:@"NSDateFormatter serviceDateFormatter dateFromString:" iterations:dateStrings.count block:^(NSUInteger iterations) {
+        for (NSUInteger i = 0; i < iterations; i++) {
+            (void)[formatter dateFromString:dateStrings[i % dateStrings.count]];
+        }
+    }];
+    [runner measure:@"NSDateFormatter serviceDateFromString:" iterations:dateStrings.count block:^(NSUInteger iterations) {
+        for (NSUInteger i = 0; i < iterations; i++) {
+            (void)[NSDateFormatter serviceDateFromString:dateStrings[i % dateStrings.count]];
+        }
+    }];
+
+    // listings are parsed on many queues at once, the formatter cannot be shared that way
+    NSUInteger numberOfThreads = MAX([NSProcessInfo processInfo].activeProcessorCount, 2);
+    NSString *name = [NSString stringWithFormat:@"NSDateFormatter serviceDateFromString: (%lu threads)", (unsigned long)numberOfThreads];
+    [runner measure:name iterations:dateStrings.count * numberOfThreads block:^(NSUInteger iterations) {
+        dispatch_apply(numberOfThreads, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t thread) {
+            @autoreleasepool {
+                for (NSUInteger i = thread; i < iterations; i += numberOfThreads) {
+                    (void)[NSDateFormatter serviceDateFromString:dateStrings[i % dateStrings.count]];
+                }
+            }
+        });
+    }];
+
+    NSMutableArray *dates = [NSMutableArray arrayWithCapacity:dateStrings.count];
+    for (NSString *dateString in dateStrings) {
+        [dates addObject:[NSDateFormatter serviceDateFromString:dateString]];
+    }
+    [runner measure:@"NSDateFormatter serviceDateFormatter stringFromDate:" iterations:dates.count block:^(NSUInteger iterations) {
+        for (NSUInteger i = 0; i < iterations; i++) {
+            (void)[formatter stringFromDate:dates[i % dates.count]];
+        }
+    }];
+    [runner measure:@"NSDateFormatter serviceStringFromDate:" iterations:dates.count block:^(NSUInteger iterations) {
+        for (NSUInteger i = 0; i < iterations; i++) {
+            (void)[NSDateFormatter serviceStringFromDate:dates[i % dates.count]];
+        }
+    }];
+}
+
+// The fixed-format parser and formatter have to agree with serviceDateFormatter, which writes dates in the local time zone
++ (void)_checkServiceDatesWithFailures:(NSMutableArray *)failures {
+    NSDateFormatter *formatter = [NSDateFormatter serviceDateFormatter];
+    NSDateFormatter *utcFormatter = [NSDateFormatter new];
+    utcFormatter.locale = formatter.locale;
+    utcFormatter.dateFormat = formatter.dateFormat;
+    utcFormatter.timeZone = [NSTimeZone timeZoneForSecondsFromGMT:0];
+
+    NSMutableArray *dates = [NSMutableArray new];
+    for (NSDictionary *dictionary in [BenchmarkFixtures itemDictionariesWithCount:100 inFolder:@"/Photos"]) {
+        NSDate *date = [formatter dateFromString:dictionary[@"modified"]];
+        if (date) [dates addObject:date];
+    }
+    // a leap day, the last second of a century and a date before 1970
+    for (NSNumber *interval in @[@951782400, @946684799, @(-86401)]) {
+        [dates addObject:[NSDate dateWithTimeIntervalSince1970:interval.doubleValue]];
+    }
+
+    for (NSDate *date in dates) {
+        NSString *string = [NSDateFormatter serviceStringFromDate:date];
+        if (![string isEqualToString:[utcFormatter stringFromDate:date]] ||
+            ![[formatter dateFromString:string] isEqualToDate:date] ||
+            ![[NSDateFormatter serviceDateFromString:string] isEqualToDate:date] ||
+            ![[NSDateFormatter serviceDateFromString:[formatter stringFromDate:date]] isEqualToDate:date]) {
+            [failures addObject:[NSString stringWithFormat:@"NSDateFormatter: %@ does not round-trip, formatted as %@", date, string]];
+        }
+    }
+}
+
+#pragma mark - Persistence
+
+// Transfers that are neither running nor finished, so that loading them back does not start them,
+// and setting their state does not reach the manager
++ (void)_fillTransferManager:(CLDTransferManager *)manager numberOfTransfers:(NSUInteger)numberOfTransfers session:(CLDSession *)session {
+    [manager.transfers removeAllObjects];
+    for (NSUInteger i = 0; i < numberOfTransfers; i++) {
+        NSString *path = [NSString stringWithFormat:@"/Uploads/IMG_%05lu.JPG", (unsigned long)i];
+        CLDItem *item = [CLDItem itemWithDictionary:[BenchmarkFixtures fileDictionaryWithPath:path size:(i + 1) * 65536] session:session];
+        CLDTransfer *transfer = [CLDTransfer new];
+        [transfer setValue:session.sessionIdentifier forKey:@"sessionIdentifier"];
+        [transfer setValue:@(i % 2 ? CLDTransferTypeUpload : CLDTransferTypeDownload) forKey:@"type"];
+        [transfer setValue:item forKey:@"item"];
+        [transfer setValue:@(i % 3 ? CLDTransferStateSuspended : CLDTransferStateFailed) forKey:@"state"];
+        [manager.transfers addObject:transfer];
+    }
+}
+
++ (void)_runTransferPersistenceBenchmarksWithRunner:(BenchmarkRunner *)runner session:(CLDSession *)session {
+    CLDTransferManager *manager = [[CLDTransferManager alloc] initWithSession:session];
+    for (NSNumber *count in @[@10, @100, @1000]) {
+        NSUInteger numberOfTransfers = count.unsignedIntegerValue;
+        NSUInteger rounds = MAX(1000 / numberOfTransfers, 1);
+        [self _fillTransferManager:manager numberOfTransfers:numberOfTransfers session:session];
+
+        NSString *name = [NSString stringWithFormat:@"CLDTransferManager save (%lu transfers)", (unsigned long)numberOfTransfers];
+        [runner measure:name iterations:rounds block:^(NSUInteger iterations) {
+            for (NSUInteger i = 0; i < iterations; i++) {
+                [manager save];
+            }
+        }];
+
+        name = [NSString stringWithFormat:@"CLDTransferManager _loadTransfersIfTheyExist (%lu transfers)", (unsigned long)numberOfTransfers];
+        [runner measure:name iterations:rounds block:^(NSUInteger iterations) {
+            for (NSUInteger i = 0; i < iterations; i++) {
+                [manager _loadTransfersIfTheyExist];
+            }
+        }];
+    }
+
+    // leave an empty queue behind
+    [manager.transfers removeAllObjects];
+    [manager save];
+}
+
++ (void)_runCredentialBenchmarksWithRunner:(BenchmarkRunner *)runner {
+    Class<BenchmarkAuthCredential> credentialClass = BenchmarkAuthCredentialClass;
+    if (credentialClass == Nil) {
+        NSLog(@"[%@] CLDAuthCredential not found, skipping credential benchmarks", runner.suiteName);
+        return;
+    }
+    id credential = [credentialClass credentialWithAccessToken:@"0b8f5b4c-6a49-4d6e-9d8e-1c1f0c3b2a77"
+                                                     tokenType:@"Bearer"
+                                                  refreshToken:@"5d0c1f1e-8a27-4f0b-a3b2-9e6d4c7f8a10"
+                                                         scope:@""
+                                                expirationDate:[NSDate dateWithTimeIntervalSinceNow:3600]
+                                                   consumerKey:@"e6a0f5e4-2f0d-4f4b-8e3a-3f0a1b2c3d4e"
+                                                consumerSecret:@"157933512954387474785287497593452838475"
+                                                   callbackURL:[NSURL URLWithString:@"meocloudsample://oauth"]
+                                                       sandbox:NO];
+    [runner measure:@"CLDAuthCredential archive" iterations:1000 block:^(NSUInteger iterations) {
+        for (NSUInteger i = 0; i < iterations; i++) {
+            (void)[NSKeyedArchiver archivedDataWithRootObject:credential];
+        }
+    }];
+
+    NSData *data = [NSKeyedArchiver archivedDataWithRootObject:credential];
+    [runner measure:@"CLDAuthCredential unarchive" iterations:1000 block:^(NSUInteger iterations) {
+        for (NSUInteger i = 0; i < iterations; i++) {
+            (void)[NSKeyedUnarchiver unarchiveObjectWithData:data];
+        }
+    }];
+}
+
+@end
@@ -0,0 +1,23 @@
+//
+//  StubCLDSession.h
+//  MEOCloudSDKSample
+//
+//  Created by Hugo Sousa on 19/10/26.
+//  Copyright (c) 2026 SAPO. All rights reserved.
+//
+
+#import <MEOCloudSDK/MEOCloudSDK.h>
+
+@class StubServer;
+
+// A session whose API and authorization hosts are a StubServer on the loopback interface.
+// Create it with +sessionWithIdentifier: after setting the server, with an identifier no other session uses.
+@interface StubCLDSession : CLDSession
+
++ (StubServer *)server;
++ (void)setServer:(StubServer *)server;
+
+// Links the session with the server's access token, without going through the login page or the keychain.
+- (void)linkWithStubServer;
+
+@end
@@ -0,0 +1,77 @@
+//
+//  StubCLDSession.m
+//  MEOCloudSDKSample
+//
+//  Created by Hugo Sousa on 19/10/26.
+//  Copyright (c) 2026 SAPO. All rights reserved.
+//
+
+#import "StubCLDSession.h"
+
+#import "BenchmarkSDKPrivate.h"
+#import "StubServer.h"
+
+static StubServer *_server = nil;
+
+@implementation StubCLDSession
+
++ (StubServer *)server {
+    @synchronized(self) {
+        return _server;
+    }
+}
+
++ (void)setServer:(StubServer *)server {
+    @synchronized(self) {
+        _server = server;
+    }
+}
+
+- (void)linkWithStubServer {
+    StubServer *server = [[self class] server];
+    NSParameterAssert(server);
+    id<BenchmarkAuthCredential> credential = [BenchmarkAuthCredentialClass credentialWithAccessToken:server.accessToken
+                                                                                           tokenType:@"Bearer"
+                                                                                        refreshToken:@"stub-refresh-token"
+                                                                                               scope:@""
+                                                                                      expirationDate:[NSDate distantFuture]
+                                                                                         consumerKey:@"stub-consumer-key"
+                                                                                      consumerSecret:@"stub-consumer-secret"
+                                                                                         callbackURL:[NSURL URLWithString:@"http://127.0.0.1/callback"]
+                                                                                             sandbox:NO];
+    [self setCredentials:credential];
+}
+
+- (NSString *)_authScheme {
+    return @"http";
+}
+
+- (NSString *)_authHost {
+    return @"127.0.0.1";
+}
+
+- (NSNumber *)_authPort {
+    return @([[self class] server].apiPort);
+}
+
+- (NSString *)_apiScheme {
+    return @"http";
+}
+
+- (NSString *)_apiHost {
+    return @"127.0.0.1";
+}
+
+- (NSString *)_apiContentHost {
+    return @"127.0.0.1";
+}
+
+- (NSNumber *)_apiPort {
+    return @([[self class] server].apiPort);
+}
+
+- (NSNumber *)_apiContentPort {
+    return @([[self class] server].contentPort);
+}
+
+@end
@@ -0,0 +1,72 @@
+//
+//  StubServer.h
+//  MEOCloudSDKSample
+//
+//  Created by Hugo Sousa on 19/10/26.
+//  Copyright (c) 2026 SAPO. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+// A request as the stub server received it.
+@interface StubServerRequest : NSObject
+@property (readonly, strong, nonatomic) NSString *method;
+@property (readonly, strong, nonatomic) NSString *endpoint;     // e.g. "Metadata", "ChunkedUpload" or "Account/Info"
+@property (readonly, strong, nonatomic) NSString *path;         // of the item, without endpoint and access mode, e.g. "/Photos/IMG_0001.JPG"
+@property (readonly, strong, nonatomic) NSDictionary *query;
+@property (readonly, strong, nonatomic) NSDictionary *headers;  // by lowercase name
+@property (readonly, nonatomic) uint64_t contentLength;
+@end
+
+// Faults the server can inject into a request, see faultBlock.
+typedef NS_ENUM(NSInteger, StubServerFault) {
+    StubServerFaultNone,
+    StubServerFaultDropRequestBody,     // the connection is closed halfway through the request body, e.g. mid-chunk
+    StubServerFaultDropResponseBody,    // the connection is closed halfway through the response body
+    StubServerFaultBadRequest,          // 400 instead of the response, the request has no effect
+    StubServerFaultUnauthorized,        // 401 instead of the response, the request has no effect
+    StubServerFaultTruncatedBody        // half of the response body, with a Content-Length to match
+};
+
+// A minimal MEO Cloud API on the loopback interface, so that the SDK can be measured offline.
+//
+// It serves Account/Info, Metadata, Search, Thumbnails, Files (with Range and If-Range), ChunkedUpload,
+// CommitChunkedUpload, DisableAccessToken and the OAuth token endpoint, from contents kept in memory.
+// The public API and the content API listen on different ports, the way they are different hosts in production.
+// Every connection is served on its own thread with blocking I/O, and network conditions are simulated per connection.
+// Faults can be injected into single requests, to measure how transfers recover from them.
+@interface StubServer : NSObject
+
+@property (readonly, strong, nonatomic) NSString *accessToken;  // requests must be signed with it, as a Bearer token
+@property (readonly, nonatomic) uint16_t apiPort;
+@property (readonly, nonatomic) uint16_t contentPort;
+
+// network conditions, they can be changed while the server runs
+@property (readwrite, atomic) NSTimeInterval latency;   // added before every response
+@property (readwrite, atomic) double bandwidth;         // bytes per second per connection and direction, 0 for unlimited
+@property (readwrite, atomic) double lossRate;          // chance of a connection dropping halfway through a response body
+
+// decides the fault of every request once its head arrives, on the thread of its connection, nil for none
+@property (readwrite, copy, atomic) StubServerFault (^faultBlock)(StubServerRequest *request);
+
+- (instancetype)initWithAccessToken:(NSString *)accessToken;
+
+// listens on ephemeral ports of the loopback interface
+- (BOOL)start:(NSError **)error;
+- (void)stop;
+
+// contents
+- (void)addFolderAtPath:(NSString *)path numberOfItems:(NSUInteger)numberOfItems;
+- (void)addFileAtPath:(NSString *)path data:(NSData *)data;
+- (NSData *)dataForFileAtPath:(NSString *)path;         // nil if there is no such file
+- (NSDictionary *)metadataForItemAtPath:(NSString *)path;
+
+// statistics, since the server started or they were last reset
+@property (readonly, atomic) NSUInteger numberOfRequests;
+@property (readonly, atomic) NSUInteger numberOfDroppedConnections;
+@property (readonly, atomic) NSTimeInterval cpuTime;    // spent serving requests, to tell it apart from the SDK's
+- (uint64_t)bytesReceivedForEndpoint:(NSString *)endpoint;  // request bodies, including ones that did not arrive whole
+- (uint64_t)bytesSentForEndpoint:(NSString *)endpoint;      // response bodies, including ones that were cut short
+- (void)resetStatistics;
+
+@end
@@ -0,0 +1,841 @@
+//
+//  StubServer.m
+//  MEOCloudSDKSample
+//
+//  Created by Hugo Sousa on 19/10/26.
+//  Copyright (c) 2026 SAPO. All rights reserved.
+//
+
+#import "StubServer.h"
+
+#import "BenchmarkFixtures.h"
+
+#import <mach/mach.h>
+#import <netinet/in.h>
+#import <netinet/tcp.h>
+#import <sys/socket.h>
+
+#define StubServerBufferSize            (16 * 1024)
+#define StubServerMaximumHeadLength     (64 * 1024)
+#define StubServerUploadLifetime        (24 * 60 * 60)
+#define StubServerDefaultSearchLimit    1000
+
+// a 1x1 PNG, the SDK only needs thumbnails to decode
+static NSString * const StubServerThumbnail = @"iVBORw0KGgoAAAANSUhEUgAAAAEAAAABCAQAAAC1HAwCAAAAC0lEQVR42mNkYAAAAAYAAjCB0C8AAAAASUVORK5CYII=";
+
+// time the calling thread spent on a CPU, blocking reads and writes cost nothing
+static NSTimeInterval StubServerThreadCPUTime(void) {
+    mach_port_t thread = mach_thread_self();
+    thread_basic_info_data_t info;
+    mach_msg_type_number_t count = THREAD_BASIC_INFO_COUNT;
+    kern_return_t result = thread_info(thread, THREAD_BASIC_INFO, (thread_info_t)&info, &count);
+    mach_port_deallocate(mach_task_self(), thread);
+    if (result != KERN_SUCCESS) return 0;
+    return info.user_time.seconds + info.user_time.microseconds / 1e6 + info.system_time.seconds + info.system_time.microseconds / 1e6;
+}
+
+#pragma mark - Requests and responses
+
+@interface StubServerRequest ()
+@property (readwrite, strong, nonatomic) NSString *method;
+@property (readwrite, strong, nonatomic) NSString *endpoint;
+@property (readwrite, strong, nonatomic) NSString *path;
+@property (readwrite, strong, nonatomic) NSDictionary *query;
+@property (readwrite, strong, nonatomic) NSDictionary *headers;
+@property (readwrite, nonatomic) uint64_t contentLength;
+@property (readwrite, nonatomic, getter = isAPIRequest) BOOL APIRequest;
+@property (readwrite, strong, nonatomic) NSData *body;
+@end
+
+@implementation StubServerRequest
+@end
+
+@interface StubServerResponse : NSObject
+@property (readwrite, nonatomic) NSInteger statusCode;
+@property (readwrite, strong, nonatomic) NSMutableDictionary *headers;
+@property (readwrite, strong, nonatomic) NSData *body;
+@property (readwrite, nonatomic) NSUInteger bytesBeforeDrop;    // NSNotFound to send the whole body
+@end
+
+@implementation StubServerResponse
+
++ (instancetype)responseWithStatusCode:(NSInteger)statusCode data:(NSData *)data contentType:(NSString *)contentType {
+    StubServerResponse *response = [self new];
+    response.statusCode = statusCode;
+    response.headers = [NSMutableDictionary new];
+    if (contentType) response.headers[@"Content-Type"] = contentType;
+    response.body = data ?: [NSData data];
+    response.bytesBeforeDrop = NSNotFound;
+    return response;
+}
+
++ (instancetype)responseWithStatusCode:(NSInteger)statusCode JSONObject:(id)object {
+    NSData *data = [NSJSONSerialization dataWithJSONObject:object ?: @{} options:0 error:nil];
+    return [self responseWithStatusCode:statusCode data:data contentType:@"application/json"];
+}
+
++ (instancetype)errorResponseWithStatusCode:(NSInteger)statusCode {
+    return [self responseWithStatusCode:statusCode JSONObject:@{@"error": [NSHTTPURLResponse localizedStringForStatusCode:statusCode]}];
+}
+
+@end
+
+#pragma mark - Server
+
+@interface StubServer ()
+@property (readwrite, strong, nonatomic) NSString *accessToken;
+@property (readwrite, nonatomic) uint16_t apiPort;
+@property (readwrite, nonatomic) uint16_t contentPort;
+@end
+
+@implementation StubServer {
+    dispatch_queue_t _acceptQueue;
+    dispatch_source_t _apiSource;
+    dispatch_source_t _contentSource;
+    NSMutableSet *_connections;         // sockets of open connections
+    volatile BOOL _stopped;
+
+    // contents, guarded by self
+    NSMutableDictionary *_metadata;     // lowercase path -> metadata of files and folders
+    NSMutableDictionary *_children;     // lowercase folder path -> lowercase child path -> metadata
+    NSMutableDictionary *_listings;     // lowercase folder path -> serialized contents, dropped when they change
+    NSMutableDictionary *_fileData;     // lowercase path -> contents, files without them get generated contents
+    NSMutableDictionary *_uploads;      // upload id -> data received so far
+    uint64_t _lastRevision;
+
+    // statistics, guarded by _statisticsLock
+    NSObject *_statisticsLock;
+    NSUInteger _numberOfRequests;
+    NSUInteger _numberOfDroppedConnections;
+    NSTimeInterval _cpuTime;
+    NSMutableDictionary *_bytesReceived;    // endpoint -> bytes
+    NSMutableDictionary *_bytesSent;        // endpoint -> bytes
+}
+
+- (instancetype)initWithAccessToken:(NSString *)accessToken {
+    NSParameterAssert(accessToken);
+    self = [super init];
+    if (self) {
+        _accessToken = accessToken;
+        _acceptQueue = dispatch_queue_create("pt.meo.cloud.sdk.sample.stubserver.accept", DISPATCH_QUEUE_SERIAL);
+        _connections = [NSMutableSet new];
+        _metadata = [NSMutableDictionary new];
+        _children = [NSMutableDictionary new];
+        _listings = [NSMutableDictionary new];
+        _fileData = [NSMutableDictionary new];
+        _uploads = [NSMutableDictionary new];
+        _statisticsLock = [NSObject new];
+        _bytesReceived = [NSMutableDictionary new];
+        _bytesSent = [NSMutableDictionary new];
+        [self _addFolderMetadataAtPath:@"/"];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [self stop];
+}
+
+#pragma mark - Listening
+
+- (int)_listeningSocketOnPort:(uint16_t *)port error:(NSError **)error {
+    int listeningSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listeningSocket < 0) {
+        if (error) *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+        return -1;
+    }
+    int yes = 1;
+    setsockopt(listeningSocket, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_len = sizeof(address);
+    address.sin_family = AF_INET;
+    address.sin_port = htons(0);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    if (bind(listeningSocket, (struct sockaddr *)&address, sizeof(address)) != 0 ||
+        listen(listeningSocket, 64) != 0 ||
+        getsockname(listeningSocket, (struct sockaddr *)&address, &length) != 0) {
+        if (error) *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+        close(listeningSocket);
+        return -1;
+    }
+    *port = ntohs(address.sin_port);
+    return listeningSocket;
+}
+
+- (dispatch_source_t)_acceptSourceForSocket:(int)listeningSocket {
+    dispatch_source_t source = dispatch_source_create(DISPATCH_SOURCE_TYPE_READ, (uintptr_t)listeningSocket, 0, _acceptQueue);
+    __weak typeof(self) weakSelf = self;
+    dispatch_source_set_event_handler(source, ^{
+        int connection = accept(listeningSocket, NULL, NULL);
+        if (connection < 0) return;
+        int yes = 1;
+        setsockopt(connection, SOL_SOCKET, SO_NOSIGPIPE, &yes, sizeof(yes));
+        setsockopt(connection, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+
+        StubServer *server = weakSelf;
+        if (server == nil) {
+            close(connection);
+            return;
+        }
+        // blocking I/O, a thread per connection keeps slow connections from holding back the others
+        NSThread *thread = [[NSThread alloc] initWithTarget:server selector:@selector(_serveConnection:) object:@(connection)];
+        thread.name = @"pt.meo.cloud.sdk.sample.stubserver.connection";
+        [thread start];
+    });
+    dispatch_source_set_cancel_handler(source, ^{
+        close(listeningSocket);
+    });
+    dispatch_resume(source);
+    return source;
+}
+
+- (BOOL)start:(NSError **)error {
+    @synchronized(self) {
+        if (_apiSource) return YES;
+        _stopped = NO;
+
+        uint16_t apiPort = 0;
+        uint16_t contentPort = 0;
+        int apiSocket = [self _listeningSocketOnPort:&apiPort error:error];
+        if (apiSocket < 0) return NO;
+        int contentSocket = [self _listeningSocketOnPort:&contentPort error:error];
+        if (contentSocket < 0) {
+            close(apiSocket);
+            return NO;
+        }
+        self.apiPort = apiPort;
+        self.contentPort = contentPort;
+        _apiSource = [self _acceptSourceForSocket:apiSocket];
+        _contentSource = [self _acceptSourceForSocket:contentSocket];
+        NSLog(@"Stub server listening on 127.0.0.1:%u (API) and 127.0.0.1:%u (content)", apiPort, contentPort);
+        return YES;
+    }
+}
+
+- (void)stop {
+    @synchronized(self) {
+        if (_apiSource == nil) return;
+        _stopped = YES;
+        dispatch_source_cancel(_apiSource);
+        dispatch_source_cancel(_contentSource);
+        _apiSource = nil;
+        _contentSource = nil;
+    }
+    // wakes up the connection threads, they close their sockets themselves
+    @synchronized(_connections) {
+        for (NSNumber *connection in _connections) {
+            shutdown(connection.intValue, SHUT_RDWR);
+        }
+    }
+}
+
+#pragma mark - Connections
+
+- (void)_serveConnection:(NSNumber *)connectionNumber {
+    int connection = connectionNumber.intValue;
+    @synchronized(_connections) {
+        [_connections addObject:connectionNumber];
+    }
+    NSMutableData *buffer = [NSMutableData new];
+    BOOL keepAlive = YES;
+    while (keepAlive && !_stopped) {
+        @autoreleasepool {
+            NSTimeInterval cpuTime = StubServerThreadCPUTime();
+            keepAlive = [self _serveRequestOnConnection:connection buffer:buffer];
+            cpuTime = StubServerThreadCPUTime() - cpuTime;
+            @synchronized(_statisticsLock) {
+                _cpuTime += cpuTime;
+            }
+        }
+    }
+    @synchronized(_connections) {
+        [_connections removeObject:connectionNumber];
+    }
+    close(connection);
+}
+
+- (BOOL)_readFromConnection:(int)connection intoBuffer:(NSMutableData *)buffer {
+    uint8_t bytes[StubServerBufferSize];
+    ssize_t count;
+    do {
+        count = recv(connection, bytes, sizeof(bytes), 0);
+    } while (count < 0 && errno == EINTR);
+    if (count <= 0) return NO;
+    [buffer appendBytes:bytes length:(NSUInteger)count];
+    return YES;
+}
+
+- (BOOL)_writeBytes:(const void *)bytes length:(NSUInteger)length toConnection:(int)connection {
+    while (length > 0) {
+        ssize_t count = send(connection, bytes, length, 0);
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) return NO;
+        bytes = (const uint8_t *)bytes + count;
+        length -= (NSUInteger)count;
+    }
+    return YES;
+}
+
+// sleeps for as long as it takes to keep a transfer that started at startTime within the bandwidth
+- (void)_throttleBytes:(uint64_t)bytes startTime:(CFAbsoluteTime)startTime {
+    double bandwidth = self.bandwidth;
+    if (bandwidth <= 0) return;
+    NSTimeInterval ahead = bytes / bandwidth - (CFAbsoluteTimeGetCurrent() - startTime);
+    if (ahead > 0) usleep((useconds_t)(ahead * USEC_PER_SEC));
+}
+
+- (void)_addBytes:(uint64_t)bytes toCounts:(NSMutableDictionary *)counts endpoint:(NSString *)endpoint {
+    if (bytes == 0 || endpoint == nil) return;
+    @synchronized(_statisticsLock) {
+        counts[endpoint] = @([counts[endpoint] unsignedLongLongValue] + bytes);
+    }
+}
+
+// Returns NO when the connection should be closed.
+- (BOOL)_serveRequestOnConnection:(int)connection buffer:(NSMutableData *)buffer {
+    // head
+    NSData *separator = [@"\r\n\r\n" dataUsingEncoding:NSASCIIStringEncoding];
+    NSRange end;
+    while ((end = [buffer rangeOfData:separator options:0 range:NSMakeRange(0, buffer.length)]).location == NSNotFound) {
+        if (buffer.length > StubServerMaximumHeadLength) return NO;
+        if (![self _readFromConnection:connection intoBuffer:buffer]) return NO;
+    }
+    NSString *head = [[NSString alloc] initWithData:[buffer subdataWithRange:NSMakeRange(0, end.location)] encoding:NSISOLatin1StringEncoding];
+    [buffer replaceBytesInRange:NSMakeRange(0, NSMaxRange(end)) withBytes:NULL length:0];
+    StubServerRequest *request = [self _requestWithHead:head];
+    if (request == nil) {
+        [self _writeResponse:[StubServerResponse errorResponseWithStatusCode:400] forRequest:nil toConnection:connection];
+        return NO;
+    }
+    @synchronized(_statisticsLock) {
+        _numberOfRequests++;
+    }
+    StubServerFault (^faultBlock)(StubServerRequest *) = self.faultBlock;
+    StubServerFault fault = faultBlock ? faultBlock(request) : StubServerFaultNone;
+    if (fault == StubServerFaultDropRequestBody) {
+        [self _dropRequest:request onConnection:connection buffer:buffer];
+        return NO;
+    }
+
+    // body
+    NSData *body = [self _readBodyOfRequest:request fromConnection:connection buffer:buffer];
+    if (body == nil) return NO;
+    request.body = body;
+
+    StubServerResponse *response = nil;
+    switch (fault) {
+        case StubServerFaultBadRequest:
+            response = [StubServerResponse errorResponseWithStatusCode:400];
+            break;
+        case StubServerFaultUnauthorized:
+            response = [StubServerResponse errorResponseWithStatusCode:401];
+            break;
+        default:
+            response = [self _responseForRequest:request];
+            break;
+    }
+    if (fault == StubServerFaultDropResponseBody) {
+        response.bytesBeforeDrop = response.body.length / 2;
+    } else if (fault == StubServerFaultTruncatedBody) {
+        response.body = [response.body subdataWithRange:NSMakeRange(0, response.body.length / 2)];
+    }
+
+    NSTimeInterval latency = self.latency;
+    if (latency > 0) usleep((useconds_t)(latency * USEC_PER_SEC));
+    double lossRate = self.lossRate;
+    if (lossRate > 0 && response.body.length > 1 && arc4random_uniform(1000000) < lossRate * 1000000) {
+        response.bytesBeforeDrop = response.body.length / 2;
+    }
+    if (![self _writeResponse:response forRequest:request toConnection:connection]) return NO;
+    return ![[request.headers[@"connection"] lowercaseString] isEqualToString:@"close"];
+}
+
+// reads half of the request body, then closes the connection
+- (void)_dropRequest:(StubServerRequest *)request onConnection:(int)connection buffer:(NSMutableData *)buffer {
+    uint64_t length = request.contentLength / 2;
+    while (buffer.length < length) {
+        if (![self _readFromConnection:connection intoBuffer:buffer]) break;
+    }
+    [self _addBytes:MIN((uint64_t)buffer.length, length) toCounts:_bytesReceived endpoint:request.endpoint];
+    [buffer setLength:0];
+    @synchronized(_statisticsLock) {
+        _numberOfDroppedConnections++;
+    }
+}
+
+- (StubServerRequest *)_requestWithHead:(NSString *)head {
+    NSArray *lines = [head componentsSeparatedByString:@"\r\n"];
+    NSArray *requestLine = [lines.firstObject componentsSeparatedByString:@" "];
+    if (requestLine.count < 3) return nil;
+
+    NSMutableDictionary *headers = [NSMutableDictionary new];
+    for (NSString *line in [lines subarrayWithRange:NSMakeRange(1, lines.count - 1)]) {
+        NSRange colon = [line rangeOfString:@":"];
+        if (colon.location == NSNotFound) continue;
+        NSString *name = [[line substringToIndex:colon.location] lowercaseString];
+        headers[name] = [[line substringFromIndex:NSMaxRange(colon)] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+    }
+
+    StubServerRequest *request = [StubServerRequest new];
+    request.method = requestLine[0];
+    request.headers = headers;
+    request.contentLength = strtoull([headers[@"content-length"] UTF8String] ?: "0", NULL, 10);
+
+    NSString *target = requestLine[1];
+    NSRange questionMark = [target rangeOfString:@"?"];
+    NSString *encodedPath = (questionMark.location == NSNotFound) ? target : [target substringToIndex:questionMark.location];
+    request.query = (questionMark.location == NSNotFound) ? @{} : [self _parametersWithString:[target substringFromIndex:NSMaxRange(questionMark)]];
+
+    // API requests are /1/<endpoint>[/<mode>][/<path>], anything else is the authorization server
+    NSString *path = [encodedPath stringByRemovingPercentEncoding] ?: encodedPath;
+    NSString *apiPrefix = @"/1/";
+    if (![path hasPrefix:apiPrefix]) {
+        request.endpoint = path;
+        request.path = @"/";
+        return request;
+    }
+    request.APIRequest = YES;
+    NSMutableArray *components = [[[path substringFromIndex:apiPrefix.length] componentsSeparatedByString:@"/"] mutableCopy];
+    if (components.count >= 2 && [components[0] isEqualToString:@"Account"]) {
+        request.endpoint = [NSString stringWithFormat:@"%@/%@", components[0], components[1]];
+        [components removeObjectsInRange:NSMakeRange(0, 2)];
+    } else {
+        request.endpoint = components.firstObject;
+        [components removeObjectAtIndex:0];
+    }
+    if (components.count > 0 && ([components[0] isEqualToString:@"meocloud"] || [components[0] isEqualToString:@"sandbox"])) {
+        [components removeObjectAtIndex:0];
+    }
+    NSString *itemPath = [@"/" stringByAppendingString:[components componentsJoinedByString:@"/"]];
+    if (itemPath.length > 1 && [itemPath hasSuffix:@"/"]) itemPath = [itemPath substringToIndex:itemPath.length - 1];
+    request.path = itemPath;
+    return request;
+}
+
+- (NSDictionary *)_parametersWithString:(NSString *)string {
+    NSMutableDictionary *parameters = [NSMutableDictionary new];
+    for (NSString *pair in [string componentsSeparatedByString:@"&"]) {
+        if (pair.length == 0) continue;
+        NSRange equals = [pair rangeOfString:@"="];
+        NSString *key = (equals.location == NSNotFound) ? pair : [pair substringToIndex:equals.location];
+        NSString *value = (equals.location == NSNotFound) ? @"" : [pair substringFromIndex:NSMaxRange(equals)];
+        value = [[value stringByReplacingOccurrencesOfString:@"+" withString:@" "] stringByRemovingPercentEncoding] ?: value;
+        parameters[[key stringByRemovingPercentEncoding] ?: key] = value;
+    }
+    return parameters;
+}
+
+// Returns nil if the connection ended before the whole body arrived.
+- (NSData *)_readBodyOfRequest:(StubServerRequest *)request fromConnection:(int)connection buffer:(NSMutableData *)buffer {
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    uint64_t received = 0;
+    NSData *body = nil;
+
+    if ([[request.headers[@"transfer-encoding"] lowercaseString] isEqualToString:@"chunked"]) {
+        NSMutableData *chunkedBody = [NSMutableData new];
+        NSData *lineEnd = [@"\r\n" dataUsingEncoding:NSASCIIStringEncoding];
+        while (YES) {
+            NSRange end;
+            while ((end = [buffer rangeOfData:lineEnd options:0 range:NSMakeRange(0, buffer.length)]).location == NSNotFound) {
+                NSUInteger length = buffer.length;
+                if (![self _readFromConnection:connection intoBuffer:buffer]) {
+                    [self _addBytes:received + chunkedBody.length toCounts:_bytesReceived endpoint:request.endpoint];
+                    return nil;
+                }
+                received += buffer.length - length;
+            }
+            NSString *sizeLine = [[NSString alloc] initWithData:[buffer subdataWithRange:NSMakeRange(0, end.location)] encoding:NSASCIIStringEncoding];
+            NSUInteger chunkSize = (NSUInteger)strtoul(sizeLine.UTF8String, NULL, 16);
+            [buffer replaceBytesInRange:NSMakeRange(0, NSMaxRange(end)) withBytes:NULL length:0];
+            while (buffer.length < chunkSize + lineEnd.length) {
+                NSUInteger length = buffer.length;
+                if (![self _readFromConnection:connection intoBuffer:buffer]) {
+                    [self _addBytes:chunkedBody.length + buffer.length toCounts:_bytesReceived endpoint:request.endpoint];
+                    return nil;
+                }
+                received += buffer.length - length;
+                [self _throttleBytes:received startTime:startTime];
+            }
+            [chunkedBody appendData:[buffer subdataWithRange:NSMakeRange(0, chunkSize)]];
+            [buffer replaceBytesInRange:NSMakeRange(0, chunkSize + lineEnd.length) withBytes:NULL length:0];
+            if (chunkSize == 0) break;
+        }
+        body = chunkedBody;
+    } else {
+        uint64_t contentLength = request.contentLength;
+        while (buffer.length < contentLength) {
+            NSUInteger length = buffer.length;
+            if (![self _readFromConnection:connection intoBuffer:buffer]) {
+                [self _addBytes:buffer.length toCounts:_bytesReceived endpoint:request.endpoint];
+                return nil;
+            }
+            received += buffer.length - length;
+            [self _throttleBytes:received startTime:startTime];
+        }
+        body = [buffer subdataWithRange:NSMakeRange(0, (NSUInteger)contentLength)];
+        [buffer replaceBytesInRange:NSMakeRange(0, (NSUInteger)contentLength) withBytes:NULL length:0];
+    }
+    [self _addBytes:body.length toCounts:_bytesReceived endpoint:request.endpoint];
+    return body;
+}
+
+// Returns NO if the connection was dropped.
+- (BOOL)_writeResponse:(StubServerResponse *)response forRequest:(StubServerRequest *)request toConnection:(int)connection {
+    NSData *body = response.body;
+    NSMutableString *head = [NSMutableString stringWithFormat:@"HTTP/1.1 %ld %@\r\n", (long)response.statusCode,
+                             [NSHTTPURLResponse localizedStringForStatusCode:response.statusCode]];
+    if (response.headers[@"Content-Length"] == nil) {
+        [head appendFormat:@"Content-Length: %lu\r\n", (unsigned long)body.length];
+    }
+    for (NSString *name in response.headers) {
+        [head appendFormat:@"%@: %@\r\n", name, response.headers[name]];
+    }
+    [head appendString:@"\r\n"];
+    NSData *headData = [head dataUsingEncoding:NSISOLatin1StringEncoding];
+    if (![self _writeBytes:headData.bytes length:headData.length toConnection:connection]) return NO;
+
+    BOOL isHead = [request.method isEqualToString:@"HEAD"];
+    NSUInteger length = isHead ? 0 : body.length;
+    NSUInteger bytesBeforeDrop = response.bytesBeforeDrop;
+    if (bytesBeforeDrop != NSNotFound && bytesBeforeDrop < length) length = bytesBeforeDrop;
+
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    NSUInteger sent = 0;
+    while (sent < length) {
+        NSUInteger count = MIN(length - sent, (NSUInteger)StubServerBufferSize);
+        if (![self _writeBytes:(const uint8_t *)body.bytes + sent length:count toConnection:connection]) {
+            [self _addBytes:sent toCounts:_bytesSent endpoint:request.endpoint];
+            return NO;
+        }
+        sent += count;
+        [self _throttleBytes:sent startTime:startTime];
+    }
+    [self _addBytes:sent toCounts:_bytesSent endpoint:request.endpoint];
+
+    if (bytesBeforeDrop != NSNotFound && !isHead) {
+        @synchronized(_statisticsLock) {
+            _numberOfDroppedConnections++;
+        }
+        return NO;
+    }
+    return YES;
+}
+
+#pragma mark - Routing
+
+- (StubServerResponse *)_responseForRequest:(StubServerRequest *)request {
+    if (!request.isAPIRequest) {
+        if ([request.endpoint isEqualToString:@"/oauth2/token"]) return [self _tokenResponseForRequest:request];
+        return [StubServerResponse errorResponseWithStatusCode:404];
+    }
+
+    NSString *authorization = [NSString stringWithFormat:@"Bearer %@", self.accessToken];
+    if (![request.headers[@"authorization"] isEqualToString:authorization]) {
+        return [StubServerResponse errorResponseWithStatusCode:401];
+    }
+
+    NSString *endpoint = request.endpoint;
+    if ([endpoint isEqualToString:@"Account/Info"]) return [self _accountInfoResponse];
+    if ([endpoint isEqualToString:@"DisableAccessToken"]) return [StubServerResponse responseWithStatusCode:200 JSONObject:@{}];
+    if ([endpoint isEqualToString:@"Metadata"]) return [self _metadataResponseForRequest:request];
+    if ([endpoint isEqualToString:@"Search"]) return [self _searchResponseForRequest:request];
+    if ([endpoint isEqualToString:@"Thumbnails"]) return [self _thumbnailResponseForRequest:request];
+    if ([endpoint isEqualToString:@"Files"]) return [self _fileResponseForRequest:request];
+    if ([endpoint isEqualToString:@"ChunkedUpload"]) return [self _chunkedUploadResponseForRequest:request];
+    if ([endpoint isEqualToString:@"CommitChunkedUpload"]) return [self _commitChunkedUploadResponseForRequest:request];
+    return [StubServerResponse errorResponseWithStatusCode:404];
+}
+
+- (StubServerResponse *)_tokenResponseForRequest:(StubServerRequest *)request {
+    return [StubServerResponse responseWithStatusCode:200 JSONObject:@{@"access_token": self.accessToken,
+                                                                        @"token_type": @"Bearer",
+                                                                        @"refresh_token": @"stub-refresh-token",
+                                                                        @"scope": @"",
+                                                                        @"expires_in": @(24 * 60 * 60)}];
+}
+
+- (StubServerResponse *)_accountInfoResponse {
+    return [StubServerResponse responseWithStatusCode:200 JSONObject:@{@"uid": @"00000000-0000-0000-0000-000000000001",
+                                                                        @"display_name": @"Stub Server",
+                                                                        @"email": @"stub@localhost",
+                                                                        @"active": @YES,
+                                                                        @"trial": @NO,
+                                                                        @"quota_info": @{@"quota": @(1ULL << 40), @"normal": @0, @"shared": @0}}];
+}
+
+- (StubServerResponse *)_metadataResponseForRequest:(StubServerRequest *)request {
+    NSString *key = request.path.lowercaseString;
+    NSDictionary *metadata = nil;
+    NSData *contents = nil;
+    @synchronized(self) {
+        metadata = _metadata[key];
+        if ([metadata[@"is_dir"] boolValue] && ![request.query[@"list"] isEqualToString:@"false"]) {
+            contents = _listings[key];
+            if (contents == nil) {
+                contents = [NSJSONSerialization dataWithJSONObject:[_children[key] allValues] ?: @[] options:0 error:nil];
+                _listings[key] = contents;
+            }
+        }
+    }
+    if (metadata == nil) return [StubServerResponse errorResponseWithStatusCode:404];
+    if (contents == nil) return [StubServerResponse responseWithStatusCode:200 JSONObject:metadata];
+
+    // splice the cached contents in, serializing a large listing on every request would make the server the bottleneck
+    NSMutableDictionary *folder = [metadata mutableCopy];
+    folder[@"contents"] = @[];
+    NSMutableData *data = [[NSJSONSerialization dataWithJSONObject:folder options:0 error:nil] mutableCopy];
+    NSData *placeholder = [@"\"contents\":[]" dataUsingEncoding:NSUTF8StringEncoding];
+    NSRange range = [data rangeOfData:placeholder options:0 range:NSMakeRange(0, data.length)];
+    if (range.location == NSNotFound) return [StubServerResponse errorResponseWithStatusCode:500];
+    range = NSMakeRange(NSMaxRange(range) - 2, 2);
+    [data replaceBytesInRange:range withBytes:contents.bytes length:contents.length];
+    return [StubServerResponse responseWithStatusCode:200 data:data contentType:@"application/json"];
+}
+
+- (StubServerResponse *)_searchResponseForRequest:(StubServerRequest *)request {
+    NSString *folderKey = request.path.lowercaseString;
+    NSString *prefix = [folderKey hasSuffix:@"/"] ? folderKey : [folderKey stringByAppendingString:@"/"];
+    NSString *query = request.query[@"query"];
+    if (query.length == 0) return [StubServerResponse errorResponseWithStatusCode:400];
+    NSUInteger limit = request.query[@"file_limit"] ? (NSUInteger)[request.query[@"file_limit"] integerValue] : StubServerDefaultSearchLimit;
+    NSString *mimeType = request.query[@"mime_type"];
+
+    NSMutableArray *results = [NSMutableArray new];
+    @synchronized(self) {
+        if (_metadata[folderKey] == nil) return [StubServerResponse errorResponseWithStatusCode:404];
+        for (NSString *key in _metadata) {
+            if (results.count >= limit) break;
+            if (![key hasPrefix:prefix]) continue;
+            NSDictionary *metadata = _metadata[key];
+            if (mimeType && ![metadata[@"mime_type"] hasPrefix:mimeType]) continue;
+            if ([[key lastPathComponent] rangeOfString:query options:NSCaseInsensitiveSearch].location == NSNotFound) continue;
+            [results addObject:metadata];
+        }
+    }
+    return [StubServerResponse responseWithStatusCode:200 JSONObject:results];
+}
+
+- (StubServerResponse *)_thumbnailResponseForRequest:(StubServerRequest *)request {
+    NSDictionary *metadata = [self metadataForItemAtPath:request.path];
+    if (![metadata[@"thumb_exists"] boolValue]) return [StubServerResponse errorResponseWithStatusCode:404];
+    NSData *thumbnail = [[NSData alloc] initWithBase64EncodedString:StubServerThumbnail options:0];
+    return [StubServerResponse responseWithStatusCode:200 data:thumbnail contentType:@"image/png"];
+}
+
+- (StubServerResponse *)_fileResponseForRequest:(StubServerRequest *)request {
+    NSDictionary *metadata = [self metadataForItemAtPath:request.path];
+    if (metadata == nil || [metadata[@"is_dir"] boolValue]) return [StubServerResponse errorResponseWithStatusCode:404];
+    NSData *data = [self dataForFileAtPath:request.path];
+    NSString *entityTag = [NSString stringWithFormat:@"\"%@\"", metadata[@"rev"]];
+
+    // a range is only honoured for the revision it was asked for
+    NSString *range = request.headers[@"range"];
+    NSString *ifRange = request.headers[@"if-range"];
+    if (range && (ifRange == nil || [ifRange isEqualToString:entityTag])) {
+        unsigned long long start = 0;
+        unsigned long long end = data.length > 0 ? data.length - 1 : 0;
+        NSScanner *scanner = [NSScanner scannerWithString:range];
+        BOOL valid = [scanner scanString:@"bytes=" intoString:NULL] && [scanner scanUnsignedLongLong:&start] && [scanner scanString:@"-" intoString:NULL];
+        if (valid && !scanner.isAtEnd) valid = [scanner scanUnsignedLongLong:&end];
+        end = MIN(end, data.length > 0 ? data.length - 1 : 0);
+        if (!valid || start >= data.length || start > end) {
+            StubServerResponse *response = [StubServerResponse errorResponseWithStatusCode:416];
+            response.headers[@"Content-Range"] = [NSString stringWithFormat:@"bytes */%lu", (unsigned long)data.length];
+            return response;
+        }
+        NSData *part = [data subdataWithRange:NSMakeRange((NSUInteger)start, (NSUInteger)(end - start + 1))];
+        StubServerResponse *response = [StubServerResponse responseWithStatusCode:206 data:part contentType:metadata[@"mime_type"]];
+        response.headers[@"Content-Range"] = [NSString stringWithFormat:@"bytes %llu-%llu/%lu", start, end, (unsigned long)data.length];
+        response.headers[@"ETag"] = entityTag;
+        response.headers[@"Accept-Ranges"] = @"bytes";
+        return response;
+    }
+
+    StubServerResponse *response = [StubServerResponse responseWithStatusCode:200 data:data contentType:metadata[@"mime_type"]];
+    response.headers[@"ETag"] = entityTag;
+    response.headers[@"Accept-Ranges"] = @"bytes";
+    response.headers[@"Last-Modified"] = metadata[@"modified"];
+    return response;
+}
+
+- (StubServerResponse *)_chunkedUploadResponseForRequest:(StubServerRequest *)request {
+    if (![request.method isEqualToString:@"PUT"] && ![request.method isEqualToString:@"POST"]) return [StubServerResponse errorResponseWithStatusCode:405];
+    NSString *uploadIdentifier = request.query[@"upload_id"];
+    uint64_t offset = strtoull([request.query[@"offset"] UTF8String] ?: "0", NULL, 10);
+    uint64_t length = 0;
+    @synchronized(self) {
+        NSMutableData *upload = nil;
+        if (uploadIdentifier) {
+            upload = _uploads[uploadIdentifier];
+            if (upload == nil) return [StubServerResponse errorResponseWithStatusCode:404];
+        } else {
+            uploadIdentifier = [[NSUUID UUID] UUIDString];
+            upload = [NSMutableData new];
+            _uploads[uploadIdentifier] = upload;
+        }
+        // the offset must be where the upload stands, the client skips chunks we say are wrong
+        if (offset != upload.length) {
+            return [StubServerResponse responseWithStatusCode:400 JSONObject:@{@"upload_id": uploadIdentifier, @"offset": @(upload.length)}];
+        }
+        [upload appendData:request.body];
+        length = upload.length;
+    }
+    NSString *expires = [BenchmarkFixtures serviceDateStringWithDate:[NSDate dateWithTimeIntervalSinceNow:StubServerUploadLifetime]];
+    return [StubServerResponse responseWithStatusCode:200 JSONObject:@{@"upload_id": uploadIdentifier, @"offset": @(length), @"expires": expires}];
+}
+
+- (StubServerResponse *)_commitChunkedUploadResponseForRequest:(StubServerRequest *)request {
+    if (![request.method isEqualToString:@"POST"]) return [StubServerResponse errorResponseWithStatusCode:405];
+    NSString *form = [[NSString alloc] initWithData:request.body encoding:NSUTF8StringEncoding];
+    NSDictionary *parameters = [self _parametersWithString:form ?: @""];
+    NSString *uploadIdentifier = parameters[@"upload_id"];
+    BOOL overwrite = [parameters[@"overwrite"] isEqualToString:@"true"];
+
+    NSDictionary *metadata = nil;
+    @synchronized(self) {
+        NSData *upload = uploadIdentifier ? _uploads[uploadIdentifier] : nil;
+        if (upload == nil) return [StubServerResponse errorResponseWithStatusCode:400];
+        NSString *path = request.path;
+        if (!overwrite) {
+            // like the service, keep both files
+            NSString *extension = path.pathExtension;
+            NSString *base = path.stringByDeletingPathExtension;
+            for (NSUInteger copy = 1; _metadata[path.lowercaseString] != nil; copy++) {
+                path = [NSString stringWithFormat:@"%@ (%lu)", base, (unsigned long)copy];
+                if (extension.length > 0) path = [path stringByAppendingPathExtension:extension];
+            }
+        }
+        metadata = [self _addFileMetadataAtPath:path data:upload];
+        [_uploads removeObjectForKey:uploadIdentifier];
+    }
+    return [StubServerResponse responseWithStatusCode:200 JSONObject:metadata];
+}
+
+#pragma mark - Contents
+
+// must be called inside @synchronized(self)
+- (void)_addMetadata:(NSDictionary *)metadata atPath:(NSString *)path {
+    NSString *key = path.lowercaseString;
+    _metadata[key] = metadata;
+    if ([metadata[@"is_dir"] boolValue] && _children[key] == nil) _children[key] = [NSMutableDictionary new];
+    if ([key isEqualToString:@"/"]) return;
+
+    NSString *parentPath = path.stringByDeletingLastPathComponent;
+    if (_metadata[parentPath.lowercaseString] == nil) [self _addFolderMetadataAtPath:parentPath];
+    _children[parentPath.lowercaseString][key] = metadata;
+    [_listings removeObjectForKey:parentPath.lowercaseString];
+}
+
+// must be called inside @synchronized(self)
+- (void)_addFolderMetadataAtPath:(NSString *)path {
+    NSMutableDictionary *metadata = [[BenchmarkFixtures folderDictionaryWithPath:path numberOfItems:0] mutableCopy];
+    [metadata removeObjectForKey:@"contents"];
+    [self _addMetadata:metadata atPath:path];
+}
+
+// must be called inside @synchronized(self)
+- (NSDictionary *)_addFileMetadataAtPath:(NSString *)path data:(NSData *)data {
+    NSMutableDictionary *metadata = [[BenchmarkFixtures fileDictionaryWithPath:path size:data.length] mutableCopy];
+    metadata[@"rev"] = [NSString stringWithFormat:@"%016llx", ++_lastRevision];
+    metadata[@"modified"] = [BenchmarkFixtures serviceDateStringWithDate:[NSDate date]];
+    [self _addMetadata:metadata atPath:path];
+    _fileData[path.lowercaseString] = [data copy];
+    return metadata;
+}
+
+- (void)addFolderAtPath:(NSString *)path numberOfItems:(NSUInteger)numberOfItems {
+    NSParameterAssert(path);
+    NSArray *items = [BenchmarkFixtures itemDictionariesWithCount:numberOfItems inFolder:path];
+    @synchronized(self) {
+        [self _addFolderMetadataAtPath:path];
+        for (NSDictionary *item in items) {
+            [self _addMetadata:item atPath:item[@"path"]];
+        }
+    }
+}
+
+- (void)addFileAtPath:(NSString *)path data:(NSData *)data {
+    NSParameterAssert(path);
+    NSParameterAssert(data);
+    @synchronized(self) {
+        [self _addFileMetadataAtPath:path data:data];
+    }
+}
+
+- (NSDictionary *)metadataForItemAtPath:(NSString *)path {
+    NSParameterAssert(path);
+    @synchronized(self) {
+        return _metadata[path.lowercaseString];
+    }
+}
+
+- (NSData *)dataForFileAtPath:(NSString *)path {
+    NSParameterAssert(path);
+    NSDictionary *metadata = nil;
+    @synchronized(self) {
+        NSData *data = _fileData[path.lowercaseString];
+        if (data) return data;
+        metadata = _metadata[path.lowercaseString];
+    }
+    if (metadata == nil || [metadata[@"is_dir"] boolValue]) return nil;
+
+    // listed files without contents of their own get the same made-up bytes every time
+    NSUInteger size = [metadata[@"bytes"] unsignedIntegerValue];
+    NSMutableData *data = [NSMutableData dataWithLength:size];
+    uint32_t state = (uint32_t)[metadata[@"path"] hash] | 1;
+    uint8_t *bytes = data.mutableBytes;
+    for (NSUInteger i = 0; i < size; i++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        bytes[i] = (uint8_t)state;
+    }
+    return data;
+}
+
+#pragma mark - Statistics
+
+- (NSUInteger)numberOfRequests {
+    @synchronized(_statisticsLock) {
+        return _numberOfRequests;
+    }
+}
+
+- (NSUInteger)numberOfDroppedConnections {
+    @synchronized(_statisticsLock) {
+        return _numberOfDroppedConnections;
+    }
+}
+
+- (NSTimeInterval)cpuTime {
+    @synchronized(_statisticsLock) {
+        return _cpuTime;
+    }
+}
+
+- (uint64_t)bytesReceivedForEndpoint:(NSString *)endpoint {
+    @synchronized(_statisticsLock) {
+        return [_bytesReceived[endpoint] unsignedLongLongValue];
+    }
+}
+
+- (uint64_t)bytesSentForEndpoint:(NSString *)endpoint {
+    @synchronized(_statisticsLock) {
+        return [_bytesSent[endpoint] unsignedLongLongValue];
+    }
+}
+
+- (void)resetStatistics {
+    @synchronized(_statisticsLock) {
+        _numberOfRequests = 0;
+        _numberOfDroppedConnections = 0;
+        _cpuTime = 0;
+        [_bytesReceived removeAllObjects];
+        [_bytesSent removeAllObjects];
+    }
+}
+
+@end
@@ -30,4 +30,12 @@
     return @"meocloud";
 }
 
+// To run against a stub server on the loopback interface, override the scheme, hosts and ports, e.g.:
+//
+// - (NSString *)_apiScheme { return @"http"; }
+// - (NSString *)_apiHost { return @"127.0.0.1"; }
+// - (NSNumber *)_apiPort { return @8080; }
+// - (NSString *)_apiContentHost { return @"127.0.0.1"; }
+// - (NSNumber *)_apiContentPort { return @8081; }
+
 @end
@@ -10,11 +10,14 @@
 
 #import <MEOCloudSDK/MEOCloudSDK.h>
 
+#import "BenchmarkSuites.h"
+
 @implementation AppDelegate
 
 - (BOOL)application:(UIApplication *)application didFinishLaunchingWithOptions:(NSDictionary *)launchOptions
 {
     // Override point for customization after application launch.
+    [BenchmarkSuites runRequestedSuites];
     return YES;
 }
 							